@@ -0,0 +1,409 @@
+/**
+ * @file bcdp_bench.cc
+ * @author Derek Huang
+ * @brief pdcpl_bcdp lexer and parser throughput benchmark
+ * @copyright MIT License
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <vector>
+
+#define PDCPL_HAS_PROGRAM_USAGE
+#define PDCPL_HAS_PROGRAM_OPTIONS
+#include "pdcpl/bench.h"
+#include "pdcpl/cliopts.h"
+#include "pdcpl/core.h"
+
+#include "pdcpl/cdcl_parser.hh"
+
+/**
+ * Static globals set during program option parsing.
+ */
+static std::filesystem::path data_dir{PDCPL_BCDP_BENCH_DATA_DIR};
+static const char *json_path_target = nullptr;
+static unsigned long scale = 1000;
+static pdcpl_bench_options bench_options = PDCPL_BENCH_OPTIONS_DEFAULT;
+
+/**
+ * Number of declarations in the scaled input, set by the case setup.
+ */
+static std::size_t n_input_dclns = 0;
+
+/**
+ * Action to set the directory the `bdcl.in.*` input files are read from.
+ */
+static
+PDCPL_CLIOPT_ACTION(data_dir_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  auto path = argv[argi + 1];
+  if (!std::filesystem::exists(path))
+    return PDCPL_CLIOPT_ERROR_NO_PATH_EXISTS;
+  if (!std::filesystem::is_directory(path))
+    return PDCPL_CLIOPT_ERROR_INVALID_VALUE;
+  data_dir = path;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the number of times the input files are repeated.
+ */
+static
+PDCPL_CLIOPT_ACTION(scale_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  errno = 0;
+  auto value = std::strtoul(argv[argi + 1], &end, 10);
+  if (end == argv[argi + 1] || *end || errno)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (!value)
+    return PDCPL_CLIOPT_ERROR_EXPECTED_POSITIVE;
+  scale = value;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the path results are written to as JSON.
+ */
+static
+PDCPL_CLIOPT_ACTION(json_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  json_path_target = argv[argi + 1];
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the minimum seconds per sample.
+ */
+static
+PDCPL_CLIOPT_ACTION(min_time_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  double min_time = std::strtod(argv[argi + 1], &end);
+  if (end == argv[argi + 1] || *end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (min_time <= 0)
+    return PDCPL_CLIOPT_ERROR_EXPECTED_POSITIVE;
+  bench_options.min_time = min_time;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the number of samples.
+ */
+static
+PDCPL_CLIOPT_ACTION(samples_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  long samples = std::strtol(argv[argi + 1], &end, 10);
+  if (end == argv[argi + 1] || *end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (samples <= 0 || samples > PDCPL_BENCH_MAX_SAMPLES)
+    return PDCPL_CLIOPT_ERROR_INVALID_VALUE;
+  bench_options.samples = static_cast<unsigned int>(samples);
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+PDCPL_PROGRAM_USAGE_DEF
+(
+  "Measure pdcpl_bcdp lexer and parser throughput in declarations per second.\n"
+  "\n"
+  "The bdcl.in.* files in the data directory are concatenated and repeated\n"
+  "-n times, then parsed from a string, from a memory-mapped file, and from\n"
+  "stdin redirected to the same file. Declarations are streamed to a sink\n"
+  "that only counts them, so the lexer and parser are what is measured.\n"
+  "\n"
+  "Each case is sampled like pdcpl_bench. The median and median absolute\n"
+  "deviation of the time per parse are reported, followed by the median and\n"
+  "best declarations per second and the deviation relative to the median."
+)
+
+PDCPL_PROGRAM_OPTIONS_DEF
+{
+  {
+    "-d", "--data-dir",
+    "Directory with the bdcl.in.* input files, defaults to the source data/",
+    1,
+    data_dir_action,
+    NULL
+  },
+  {
+    "-n", "--scale",
+    "Number of times the input files are repeated, defaults to 1000",
+    1,
+    scale_action,
+    NULL
+  },
+  {
+    "-o", "--json",
+    "Also write results as JSON to the given path",
+    1,
+    json_action,
+    NULL
+  },
+  {
+    "-t", "--min-time",
+    "Minimum seconds per sample, defaults to 0.01",
+    1,
+    min_time_action,
+    NULL
+  },
+  {
+    "-s", "--samples",
+    "Number of samples per case, defaults to 15",
+    1,
+    samples_action,
+    NULL
+  },
+  PDCPL_PROGRAM_OPTIONS_END
+};
+
+namespace {
+
+/**
+ * Parser benchmark context.
+ *
+ * @param text Scaled input text
+ * @param path Temporary file the scaled input is written to
+ * @param parser Parser streaming declarations to a counting sink
+ * @param n_dclns Number of declarations seen by the sink in the last parse
+ */
+struct bcdp_context {
+  std::string text;
+  std::filesystem::path path;
+  pdcpl::cdcl_parser parser;
+  std::size_t n_dclns = 0;
+};
+
+/**
+ * Return the scaled input text.
+ *
+ * The input files are sorted by name so the text is the same on every run.
+ *
+ * @param dir Directory with the `bdcl.in.*` input files
+ * @param n Number of times to repeat the input files
+ */
+std::string scaled_input(const std::filesystem::path& dir, unsigned long n)
+{
+  std::vector<std::filesystem::path> paths;
+  for (const auto& entry : std::filesystem::directory_iterator{dir}) {
+    if (entry.path().filename().string().rfind("bdcl.in.", 0) == 0)
+      paths.push_back(entry.path());
+  }
+  std::sort(paths.begin(), paths.end());
+  std::string input;
+  for (const auto& path : paths) {
+    std::ifstream f{path, std::ios::binary};
+    input.append(std::istreambuf_iterator<char>{f}, {});
+  }
+  std::string text;
+  text.reserve(input.size() * n);
+  for (unsigned long i = 0; i < n; i++)
+    text += input;
+  return text;
+}
+
+/**
+ * Free parser benchmark context and remove its temporary file.
+ */
+int bcdp_teardown(pdcpl_bench_state* state)
+{
+  auto ctx = static_cast<bcdp_context*>(state->ctx);
+  if (ctx) {
+    std::error_code ec;
+    std::filesystem::remove(ctx->path, ec);
+  }
+  delete ctx;
+  return 0;
+}
+
+/**
+ * Create the scaled input, write it to a temporary file, and count its
+ * declarations with an untimed parse.
+ *
+ * Redeclaration checks are disabled since the repeated input declares each
+ * identifier many times, which also keeps the sink from holding any state.
+ */
+int bcdp_setup(pdcpl_bench_state* state)
+{
+  auto ctx = new(std::nothrow) bcdp_context;
+  if (!ctx)
+    return -ENOMEM;
+  state->ctx = ctx;
+  try {
+    ctx->text = scaled_input(data_dir, scale);
+    ctx->path = std::filesystem::temp_directory_path() /
+      ("pdcpl_bcdp_bench." + std::to_string(scale) + ".in");
+    std::ofstream f{ctx->path, std::ios::binary};
+    f.write(ctx->text.data(), static_cast<std::streamsize>(ctx->text.size()));
+    f.close();
+    if (!f) {
+      bcdp_teardown(state);
+      return -EIO;
+    }
+    ctx->parser.set_sink(
+      [ctx](const pdcpl::cdcl_dcln&, const pdcpl::cdcl_position&)
+      {
+        ctx->n_dclns++;
+      },
+      false
+    );
+    if (ctx->text.empty()) {
+      std::fprintf(
+        stderr,
+        "%s: no bdcl.in.* input in %s\n",
+        PDCPL_PROGRAM_NAME,
+        data_dir.string().c_str()
+      );
+      bcdp_teardown(state);
+      return -EINVAL;
+    }
+    if (!ctx->parser.parse_string(ctx->text)) {
+      std::fprintf(
+        stderr,
+        "%s: %s\n",
+        PDCPL_PROGRAM_NAME,
+        ctx->parser.last_error().c_str()
+      );
+      bcdp_teardown(state);
+      return -EINVAL;
+    }
+  }
+  catch (const std::exception& exc) {
+    std::fprintf(stderr, "%s: %s\n", PDCPL_PROGRAM_NAME, exc.what());
+    bcdp_teardown(state);
+    return -EIO;
+  }
+  n_input_dclns = ctx->n_dclns;
+  state->bytes = ctx->text.size();
+  return 0;
+}
+
+/**
+ * Run a parse function the requested number of iterations.
+ *
+ * @tparam F Callable taking `bcdp_context&` and returning `true` on success
+ *
+ * @param state Benchmark state
+ * @param parse Parse function
+ * @returns 0 on success, -EIO if a parse fails or misses declarations
+ */
+template <typename F>
+int bcdp_parse(pdcpl_bench_state* state, F parse)
+{
+  auto ctx = static_cast<bcdp_context*>(state->ctx);
+  for (std::uint64_t n = 0; n < state->iterations; n++) {
+    ctx->n_dclns = 0;
+    if (!parse(*ctx) || ctx->n_dclns != n_input_dclns)
+      return -EIO;
+  }
+  return 0;
+}
+
+/**
+ * Parse the scaled input from a string.
+ */
+int bcdp_string_bench(pdcpl_bench_state* state)
+{
+  return bcdp_parse(
+    state, [](bcdp_context& ctx) { return ctx.parser.parse_string(ctx.text); }
+  );
+}
+
+/**
+ * Parse the scaled input from its memory-mapped temporary file.
+ */
+int bcdp_mmap_bench(pdcpl_bench_state* state)
+{
+  return bcdp_parse(
+    state, [](bcdp_context& ctx) { return ctx.parser.parse(ctx.path); }
+  );
+}
+
+/**
+ * Parse the scaled input from `stdin` redirected to its temporary file.
+ *
+ * `stdin` is reopened for each parse, which is negligible next to the parse.
+ */
+int bcdp_stdin_bench(pdcpl_bench_state* state)
+{
+  return bcdp_parse(
+    state,
+    [](bcdp_context& ctx)
+    {
+      if (!std::freopen(ctx.path.string().c_str(), "rb", stdin))
+        return false;
+      return ctx.parser.parse();
+    }
+  );
+}
+
+/**
+ * Benchmark cases, one per input source.
+ */
+const pdcpl_bench_case bcdp_cases[] = {
+  {"bcdp/string", bcdp_string_bench, bcdp_setup, bcdp_teardown},
+  {"bcdp/mmap", bcdp_mmap_bench, bcdp_setup, bcdp_teardown},
+  {"bcdp/stdin", bcdp_stdin_bench, bcdp_setup, bcdp_teardown},
+  PDCPL_BENCH_CASES_END
+};
+
+}  // namespace
+
+PDCPL_ARG_MAIN
+{
+  PDCPL_PARSE_PROGRAM_OPTIONS();
+  pdcpl_bench_result results[PDCPL_ARRAY_SIZE(bcdp_cases)] = {};
+  std::printf(
+    "%-40s %15s %13s %12s %15s\n",
+    "case", "median", "mad", "iterations", "throughput"
+  );
+  std::size_t n_results = 0;
+  int status = 0;
+  for (const pdcpl_bench_case* bc = bcdp_cases; bc->name; bc++) {
+    auto res = results + n_results;
+    if ((status = pdcpl_bench_run(bc, &bench_options, res))) {
+      PDCPL_PRINT_ERROR_EX("error: %s: %s\n", bc->name, std::strerror(-status));
+      break;
+    }
+    pdcpl_bench_fprintf(stdout, res);
+    // declarations per second from the median and fastest times per parse
+    auto n_dclns = static_cast<double>(n_input_dclns);
+    std::printf(
+      "  %zu dclns, %.0f dclns/s median, %.0f dclns/s best, mad %.1f%%\n",
+      n_input_dclns,
+      1e9 * n_dclns / res->median_ns,
+      1e9 * n_dclns / res->min_ns,
+      100 * res->mad_ns / res->median_ns
+    );
+    n_results++;
+    std::fflush(stdout);
+  }
+  // write JSON results even if a case failed so completed cases are kept
+  if (json_path_target) {
+    auto f = std::fopen(json_path_target, "w");
+    if (!f || pdcpl_bench_fprintf_json(f, results, n_results)) {
+      PDCPL_PRINT_ERROR_EX("error: unable to write %s\n", json_path_target);
+      status = -EIO;
+    }
+    if (f)
+      std::fclose(f);
+  }
+  return (status) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file bench_suites.h
+ * @author Derek Huang
+ * @brief C header declaring the pdcpl_bench benchmark suites
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_BENCH_SUITES_H_
+#define PDCPL_BENCH_SUITES_H_
+
+#include <stdint.h>
+
+#include "pdcpl/bench.h"
+#include "pdcpl/common.h"
+
+/**
+ * Benchmark suites, each terminated by `PDCPL_BENCH_CASES_END`.
+ */
+extern const pdcpl_bench_case pdcpl_bench_bitwise_cases[];
+extern const pdcpl_bench_case pdcpl_bench_dsv_cases[];
+extern const pdcpl_bench_case pdcpl_bench_histogram_cases[];
+extern const pdcpl_bench_case pdcpl_bench_memory_cases[];
+extern const pdcpl_bench_case pdcpl_bench_pipeline_cases[];
+extern const pdcpl_bench_case pdcpl_bench_queue_cases[];
+extern const pdcpl_bench_case pdcpl_bench_string_cases[];
+extern const pdcpl_bench_case pdcpl_bench_thread_pool_cases[];
+extern const pdcpl_bench_case pdcpl_bench_variant_cases[];
+
+/**
+ * Return the next value of a 64-bit linear congruential generator.
+ *
+ * Benchmark inputs use this so they are the same on every run and platform.
+ *
+ * @param state Address of generator state
+ */
+PDCPL_INLINE uint64_t
+pdcpl_bench_lcg(uint64_t *state)
+{
+  *state = *state * 6364136223846793005u + 1442695040888963407u;
+  return *state >> 16;
+}
+
+#endif  // PDCPL_BENCH_SUITES_H_
@@ -0,0 +1,103 @@
+/**
+ * @file bitwise_bench.c
+ * @author Derek Huang
+ * @brief bitwise.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/bitwise.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+
+/**
+ * Number of input values.
+ */
+#define N_VALUES 1024
+
+/**
+ * Allocate pseudo-random input values.
+ */
+static int
+values_setup(pdcpl_bench_state *state)
+{
+  unsigned int *values = malloc(N_VALUES * sizeof *values);
+  if (!values)
+    return -ENOMEM;
+  uint64_t seed = 42;
+  for (size_t i = 0; i < N_VALUES; i++)
+    values[i] = (unsigned int) pdcpl_bench_lcg(&seed);
+  state->ctx = values;
+  state->bytes = N_VALUES * sizeof *values;
+  return 0;
+}
+
+/**
+ * Free input values.
+ */
+static int
+values_teardown(pdcpl_bench_state *state)
+{
+  free(state->ctx);
+  return 0;
+}
+
+/**
+ * Count 1-bits in each value.
+ */
+static int
+bitcount_bench(pdcpl_bench_state *state)
+{
+  const unsigned int *values = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    unsigned int total = 0;
+    for (size_t i = 0; i < N_VALUES; i++)
+      total += pdcpl_bitcount(values[i]);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(total);
+  }
+  return 0;
+}
+
+/**
+ * Set a bit field in each value.
+ */
+static int
+setbits_bench(pdcpl_bench_state *state)
+{
+  const unsigned int *values = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    unsigned int out = 0;
+    for (size_t i = 0; i < N_VALUES; i++)
+      pdcpl_setbits(values[i], &out, 20, 8, out);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(out);
+  }
+  return 0;
+}
+
+/**
+ * Rotate each value right.
+ */
+static int
+rrotbits_bench(pdcpl_bench_state *state)
+{
+  const unsigned int *values = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    unsigned int total = 0;
+    for (size_t i = 0; i < N_VALUES; i++)
+      total ^= pdcpl_rrotbits(values[i], (unsigned short) (i % 32));
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(total);
+  }
+  return 0;
+}
+
+const pdcpl_bench_case pdcpl_bench_bitwise_cases[] = {
+  {"bitwise/bitcount", bitcount_bench, values_setup, values_teardown},
+  {"bitwise/setbits", setbits_bench, values_setup, values_teardown},
+  {"bitwise/rrotbits", rrotbits_bench, values_setup, values_teardown},
+  PDCPL_BENCH_CASES_END
+};
@@ -0,0 +1,305 @@
+/**
+ * @file datagen.c
+ * @author Derek Huang
+ * @brief Deterministic synthetic input generator for throughput tests
+ * @copyright MIT License
+ */
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif  // _WIN32
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PDCPL_HAS_PROGRAM_USAGE
+#define PDCPL_HAS_PROGRAM_OPTIONS
+#include "bench_suites.h"
+#include "pdcpl/cliopts.h"
+#include "pdcpl/common.h"
+#include "pdcpl/core.h"
+
+/**
+ * Kinds of data that can be generated.
+ */
+typedef enum {
+  DATAGEN_TEXT,
+  DATAGEN_LONG_LINES,
+  DATAGEN_NUMERIC,
+  DATAGEN_DCLN
+} datagen_kind;
+
+/**
+ * Static globals set during program option parsing.
+ */
+static datagen_kind kind_target = DATAGEN_TEXT;
+static uint64_t size_target = 1 << 20;
+static uint64_t seed_target = 1;
+static const char *output_target = NULL;
+
+/**
+ * Action to set the kind of data generated.
+ */
+static
+PDCPL_CLIOPT_ACTION(kind_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  const char *kind = argv[argi + 1];
+  if (!strcmp(kind, "text"))
+    kind_target = DATAGEN_TEXT;
+  else if (!strcmp(kind, "long"))
+    kind_target = DATAGEN_LONG_LINES;
+  else if (!strcmp(kind, "numeric"))
+    kind_target = DATAGEN_NUMERIC;
+  else if (!strcmp(kind, "dcln"))
+    kind_target = DATAGEN_DCLN;
+  else
+    return PDCPL_CLIOPT_ERROR_INVALID_VALUE;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the approximate output size, with optional K, M, G suffix.
+ */
+static
+PDCPL_CLIOPT_ACTION(size_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  unsigned long long size = strtoull(argv[argi + 1], &end, 10);
+  if (end == argv[argi + 1])
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  switch (*end) {
+    case 'G':
+      size <<= 10;
+      // fall through
+    case 'M':
+      size <<= 10;
+      // fall through
+    case 'K':
+      size <<= 10;
+      end++;
+      // fall through
+    case '\0':
+      break;
+    default:
+      return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  }
+  if (*end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (!size)
+    return PDCPL_CLIOPT_ERROR_EXPECTED_POSITIVE;
+  size_target = size;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the generator seed.
+ */
+static
+PDCPL_CLIOPT_ACTION(seed_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  unsigned long long seed = strtoull(argv[argi + 1], &end, 10);
+  if (end == argv[argi + 1] || *end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  seed_target = seed;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the output path.
+ */
+static
+PDCPL_CLIOPT_ACTION(output_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  output_target = argv[argi + 1];
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+PDCPL_PROGRAM_USAGE_DEF
+(
+  "Generate deterministic synthetic input for throughput tests.\n"
+  "\n"
+  "Lines are written until at least SIZE bytes have been written, so the\n"
+  "output for a given kind, size, and seed is the same on every platform.\n"
+  "Kinds are text (words with irregular spacing), long (lines of 4K to 64K\n"
+  "characters), numeric (one integer or decimal number per line), and dcln\n"
+  "(C declarations for bdcl). If an output path is given, the number of\n"
+  "bytes and lines written is printed as JSON."
+)
+
+PDCPL_PROGRAM_OPTIONS_DEF
+{
+  {
+    "-k", "--kind",
+    "Kind of data to generate, one of text, long, numeric, dcln",
+    1,
+    kind_action,
+    NULL
+  },
+  {
+    "-s", "--size",
+    "Minimum output size in bytes with optional K, M, G suffix, e.g. 64M",
+    1,
+    size_action,
+    NULL
+  },
+  {
+    "-S", "--seed",
+    "Generator seed, defaults to 1",
+    1,
+    seed_action,
+    NULL
+  },
+  {
+    "-o", "--output",
+    "Path to write to instead of stdout",
+    1,
+    output_action,
+    NULL
+  },
+  PDCPL_PROGRAM_OPTIONS_END
+};
+
+/**
+ * Words used to build text lines.
+ */
+static const char *const words[] = {
+  "the", "quick", "Brown", "fox", "jumps", "over", "LAZY", "dog", "while",
+  "programming", "in", "C", "is", "fun", "pointer", "array", "struct",
+  "buffer", "Stream", "getline", "a\\b", "x", "declaration", "of", "and"
+};
+
+/**
+ * Declaration type specifiers and qualifiers.
+ */
+static const char *const dcln_types[] = {
+  "int", "char", "unsigned long", "const volatile double", "short",
+  "struct my_struct", "enum my_enum", "my_type", "signed char"
+};
+
+/**
+ * Declaration declarator templates. `%s` is replaced with the name.
+ */
+static const char *const dcln_declarators[] = {
+  "%s", "*%s", "**%s", "%s[13]", "(*%s)[13]", "*%s[10]", "(*%s)()",
+  "*%s(int, const char *)", "(*(*%s())[])()", "(*(*%s[3])())[5]",
+  "*const %s", "(*%s)(const struct my_struct *a, short b)"
+};
+
+/**
+ * Write a line of words separated by irregular blanks and tabs.
+ *
+ * @param f Stream to write to
+ * @param state Generator state
+ * @param width Approximate line width
+ * @returns Number of bytes written
+ */
+static uint64_t
+write_words(FILE *f, uint64_t *state, size_t width)
+{
+  uint64_t n = 0;
+  while (n < width) {
+    uint64_t r = pdcpl_bench_lcg(state);
+    const char *word = words[r % PDCPL_ARRAY_SIZE(words)];
+    // mostly single blanks, with some runs of blanks and some tabs
+    const char *sep = (r >> 8) % 8 ? " " : ((r >> 11) % 2 ? "   " : "\t");
+    n += (uint64_t) fprintf(f, "%s%s", (n) ? sep : "", word);
+  }
+  fputc('\n', f);
+  return n + 1;
+}
+
+/**
+ * Write a line of the given kind.
+ *
+ * @param f Stream to write to
+ * @param kind Kind of line
+ * @param state Generator state
+ * @param line_no Zero-based line number, used for unique declaration names
+ * @returns Number of bytes written
+ */
+static uint64_t
+write_line(FILE *f, datagen_kind kind, uint64_t *state, uint64_t line_no)
+{
+  uint64_t r = pdcpl_bench_lcg(state);
+  switch (kind) {
+    case DATAGEN_TEXT:
+      return write_words(f, state, 20 + r % 100);
+    case DATAGEN_LONG_LINES:
+      return write_words(f, state, 4096 + r % 61440);
+    case DATAGEN_NUMERIC:
+      // mix of negative and positive integers and decimals
+      if (r % 3)
+        return (uint64_t) fprintf(
+          f, "%s%llu\n", (r >> 8) % 4 ? "" : "-",
+          (unsigned long long) (pdcpl_bench_lcg(state) % 1000000000)
+        );
+      return (uint64_t) fprintf(
+        f, "%s%llu.%03u\n", (r >> 8) % 4 ? "" : "-",
+        (unsigned long long) (pdcpl_bench_lcg(state) % 1000000),
+        (unsigned int) ((r >> 16) % 1000)
+      );
+    case DATAGEN_DCLN: {
+      char name[32], declarator[96];
+      snprintf(name, sizeof name, "v%llu", (unsigned long long) line_no);
+      snprintf(
+        declarator,
+        sizeof declarator,
+        dcln_declarators[(r >> 8) % PDCPL_ARRAY_SIZE(dcln_declarators)],
+        name
+      );
+      return (uint64_t) fprintf(
+        f, "%s %s;\n", dcln_types[r % PDCPL_ARRAY_SIZE(dcln_types)], declarator
+      );
+    }
+    default:
+      return 0;
+  }
+}
+
+PDCPL_ARG_MAIN
+{
+  PDCPL_PARSE_PROGRAM_OPTIONS();
+  // binary mode so that output is the same on Windows
+  FILE *f = (output_target) ? fopen(output_target, "wb") : stdout;
+  if (!f) {
+    PDCPL_PRINT_ERROR_EX("error: unable to open %s\n", output_target);
+    return EXIT_FAILURE;
+  }
+#ifdef _WIN32
+  // stdout is opened in text mode, which would translate \n to \r\n
+  if (!output_target && _setmode(_fileno(stdout), _O_BINARY) == -1) {
+    PDCPL_PRINT_ERROR_EX("error: unable to set stdout to binary mode\n");
+    return EXIT_FAILURE;
+  }
+#endif  // _WIN32
+  // mix the seed so nearby seeds give unrelated output
+  uint64_t state = seed_target * 0x9e3779b97f4a7c15u + 1;
+  uint64_t n_bytes = 0, n_lines = 0;
+  while (n_bytes < size_target && !ferror(f))
+    n_bytes += write_line(f, kind_target, &state, n_lines++);
+  bool failed = ferror(f) || ((output_target) ? fclose(f) : fflush(f));
+  if (failed) {
+    PDCPL_PRINT_ERROR_EX(
+      "error: unable to write %s\n", (output_target) ? output_target : "stdout"
+    );
+    return EXIT_FAILURE;
+  }
+  if (output_target)
+    printf(
+      "{\"bytes\": %llu, \"lines\": %llu}\n",
+      (unsigned long long) n_bytes,
+      (unsigned long long) n_lines
+    );
+  return EXIT_SUCCESS;
+}
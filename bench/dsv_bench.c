@@ -0,0 +1,142 @@
+/**
+ * @file dsv_bench.c
+ * @author Derek Huang
+ * @brief dsv.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/dsv.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+
+/**
+ * Approximate size of the input records.
+ */
+#define RECORDS_SIZE (1 << 20)
+
+/**
+ * DSV benchmark context.
+ *
+ * @param records Numeric TSV records, not modified
+ * @param buf Buffer the records are copied to before each parse
+ * @param size Length of the records
+ */
+typedef struct {
+  char *records;
+  char *buf;
+  size_t size;
+} dsv_context;
+
+/**
+ * Free DSV benchmark context.
+ */
+static int
+tsv_teardown(pdcpl_bench_state *state)
+{
+  dsv_context *ctx = state->ctx;
+  free(ctx->records);
+  free(ctx->buf);
+  free(ctx);
+  return 0;
+}
+
+/**
+ * Generate numeric TSV records of an int, two doubles, and an int.
+ */
+static int
+tsv_setup(pdcpl_bench_state *state)
+{
+  dsv_context *ctx = calloc(1, sizeof *ctx);
+  if (!ctx)
+    return -ENOMEM;
+  state->ctx = ctx;
+  // one record is at most ~80 chars, so leave room for the last one
+  size_t capacity = RECORDS_SIZE + 128;
+  if (!(ctx->records = malloc(capacity)) || !(ctx->buf = malloc(capacity))) {
+    tsv_teardown(state);
+    return -ENOMEM;
+  }
+  uint64_t seed = 42;
+  while (ctx->size < RECORDS_SIZE) {
+    uint64_t r = pdcpl_bench_lcg(&seed);
+    int n = snprintf(
+      ctx->records + ctx->size,
+      capacity - ctx->size,
+      "%lld\t%.6f\t%.9e\t%u\n",
+      (long long) (r % 2000000) - 1000000,
+      (double) (r % 100000000) / 1000.,
+      (double) pdcpl_bench_lcg(&seed) / 3e10,
+      (unsigned int) ((r >> 20) % 1000)
+    );
+    if (n < 0) {
+      tsv_teardown(state);
+      return -EIO;
+    }
+    ctx->size += (size_t) n;
+  }
+  state->bytes = ctx->size;
+  return 0;
+}
+
+/**
+ * Parse the records with the given columns selected.
+ *
+ * Parsing modifies the buffer, so the records are copied into it first. The
+ * copy is included in the time but is much faster than the parse.
+ *
+ * @param state Benchmark state
+ * @param columns Selected columns, `NULL` for all columns
+ * @param n_columns Number of selected columns
+ */
+static int
+tsv_parse(pdcpl_bench_state *state, const size_t *columns, size_t n_columns)
+{
+  dsv_context *ctx = state->ctx;
+  pdcpl_dsv_options opts = pdcpl_dsv_options_default('\t');
+  opts.quote = '\0';
+  opts.columns = columns;
+  opts.n_columns = n_columns;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    memcpy(ctx->buf, ctx->records, ctx->size);
+    pdcpl_dsv_table table;
+    int status = pdcpl_dsv_parse(ctx->buf, ctx->size, &opts, &table);
+    if (status)
+      return status;
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(table);
+    pdcpl_dsv_table_free(&table);
+  }
+  return 0;
+}
+
+/**
+ * Parse all the columns of the records.
+ */
+static int
+tsv_numeric_bench(pdcpl_bench_state *state)
+{
+  return tsv_parse(state, NULL, 0);
+}
+
+/**
+ * Parse only the first double column, skipping the rest of each record.
+ */
+static int
+tsv_select_bench(pdcpl_bench_state *state)
+{
+  static const size_t columns[] = {1};
+  return tsv_parse(state, columns, PDCPL_ARRAY_SIZE(columns));
+}
+
+const pdcpl_bench_case pdcpl_bench_dsv_cases[] = {
+  {"dsv/tsv_numeric", tsv_numeric_bench, tsv_setup, tsv_teardown},
+  {"dsv/tsv_select", tsv_select_bench, tsv_setup, tsv_teardown},
+  PDCPL_BENCH_CASES_END
+};
@@ -0,0 +1,252 @@
+# the project minimum is passed in since cmake -P doesn't read CMakeLists.txt
+if(NOT DEFINED PDCPL_E2E_CMAKE_MINIMUM_VERSION)
+    message(FATAL_ERROR "PDCPL_E2E_CMAKE_MINIMUM_VERSION must be defined")
+endif()
+cmake_minimum_required(VERSION ${PDCPL_E2E_CMAKE_MINIMUM_VERSION})
+
+##
+# End-to-end throughput test script, run with cmake -P.
+#
+# Each program is run on generated input with --stats=json and its wall time
+# is used to compute MB/s and lines/s. CMake only has integer arithmetic, so
+# times are handled in microseconds and rates in thousandths.
+#
+# Arguments, passed with -D:
+#   PDCPL_E2E_CMAKE_MINIMUM_VERSION
+#       Project minimum CMake version, i.e. CMAKE_MINIMUM_REQUIRED_VERSION
+#   PDCPL_E2E_MODE
+#       generate: generate input data of a kind if missing or out of date
+#       run: run a program, record results, and compare against the baseline
+#       report: merge results into one JSON file and seed the baseline
+#   PDCPL_E2E_DATA_DIR
+#       Directory holding generated input data
+#   PDCPL_E2E_RESULTS_DIR
+#       Directory holding per-program results
+#   PDCPL_E2E_SIZE
+#       Input data size with optional K, M, G suffix, e.g. 64M
+#   PDCPL_E2E_KIND
+#       Input data kind, see pdcpl_datagen --help. generate and run modes
+#   PDCPL_E2E_DATAGEN
+#       Path to pdcpl_datagen. generate mode only
+#   PDCPL_E2E_NAME
+#       Program name used in results. run mode only
+#   PDCPL_E2E_PROGRAM
+#       Path to the program. run mode only
+#   PDCPL_E2E_ARGS
+#       Optional extra program argument. run mode only
+#   PDCPL_E2E_REPEAT
+#       Number of runs, of which the fastest is recorded. run mode only
+#   PDCPL_E2E_BASELINE
+#       Path to baseline JSON. run and report modes
+#   PDCPL_E2E_TOLERANCE
+#       Allowed slowdown in percent relative to the baseline. run mode only
+#   PDCPL_E2E_CHECK_COUNTERS
+#       If true, fail if the program's --stats reports no bytes read, bytes
+#       written, or lines. run mode only
+#   PDCPL_E2E_UPDATE_BASELINE
+#       If true, overwrite the baseline with the results. report mode only
+#
+
+##
+# Parse a non-negative decimal string into a scaled integer.
+#
+# Arguments:
+#   value
+#       Decimal string, e.g. 123.4567
+#   digits
+#       Number of fractional digits to keep, e.g. 3 for thousandths
+#   out_var
+#       Name of variable to set in the parent scope
+#
+function(pdcpl_e2e_parse_decimal value digits out_var)
+    if(NOT value MATCHES "^([0-9]+)(\\.([0-9]*))?$")
+        message(FATAL_ERROR "Cannot parse ${value} as a decimal")
+    endif()
+    # pad or truncate fractional part to the number of digits
+    string(REPEAT 0 ${digits} padding)
+    string(SUBSTRING "${CMAKE_MATCH_3}${padding}" 0 ${digits} frac)
+    # strip leading zeros so math() does not treat the value as octal. REGEX
+    # REPLACE is not used since it applies ^ again after each replacement
+    string(REGEX MATCH "^0*([0-9]+)$" scaled "${CMAKE_MATCH_1}${frac}")
+    set(${out_var} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+##
+# Format an integer in thousandths as a decimal string.
+#
+# Arguments:
+#   milli
+#       Integer value in thousandths
+#   out_var
+#       Name of variable to set in the parent scope
+#
+function(pdcpl_e2e_format_milli milli out_var)
+    math(EXPR whole "${milli} / 1000")
+    math(EXPR frac "${milli} % 1000 + 1000")
+    string(SUBSTRING ${frac} 1 3 frac)
+    set(${out_var} ${whole}.${frac} PARENT_SCOPE)
+endfunction()
+
+# input data and summary written by pdcpl_datagen
+set(DATA_PREFIX ${PDCPL_E2E_DATA_DIR}/${PDCPL_E2E_KIND}-${PDCPL_E2E_SIZE})
+set(DATA_FILE ${DATA_PREFIX}.txt)
+set(DATA_SUMMARY ${DATA_PREFIX}.json)
+
+if(PDCPL_E2E_MODE STREQUAL "generate")
+    # data is deterministic, so only regenerate if pdcpl_datagen changed
+    if(
+        EXISTS ${DATA_FILE} AND EXISTS ${DATA_SUMMARY} AND
+        NOT PDCPL_E2E_DATAGEN IS_NEWER_THAN ${DATA_SUMMARY}
+    )
+        message(STATUS "Using existing ${DATA_FILE}")
+        return()
+    endif()
+    file(MAKE_DIRECTORY ${PDCPL_E2E_DATA_DIR})
+    execute_process(
+        COMMAND
+            ${PDCPL_E2E_DATAGEN}
+                -k ${PDCPL_E2E_KIND} -s ${PDCPL_E2E_SIZE} -o ${DATA_FILE}
+        OUTPUT_FILE ${DATA_SUMMARY}
+        RESULT_VARIABLE status
+    )
+    if(NOT status EQUAL 0)
+        file(REMOVE ${DATA_FILE} ${DATA_SUMMARY})
+        message(FATAL_ERROR "Failed to generate ${DATA_FILE}: ${status}")
+    endif()
+    message(STATUS "Generated ${DATA_FILE}")
+elseif(PDCPL_E2E_MODE STREQUAL "run")
+    file(READ ${DATA_SUMMARY} summary)
+    string(JSON n_bytes GET "${summary}" bytes)
+    string(JSON n_lines GET "${summary}" lines)
+    # output is discarded so that only the program itself is measured
+    if(CMAKE_HOST_WIN32)
+        set(NULL_FILE NUL)
+    else()
+        set(NULL_FILE /dev/null)
+    endif()
+    # fastest run in microseconds
+    set(best_us 0)
+    foreach(i RANGE 1 ${PDCPL_E2E_REPEAT})
+        execute_process(
+            COMMAND ${PDCPL_E2E_PROGRAM} ${PDCPL_E2E_ARGS} --stats=json
+            INPUT_FILE ${DATA_FILE}
+            OUTPUT_FILE ${NULL_FILE}
+            ERROR_VARIABLE errors
+            RESULT_VARIABLE status
+        )
+        if(NOT status EQUAL 0)
+            message(
+                FATAL_ERROR "${PDCPL_E2E_NAME} failed: ${status}\n${errors}"
+            )
+        endif()
+        # statistics are the last line written to stderr
+        string(STRIP "${errors}" errors)
+        string(REGEX REPLACE "^.*\n" "" stats "${errors}")
+        # matched as text since string(JSON GET) reformats decimals as doubles
+        if(NOT stats MATCHES "\"wall_time\": ([0-9.]+)")
+            message(FATAL_ERROR "${PDCPL_E2E_NAME} wrote no statistics")
+        endif()
+        set(wall_time ${CMAKE_MATCH_1})
+        # every counted program reads, writes, and sees lines of its input
+        if(PDCPL_E2E_CHECK_COUNTERS)
+            foreach(counter bytes_read bytes_written lines)
+                if(NOT stats MATCHES "\"${counter}\": ([0-9]+)")
+                    message(FATAL_ERROR "${PDCPL_E2E_NAME} has no ${counter}")
+                endif()
+                if(CMAKE_MATCH_1 EQUAL 0)
+                    message(
+                        FATAL_ERROR
+                        "${PDCPL_E2E_NAME} reported zero ${counter}\n${stats}"
+                    )
+                endif()
+            endforeach()
+        endif()
+        pdcpl_e2e_parse_decimal(${wall_time} 6 wall_us)
+        if(wall_us EQUAL 0)
+            set(wall_us 1)
+        endif()
+        if(best_us EQUAL 0 OR wall_us LESS best_us)
+            set(best_us ${wall_us})
+        endif()
+    endforeach()
+    # bytes / us is MB/s, scaled to thousandths
+    math(EXPR mb_per_sec_milli "${n_bytes} * 1000 / ${best_us}")
+    math(EXPR lines_per_sec "${n_lines} * 1000000 / ${best_us}")
+    pdcpl_e2e_format_milli(${mb_per_sec_milli} mb_per_sec)
+    message(
+        STATUS
+        "${PDCPL_E2E_NAME}: ${mb_per_sec} MB/s, ${lines_per_sec} lines/s "
+        "(${n_bytes} bytes, ${n_lines} lines, ${best_us} us)"
+    )
+    file(MAKE_DIRECTORY ${PDCPL_E2E_RESULTS_DIR})
+    file(
+        WRITE ${PDCPL_E2E_RESULTS_DIR}/${PDCPL_E2E_NAME}.json
+        "{\"kind\": \"${PDCPL_E2E_KIND}\", \"bytes\": ${n_bytes}, "
+        "\"lines\": ${n_lines}, \"wall_time_us\": ${best_us}, "
+        "\"mb_per_sec\": ${mb_per_sec}, \"lines_per_sec\": ${lines_per_sec}}\n"
+    )
+    # compare against the baseline if it has a result for the same size
+    if(NOT EXISTS ${PDCPL_E2E_BASELINE})
+        message(STATUS "No baseline ${PDCPL_E2E_BASELINE}, not comparing")
+        return()
+    endif()
+    file(READ ${PDCPL_E2E_BASELINE} baseline)
+    string(JSON baseline_size ERROR_VARIABLE error GET "${baseline}" size)
+    string(
+        JSON baseline_mb_per_sec ERROR_VARIABLE error
+        GET "${baseline}" programs ${PDCPL_E2E_NAME} mb_per_sec
+    )
+    if(error OR NOT baseline_size STREQUAL PDCPL_E2E_SIZE)
+        message(
+            STATUS
+            "No ${PDCPL_E2E_SIZE} baseline for ${PDCPL_E2E_NAME}, "
+            "not comparing"
+        )
+        return()
+    endif()
+    pdcpl_e2e_parse_decimal(${baseline_mb_per_sec} 3 baseline_milli)
+    math(
+        EXPR min_milli
+        "${baseline_milli} * (100 - ${PDCPL_E2E_TOLERANCE}) / 100"
+    )
+    pdcpl_e2e_format_milli(${min_milli} min_mb_per_sec)
+    if(mb_per_sec_milli LESS min_milli)
+        message(
+            FATAL_ERROR
+            "${PDCPL_E2E_NAME} regressed: ${mb_per_sec} MB/s is below "
+            "${min_mb_per_sec} MB/s, ${PDCPL_E2E_TOLERANCE}% under the "
+            "baseline ${baseline_mb_per_sec} MB/s"
+        )
+    endif()
+    message(
+        STATUS
+        "${PDCPL_E2E_NAME}: baseline ${baseline_mb_per_sec} MB/s, "
+        "minimum ${min_mb_per_sec} MB/s"
+    )
+elseif(PDCPL_E2E_MODE STREQUAL "report")
+    file(GLOB result_files ${PDCPL_E2E_RESULTS_DIR}/*.json)
+    # built as text since string(JSON SET) reformats decimals as doubles
+    set(programs "")
+    foreach(result_file ${result_files})
+        get_filename_component(name ${result_file} NAME_WLE)
+        file(READ ${result_file} result)
+        string(STRIP "${result}" result)
+        if(programs)
+            string(APPEND programs ",\n")
+        endif()
+        string(APPEND programs "    \"${name}\": ${result}")
+    endforeach()
+    set(
+        report
+        "{\"size\": \"${PDCPL_E2E_SIZE}\", \"programs\": {\n${programs}\n}}"
+    )
+    file(WRITE ${PDCPL_E2E_RESULTS_DIR}.json "${report}\n")
+    message(STATUS "Wrote ${PDCPL_E2E_RESULTS_DIR}.json")
+    # the first run seeds the baseline so later runs have something to compare
+    if(PDCPL_E2E_UPDATE_BASELINE OR NOT EXISTS ${PDCPL_E2E_BASELINE})
+        file(WRITE ${PDCPL_E2E_BASELINE} "${report}\n")
+        message(STATUS "Wrote baseline ${PDCPL_E2E_BASELINE}")
+    endif()
+else()
+    message(FATAL_ERROR "Unknown PDCPL_E2E_MODE ${PDCPL_E2E_MODE}")
+endif()
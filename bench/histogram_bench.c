@@ -0,0 +1,88 @@
+/**
+ * @file histogram_bench.c
+ * @author Derek Huang
+ * @brief histogram.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/histogram.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+
+/**
+ * Number of values to bucket and number of histogram bins.
+ */
+#define N_VALUES 4096
+#define N_BINS 16
+
+/**
+ * Histogram benchmark context.
+ *
+ * @param values Values in [0, `N_BINS`)
+ * @param counts Bin counts
+ * @param hist Histogram data using `counts`
+ */
+typedef struct {
+  double values[N_VALUES];
+  size_t counts[N_BINS];
+  pdcpl_histdata hist;
+} histogram_context;
+
+/**
+ * Allocate values and a histogram with unit-width bins.
+ */
+static int
+histogram_setup(pdcpl_bench_state *state)
+{
+  histogram_context *ctx = calloc(1, sizeof *ctx);
+  if (!ctx)
+    return -ENOMEM;
+  uint64_t seed = 42;
+  for (size_t i = 0; i < N_VALUES; i++)
+    ctx->values[i] = (double) (pdcpl_bench_lcg(&seed) % (N_BINS * 1000)) /
+      1000;
+  ctx->hist.nb = N_BINS;
+  ctx->hist.counts = ctx->counts;
+  ctx->hist.bw = 1;
+  ctx->hist.bmin = 0;
+  ctx->hist.bmax = N_BINS;
+  state->ctx = ctx;
+  state->bytes = sizeof ctx->values;
+  return 0;
+}
+
+/**
+ * Free histogram context.
+ */
+static int
+histogram_teardown(pdcpl_bench_state *state)
+{
+  free(state->ctx);
+  return 0;
+}
+
+/**
+ * Bucket all the values.
+ */
+static int
+bucket_bench(pdcpl_bench_state *state)
+{
+  histogram_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    for (size_t i = 0; i < N_VALUES; i++)
+      pdcpl_histdata_bucket(&ctx->hist, ctx->values[i]);
+    pdcpl_bench_clobber_memory();
+  }
+  return 0;
+}
+
+const pdcpl_bench_case pdcpl_bench_histogram_cases[] = {
+  {"histogram/bucket", bucket_bench, histogram_setup, histogram_teardown},
+  PDCPL_BENCH_CASES_END
+};
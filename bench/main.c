@@ -0,0 +1,329 @@
+/**
+ * @file main.c
+ * @author Derek Huang
+ * @brief pdcpl microbenchmark runner
+ * @copyright MIT License
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PDCPL_HAS_PROGRAM_USAGE
+#define PDCPL_HAS_PROGRAM_OPTIONS
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+#include "pdcpl/cliopts.h"
+#include "pdcpl/core.h"
+#include "pdcpl/perf.h"
+
+/**
+ * Static globals set during program option parsing.
+ */
+static const char *filter_target = NULL;
+static const char *json_path_target = NULL;
+static bool list_target = false;
+static bool perf_target = false;
+static pdcpl_bench_options bench_options = PDCPL_BENCH_OPTIONS_DEFAULT;
+
+/**
+ * Action to only run cases whose names contain a substring.
+ */
+static
+PDCPL_CLIOPT_ACTION(filter_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  filter_target = argv[argi + 1];
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the path results are written to as JSON.
+ */
+static
+PDCPL_CLIOPT_ACTION(json_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  json_path_target = argv[argi + 1];
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to list case names instead of running them.
+ */
+static
+PDCPL_CLIOPT_ACTION(list_action)
+{
+  PDCPL_CLIOPT_ACTION_NO_WARN_UNUSED
+  list_target = true;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to also count hardware events for each case.
+ */
+static
+PDCPL_CLIOPT_ACTION(perf_action)
+{
+  PDCPL_CLIOPT_ACTION_NO_WARN_UNUSED
+  perf_target = true;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the minimum seconds per sample.
+ */
+static
+PDCPL_CLIOPT_ACTION(min_time_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  double min_time = strtod(argv[argi + 1], &end);
+  if (end == argv[argi + 1] || *end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (min_time <= 0)
+    return PDCPL_CLIOPT_ERROR_EXPECTED_POSITIVE;
+  bench_options.min_time = min_time;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Action to set the number of samples.
+ */
+static
+PDCPL_CLIOPT_ACTION(samples_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  long samples = strtol(argv[argi + 1], &end, 10);
+  if (end == argv[argi + 1] || *end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (samples <= 0 || samples > PDCPL_BENCH_MAX_SAMPLES)
+    return PDCPL_CLIOPT_ERROR_INVALID_VALUE;
+  bench_options.samples = (unsigned int) samples;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+PDCPL_PROGRAM_USAGE_DEF
+(
+  "Run pdcpl library microbenchmarks.\n"
+  "\n"
+  "Each case is calibrated so that a sample takes at least the minimum time,\n"
+  "warmed up, and then sampled. The median and median absolute deviation of\n"
+  "the time per iteration are reported, with throughput for cases that\n"
+  "process a known number of bytes. Results can also be written as JSON for\n"
+  "comparison against a previous run.\n"
+  "\n"
+  "With --perf, each case is run once more with hardware counters enabled and\n"
+  "IPC and event rates are reported. Counters require Linux perf events and\n"
+  "are reported as unavailable if perf events are restricted."
+)
+
+PDCPL_PROGRAM_OPTIONS_DEF
+{
+  {
+    "-f", "--filter",
+    "Only run cases whose names contain the given substring",
+    1,
+    filter_action,
+    NULL
+  },
+  {
+    "-o", "--json",
+    "Also write results as JSON to the given path",
+    1,
+    json_action,
+    NULL
+  },
+  {
+    "-l", "--list",
+    "List case names instead of running them",
+    0,
+    list_action,
+    NULL
+  },
+  {
+    "-p", "--perf",
+    "Count hardware events for each case, if available",
+    0,
+    perf_action,
+    NULL
+  },
+  {
+    "-t", "--min-time",
+    "Minimum seconds per sample, defaults to 0.01",
+    1,
+    min_time_action,
+    NULL
+  },
+  {
+    "-s", "--samples",
+    "Number of samples per case, defaults to 15",
+    1,
+    samples_action,
+    NULL
+  },
+  PDCPL_PROGRAM_OPTIONS_END
+};
+
+/**
+ * Count hardware events for one sample of a benchmark case.
+ *
+ * @param bc Benchmark case
+ * @param iterations Number of iterations to run, usually from calibration
+ * @param group Opened counter group
+ * @param counters Address of `pdcpl_perf_counters` to write to
+ * @param bytes Address to write number of bytes processed to
+ * @returns 0 on success, negative `errno` value on error
+ */
+static int
+bench_perf(
+  const pdcpl_bench_case *bc,
+  uint64_t iterations,
+  pdcpl_perf_group *group,
+  pdcpl_perf_counters *counters,
+  uint64_t *bytes)
+{
+  pdcpl_bench_state state = {iterations, 0, NULL};
+  int status;
+  if (bc->setup && (status = bc->setup(&state)))
+    return status;
+  uint64_t elapsed;
+  if (!(status = pdcpl_perf_start(group))) {
+    status = pdcpl_bench_sample(bc, &state, &elapsed);
+    int stop_status = pdcpl_perf_stop(group, counters);
+    if (!status)
+      status = stop_status;
+  }
+  if (bc->teardown)
+    bc->teardown(&state);
+  *bytes = state.bytes * iterations;
+  return status;
+}
+
+/**
+ * Print hardware event rates for a case on one line.
+ *
+ * Rates are per byte if the case processes a known number of bytes and per
+ * iteration otherwise.
+ *
+ * @param counters Counter values
+ * @param iterations Number of iterations counted
+ * @param bytes Number of bytes processed, 0 if not known
+ */
+static void
+bench_perf_printf(
+  const pdcpl_perf_counters *counters, uint64_t iterations, uint64_t bytes)
+{
+  const char *unit = (bytes) ? "B" : "iter";
+  double divisor = (double) ((bytes) ? bytes : iterations);
+  printf("  ipc %.2f", pdcpl_perf_ipc(counters));
+  for (int i = 0; i < PDCPL_PERF_EVENT_MAX; i++) {
+    pdcpl_perf_event event = (pdcpl_perf_event) i;
+    if (pdcpl_perf_has(counters, event))
+      printf(
+        ", %s/%s %.3f",
+        pdcpl_perf_event_name(event),
+        unit,
+        (double) counters->values[i] / divisor
+      );
+  }
+  putchar('\n');
+}
+
+/**
+ * Benchmark suites to run.
+ */
+static const pdcpl_bench_case *const bench_suites[] = {
+  pdcpl_bench_bitwise_cases,
+  pdcpl_bench_dsv_cases,
+  pdcpl_bench_histogram_cases,
+  pdcpl_bench_memory_cases,
+  pdcpl_bench_pipeline_cases,
+  pdcpl_bench_queue_cases,
+  pdcpl_bench_string_cases,
+  pdcpl_bench_thread_pool_cases,
+  pdcpl_bench_variant_cases
+};
+
+PDCPL_ARG_MAIN
+{
+  PDCPL_PARSE_PROGRAM_OPTIONS();
+  // count selected cases to size the results array
+  size_t n_cases = 0;
+  for (size_t i = 0; i < PDCPL_ARRAY_SIZE(bench_suites); i++) {
+    for (const pdcpl_bench_case *bc = bench_suites[i]; bc->name; bc++) {
+      if (!filter_target || strstr(bc->name, filter_target))
+        n_cases++;
+    }
+  }
+  pdcpl_bench_result *results = calloc(n_cases + 1, sizeof *results);
+  if (!results) {
+    PDCPL_PRINT_ERROR("error: unable to allocate results\n");
+    return EXIT_FAILURE;
+  }
+  // counters are only reported as unavailable once
+  pdcpl_perf_group perf_group;
+  if (perf_target && !list_target) {
+    int perf_status = pdcpl_perf_open(&perf_group);
+    if (perf_status) {
+      printf("perf counters unavailable: %s\n", strerror(-perf_status));
+      perf_target = false;
+    }
+  }
+  if (!list_target)
+    printf(
+      "%-40s %15s %13s %12s %15s\n",
+      "case", "median", "mad", "iterations", "throughput"
+    );
+  size_t n_results = 0;
+  int status = 0;
+  for (size_t i = 0; i < PDCPL_ARRAY_SIZE(bench_suites); i++) {
+    for (const pdcpl_bench_case *bc = bench_suites[i]; bc->name; bc++) {
+      if (filter_target && !strstr(bc->name, filter_target))
+        continue;
+      if (list_target) {
+        printf("%s\n", bc->name);
+        continue;
+      }
+      status = pdcpl_bench_run(bc, &bench_options, results + n_results);
+      if (status) {
+        PDCPL_PRINT_ERROR_EX("error: %s: %s\n", bc->name, strerror(-status));
+        break;
+      }
+      pdcpl_bench_fprintf(stdout, results + n_results);
+      if (perf_target) {
+        pdcpl_perf_counters counters;
+        uint64_t iterations = results[n_results].iterations, bytes;
+        status = bench_perf(bc, iterations, &perf_group, &counters, &bytes);
+        if (status) {
+          PDCPL_PRINT_ERROR_EX("error: %s: %s\n", bc->name, strerror(-status));
+          break;
+        }
+        bench_perf_printf(&counters, iterations, bytes);
+      }
+      n_results++;
+      fflush(stdout);
+    }
+    if (status)
+      break;
+  }
+  // write JSON results even if a case failed so completed cases are kept
+  if (json_path_target && !list_target) {
+    FILE *f = fopen(json_path_target, "w");
+    if (!f || pdcpl_bench_fprintf_json(f, results, n_results)) {
+      PDCPL_PRINT_ERROR_EX("error: unable to write %s\n", json_path_target);
+      status = -EIO;
+    }
+    if (f)
+      fclose(f);
+  }
+  if (perf_target)
+    pdcpl_perf_close(&perf_group);
+  free(results);
+  return (status) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file memory_bench.c
+ * @author Derek Huang
+ * @brief memory.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/memory.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+
+/**
+ * Size of buffers to copy or fill and size of each write when filling.
+ */
+#define BUFFER_SIZE 65536
+#define CHUNK_SIZE 64
+
+/**
+ * Allocate and free a buffer.
+ */
+static int
+new_clear_bench(pdcpl_bench_state *state)
+{
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_buffer buf = pdcpl_buffer_new(4096);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(buf.data);
+    pdcpl_buffer_clear(&buf);
+  }
+  return 0;
+}
+
+/**
+ * Allocate a filled buffer to copy.
+ */
+static int
+buffer_setup(pdcpl_bench_state *state)
+{
+  pdcpl_buffer *buf = malloc(sizeof *buf);
+  if (!buf)
+    return -ENOMEM;
+  *buf = pdcpl_buffer_new(BUFFER_SIZE);
+  if (!pdcpl_buffer_ready(buf)) {
+    free(buf);
+    return -ENOMEM;
+  }
+  memset(buf->data, 'a', buf->size);
+  state->ctx = buf;
+  state->bytes = BUFFER_SIZE;
+  return 0;
+}
+
+/**
+ * Free the buffer to copy.
+ */
+static int
+buffer_teardown(pdcpl_bench_state *state)
+{
+  pdcpl_buffer_clear(state->ctx);
+  free(state->ctx);
+  return 0;
+}
+
+/**
+ * Copy a buffer.
+ */
+static int
+copy_bench(pdcpl_bench_state *state)
+{
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_buffer copy;
+    if (pdcpl_buffer_copy(state->ctx, &copy))
+      return -ENOMEM;
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(copy.data);
+    pdcpl_buffer_clear(&copy);
+  }
+  return 0;
+}
+
+/**
+ * Fill a growing buffer in small chunks.
+ */
+static int
+dynexpand_bench(pdcpl_bench_state *state)
+{
+  char chunk[CHUNK_SIZE];
+  memset(chunk, 'a', sizeof chunk);
+  state->bytes = BUFFER_SIZE;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_buffer buf = pdcpl_buffer_new(BUFSIZ);
+    // dynexpand requires the write position to be inside the buffer, so we
+    // reserve an extra byte to keep the next write position inside
+    for (size_t pos = 0; pos < BUFFER_SIZE; pos += CHUNK_SIZE) {
+      int status = pdcpl_buffer_dynexpand(
+        &buf, (char *) buf.data + pos, CHUNK_SIZE + 1
+      );
+      if (status) {
+        pdcpl_buffer_clear(&buf);
+        return status;
+      }
+      memcpy((char *) buf.data + pos, chunk, CHUNK_SIZE);
+    }
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(buf.data);
+    pdcpl_buffer_clear(&buf);
+  }
+  return 0;
+}
+
+const pdcpl_bench_case pdcpl_bench_memory_cases[] = {
+  {"memory/new_clear", new_clear_bench, NULL, NULL},
+  {"memory/copy", copy_bench, buffer_setup, buffer_teardown},
+  {"memory/dynexpand", dynexpand_bench, NULL, NULL},
+  PDCPL_BENCH_CASES_END
+};
@@ -0,0 +1,144 @@
+/**
+ * @file pipeline_bench.c
+ * @author Derek Huang
+ * @brief pipeline.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/pipeline.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+
+/**
+ * Size of the input text, which is one pipeline block.
+ */
+#define TEXT_SIZE PDCPL_PIPELINE_BLOCK_SIZE
+
+/**
+ * Pipeline benchmark context.
+ *
+ * @param text Text of words separated by runs of blanks and tabs
+ * @param pipeline Pipeline to transform the text with
+ */
+typedef struct {
+  char text[TEXT_SIZE];
+  pdcpl_pipeline *pipeline;
+} pipeline_context;
+
+/**
+ * Free pipeline benchmark context.
+ */
+static int
+pipeline_teardown(pdcpl_bench_state *state)
+{
+  pipeline_context *ctx = state->ctx;
+  if (ctx->pipeline)
+    pdcpl_pipeline_destroy(ctx->pipeline);
+  free(ctx);
+  return 0;
+}
+
+/**
+ * Generate text with irregular spacing and create a pipeline.
+ *
+ * @param state Benchmark state
+ * @param spec Pipeline specification
+ */
+static int
+pipeline_setup(pdcpl_bench_state *state, const char *spec)
+{
+  pipeline_context *ctx = calloc(1, sizeof *ctx);
+  if (!ctx)
+    return -ENOMEM;
+  state->ctx = ctx;
+  uint64_t seed = 42;
+  size_t size = 0;
+  while (size < TEXT_SIZE) {
+    // mixed-case word of 1-10 letters, then 1-4 blanks, a tab, or a newline
+    uint64_t r = pdcpl_bench_lcg(&seed);
+    for (uint64_t i = 0; i <= r % 10 && size < TEXT_SIZE; i++)
+      ctx->text[size++] = (char) (((r >> 40) % 2 ? 'a' : 'A') + i % 26);
+    switch ((r >> 32) % 8) {
+      case 0:
+        if (size < TEXT_SIZE)
+          ctx->text[size++] = '\n';
+        break;
+      case 1:
+        if (size < TEXT_SIZE)
+          ctx->text[size++] = '\t';
+        break;
+      default:
+        for (uint64_t i = 0; i <= (r >> 36) % 4 && size < TEXT_SIZE; i++)
+          ctx->text[size++] = ' ';
+    }
+  }
+  state->bytes = TEXT_SIZE;
+  int status = pdcpl_pipeline_create(&ctx->pipeline, spec, TEXT_SIZE);
+  if (status) {
+    pipeline_teardown(state);
+    return status;
+  }
+  return 0;
+}
+
+/**
+ * Transform the text through the pipeline.
+ */
+static int
+pipeline_bench(pdcpl_bench_state *state)
+{
+  pipeline_context *ctx = state->ctx;
+  const char *out;
+  size_t out_size;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    int status = pdcpl_pipeline_process(
+      ctx->pipeline, ctx->text, TEXT_SIZE, &out, &out_size
+    );
+    if (status)
+      return status;
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(out);
+  }
+  return 0;
+}
+
+/**
+ * Define a setup function for a pipeline specification.
+ *
+ * @param spec Pipeline specification
+ * @param suffix Function name suffix
+ */
+#define PIPELINE_SETUP_DEF(spec, suffix) \
+  static int \
+  pipeline_setup_ ## suffix(pdcpl_bench_state *state) \
+  { \
+    return pipeline_setup(state, spec); \
+  }
+
+PIPELINE_SETUP_DEF("lower", lower)
+PIPELINE_SETUP_DEF("squeeze", squeeze)
+PIPELINE_SETUP_DEF("detab 4", detab)
+PIPELINE_SETUP_DEF("detab 4 | squeeze | lower", detab_squeeze_lower)
+
+const pdcpl_bench_case pdcpl_bench_pipeline_cases[] = {
+  {"pipeline/lower", pipeline_bench, pipeline_setup_lower, pipeline_teardown},
+  {
+    "pipeline/squeeze",
+    pipeline_bench,
+    pipeline_setup_squeeze,
+    pipeline_teardown
+  },
+  {"pipeline/detab", pipeline_bench, pipeline_setup_detab, pipeline_teardown},
+  {
+    "pipeline/detab_squeeze_lower",
+    pipeline_bench,
+    pipeline_setup_detab_squeeze_lower,
+    pipeline_teardown
+  },
+  PDCPL_BENCH_CASES_END
+};
@@ -0,0 +1,364 @@
+/**
+ * @file queue_bench.c
+ * @author Derek Huang
+ * @brief queue.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/queue.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+#include "pdcpl/memory.h"
+#include "pdcpl/thread.h"
+
+/**
+ * Queue capacity and number of buffers per batch operation.
+ */
+#define QUEUE_CAPACITY 1024
+#define BATCH_SIZE 32
+
+/**
+ * Queue benchmark context.
+ *
+ * Time per iteration is time per buffer, so items/sec is 1e9 / median ns.
+ * For ping-pong cases it is the round-trip latency between two threads.
+ *
+ * @param spsc SPSC queue, also used for requests in ping-pong cases
+ * @param spsc_reply SPSC queue for replies in ping-pong cases
+ * @param mpmc MPMC queue
+ * @param blocking Blocking MPMC queue
+ * @param n_items Number of buffers the helper thread handles
+ * @param batch Number of buffers per operation in the helper thread
+ */
+typedef struct {
+  pdcpl_spsc_queue *spsc;
+  pdcpl_spsc_queue *spsc_reply;
+  pdcpl_mpmc_queue *mpmc;
+  pdcpl_blocking_queue *blocking;
+  uint64_t n_items;
+  size_t batch;
+} queue_context;
+
+/**
+ * Free queue benchmark context.
+ */
+static int
+queue_teardown(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  if (ctx->spsc)
+    pdcpl_spsc_queue_destroy(ctx->spsc);
+  if (ctx->spsc_reply)
+    pdcpl_spsc_queue_destroy(ctx->spsc_reply);
+  if (ctx->mpmc)
+    pdcpl_mpmc_queue_destroy(ctx->mpmc);
+  if (ctx->blocking)
+    pdcpl_blocking_queue_destroy(ctx->blocking);
+  free(ctx);
+  return 0;
+}
+
+/**
+ * Create one queue of each kind.
+ */
+static int
+queue_setup(pdcpl_bench_state *state)
+{
+  queue_context *ctx = calloc(1, sizeof *ctx);
+  if (!ctx)
+    return -ENOMEM;
+  state->ctx = ctx;
+  int status;
+  if (
+    (status = pdcpl_spsc_queue_create(&ctx->spsc, QUEUE_CAPACITY)) ||
+    (status = pdcpl_spsc_queue_create(&ctx->spsc_reply, QUEUE_CAPACITY)) ||
+    (status = pdcpl_mpmc_queue_create(&ctx->mpmc, QUEUE_CAPACITY)) ||
+    (status = pdcpl_blocking_queue_create(
+      &ctx->blocking, PDCPL_QUEUE_MPMC, QUEUE_CAPACITY
+    ))
+  ) {
+    queue_teardown(state);
+    return status;
+  }
+  return 0;
+}
+
+/**
+ * Push and pop a buffer on the SPSC queue from one thread.
+ */
+static int
+spsc_push_pop_bench(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  pdcpl_buffer buf = {NULL, 0};
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_spsc_queue_push(ctx->spsc, &buf);
+    pdcpl_spsc_queue_pop(ctx->spsc, &buf);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(buf);
+  }
+  return 0;
+}
+
+/**
+ * Push and pop a buffer on the MPMC queue from one thread.
+ */
+static int
+mpmc_push_pop_bench(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  pdcpl_buffer buf = {NULL, 0};
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_mpmc_queue_push(ctx->mpmc, &buf);
+    pdcpl_mpmc_queue_pop(ctx->mpmc, &buf);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(buf);
+  }
+  return 0;
+}
+
+/**
+ * Thread function that pushes buffers to the SPSC queue in batches.
+ *
+ * @param arg `queue_context *` context
+ * @returns `NULL`
+ */
+static void *
+spsc_producer(void *arg)
+{
+  queue_context *ctx = arg;
+  pdcpl_buffer bufs[BATCH_SIZE] = {{NULL, 0}};
+  for (uint64_t done = 0; done < ctx->n_items; ) {
+    size_t n = (ctx->n_items - done < ctx->batch) ?
+      (size_t) (ctx->n_items - done) : ctx->batch;
+    size_t k = pdcpl_spsc_queue_push_n(ctx->spsc, bufs, n);
+    // yield when full so this also works with fewer cores than threads
+    if (!k)
+      pdcpl_thread_yield();
+    done += k;
+  }
+  return NULL;
+}
+
+/**
+ * Thread function that pushes buffers to the MPMC queue in batches.
+ *
+ * @param arg `queue_context *` context
+ * @returns `NULL`
+ */
+static void *
+mpmc_producer(void *arg)
+{
+  queue_context *ctx = arg;
+  pdcpl_buffer bufs[BATCH_SIZE] = {{NULL, 0}};
+  for (uint64_t done = 0; done < ctx->n_items; ) {
+    size_t n = (ctx->n_items - done < ctx->batch) ?
+      (size_t) (ctx->n_items - done) : ctx->batch;
+    size_t k = pdcpl_mpmc_queue_push_n(ctx->mpmc, bufs, n);
+    if (!k)
+      pdcpl_thread_yield();
+    done += k;
+  }
+  return NULL;
+}
+
+/**
+ * Thread function that pushes buffers to the blocking queue in batches.
+ *
+ * @param arg `queue_context *` context
+ * @returns `NULL` on success, `arg` on error
+ */
+static void *
+blocking_producer(void *arg)
+{
+  queue_context *ctx = arg;
+  pdcpl_buffer bufs[BATCH_SIZE] = {{NULL, 0}};
+  for (uint64_t done = 0; done < ctx->n_items; ) {
+    size_t n = (ctx->n_items - done < ctx->batch) ?
+      (size_t) (ctx->n_items - done) : ctx->batch;
+    if (pdcpl_blocking_queue_push_n(ctx->blocking, bufs, n, NULL))
+      return arg;
+    done += n;
+  }
+  return NULL;
+}
+
+/**
+ * Move buffers from a producer thread to the calling thread.
+ *
+ * @param state Benchmark state
+ * @param producer Producer thread function
+ * @param batch Number of buffers per push and pop
+ * @param pop_n Function to pop up to `n` buffers without blocking, `NULL`
+ *  to pop from the blocking queue
+ * @param queue Queue handle passed to `pop_n`
+ */
+static int
+transfer(
+  pdcpl_bench_state *state,
+  void *(*producer)(void *),
+  size_t batch,
+  size_t (*pop_n)(void *, pdcpl_buffer *, size_t),
+  void *queue)
+{
+  queue_context *ctx = state->ctx;
+  ctx->n_items = state->iterations;
+  ctx->batch = batch;
+  pdcpl_thread *thread;
+  int status = pdcpl_thread_create(&thread, producer, ctx);
+  if (status)
+    return status;
+  pdcpl_buffer bufs[BATCH_SIZE];
+  for (uint64_t done = 0; done < state->iterations && !status; ) {
+    size_t k;
+    if (pop_n) {
+      if (!(k = pop_n(queue, bufs, batch)))
+        pdcpl_thread_yield();
+    }
+    else
+      status = pdcpl_blocking_queue_pop_n(ctx->blocking, bufs, batch, &k);
+    done += k;
+  }
+  void *result;
+  pdcpl_thread_join(thread, &result);
+  return (status) ? status : ((result) ? -EPIPE : 0);
+}
+
+/**
+ * Pop from the SPSC queue, adapting the handle type.
+ */
+static size_t
+spsc_pop_n(void *queue, pdcpl_buffer *bufs, size_t n)
+{
+  return pdcpl_spsc_queue_pop_n(queue, bufs, n);
+}
+
+/**
+ * Pop from the MPMC queue, adapting the handle type.
+ */
+static size_t
+mpmc_pop_n(void *queue, pdcpl_buffer *bufs, size_t n)
+{
+  return pdcpl_mpmc_queue_pop_n(queue, bufs, n);
+}
+
+/**
+ * Move buffers one at a time between threads through the SPSC queue.
+ */
+static int
+spsc_transfer_bench(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  return transfer(state, spsc_producer, 1, spsc_pop_n, ctx->spsc);
+}
+
+/**
+ * Move buffers in batches between threads through the SPSC queue.
+ */
+static int
+spsc_transfer_batch_bench(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  return transfer(state, spsc_producer, BATCH_SIZE, spsc_pop_n, ctx->spsc);
+}
+
+/**
+ * Move buffers one at a time between threads through the MPMC queue.
+ */
+static int
+mpmc_transfer_bench(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  return transfer(state, mpmc_producer, 1, mpmc_pop_n, ctx->mpmc);
+}
+
+/**
+ * Move buffers in batches between threads through the MPMC queue.
+ */
+static int
+mpmc_transfer_batch_bench(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  return transfer(state, mpmc_producer, BATCH_SIZE, mpmc_pop_n, ctx->mpmc);
+}
+
+/**
+ * Move buffers one at a time between threads through the blocking queue.
+ */
+static int
+blocking_transfer_bench(pdcpl_bench_state *state)
+{
+  return transfer(state, blocking_producer, 1, NULL, NULL);
+}
+
+/**
+ * Thread function that echoes requests back as replies.
+ *
+ * @param arg `queue_context *` context
+ * @returns `NULL`
+ */
+static void *
+spsc_echo(void *arg)
+{
+  queue_context *ctx = arg;
+  pdcpl_buffer buf;
+  for (uint64_t n = 0; n < ctx->n_items; n++) {
+    while (pdcpl_spsc_queue_pop(ctx->spsc, &buf))
+      pdcpl_thread_yield();
+    while (pdcpl_spsc_queue_push(ctx->spsc_reply, &buf))
+      pdcpl_thread_yield();
+  }
+  return NULL;
+}
+
+/**
+ * Send a buffer to another thread and wait for it to come back.
+ */
+static int
+spsc_ping_pong_bench(pdcpl_bench_state *state)
+{
+  queue_context *ctx = state->ctx;
+  ctx->n_items = state->iterations;
+  pdcpl_thread *thread;
+  int status = pdcpl_thread_create(&thread, spsc_echo, ctx);
+  if (status)
+    return status;
+  pdcpl_buffer buf = {NULL, 0};
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_spsc_queue_push(ctx->spsc, &buf);
+    while (pdcpl_spsc_queue_pop(ctx->spsc_reply, &buf))
+      pdcpl_thread_yield();
+  }
+  return pdcpl_thread_join(thread, NULL);
+}
+
+const pdcpl_bench_case pdcpl_bench_queue_cases[] = {
+  {"queue/spsc/push_pop", spsc_push_pop_bench, queue_setup, queue_teardown},
+  {"queue/mpmc/push_pop", mpmc_push_pop_bench, queue_setup, queue_teardown},
+  {"queue/spsc/transfer", spsc_transfer_bench, queue_setup, queue_teardown},
+  {
+    "queue/spsc/transfer_batch",
+    spsc_transfer_batch_bench,
+    queue_setup,
+    queue_teardown
+  },
+  {"queue/mpmc/transfer", mpmc_transfer_bench, queue_setup, queue_teardown},
+  {
+    "queue/mpmc/transfer_batch",
+    mpmc_transfer_batch_bench,
+    queue_setup,
+    queue_teardown
+  },
+  {
+    "queue/blocking/transfer",
+    blocking_transfer_bench,
+    queue_setup,
+    queue_teardown
+  },
+  {"queue/spsc/ping_pong", spsc_ping_pong_bench, queue_setup, queue_teardown},
+  PDCPL_BENCH_CASES_END
+};
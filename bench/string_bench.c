@@ -0,0 +1,158 @@
+/**
+ * @file string_bench.c
+ * @author Derek Huang
+ * @brief string.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/string.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+
+/**
+ * Approximate size of the input text.
+ */
+#define TEXT_SIZE 65536
+
+/**
+ * String benchmark context.
+ *
+ * @param text Text of lines of lowercase words
+ * @param size Text length
+ * @param stream Temporary file containing the text
+ */
+typedef struct {
+  char *text;
+  size_t size;
+  FILE *stream;
+} string_context;
+
+/**
+ * Free string benchmark context.
+ */
+static int
+text_teardown(pdcpl_bench_state *state)
+{
+  string_context *ctx = state->ctx;
+  if (ctx->stream)
+    fclose(ctx->stream);
+  free(ctx->text);
+  free(ctx);
+  return 0;
+}
+
+/**
+ * Generate text of lines of pseudo-random words and write it to a stream.
+ */
+static int
+text_setup(pdcpl_bench_state *state)
+{
+  string_context *ctx = calloc(1, sizeof *ctx);
+  if (!ctx)
+    return -ENOMEM;
+  state->ctx = ctx;
+  if (!(ctx->text = malloc(TEXT_SIZE + 1))) {
+    text_teardown(state);
+    return -ENOMEM;
+  }
+  uint64_t seed = 42;
+  while (ctx->size < TEXT_SIZE) {
+    // word of 1-10 letters, then a space or a newline every ~8 words
+    uint64_t r = pdcpl_bench_lcg(&seed);
+    for (uint64_t i = 0; i <= r % 10 && ctx->size < TEXT_SIZE; i++)
+      ctx->text[ctx->size++] = (char) ('a' + (r >> (8 + i)) % 26);
+    if (ctx->size < TEXT_SIZE)
+      ctx->text[ctx->size++] = ((r >> 32) % 8) ? ' ' : '\n';
+  }
+  ctx->text[ctx->size] = '\0';
+  ctx->stream = tmpfile();
+  if (!ctx->stream || fputs(ctx->text, ctx->stream) == EOF) {
+    text_teardown(state);
+    return -EIO;
+  }
+  state->bytes = ctx->size;
+  return 0;
+}
+
+/**
+ * Count words, chars, and lines in the text.
+ */
+static int
+strwc_bench(pdcpl_bench_state *state)
+{
+  string_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_wcresults res;
+    pdcpl_strwc(ctx->text, &res);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(res);
+  }
+  return 0;
+}
+
+/**
+ * Reverse the text into a new string.
+ */
+static int
+strrev_bench(pdcpl_bench_state *state)
+{
+  string_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    char *rev;
+    if (pdcpl_strrev(ctx->text, &rev, NULL))
+      return -ENOMEM;
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(rev);
+    free(rev);
+  }
+  return 0;
+}
+
+/**
+ * Search for a substring not present in the text.
+ */
+static int
+strfind_bench(pdcpl_bench_state *state)
+{
+  string_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    size_t pos;
+    pdcpl_strfind(ctx->text, "abcdefghijk", &pos);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(pos);
+  }
+  return 0;
+}
+
+/**
+ * Read all the lines of the text from the stream.
+ */
+static int
+getline_bench(pdcpl_bench_state *state)
+{
+  string_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    rewind(ctx->stream);
+    char *line;
+    int status;
+    while (!(status = pdcpl_getline(ctx->stream, &line, NULL)) && line) {
+      PDCPL_BENCH_DO_NOT_OPTIMIZE(line);
+      free(line);
+    }
+    if (status)
+      return status;
+  }
+  return 0;
+}
+
+const pdcpl_bench_case pdcpl_bench_string_cases[] = {
+  {"string/strwc", strwc_bench, text_setup, text_teardown},
+  {"string/strrev", strrev_bench, text_setup, text_teardown},
+  {"string/strfind", strfind_bench, text_setup, text_teardown},
+  {"string/getline", getline_bench, text_setup, text_teardown},
+  PDCPL_BENCH_CASES_END
+};
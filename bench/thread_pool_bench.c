@@ -0,0 +1,157 @@
+/**
+ * @file thread_pool_bench.c
+ * @author Derek Huang
+ * @brief thread_pool.(c|h) scaling benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/thread_pool.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+#include "pdcpl/string.h"
+
+/**
+ * Number of lines and approximate line length of the input text.
+ */
+#define N_LINES 4096
+#define LINE_SIZE 1024
+
+/**
+ * Thread pool benchmark context.
+ *
+ * @param pool Thread pool
+ * @param lines Lines of words
+ * @param words Per-line word counts written by the kernel
+ */
+typedef struct {
+  pdcpl_thread_pool *pool;
+  char *lines[N_LINES];
+  size_t words[N_LINES];
+} pool_context;
+
+/**
+ * Free thread pool benchmark context.
+ */
+static int
+pool_teardown(pdcpl_bench_state *state)
+{
+  pool_context *ctx = state->ctx;
+  if (ctx->pool)
+    pdcpl_thread_pool_destroy(ctx->pool);
+  for (size_t i = 0; i < N_LINES; i++)
+    free(ctx->lines[i]);
+  free(ctx);
+  return 0;
+}
+
+/**
+ * Generate lines of pseudo-random words and start a pool.
+ *
+ * @param state Benchmark state
+ * @param n_threads Number of workers, 0 for the number of hardware threads
+ */
+static int
+pool_setup(pdcpl_bench_state *state, unsigned int n_threads)
+{
+  pool_context *ctx = calloc(1, sizeof *ctx);
+  if (!ctx)
+    return -ENOMEM;
+  state->ctx = ctx;
+  uint64_t seed = 42;
+  for (size_t i = 0; i < N_LINES; i++) {
+    char *line = ctx->lines[i] = malloc(LINE_SIZE + 1);
+    if (!line) {
+      pool_teardown(state);
+      return -ENOMEM;
+    }
+    // words of 1-10 letters separated by spaces
+    size_t size = 0;
+    while (size < LINE_SIZE) {
+      uint64_t r = pdcpl_bench_lcg(&seed);
+      for (uint64_t j = 0; j <= r % 10 && size < LINE_SIZE; j++)
+        line[size++] = (char) ('a' + (r >> (8 + j)) % 26);
+      if (size < LINE_SIZE)
+        line[size++] = ' ';
+    }
+    line[size] = '\0';
+    state->bytes += size;
+  }
+  pdcpl_thread_pool_options opts = {n_threads, false};
+  int status = pdcpl_thread_pool_create(&ctx->pool, &opts);
+  if (status) {
+    pool_teardown(state);
+    return status;
+  }
+  return 0;
+}
+
+/**
+ * Count words in a range of lines.
+ *
+ * @param begin First line
+ * @param end One past the last line
+ * @param arg `pool_context *` context
+ */
+static void
+strwc_range(size_t begin, size_t end, void *arg)
+{
+  pool_context *ctx = arg;
+  for (size_t i = begin; i < end; i++) {
+    pdcpl_wcresults res;
+    pdcpl_strwc(ctx->lines[i], &res);
+    ctx->words[i] = res.nw;
+  }
+}
+
+/**
+ * Count words in every line in parallel.
+ */
+static int
+strwc_bench(pdcpl_bench_state *state)
+{
+  pool_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    int status = pdcpl_parallel_for(
+      ctx->pool, 0, N_LINES, 0, strwc_range, ctx
+    );
+    if (status)
+      return status;
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(ctx->words);
+  }
+  return 0;
+}
+
+/**
+ * Define a setup function for a pool with the given number of threads.
+ *
+ * @param n Number of threads, 0 for the number of hardware threads
+ * @param suffix Function name suffix
+ */
+#define POOL_SETUP_DEF(n, suffix) \
+  static int \
+  pool_setup_ ## suffix(pdcpl_bench_state *state) \
+  { \
+    return pool_setup(state, n); \
+  }
+
+POOL_SETUP_DEF(1, 1)
+POOL_SETUP_DEF(2, 2)
+POOL_SETUP_DEF(4, 4)
+POOL_SETUP_DEF(8, 8)
+POOL_SETUP_DEF(0, all)
+
+// compare against string/strwc for the single-threaded baseline
+const pdcpl_bench_case pdcpl_bench_thread_pool_cases[] = {
+  {"thread_pool/strwc/1", strwc_bench, pool_setup_1, pool_teardown},
+  {"thread_pool/strwc/2", strwc_bench, pool_setup_2, pool_teardown},
+  {"thread_pool/strwc/4", strwc_bench, pool_setup_4, pool_teardown},
+  {"thread_pool/strwc/8", strwc_bench, pool_setup_8, pool_teardown},
+  {"thread_pool/strwc/all", strwc_bench, pool_setup_all, pool_teardown},
+  PDCPL_BENCH_CASES_END
+};
@@ -0,0 +1,161 @@
+/**
+ * @file variant_bench.c
+ * @author Derek Huang
+ * @brief variant.(c|h), variant_map.(c|h) benchmarks
+ * @copyright MIT License
+ */
+
+#include "pdcpl/variant.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench_suites.h"
+#include "pdcpl/bench.h"
+#include "pdcpl/variant_map.h"
+
+/**
+ * Number of keys.
+ */
+#define N_KEYS 1024
+
+/**
+ * Variant benchmark context.
+ *
+ * @param keys String keys
+ * @param map Map containing the keys
+ */
+typedef struct {
+  pdcpl_variant keys[N_KEYS];
+  pdcpl_variant_map map;
+} variant_context;
+
+/**
+ * Free variant benchmark context.
+ */
+static int
+keys_teardown(pdcpl_bench_state *state)
+{
+  variant_context *ctx = state->ctx;
+  for (size_t i = 0; i < N_KEYS; i++)
+    pdcpl_variant_free(ctx->keys + i);
+  pdcpl_variant_map_free(&ctx->map);
+  free(ctx);
+  return 0;
+}
+
+/**
+ * Create distinct string keys and a map containing them.
+ */
+static int
+keys_setup(pdcpl_bench_state *state)
+{
+  variant_context *ctx = calloc(1, sizeof *ctx);
+  if (!ctx)
+    return -ENOMEM;
+  state->ctx = ctx;
+  int status;
+  if ((status = pdcpl_variant_map_init(&ctx->map, N_KEYS, 0))) {
+    keys_teardown(state);
+    return status;
+  }
+  uint64_t seed = 42;
+  for (size_t i = 0; i < N_KEYS; i++) {
+    char key[32];
+    snprintf(
+      key, sizeof key, "key_%zu_%llu",
+      i, (unsigned long long) pdcpl_bench_lcg(&seed) % 100000
+    );
+    if (
+      (status = pdcpl_variant_init_string(ctx->keys + i, key)) ||
+      (status = pdcpl_variant_map_insert(&ctx->map, ctx->keys + i, NULL))
+    ) {
+      keys_teardown(state);
+      return status;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Hash each key.
+ */
+static int
+hash_bench(pdcpl_bench_state *state)
+{
+  variant_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < N_KEYS; i++)
+      total ^= pdcpl_variant_hash(ctx->keys + i);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(total);
+  }
+  return 0;
+}
+
+/**
+ * Compare adjacent keys.
+ */
+static int
+compare_bench(pdcpl_bench_state *state)
+{
+  variant_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    int total = 0;
+    for (size_t i = 1; i < N_KEYS; i++)
+      total += pdcpl_variant_compare(ctx->keys + i - 1, ctx->keys + i);
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(total);
+  }
+  return 0;
+}
+
+/**
+ * Look up each key in the map.
+ */
+static int
+map_find_bench(pdcpl_bench_state *state)
+{
+  variant_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    for (size_t i = 0; i < N_KEYS; i++) {
+      void **slot = pdcpl_variant_map_find(&ctx->map, ctx->keys + i);
+      PDCPL_BENCH_DO_NOT_OPTIMIZE(slot);
+    }
+  }
+  return 0;
+}
+
+/**
+ * Build a map from all the keys, starting from an empty map.
+ */
+static int
+map_insert_bench(pdcpl_bench_state *state)
+{
+  variant_context *ctx = state->ctx;
+  for (uint64_t n = 0; n < state->iterations; n++) {
+    pdcpl_variant_map map;
+    int status;
+    if ((status = pdcpl_variant_map_init(&map, 0, 0)))
+      return status;
+    for (size_t i = 0; i < N_KEYS; i++) {
+      if ((status = pdcpl_variant_map_insert(&map, ctx->keys + i, NULL)))
+        break;
+    }
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(map.size);
+    pdcpl_variant_map_free(&map);
+    if (status)
+      return status;
+  }
+  return 0;
+}
+
+const pdcpl_bench_case pdcpl_bench_variant_cases[] = {
+  {"variant/hash", hash_bench, keys_setup, keys_teardown},
+  {"variant/compare", compare_bench, keys_setup, keys_teardown},
+  {"variant/map_find", map_find_bench, keys_setup, keys_teardown},
+  {"variant/map_insert", map_insert_bench, keys_setup, keys_teardown},
+  PDCPL_BENCH_CASES_END
+};
@@ -4,6 +4,10 @@ cmake_minimum_required(VERSION ${CMAKE_MINIMUM_REQUIRED_VERSION})
 if(BUILD_SHARED_LIBS)
     add_compile_definitions(PDCPL_DLL)
 endif()
+# if tracing is enabled, define PDCPL_ENABLE_TRACE
+if(PDCPL_ENABLE_TRACE)
+    add_compile_definitions(PDCPL_ENABLE_TRACE)
+endif()
 if(MSVC)
     # stop MSVC from warning about unsafe functions, C is unsafe by nature
     add_compile_definitions(_CRT_SECURE_NO_WARNINGS)
@@ -74,4 +78,17 @@ else()
         add_compile_options(-fsanitize=address)
         add_link_options(-fsanitize=address)
     endif()
+    # enable ThreadSanitizer use, e.g. to check concurrent parsing. MSVC has
+    # no ThreadSanitizer and it cannot be combined with AddressSanitizer
+    if(ENABLE_TSAN)
+        if(ENABLE_ASAN)
+            message(
+                FATAL_ERROR
+                "ENABLE_TSAN and ENABLE_ASAN cannot both be enabled"
+            )
+        endif()
+        message(STATUS "ThreadSanitizer (-fsanitize=thread) enabled")
+        add_compile_options(-fsanitize=thread)
+        add_link_options(-fsanitize=thread)
+    endif()
 endif()
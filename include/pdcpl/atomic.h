@@ -0,0 +1,220 @@
+/**
+ * @file atomic.h
+ * @author Derek Huang
+ * @brief C/C++ header for portable atomic operations
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_ATOMIC_H_
+#define PDCPL_ATOMIC_H_
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdcpl/common.h"
+
+// C11 <stdatomic.h> is not available for MSVC C or in C++ before C++23, so we
+// use compiler builtins. on MSVC, Interlocked* intrinsics are full barriers.
+
+// on MSVC, acquire loads are done like the MSVC STL does them, i.e. a plain
+// volatile load followed by a barrier. x86/x64 loads already have acquire
+// ordering, so there the barrier only stops compiler reordering.
+#if defined(_MSC_VER)
+#if defined(_M_ARM) || defined(_M_ARM64) || defined(_M_ARM64EC)
+#define PDCPL_ATOMIC_ACQUIRE_BARRIER() __dmb(0xB)  // _ARM64_BARRIER_ISH
+#else
+#define PDCPL_ATOMIC_ACQUIRE_BARRIER() _ReadWriteBarrier()
+#endif  // !defined(_M_ARM) && !defined(_M_ARM64) && !defined(_M_ARM64EC)
+#endif  // _MSC_VER
+
+/**
+ * Atomically load a 64-bit unsigned integer with acquire semantics.
+ *
+ * @param p Address of value to load
+ */
+PDCPL_INLINE uint64_t
+pdcpl_atomic_load_u64(const volatile uint64_t *p)
+{
+#if defined(_MSC_VER)
+  uint64_t v = (uint64_t) __iso_volatile_load64((const volatile __int64 *) p);
+  PDCPL_ATOMIC_ACQUIRE_BARRIER();
+  return v;
+#else
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Atomically store a 64-bit unsigned integer with release semantics.
+ *
+ * @param p Address of value to store to
+ * @param v Value to store
+ */
+PDCPL_INLINE void
+pdcpl_atomic_store_u64(volatile uint64_t *p, uint64_t v)
+{
+#if defined(_MSC_VER)
+  _InterlockedExchange64((volatile __int64 *) p, (__int64) v);
+#else
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Atomically add to a 64-bit unsigned integer and return the previous value.
+ *
+ * Only atomicity is guaranteed, i.e. no ordering of other memory accesses.
+ *
+ * @param p Address of value to add to
+ * @param n Amount to add
+ */
+PDCPL_INLINE uint64_t
+pdcpl_atomic_fetch_add_u64(volatile uint64_t *p, uint64_t n)
+{
+#if defined(_MSC_VER)
+  return (uint64_t) _InterlockedExchangeAdd64(
+    (volatile __int64 *) p, (__int64) n
+  );
+#else
+  return __atomic_fetch_add(p, n, __ATOMIC_RELAXED);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Atomically add to a 64-bit unsigned integer and return the previous value.
+ *
+ * Prior memory accesses of the calling thread are released, so a thread that
+ * acquire loads the new value sees them.
+ *
+ * @param p Address of value to add to
+ * @param n Amount to add
+ */
+PDCPL_INLINE uint64_t
+pdcpl_atomic_fetch_add_release_u64(volatile uint64_t *p, uint64_t n)
+{
+#if defined(_MSC_VER)
+  return (uint64_t) _InterlockedExchangeAdd64(
+    (volatile __int64 *) p, (__int64) n
+  );
+#else
+  return __atomic_fetch_add(p, n, __ATOMIC_RELEASE);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Atomically replace a 64-bit unsigned integer if it has the expected value.
+ *
+ * This is a full barrier. On failure, `*expected` is updated with the current
+ * value.
+ *
+ * @param p Address of value to update
+ * @param expected Address of expected current value
+ * @param desired Value to store if `*p` equals `*expected`
+ * @returns `true` if the value was replaced, `false` otherwise
+ */
+PDCPL_INLINE bool
+pdcpl_atomic_cas_u64(volatile uint64_t *p, uint64_t *expected, uint64_t desired)
+{
+#if defined(_MSC_VER)
+  uint64_t prev = (uint64_t) _InterlockedCompareExchange64(
+    (volatile __int64 *) p, (__int64) desired, (__int64) *expected
+  );
+  if (prev == *expected)
+    return true;
+  *expected = prev;
+  return false;
+#else
+  return __atomic_compare_exchange_n(
+    p, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST
+  );
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Issue a sequentially consistent memory fence.
+ */
+PDCPL_INLINE void
+pdcpl_atomic_fence(void)
+{
+#if defined(_MSC_VER)
+  // interlocked operations are full barriers, like MemoryBarrier()
+  volatile long barrier = 0;
+  _InterlockedOr(&barrier, 0);
+#else
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Atomically load a pointer with acquire semantics.
+ *
+ * @param p Address of pointer to load
+ */
+PDCPL_INLINE void *
+pdcpl_atomic_load_ptr(void *const volatile *p)
+{
+#if defined(_MSC_VER)
+#if defined(_WIN64)
+  void *v = (void *) (uintptr_t) __iso_volatile_load64(
+    (const volatile __int64 *) p
+  );
+#else
+  void *v = (void *) (uintptr_t) __iso_volatile_load32(
+    (const volatile __int32 *) p
+  );
+#endif  // !defined(_WIN64)
+  PDCPL_ATOMIC_ACQUIRE_BARRIER();
+  return v;
+#else
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Atomically store a pointer with release semantics.
+ *
+ * @param p Address of pointer to store to
+ * @param v Value to store
+ */
+PDCPL_INLINE void
+pdcpl_atomic_store_ptr(void *volatile *p, void *v)
+{
+#if defined(_MSC_VER)
+  _InterlockedExchangePointer(p, v);
+#else
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Atomically replace a pointer if it has the expected value.
+ *
+ * On failure, `*expected` is updated with the current value.
+ *
+ * @param p Address of pointer to update
+ * @param expected Address of expected current value
+ * @param desired Value to store if `*p` equals `*expected`
+ * @returns `true` if the pointer was replaced, `false` otherwise
+ */
+PDCPL_INLINE bool
+pdcpl_atomic_cas_ptr(void *volatile *p, void **expected, void *desired)
+{
+#if defined(_MSC_VER)
+  void *prev = _InterlockedCompareExchangePointer(p, desired, *expected);
+  if (prev == *expected)
+    return true;
+  *expected = prev;
+  return false;
+#else
+  return __atomic_compare_exchange_n(
+    p, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+  );
+#endif  // !defined(_MSC_VER)
+}
+
+#endif  // PDCPL_ATOMIC_H_
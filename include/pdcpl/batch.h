@@ -0,0 +1,73 @@
+/**
+ * @file batch.h
+ * @author Derek Huang
+ * @brief C header for running a stream function over many files in parallel
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_BATCH_H_
+#define PDCPL_BATCH_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Function that processes one input stream and writes to an output stream.
+ *
+ * This is typically the body of a program that otherwise reads from `stdin`
+ * and writes to `stdout`. It may be called concurrently from multiple threads
+ * so any shared state must be read-only or synchronized.
+ *
+ * @param in Input stream
+ * @param out Output stream
+ * @param path Path of the input stream, `"-"` for `stdin`
+ * @param ctx User-defined context
+ * @returns 0 on success, negative errno value on error
+ */
+typedef int (*pdcpl_batch_func)(
+  FILE *in, FILE *out, const char *path, void *ctx);
+
+/**
+ * Run a stream function over a list of files, possibly in parallel.
+ *
+ * Files are processed by up to `n_jobs` threads, including the calling
+ * thread. Each file's output is buffered in memory, or in a temporary file if
+ * in-memory streams are not available, and is written to `out` in argument
+ * order as soon as all the files before it are done. When `n_jobs` is 1 or
+ * there is only one file, output is written to `out` directly.
+ *
+ * A path of `"-"` reads from `stdin`. Errors opening or processing a file are
+ * reported to `stderr` in argument order as `name: path: message` and do not
+ * stop processing of the other files.
+ *
+ * @param paths Array of input file paths
+ * @param n_paths Number of input file paths
+ * @param n_jobs Maximum number of threads to use, 0 to use the number of
+ *  hardware threads
+ * @param func Function to process each file
+ * @param ctx User-defined context passed to `func`
+ * @param out Stream to write outputs to
+ * @param name Prefix for error messages, e.g. program name, can be `NULL`
+ * @returns 0 if all files were processed successfully, -EINVAL if `paths`,
+ *  `func`, or `out` is `NULL`, -ENOMEM if memory allocation fails, otherwise
+ *  the error status of the first file in argument order that failed
+ */
+PDCPL_PUBLIC int
+pdcpl_batch_run(
+  PDCPL_SA(In) const char *const *paths,
+  size_t n_paths,
+  unsigned int n_jobs,
+  PDCPL_SA(In) pdcpl_batch_func func,
+  PDCPL_SA(Opt(In)) void *ctx,
+  PDCPL_SA(In) FILE *out,
+  PDCPL_SA(Opt(In)) const char *name);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_BATCH_H_
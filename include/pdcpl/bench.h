@@ -0,0 +1,376 @@
+/**
+ * @file bench.h
+ * @author Derek Huang
+ * @brief C/C++ header-only microbenchmark harness
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_BENCH_H_
+#define PDCPL_BENCH_H_
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pdcpl/clock.h"
+#include "pdcpl/common.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Benchmark state passed to a benchmark function.
+ *
+ * The benchmark function should perform the measured operation `iterations`
+ * times. If the operation processes a fixed number of bytes, `bytes` should be
+ * set to that number so throughput can be reported.
+ *
+ * @param iterations Number of times to perform the operation
+ * @param bytes Bytes processed per operation, 0 if not applicable
+ * @param ctx User context, e.g. allocated by the case `setup` function
+ */
+typedef struct {
+  uint64_t iterations;
+  uint64_t bytes;
+  void *ctx;
+} pdcpl_bench_state;
+
+/**
+ * Benchmark, setup, or teardown function.
+ *
+ * Returns 0 on success and a negative `errno` value on failure.
+ */
+typedef int (*pdcpl_bench_func)(pdcpl_bench_state *state);
+
+/**
+ * Benchmark case.
+ *
+ * `setup` and `teardown` run once per case, outside of timing, and may be
+ * `NULL`. Arrays of cases are terminated by `PDCPL_BENCH_CASES_END`.
+ *
+ * @param name Case name
+ * @param func Benchmark function
+ * @param setup Function to initialize `state->ctx`
+ * @param teardown Function to release `state->ctx`
+ */
+typedef struct {
+  const char *name;
+  pdcpl_bench_func func;
+  pdcpl_bench_func setup;
+  pdcpl_bench_func teardown;
+} pdcpl_bench_case;
+
+/**
+ * Sentinel for the end of a `pdcpl_bench_case` array.
+ */
+#define PDCPL_BENCH_CASES_END {NULL, NULL, NULL, NULL}
+
+/**
+ * Maximum number of samples per benchmark case.
+ */
+#define PDCPL_BENCH_MAX_SAMPLES 1000
+
+/**
+ * Maximum iterations per sample.
+ *
+ * Limits calibration of benchmarks whose work is optimized away.
+ */
+#define PDCPL_BENCH_MAX_ITERATIONS ((uint64_t) 1 << 40)
+
+/**
+ * Benchmark run options.
+ *
+ * @param min_time Minimum seconds per sample used to calibrate iterations
+ * @param warmup_time Seconds to run before samples are taken
+ * @param samples Number of samples, at most `PDCPL_BENCH_MAX_SAMPLES`
+ */
+typedef struct {
+  double min_time;
+  double warmup_time;
+  unsigned int samples;
+} pdcpl_bench_options;
+
+/**
+ * Default `pdcpl_bench_options` initializer.
+ */
+#define PDCPL_BENCH_OPTIONS_DEFAULT {0.01, 0.05, 15}
+
+/**
+ * Benchmark case result.
+ *
+ * Times are nanoseconds per iteration. The median absolute deviation (MAD) is
+ * the median of the absolute differences between the samples and the median.
+ *
+ * @param name Case name
+ * @param iterations Iterations per sample
+ * @param samples Number of samples
+ * @param median_ns Median time
+ * @param mad_ns Median absolute deviation of the time
+ * @param min_ns Minimum time
+ * @param bytes_per_sec Throughput from the median time, 0 if not applicable
+ */
+typedef struct {
+  const char *name;
+  uint64_t iterations;
+  unsigned int samples;
+  double median_ns;
+  double mad_ns;
+  double min_ns;
+  double bytes_per_sec;
+} pdcpl_bench_result;
+
+/**
+ * Prevent the compiler from optimizing away the value at an address.
+ *
+ * The compiler must assume the value is read, so computations producing it
+ * cannot be eliminated. Prefer `PDCPL_BENCH_DO_NOT_OPTIMIZE`.
+ *
+ * @param p Address of value
+ */
+PDCPL_INLINE void
+pdcpl_bench_do_not_optimize(const void *p)
+{
+#if defined(_MSC_VER)
+  // MSVC x64 has no inline assembly, so the address escapes to a volatile
+  static const void *volatile sink;
+  sink = p;
+  _ReadWriteBarrier();
+#else
+  __asm__ volatile ("" : : "g" (p) : "memory");
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Prevent the compiler from optimizing away computation of a value.
+ *
+ * @param x Lvalue whose value must be computed
+ */
+#define PDCPL_BENCH_DO_NOT_OPTIMIZE(x) pdcpl_bench_do_not_optimize(&(x))
+
+/**
+ * Force the compiler to assume all memory is read and written.
+ *
+ * Pending stores cannot be eliminated and loads cannot be hoisted across this.
+ */
+PDCPL_INLINE void
+pdcpl_bench_clobber_memory(void)
+{
+#if defined(_MSC_VER)
+  _ReadWriteBarrier();
+#else
+  __asm__ volatile ("" : : : "memory");
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Compare two doubles for `qsort`.
+ *
+ * @param a Address of first double
+ * @param b Address of second double
+ */
+PDCPL_INLINE int
+pdcpl_bench_double_cmp(const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Return the median of an array of doubles, sorting the array.
+ *
+ * @param values Array of values
+ * @param n Number of values, must be positive
+ */
+PDCPL_INLINE double
+pdcpl_bench_median(double *values, size_t n)
+{
+  qsort(values, n, sizeof *values, pdcpl_bench_double_cmp);
+  return (n % 2) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+/**
+ * Time one sample of a benchmark function.
+ *
+ * @param bc Benchmark case
+ * @param state Benchmark state with the iterations to run
+ * @param elapsed Address to write elapsed nanoseconds to
+ * @returns 0 on success, negative `errno` value if the benchmark fails
+ */
+PDCPL_INLINE int
+pdcpl_bench_sample(
+  const pdcpl_bench_case *bc, pdcpl_bench_state *state, uint64_t *elapsed)
+{
+  uint64_t start = pdcpl_clock_ns();
+  int status = bc->func(state);
+  pdcpl_bench_clobber_memory();
+  *elapsed = pdcpl_clock_ns() - start;
+  return status;
+}
+
+/**
+ * Calibrate, warm up, and sample a benchmark case that has been set up.
+ *
+ * @param bc Benchmark case
+ * @param opts Run options
+ * @param state Benchmark state
+ * @param res Address of result to write to
+ * @returns 0 on success, negative `errno` value if the benchmark fails
+ */
+PDCPL_INLINE int
+pdcpl_bench_measure(
+  const pdcpl_bench_case *bc,
+  const pdcpl_bench_options *opts,
+  pdcpl_bench_state *state,
+  pdcpl_bench_result *res)
+{
+  int status;
+  // calibrate iterations so a sample takes at least min_time
+  uint64_t min_ns = (uint64_t) (1e9 * opts->min_time);
+  uint64_t elapsed;
+  for (;;) {
+    if ((status = pdcpl_bench_sample(bc, state, &elapsed)))
+      return status;
+    if (elapsed >= min_ns || state->iterations >= PDCPL_BENCH_MAX_ITERATIONS)
+      break;
+    // scale by the shortfall but at most 10x in case the sample was noisy
+    uint64_t scale = (elapsed) ? 1 + min_ns / elapsed : 10;
+    state->iterations *= (scale < 2) ? 2 : (scale > 10) ? 10 : scale;
+  }
+  // warm up caches, branch predictors, and CPU frequency
+  uint64_t warmup_end = pdcpl_clock_ns() + (uint64_t) (
+    1e9 * opts->warmup_time
+  );
+  while (pdcpl_clock_ns() < warmup_end) {
+    if ((status = pdcpl_bench_sample(bc, state, &elapsed)))
+      return status;
+  }
+  // take samples in nanoseconds per iteration
+  double times[PDCPL_BENCH_MAX_SAMPLES];
+  for (unsigned int i = 0; i < opts->samples; i++) {
+    if ((status = pdcpl_bench_sample(bc, state, &elapsed)))
+      return status;
+    times[i] = (double) elapsed / (double) state->iterations;
+  }
+  // compute statistics. times is sorted after computing the median
+  res->name = bc->name;
+  res->iterations = state->iterations;
+  res->samples = opts->samples;
+  res->median_ns = pdcpl_bench_median(times, opts->samples);
+  res->min_ns = times[0];
+  for (unsigned int i = 0; i < opts->samples; i++)
+    times[i] = (times[i] > res->median_ns) ?
+      times[i] - res->median_ns : res->median_ns - times[i];
+  res->mad_ns = pdcpl_bench_median(times, opts->samples);
+  res->bytes_per_sec = (state->bytes && res->median_ns > 0) ?
+    1e9 * (double) state->bytes / res->median_ns : 0;
+  return 0;
+}
+
+/**
+ * Run a benchmark case.
+ *
+ * The iteration count is scaled up until a sample takes at least `min_time`,
+ * then the benchmark runs for `warmup_time` before samples are taken.
+ *
+ * @param bc Benchmark case
+ * @param opts Run options, `NULL` for `PDCPL_BENCH_OPTIONS_DEFAULT`
+ * @param res Address of result to write to
+ * @returns 0 on success, -EINVAL if `bc` or `res` is `NULL`, the case has no
+ *  function, or there are no samples or too many samples, negative `errno`
+ *  value if the case setup or benchmark fails
+ */
+PDCPL_INLINE int
+pdcpl_bench_run(
+  const pdcpl_bench_case *bc,
+  const pdcpl_bench_options *opts,
+  pdcpl_bench_result *res)
+{
+  pdcpl_bench_options default_opts = PDCPL_BENCH_OPTIONS_DEFAULT;
+  if (!opts)
+    opts = &default_opts;
+  if (!bc || !bc->func || !res)
+    return -EINVAL;
+  if (!opts->samples || opts->samples > PDCPL_BENCH_MAX_SAMPLES)
+    return -EINVAL;
+  pdcpl_bench_state state = {1, 0, NULL};
+  int status;
+  if (bc->setup && (status = bc->setup(&state)))
+    return status;
+  status = pdcpl_bench_measure(bc, opts, &state, res);
+  if (bc->teardown)
+    bc->teardown(&state);
+  return status;
+}
+
+/**
+ * Write a benchmark result as a line of text.
+ *
+ * @param f Stream to write to
+ * @param res Result to write
+ * @returns 0 on success, -EINVAL if `f` or `res` is `NULL`, -EIO on write error
+ */
+PDCPL_INLINE int
+pdcpl_bench_fprintf(FILE *f, const pdcpl_bench_result *res)
+{
+  if (!f || !res)
+    return -EINVAL;
+  int n = fprintf(
+    f,
+    "%-40s %12.2f ns %10.2f ns %12llu",
+    res->name,
+    res->median_ns,
+    res->mad_ns,
+    (unsigned long long) res->iterations
+  );
+  if (n >= 0 && res->bytes_per_sec)
+    n = fprintf(f, " %10.2f MB/s", 1e-6 * res->bytes_per_sec);
+  if (n >= 0)
+    n = fprintf(f, "\n");
+  return (n < 0) ? -EIO : 0;
+}
+
+/**
+ * Write benchmark results as JSON for regression comparison.
+ *
+ * The output is an object with a `"benchmarks"` array of result objects.
+ * Names are written as-is so they should not need JSON escaping.
+ *
+ * @param f Stream to write to
+ * @param res Results to write
+ * @param n_res Number of results
+ * @returns 0 on success, -EINVAL if `f` is `NULL` or if `res` is `NULL` and
+ *  `n_res` is nonzero, -EIO on write error
+ */
+PDCPL_INLINE int
+pdcpl_bench_fprintf_json(FILE *f, const pdcpl_bench_result *res, size_t n_res)
+{
+  if (!f || (!res && n_res))
+    return -EINVAL;
+  fprintf(f, "{\"benchmarks\": [");
+  for (size_t i = 0; i < n_res; i++)
+    fprintf(
+      f,
+      "%s\n{\"name\": \"%s\", \"iterations\": %llu, \"samples\": %u, "
+      "\"median_ns\": %.3f, \"mad_ns\": %.3f, \"min_ns\": %.3f, "
+      "\"bytes_per_sec\": %.1f}",
+      (i) ? "," : "",
+      res[i].name,
+      (unsigned long long) res[i].iterations,
+      res[i].samples,
+      res[i].median_ns,
+      res[i].mad_ns,
+      res[i].min_ns,
+      res[i].bytes_per_sec
+    );
+  fprintf(f, "\n]}\n");
+  return (ferror(f)) ? -EIO : 0;
+}
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_BENCH_H_
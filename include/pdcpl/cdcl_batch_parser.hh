@@ -0,0 +1,201 @@
+/**
+ * @file cdcl_batch_parser.hh
+ * @author Derek Huang
+ * @brief C++ parallel batch parser for simplified C declarations
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_CDCL_BATCH_PARSER_HH_
+#define PDCPL_CDCL_BATCH_PARSER_HH_
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pdcpl/cdcl_dcln_spec.hh"
+#include "pdcpl/cdcl_parser.hh"
+#include "pdcpl/cdcl_type_table.hh"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/warnings.h"
+
+namespace pdcpl {
+
+// forward declaration for the implementation class
+class cdcl_batch_parser_impl;
+
+/**
+ * Position of a parsed declaration in a batch of input files.
+ *
+ * @param file Index of the input file in `cdcl_batch_parser::files()`
+ * @param position Position of the declaration in the input file
+ */
+struct cdcl_source_position {
+  std::size_t file;
+  cdcl_position position;
+};
+
+/**
+ * Identifier declared in more than one input file of a batch.
+ *
+ * @param iden Redeclared identifier
+ * @param first Position of the declaration kept in the merged results
+ * @param redeclared Position of the conflicting later declaration
+ */
+struct cdcl_conflict {
+  std::string iden;
+  cdcl_source_position first;
+  cdcl_source_position redeclared;
+};
+
+/**
+ * Parse driver class for parsing C declarations from many files in parallel.
+ *
+ * Files are parsed concurrently with one scanner per worker and their results
+ * are merged into a combined index. As with `cdcl_parser`, an identifier may
+ * only be declared once, so the first declaration in file order is kept and
+ * any later declarations are reported as conflicts. The merge is done in
+ * parallel by partitioning the identifiers by hash.
+ */
+class PDCPL_BCDP_PUBLIC cdcl_batch_parser {
+public:
+  using paths_type = std::vector<std::filesystem::path>;
+  using results_type = std::vector<cdcl_dcln>;
+
+  /**
+   * Ctor.
+   *
+   * @param n_jobs Number of files to parse in parallel, 0 to use the number
+   *  of hardware threads
+   */
+  explicit cdcl_batch_parser(unsigned int n_jobs = 0);
+
+  /**
+   * Dtor.
+   */
+  ~cdcl_batch_parser();
+
+  /**
+   * Return the number of files parsed in parallel, 0 for hardware threads.
+   */
+  unsigned int n_jobs() const noexcept;
+
+  /**
+   * Parse the specified input files, replacing any previous results.
+   *
+   * Files that fail to parse contribute no declarations to the results.
+   *
+   * @param files Files to read input from, "-" for `stdin`
+   * @returns `true` if all files parsed without conflicts, `false` otherwise
+   */
+  bool parse(const paths_type& files);
+
+  /**
+   * Parse the specified input files, replacing any previous results.
+   *
+   * @param files Files to read input from, "-" for `stdin`
+   * @returns `true` if all files parsed without conflicts, `false` otherwise
+   */
+  auto operator()(const paths_type& files)
+  {
+    return parse(files);
+  }
+
+  /**
+   * Return the files of the last parse.
+   */
+  const paths_type& files() const noexcept;
+
+  /**
+   * Return the errors of the last parse.
+   *
+   * Parse errors are given in file order followed by a message for each
+   * conflict, in the same order as `conflicts()`.
+   */
+  const std::vector<std::string>& errors() const noexcept;
+
+  /**
+   * Return the redeclaration conflicts between files of the last parse.
+   *
+   * Conflicts are ordered by the position of the conflicting declaration.
+   */
+  const std::vector<cdcl_conflict>& conflicts() const noexcept;
+
+  /**
+   * Return ordered vector of merged declarations.
+   *
+   * The declarations are ordered by file and then by the order in which they
+   * were parsed, skipping any conflicting redeclarations.
+   */
+  const results_type& results() const noexcept;
+
+  /**
+   * Return number of merged declarations.
+   */
+  std::size_t n_results() const noexcept;
+
+  /**
+   * Return `true` if the results have a declaration with the given identifier.
+   *
+   * @param iden Identifier to find matching C declaration for
+   */
+  bool results_contain(std::string_view iden) const;
+
+  /**
+   * Look up a declaration object with the given identifier.
+   *
+   * An exception will be thrown if no matching declaration is found. Use the
+   * `results_contain()` member to check if a matching declaration exists.
+   *
+   * @param iden Identifier to find matching C declaration for
+   */
+  const cdcl_dcln& result(std::string_view iden) const;
+
+  /**
+   * Look up a declaration object via its position in the results vector.
+   *
+   * An exception will be thrown by the vector if `idx` is out of bounds.
+   *
+   * @param idx Index of a C declaration object in `results()`
+   */
+  const cdcl_dcln& result(std::size_t idx) const;
+
+  /**
+   * Return the source position of a declaration in `results()`.
+   *
+   * An exception will be thrown if `idx` is out of bounds.
+   *
+   * @param idx Index of a C declaration object in `results()`
+   */
+  const cdcl_source_position& result_position(std::size_t idx) const;
+
+  /**
+   * Return the canonical types of the declarations in `results()`.
+   *
+   * Declarations have the same type if and only if their type ids are equal.
+   * The types are interned on first use, so this is not `noexcept` and is not
+   * safe to call concurrently with other calls to it or `result_type()`.
+   */
+  const cdcl_type_table& types() const;
+
+  /**
+   * Return the type id of a declaration via its position in `results()`.
+   *
+   * An exception will be thrown if `idx` is out of bounds.
+   *
+   * @param idx Index of a C declaration object in `results()`
+   */
+  cdcl_type_id result_type(std::size_t idx) const;
+
+private:
+  // MSVC emits C4251 since STL types are not exported. not our problem however
+PDCPL_MSVC_WARNING_DISABLE(4251)
+  std::unique_ptr<cdcl_batch_parser_impl> impl_;
+PDCPL_MSVC_WARNING_ENABLE()
+};
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_CDCL_BATCH_PARSER_HH_
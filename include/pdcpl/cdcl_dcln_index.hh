@@ -0,0 +1,185 @@
+/**
+ * @file cdcl_dcln_index.hh
+ * @author Derek Huang
+ * @brief C++ header for query indexes over parsed C declarations
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_CDCL_DCLN_INDEX_HH_
+#define PDCPL_CDCL_DCLN_INDEX_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "pdcpl/cdcl_batch_parser.hh"
+#include "pdcpl/cdcl_parser.hh"
+#include "pdcpl/cdcl_type_spec.hh"
+#include "pdcpl/cdcl_type_table.hh"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/warnings.h"
+
+namespace pdcpl {
+
+// forward declaration for the implementation class
+class cdcl_dcln_index_impl;
+
+/**
+ * Inverted indexes over the declarations of a parser's results.
+ *
+ * Each index maps a key to the ascending indices in `results()` of the
+ * declarations with that key, so queries combining keys are intersections of
+ * sorted lists. For example, extern functions using `struct s` are
+ *
+ * @code{.cc}
+ * auto ids = index.intersect(
+ *   {
+ *     index.storage(cdcl_storage::st_extern),
+ *     index.kind(cdcl_type_kind::function),
+ *     index.uses_iden("s")
+ *   }
+ * );
+ * @endcode
+ *
+ * The index is a snapshot, so it must be rebuilt if the parser's results
+ * change. It holds no references to the parser.
+ */
+class PDCPL_BCDP_PUBLIC cdcl_dcln_index {
+public:
+  using id_type = std::uint32_t;
+  using ids_type = std::vector<id_type>;
+
+  /**
+   * Ctor.
+   *
+   * Builds the indexes for the results of a parser.
+   *
+   * @param parser Parser whose results are indexed
+   */
+  explicit cdcl_dcln_index(const cdcl_parser& parser);
+
+  /**
+   * Ctor.
+   *
+   * Builds the indexes for the merged results of a batch parser.
+   *
+   * @param parser Batch parser whose results are indexed
+   */
+  explicit cdcl_dcln_index(const cdcl_batch_parser& parser);
+
+  /**
+   * Move ctor.
+   *
+   * The moved-from index can only be assigned to or destroyed.
+   */
+  cdcl_dcln_index(cdcl_dcln_index&& other) noexcept;
+
+  /**
+   * Move assignment operator.
+   *
+   * @param other Index to move from
+   */
+  cdcl_dcln_index& operator=(cdcl_dcln_index&& other) noexcept;
+
+  /**
+   * Dtor.
+   */
+  ~cdcl_dcln_index();
+
+  /**
+   * Return the number of indexed declarations.
+   */
+  std::size_t size() const noexcept;
+
+  /**
+   * Return the declarations with the given base type.
+   *
+   * The base type is the type of the declaration specifier, e.g. `char` for
+   * `char *(*f)(int)`.
+   *
+   * @param type Base type
+   */
+  const ids_type& type(cdcl_type type) const noexcept;
+
+  /**
+   * Return the declarations whose base type has the given identifier.
+   *
+   * Struct, enum, and typedef names are not distinguished, so intersect with
+   * `type()` to select one kind of name.
+   *
+   * @param iden Struct, enum, or typedef name
+   */
+  const ids_type& type_iden(std::string_view iden) const noexcept;
+
+  /**
+   * Return the declarations with a type using the given type identifier.
+   *
+   * Unlike `type_iden()`, this also includes declarations where the name is
+   * only used in function parameter types.
+   *
+   * @param iden Struct, enum, or typedef name
+   */
+  const ids_type& uses_iden(std::string_view iden) const noexcept;
+
+  /**
+   * Return the declarations with the given storage.
+   *
+   * @param storage Storage specifier
+   */
+  const ids_type& storage(cdcl_storage storage) const noexcept;
+
+  /**
+   * Return the declarations whose outermost declarator has the given kind.
+   *
+   * Declarations with no declarator specifiers have kind `base`.
+   *
+   * @param kind Type node kind
+   */
+  const ids_type& kind(cdcl_type_kind kind) const noexcept;
+
+  /**
+   * Return the declarations of variadic functions.
+   */
+  const ids_type& variadic() const noexcept;
+
+  /**
+   * Return the declarations with the given canonical type.
+   *
+   * @param id Type id in the parser's `types()`
+   */
+  const ids_type& type_id(cdcl_type_id id) const noexcept;
+
+  /**
+   * Return the ids in both sorted id lists.
+   *
+   * @param a First sorted id list
+   * @param b Second sorted id list
+   */
+  static ids_type intersect(const ids_type& a, const ids_type& b);
+
+  /**
+   * Return the ids in all sorted id lists.
+   *
+   * Lists are intersected from smallest to largest, and each remaining id is
+   * found with a galloping search, so the cost is roughly proportional to the
+   * size of the smallest list times the log of the list sizes.
+   *
+   * @param lists Sorted id lists, the result is empty if there are none
+   */
+  static ids_type intersect(
+    std::initializer_list<std::reference_wrapper<const ids_type>> lists);
+
+private:
+  // MSVC emits C4251 since STL types are not exported. not our problem however
+PDCPL_MSVC_WARNING_DISABLE(4251)
+  std::unique_ptr<cdcl_dcln_index_impl> impl_;
+PDCPL_MSVC_WARNING_ENABLE()
+};
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_CDCL_DCLN_INDEX_HH_
@@ -19,6 +19,7 @@
 #include <variant>
 #include <vector>
 
+#include "pdcpl/cdcl_memory.hh"
 #include "pdcpl/cdcl_type_spec.hh"
 #include "pdcpl/dllexport.h"
 #include "pdcpl/warnings.h"
@@ -193,10 +194,14 @@ inline auto& operator<<(std::ostream& out, const cdcl_array_spec& spec)
  * corresponding to an implied additional pointer in the specifier.
  */
 class cdcl_ptrs_spec {
+private:
+  // parsed nodes are allocated from the parser's arena
+  using storage_type = std::vector<cdcl_qual, cdcl_allocator<cdcl_qual>>;
+
 public:
   using container_type = std::vector<cdcl_qual>;
-  using iterator = container_type::iterator;
-  using const_iterator = container_type::const_iterator;
+  using iterator = storage_type::iterator;
+  using const_iterator = storage_type::const_iterator;
 
   /**
    * Default ctor.
@@ -221,21 +226,16 @@ public:
    *
    * @param specs Pointer cv-qualifiers
    */
-  cdcl_ptrs_spec(const container_type& specs) : specs_{specs} {}
+  cdcl_ptrs_spec(const container_type& specs)
+    : specs_(specs.begin(), specs.end())
+  {}
 
   /**
-   * Ctor.
-   *
-   * Constructs by move from a vector of cv-qualifiers.
+   * Return a copy of the vector of pointer cv-qualifiers.
    *
-   * @param specs Pointer cv-qualifiers
+   * Use `begin()` and `end()` to iterate without copying.
    */
-  cdcl_ptrs_spec(container_type&& specs) : specs_{std::move(specs)} {}
-
-  /**
-   * Return const reference to vector of pointer cv-qualifiers.
-   */
-  const auto& specs() const noexcept { return specs_; }
+  container_type specs() const { return {specs_.begin(), specs_.end()}; }
 
   /**
    * Return iterator to the beginning of the vector.
@@ -257,6 +257,16 @@ public:
    */
   auto end() const noexcept { return specs_.end(); }
 
+  /**
+   * Return const reverse iterator to the last pointer cv-qualifier.
+   */
+  auto rbegin() const noexcept { return specs_.rbegin(); }
+
+  /**
+   * Return const reverse iterator to before the first pointer cv-qualifier.
+   */
+  auto rend() const noexcept { return specs_.rend(); }
+
   /**
    * Append a pointer's cv-qualifier to the vector.
    *
@@ -275,7 +285,7 @@ public:
   auto size() const noexcept { return specs_.size(); }
 
 private:
-  container_type specs_;
+  storage_type specs_;
 };
 
 // forward declaration for cdcl_dclr, the C declaration declarator, as it is
@@ -362,6 +372,7 @@ public:
 private:
   PDCPL_MSVC_WARNING_DISABLE(4251)
   cdcl_qtype_spec spec_;
+  // never allocated from the parser's arena, as the pointer can be shared
   std::shared_ptr<cdcl_dclr> dclr_;
   PDCPL_MSVC_WARNING_ENABLE()
 };
@@ -384,6 +395,12 @@ inline auto& operator<<(std::ostream& out, const cdcl_param_spec& spec)
  * if the function being described is a variadic function.
  */
 class cdcl_params_spec {
+private:
+  // parsed nodes are allocated from the parser's arena
+  using storage_type = std::vector<
+    cdcl_param_spec, cdcl_allocator<cdcl_param_spec>
+  >;
+
 public:
   /**
    * Default ctor.
@@ -415,7 +432,7 @@ public:
    */
   cdcl_params_spec(
     const std::vector<cdcl_param_spec>& specs, bool variadic = false)
-    : specs_{specs}, variadic_{variadic}
+    : specs_(specs.begin(), specs.end()), variadic_{variadic}
   {}
 
   /**
@@ -428,13 +445,22 @@ public:
    */
   cdcl_params_spec(
     std::vector<cdcl_param_spec>&& specs, bool variadic = false)
-    : specs_{std::move(specs)}, variadic_{variadic}
+    : specs_(
+        std::make_move_iterator(specs.begin()),
+        std::make_move_iterator(specs.end())
+      ),
+      variadic_{variadic}
   {}
 
   /**
-   * Return const reference to the vector of function parameter specifiers.
+   * Return a copy of the vector of function parameter specifiers.
+   *
+   * Use `begin()` and `end()` to iterate without copying.
    */
-  const auto& specs() const noexcept { return specs_; }
+  std::vector<cdcl_param_spec> specs() const
+  {
+    return {specs_.begin(), specs_.end()};
+  }
 
   /**
    * Return `true` if function is variadic, `false` otherwise.
@@ -499,8 +525,8 @@ public:
   auto size() const noexcept { return specs_.size(); }
 
 private:
-  std::vector<cdcl_param_spec> specs_;
-  bool variadic_;
+  storage_type specs_;
+  bool variadic_{};
 };
 
 /**
@@ -596,10 +622,16 @@ public:
  * direct-declarator structures specified in the C grammar.
  */
 class cdcl_dclr {
+private:
+  // parsed nodes are allocated from the parser's arena
+  using storage_type = std::vector<
+    cdcl_dclr_spec, cdcl_allocator<cdcl_dclr_spec>
+  >;
+
 public:
   using container_type = std::vector<cdcl_dclr_spec>;
-  using iterator = container_type::iterator;
-  using const_iterator = container_type::const_iterator;
+  using iterator = storage_type::iterator;
+  using const_iterator = storage_type::const_iterator;
 
   /**
    * Default ctor.
@@ -616,6 +648,13 @@ public:
    */
   cdcl_dclr(const std::string& iden) : iden_{iden}, specs_{} {}
 
+  /**
+   * Ctor.
+   *
+   * @param iden Declarator identifier, can be empty for abstract declarators
+   */
+  cdcl_dclr(std::string&& iden) : iden_{std::move(iden)}, specs_{} {}
+
   /**
    * Return const reference to the identifier.
    *
@@ -624,9 +663,11 @@ public:
   const auto& iden() const noexcept { return iden_; }
 
   /**
-   * Return const reference to the vector of declarator specifiers.
+   * Return a copy of the vector of declarator specifiers.
+   *
+   * Use `begin()` and `end()` to iterate without copying.
    */
-  const auto& specs() const noexcept { return specs_; }
+  container_type specs() const { return {specs_.begin(), specs_.end()}; }
 
   /**
    * Return iterator to the beginning of the declarator specifier vector.
@@ -648,6 +689,16 @@ public:
    */
   auto end() const noexcept { return specs_.end(); }
 
+  /**
+   * Return const reverse iterator to the last declarator specifier.
+   */
+  auto rbegin() const noexcept { return specs_.rbegin(); }
+
+  /**
+   * Return const reverse iterator to before the first declarator specifier.
+   */
+  auto rend() const noexcept { return specs_.rend(); }
+
   /**
    * Return const reference to the `i`th declarator specifier.
    */
@@ -724,7 +775,7 @@ public:
 
 private:
   std::string iden_;
-  container_type specs_;
+  storage_type specs_;
 };
 
 /**
@@ -784,10 +835,16 @@ inline auto& operator<<(std::ostream& out, const cdcl_init_dclr& init_dclr)
  * Thin wrapper around a `cdcl_init_dclr` vector.
  */
 class cdcl_init_dclrs {
+private:
+  // parsed nodes are allocated from the parser's arena
+  using storage_type = std::vector<
+    cdcl_init_dclr, cdcl_allocator<cdcl_init_dclr>
+  >;
+
 public:
   using container_type = std::vector<cdcl_init_dclr>;
-  using iterator = container_type::iterator;
-  using const_iterator = container_type::const_iterator;
+  using iterator = storage_type::iterator;
+  using const_iterator = storage_type::const_iterator;
 
   /**
    * Default ctor.
@@ -814,7 +871,9 @@ public:
    *
    * @param init_dclrs Init declarators
    */
-  cdcl_init_dclrs(const container_type& init_dclrs) : init_dclrs_{init_dclrs} {}
+  cdcl_init_dclrs(const container_type& init_dclrs)
+    : init_dclrs_(init_dclrs.begin(), init_dclrs.end())
+  {}
 
   /**
    * Ctor.
@@ -824,13 +883,21 @@ public:
    * @param init_dclrs Init declarators
    */
   cdcl_init_dclrs(container_type&& init_dclrs)
-    : init_dclrs_{std::move(init_dclrs)}
+    : init_dclrs_(
+        std::make_move_iterator(init_dclrs.begin()),
+        std::make_move_iterator(init_dclrs.end())
+      )
   {}
 
   /**
-   * Return const reference to the vector of init declarators.
+   * Return a copy of the vector of init declarators.
+   *
+   * Use `begin()` and `end()` to iterate without copying.
    */
-  const auto& init_dclrs() const noexcept { return init_dclrs_; }
+  container_type init_dclrs() const
+  {
+    return {init_dclrs_.begin(), init_dclrs_.end()};
+  }
 
   /**
    * Return iterator to the beginning of the init declarators vector.
@@ -886,7 +953,7 @@ public:
   auto size() const noexcept { return init_dclrs_.size(); }
 
 private:
-  container_type init_dclrs_;
+  storage_type init_dclrs_;
 };
 
 /**
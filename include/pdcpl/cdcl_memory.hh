@@ -0,0 +1,177 @@
+/**
+ * @file cdcl_memory.hh
+ * @author Derek Huang
+ * @brief C++ header for C declaration node memory allocation
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_CDCL_MEMORY_HH_
+#define PDCPL_CDCL_MEMORY_HH_
+
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+#include "pdcpl/dllexport.h"
+
+namespace pdcpl {
+
+/**
+ * Return the calling thread's memory resource for C declaration nodes.
+ *
+ * This is the resource last set with `cdcl_memory_resource(resource)` on the
+ * calling thread, or `std::pmr::get_default_resource()` if none is set.
+ */
+PDCPL_BCDP_PUBLIC
+std::pmr::memory_resource* cdcl_memory_resource() noexcept;
+
+/**
+ * Set the calling thread's memory resource for C declaration nodes.
+ *
+ * @param resource Memory resource, `nullptr` to use the default resource
+ * @returns Previously set resource, `nullptr` if none was set
+ */
+PDCPL_BCDP_PUBLIC
+std::pmr::memory_resource* cdcl_memory_resource(
+  std::pmr::memory_resource* resource) noexcept;
+
+/**
+ * Scope guard that sets the calling thread's C declaration memory resource.
+ *
+ * The previously set resource is restored on destruction.
+ */
+class cdcl_memory_scope {
+public:
+  /**
+   * Ctor.
+   *
+   * @param resource Memory resource, `nullptr` to use the default resource
+   */
+  explicit cdcl_memory_scope(std::pmr::memory_resource* resource) noexcept
+    : prev_{cdcl_memory_resource(resource)}
+  {}
+
+  cdcl_memory_scope(const cdcl_memory_scope&) = delete;
+  cdcl_memory_scope& operator=(const cdcl_memory_scope&) = delete;
+
+  /**
+   * Dtor.
+   */
+  ~cdcl_memory_scope() { cdcl_memory_resource(prev_); }
+
+private:
+  std::pmr::memory_resource* prev_;
+};
+
+/**
+ * Allocator for C declaration nodes.
+ *
+ * Like `std::pmr::polymorphic_allocator`, this allocates from a memory
+ * resource, but by default uses the calling thread's `cdcl_memory_resource()`
+ * so that nodes built during a parse come from the parser's arena. Unlike
+ * `std::pmr::polymorphic_allocator`, the allocator propagates on move
+ * assignment and swap, so moving nodes never copies, and copies are made
+ * using the calling thread's resource at the time of copying.
+ *
+ * @tparam T Allocated type
+ */
+template <typename T>
+class cdcl_allocator {
+public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  /**
+   * Default ctor.
+   *
+   * Uses the calling thread's current C declaration memory resource.
+   */
+  cdcl_allocator() noexcept : resource_{cdcl_memory_resource()} {}
+
+  /**
+   * Ctor.
+   *
+   * @param resource Memory resource to allocate from
+   */
+  cdcl_allocator(std::pmr::memory_resource* resource) noexcept
+    : resource_{resource}
+  {}
+
+  /**
+   * Converting ctor.
+   *
+   * @param other Allocator for another type
+   */
+  template <typename U>
+  cdcl_allocator(const cdcl_allocator<U>& other) noexcept
+    : resource_{other.resource()}
+  {}
+
+  /**
+   * Return the memory resource allocated from.
+   */
+  auto resource() const noexcept { return resource_; }
+
+  /**
+   * Allocate uninitialized storage for `n` objects.
+   *
+   * @param n Number of objects
+   */
+  T* allocate(std::size_t n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length{};
+    return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /**
+   * Deallocate storage for `n` objects.
+   *
+   * @param p Storage returned from `allocate(n)`
+   * @param n Number of objects
+   */
+  void deallocate(T* p, std::size_t n) noexcept
+  {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  /**
+   * Return the allocator used by containers being copied.
+   *
+   * Copies use the calling thread's resource so they do not share arenas.
+   */
+  cdcl_allocator select_on_container_copy_construction() const noexcept
+  {
+    return {};
+  }
+
+private:
+  std::pmr::memory_resource* resource_;
+};
+
+/**
+ * Return `true` if two allocators allocate from equal memory resources.
+ */
+template <typename T, typename U>
+inline bool operator==(
+  const cdcl_allocator<T>& a, const cdcl_allocator<U>& b) noexcept
+{
+  return a.resource() == b.resource() || a.resource()->is_equal(*b.resource());
+}
+
+/**
+ * Return `true` if two allocators allocate from different memory resources.
+ */
+template <typename T, typename U>
+inline bool operator!=(
+  const cdcl_allocator<T>& a, const cdcl_allocator<U>& b) noexcept
+{
+  return !(a == b);
+}
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_CDCL_MEMORY_HH_
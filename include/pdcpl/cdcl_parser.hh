@@ -10,11 +10,15 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "pdcpl/cdcl_dcln_spec.hh"
+#include "pdcpl/cdcl_type_table.hh"
 #include "pdcpl/dllexport.h"
 #include "pdcpl/warnings.h"
 
@@ -23,6 +27,17 @@ namespace pdcpl {
 // forward declaration for the implementation class
 class cdcl_parser_impl;
 
+/**
+ * Position of a parsed declaration in its input.
+ *
+ * @param line Line number, starting from 1
+ * @param column Column number, starting from 1
+ */
+struct cdcl_position {
+  unsigned int line;
+  unsigned int column;
+};
+
 /**
  * Parse driver class for parsing C declarations.
  *
@@ -32,6 +47,9 @@ class cdcl_parser_impl;
 class PDCPL_BCDP_PUBLIC cdcl_parser {
 public:
   using results_type = std::vector<cdcl_dcln>;
+  using sink_type = std::function<
+    void(const cdcl_dcln& dcln, const cdcl_position& position)
+  >;
 
   /**
    * Ctor.
@@ -79,6 +97,60 @@ public:
     bool trace_lexer,
     bool trace_parser);
 
+  /**
+   * Parse input from a string.
+   *
+   * Named differently from `parse()` since string literals are convertible to
+   * both `std::filesystem::path` and `std::string_view`.
+   *
+   * @param input Input text
+   * @param enable_trace `true` to enable lexer and parser tracing
+   * @returns `true` on success, `false` on failure
+   */
+  bool parse_string(std::string_view input, bool enable_trace = false)
+  {
+    return parse_string(input, enable_trace, enable_trace);
+  }
+
+  /**
+   * Parse input from a string.
+   *
+   * @param input Input text
+   * @param trace_lexer `true` to enable lexer tracing
+   * @param trace_parser `true` to enable parser tracing
+   * @returns `true` on success, `false` on failure
+   */
+  bool parse_string(std::string_view input, bool trace_lexer, bool trace_parser)
+  {
+    return parse_buffer(input.data(), input.size(), trace_lexer, trace_parser);
+  }
+
+  /**
+   * Parse input from a memory buffer.
+   *
+   * @param data Input buffer, can be `nullptr` if `size` is zero
+   * @param size Number of bytes in the input buffer
+   * @param enable_trace `true` to enable lexer and parser tracing
+   * @returns `true` on success, `false` on failure
+   */
+  bool parse_buffer(
+    const void* data, std::size_t size, bool enable_trace = false)
+  {
+    return parse_buffer(data, size, enable_trace, enable_trace);
+  }
+
+  /**
+   * Parse input from a memory buffer.
+   *
+   * @param data Input buffer, can be `nullptr` if `size` is zero
+   * @param size Number of bytes in the input buffer
+   * @param trace_lexer `true` to enable lexer tracing
+   * @param trace_parser `true` to enable parser tracing
+   * @returns `true` on success, `false` on failure
+   */
+  bool parse_buffer(
+    const void* data, std::size_t size, bool trace_lexer, bool trace_parser);
+
   /**
    * Parse input from `stdin`.
    *
@@ -119,6 +191,23 @@ public:
     return parse(input_file, trace_lexer, trace_parser);
   }
 
+  /**
+   * Stream declarations to a sink instead of accumulating results.
+   *
+   * While a sink is set, each declaration is passed to it with its position
+   * as soon as it is parsed, in source order, and is not added to `results()`,
+   * so memory use does not grow with the input. To detect redeclarations,
+   * only a 64-bit hash of each identifier is kept, so for n identifiers there
+   * is roughly an n^2 / 2^65 chance of a spurious redeclaration error.
+   *
+   * The identifier hashes are kept across parses until the sink is reset. An
+   * exception thrown by the sink stops parsing and propagates to the caller.
+   *
+   * @param sink Sink to stream declarations to, empty to accumulate results
+   * @param check_redeclared `true` to report redeclared identifiers as errors
+   */
+  void set_sink(sink_type sink, bool check_redeclared = true);
+
   /**
    * Return last error encountered during parsing.
    */
@@ -141,7 +230,7 @@ public:
    *
    * @param iden Identifier to find matching C declaration for
    */
-  bool results_contain(const std::string& iden) const;
+  bool results_contain(std::string_view iden) const;
 
   /**
    * Look up a declaration object with the given identifier.
@@ -151,7 +240,7 @@ public:
    *
    * @param iden Identifier to find matching C declaration for
    */
-  const cdcl_dcln& result(const std::string& iden) const;
+  const cdcl_dcln& result(std::string_view iden) const;
 
   /**
    * Look up a declaration object via its position in the results vector.
@@ -162,6 +251,34 @@ public:
    */
   const cdcl_dcln& result(std::size_t idx) const;
 
+  /**
+   * Return the position of a declaration via its position in `results()`.
+   *
+   * Declarations sharing a declaration specifier share a position.
+   * An exception will be thrown if `idx` is out of bounds.
+   *
+   * @param idx Index of a C declaration object in `results()`
+   */
+  const cdcl_position& result_position(std::size_t idx) const;
+
+  /**
+   * Return the canonical types of the declarations in `results()`.
+   *
+   * Declarations have the same type if and only if their type ids are equal.
+   * The types are interned on first use, so this is not `noexcept` and is not
+   * safe to call concurrently with other calls to it or `result_type()`.
+   */
+  const cdcl_type_table& types() const;
+
+  /**
+   * Return the type id of a declaration via its position in `results()`.
+   *
+   * An exception will be thrown if `idx` is out of bounds.
+   *
+   * @param idx Index of a C declaration object in `results()`
+   */
+  cdcl_type_id result_type(std::size_t idx) const;
+
 private:
   // MSVC emits C4251 since STL types are not exported. not our problem however
 PDCPL_MSVC_WARNING_DISABLE(4251)
@@ -0,0 +1,231 @@
+/**
+ * @file cdcl_type_table.hh
+ * @author Derek Huang
+ * @brief C++ header for canonical C declaration types
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_CDCL_TYPE_TABLE_HH_
+#define PDCPL_CDCL_TYPE_TABLE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pdcpl/cdcl_dcln_spec.hh"
+#include "pdcpl/cdcl_type_spec.hh"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/warnings.h"
+
+namespace pdcpl {
+
+/**
+ * Identifier of a canonical type in a `cdcl_type_table`.
+ */
+using cdcl_type_id = std::uint32_t;
+
+/**
+ * Enum indicating the kind of a canonical type node.
+ */
+enum class cdcl_type_kind {
+  base,     // qualified type specifier, e.g. const char
+  pointer,  // [qualified] pointer to the target type
+  array,    // array of the target type
+  function  // function taking the parameter types returning the target type
+};
+
+/**
+ * Canonical C type node.
+ *
+ * Each node is either a qualified type specifier or is derived from the node
+ * of its target type, so the type of a declaration is a chain of nodes ending
+ * in a base node. Parameter names are not part of a function type.
+ */
+class cdcl_type_node {
+public:
+  /**
+   * Ctor.
+   *
+   * @param kind Node kind
+   * @param qual Qualifier of a base or pointer node
+   * @param spec Type specifier of a base node
+   * @param size Size of an array node, zero if unspecified
+   * @param variadic `true` if a function node accepts varargs
+   * @param target Target type of a derived node, unused for base nodes
+   * @param params Parameter types of a function node
+   */
+  cdcl_type_node(
+    cdcl_type_kind kind,
+    cdcl_qual qual,
+    cdcl_type_spec spec,
+    std::size_t size,
+    bool variadic,
+    cdcl_type_id target,
+    std::vector<cdcl_type_id> params)
+    : kind_{kind},
+      qual_{qual},
+      spec_{std::move(spec)},
+      size_{size},
+      variadic_{variadic},
+      target_{target},
+      params_{std::move(params)}
+  {}
+
+  /**
+   * Return the node kind.
+   */
+  auto kind() const noexcept { return kind_; }
+
+  /**
+   * Return the qualifier of a base or pointer node.
+   */
+  auto qual() const noexcept { return qual_; }
+
+  /**
+   * Return the type specifier of a base node.
+   */
+  const auto& spec() const noexcept { return spec_; }
+
+  /**
+   * Return the size of an array node, zero if unspecified.
+   */
+  auto size() const noexcept { return size_; }
+
+  /**
+   * Return `true` if a function node accepts varargs.
+   */
+  auto variadic() const noexcept { return variadic_; }
+
+  /**
+   * Return the target type of a pointer, array, or function node.
+   *
+   * For a function node this is the return type.
+   */
+  auto target() const noexcept { return target_; }
+
+  /**
+   * Return the parameter types of a function node.
+   */
+  const auto& params() const noexcept { return params_; }
+
+private:
+  cdcl_type_kind kind_;
+  cdcl_qual qual_;
+  cdcl_type_spec spec_;
+  std::size_t size_;
+  bool variadic_;
+  cdcl_type_id target_;
+  std::vector<cdcl_type_id> params_;
+};
+
+// forward declaration for the implementation class
+class cdcl_type_table_impl;
+
+/**
+ * Hash-consing table of canonical C types.
+ *
+ * Each distinct type is stored once as a `cdcl_type_node`, so two types are
+ * equal if and only if their ids are equal. Ids are assigned in order of
+ * first appearance and never change, and a node's target and parameter ids
+ * are always less than its own id.
+ *
+ * The table is not thread-safe, even for `description()`, which builds and
+ * caches descriptions on first use. Tables can be merged.
+ */
+class PDCPL_BCDP_PUBLIC cdcl_type_table {
+public:
+  /**
+   * Ctor.
+   */
+  cdcl_type_table();
+
+  /**
+   * Move ctor.
+   *
+   * The moved-from table can only be assigned to or destroyed.
+   */
+  cdcl_type_table(cdcl_type_table&& other) noexcept;
+
+  /**
+   * Move assignment operator.
+   *
+   * The tables are swapped so the moved-from table remains usable.
+   *
+   * @param other Table to move from
+   */
+  cdcl_type_table& operator=(cdcl_type_table&& other) noexcept;
+
+  /**
+   * Dtor.
+   */
+  ~cdcl_type_table();
+
+  /**
+   * Return the id of the type of a declaration.
+   *
+   * This is the qualified type specifier with the declarator chain applied,
+   * so storage and the declaration's identifier are not part of the type.
+   *
+   * @param dcln C declaration
+   */
+  cdcl_type_id intern(const cdcl_dcln& dcln);
+
+  /**
+   * Return the id of a qualified type with an optional declarator applied.
+   *
+   * @param spec Qualified type specifier
+   * @param dclr [Abstract] declarator, `nullptr` for none
+   */
+  cdcl_type_id intern(const cdcl_qtype_spec& spec, const cdcl_dclr* dclr);
+
+  /**
+   * Add the types of another table to this table.
+   *
+   * @param other Table to add types from
+   * @returns Ids in this table indexed by ids in `other`
+   */
+  std::vector<cdcl_type_id> merge(const cdcl_type_table& other);
+
+  /**
+   * Return the node of a type.
+   *
+   * An exception will be thrown if `id` is out of bounds.
+   *
+   * @param id Type id
+   */
+  const cdcl_type_node& node(cdcl_type_id id) const;
+
+  /**
+   * Return the description of a type.
+   *
+   * For example, "pointer to function (signed int) returning const char". The
+   * description is built on first use and cached until the table is cleared.
+   * An exception will be thrown if `id` is out of bounds.
+   *
+   * @param id Type id
+   */
+  const std::string& description(cdcl_type_id id) const;
+
+  /**
+   * Return the number of distinct types.
+   */
+  std::size_t size() const noexcept;
+
+  /**
+   * Remove all types from the table.
+   */
+  void clear() noexcept;
+
+private:
+  // MSVC emits C4251 since STL types are not exported. not our problem however
+PDCPL_MSVC_WARNING_DISABLE(4251)
+  std::unique_ptr<cdcl_type_table_impl> impl_;
+PDCPL_MSVC_WARNING_ENABLE()
+};
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_CDCL_TYPE_TABLE_HH_
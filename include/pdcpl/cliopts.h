@@ -10,6 +10,7 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -18,8 +19,13 @@
 
 #include "pdcpl/common.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/version.h"
 
+#ifdef PDCPL_HAS_PROGRAM_INPUTS
+#include "pdcpl/batch.h"
+#endif  // PDCPL_HAS_PROGRAM_INPUTS
+
 PDCPL_EXTERN_C_BEGIN
 
 // name for static global holding the program usage (before option description)
@@ -265,6 +271,156 @@ PDCPL_PROGRAM_OPTIONS_DEF {PDCPL_PROGRAM_OPTIONS_END};
 PDCPL_PROGRAM_EPILOG_DEF("")
 #endif  // PDCPL_NO_PROGRAM_EPILOG
 
+// define PDCPL_HAS_PROGRAM_INPUTS to accept input file paths and -j, --jobs
+#ifdef PDCPL_HAS_PROGRAM_INPUTS
+// name for static global pointing to the input paths, compacted in argv
+#define PDCPL_PROGRAM_INPUTS pdcpl_main_program_inputs
+// name for static global holding the number of input paths
+#define PDCPL_PROGRAM_N_INPUTS pdcpl_main_program_n_inputs
+// name for static global holding the number of jobs, 0 for hardware threads
+#define PDCPL_PROGRAM_JOBS pdcpl_main_program_jobs
+
+static char **PDCPL_PROGRAM_INPUTS = NULL;
+static size_t PDCPL_PROGRAM_N_INPUTS = 0;
+static unsigned int PDCPL_PROGRAM_JOBS = 1;
+
+/**
+ * Action to get the number of jobs to process input files with.
+ */
+static
+PDCPL_CLIOPT_ACTION(pdcpl_cliopt_jobs_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  errno = 0;
+  long n = strtol(argv[argi + 1], &end, 10);
+  if (errno || end == argv[argi + 1] || *end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (n < 0 || n > UINT_MAX)
+    return PDCPL_CLIOPT_ERROR_INVALID_VALUE;
+  PDCPL_PROGRAM_JOBS = (unsigned int) n;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+/**
+ * Built-in option for the number of jobs to process input files with.
+ */
+static pdcpl_clioption pdcpl_cliopt_jobs_option = {
+  "-j", "--jobs",
+  "Number of files to process in parallel, default 1. If 0, the number of "
+  "hardware threads is used",
+  1,
+  pdcpl_cliopt_jobs_action,
+  NULL
+};
+
+/**
+ * Return 1 if a command-line argument is an input path, 0 otherwise.
+ *
+ * Any argument not starting with a hyphen is an input path, as is `"-"`,
+ * which denotes `stdin`.
+ *
+ * @param arg Command-line argument
+ */
+PDCPL_INLINE int
+pdcpl_cliopt_is_input(const char *arg)
+{
+  return arg[0] != '-' || !strcmp(arg, "-");
+}
+
+// usage suffix after [OPTIONS...]
+#define PDCPL_PROGRAM_INPUTS_USAGE " [FILE...]"
+
+/**
+ * Print the help for the built-in options used with input files.
+ *
+ * Used in `PDCPL_PRINT_USAGE_INFO`, which returns on error.
+ */
+#define PDCPL_PRINT_INPUTS_USAGE_INFO() \
+  do { \
+    printf("Input options:\n"); \
+    if (pdcpl_cliopt_print_help(&pdcpl_cliopt_jobs_option)) \
+      return EXIT_FAILURE; \
+    putchar('\n'); \
+  } \
+  while (0)
+
+/**
+ * Point `PDCPL_PROGRAM_INPUTS` to where the input paths will be moved to.
+ */
+#define PDCPL_CLIOPT_INPUTS_BEGIN() \
+  do { \
+    PDCPL_PROGRAM_INPUTS = PDCPL_ARGV + 1; \
+    PDCPL_PROGRAM_N_INPUTS = 0; \
+  } \
+  while (0)
+
+/**
+ * Move an input path argument to the front of `argv` and skip to next arg.
+ *
+ * Used in the `PDCPL_PARSE_PROGRAM_OPTIONS` loop. Since inputs are moved to
+ * indices no greater than the current index, no unparsed args are clobbered.
+ *
+ * @param i Index of the current argument
+ */
+#define PDCPL_CLIOPT_HANDLE_INPUT(i) \
+  if (pdcpl_cliopt_is_input(PDCPL_ARGV[i])) { \
+    PDCPL_PROGRAM_INPUTS[PDCPL_PROGRAM_N_INPUTS++] = PDCPL_ARGV[i]; \
+    continue; \
+  }
+
+/**
+ * Match the current argument against the built-in input options.
+ *
+ * Used in the `PDCPL_PARSE_PROGRAM_OPTIONS` loop.
+ *
+ * @param i Index of the current argument
+ * @param opt `pdcpl_clioption *` set to the matching option if not yet set
+ */
+#define PDCPL_CLIOPT_MATCH_INPUTS_OPTION(i, opt) \
+  if ( \
+    !(opt) && ( \
+      !strcmp(PDCPL_ARGV[i], pdcpl_cliopt_jobs_option.name) || \
+      !strcmp(PDCPL_ARGV[i], pdcpl_cliopt_jobs_option.long_name) \
+    ) \
+  ) \
+    opt = &pdcpl_cliopt_jobs_option;
+
+/**
+ * Run a stream function over the program inputs in argument order.
+ *
+ * If there are no inputs, `stdin` is processed. Output is written to `stdout`
+ * using up to `PDCPL_PROGRAM_JOBS` threads and errors are reported to `stderr`
+ * prefixed with the program name. See `pdcpl_batch_run` for details.
+ *
+ * @param func `pdcpl_batch_func` to process each input with
+ * @param ctx User-defined context passed to `func`
+ * @returns 0 on success, negative errno value on error
+ */
+#define PDCPL_PROGRAM_RUN_INPUTS(func, ctx) \
+  pdcpl_batch_run( \
+    (PDCPL_PROGRAM_N_INPUTS) ? \
+      (const char *const *) PDCPL_PROGRAM_INPUTS : pdcpl_cliopt_stdin_inputs, \
+    (PDCPL_PROGRAM_N_INPUTS) ? PDCPL_PROGRAM_N_INPUTS : 1, \
+    PDCPL_PROGRAM_JOBS, \
+    func, \
+    ctx, \
+    stdout, \
+    PDCPL_PROGRAM_NAME \
+  )
+
+/**
+ * Input paths used by `PDCPL_PROGRAM_RUN_INPUTS` when there are no inputs.
+ */
+static const char *const pdcpl_cliopt_stdin_inputs[] = {"-"};
+#else
+#define PDCPL_PROGRAM_INPUTS_USAGE ""
+#define PDCPL_PRINT_INPUTS_USAGE_INFO()
+#define PDCPL_CLIOPT_INPUTS_BEGIN()
+#define PDCPL_CLIOPT_HANDLE_INPUT(i)
+#define PDCPL_CLIOPT_MATCH_INPUTS_OPTION(i, opt)
+#endif  // !PDCPL_HAS_PROGRAM_INPUTS
+
 /**
  * Return number of non-sentinel members in a `pdcpl_clioption` array.
  *
@@ -579,6 +735,62 @@ pdcpl_program_options_printf(const pdcpl_clioption *opts)
   return 0;
 }
 
+/**
+ * Statistics format selected with `--stats`, -1 if statistics are disabled.
+ */
+static int pdcpl_cliopt_stats_format = -1;
+
+/**
+ * Return the statistics format for an argument, -1 if not a `--stats` option.
+ *
+ * `--stats` selects `PDCPL_STATS_FORMAT_TEXT` while `--stats=json` selects
+ * `PDCPL_STATS_FORMAT_JSON`.
+ *
+ * @param arg Command-line argument
+ */
+PDCPL_INLINE int
+pdcpl_cliopt_stats_option(const char *arg)
+{
+  if (!strcmp(arg, "--stats"))
+    return PDCPL_STATS_FORMAT_TEXT;
+  if (!strcmp(arg, "--stats=json"))
+    return PDCPL_STATS_FORMAT_JSON;
+  return -1;
+}
+
+/**
+ * `atexit` handler that writes the program statistics to `stderr`.
+ */
+static void
+pdcpl_cliopt_stats_atexit(void)
+{
+  pdcpl_stats stats;
+  // stdout may be block buffered, so flush so stats are printed last
+  fflush(stdout);
+  if (!pdcpl_stats_get(&stats))
+    pdcpl_stats_fprintf(
+      stderr, &stats, (pdcpl_stats_format) pdcpl_cliopt_stats_format
+    );
+}
+
+/**
+ * Enable statistics reporting at exit if an argument is a `--stats` option.
+ *
+ * Only the first `--stats` option seen takes effect.
+ *
+ * @param arg Command-line argument
+ */
+static void
+pdcpl_cliopt_handle_stats(const char *arg)
+{
+  int format = pdcpl_cliopt_stats_option(arg);
+  if (format < 0 || pdcpl_cliopt_stats_format >= 0)
+    return;
+  pdcpl_cliopt_stats_format = format;
+  pdcpl_stats_start();
+  atexit(pdcpl_cliopt_stats_atexit);
+}
+
 /**
  * Print the program usage info.
  *
@@ -589,15 +801,22 @@ pdcpl_program_options_printf(const pdcpl_clioption *opts)
 #define PDCPL_PRINT_USAGE_INFO() \
   do { \
     PDCPL_SET_PROGRAM_NAME(); \
-    printf("Usage: %s [OPTIONS...]\n\n", PDCPL_PROGRAM_NAME); \
+    printf( \
+      "Usage: %s [OPTIONS...]%s\n\n", \
+      PDCPL_PROGRAM_NAME, \
+      PDCPL_PROGRAM_INPUTS_USAGE \
+    ); \
     if (strlen(PDCPL_PROGRAM_USAGE)) \
       printf("%s\n\n", PDCPL_PROGRAM_USAGE); \
     if (pdcpl_program_options_printf(PDCPL_PROGRAM_OPTIONS)) \
       return EXIT_FAILURE; \
+    PDCPL_PRINT_INPUTS_USAGE_INFO(); \
     printf( \
       "Info options:\n" \
       "  -h, --help                  Print this help output\n" \
       "  -V, --version               Print program version info\n" \
+      "  --stats[=json]              Print resource usage statistics to\n" \
+      "                              stderr at exit, as text or JSON\n" \
     ); \
     if (strlen(PDCPL_PROGRAM_EPILOG)) \
       printf("\n%s\n", PDCPL_PROGRAM_EPILOG); \
@@ -609,7 +828,8 @@ pdcpl_program_options_printf(const pdcpl_clioption *opts)
  *
  * If `-h`, `--help` is seen on the command line, the program usage is printed
  * before exit, while if `-V`, `--version` is seen on the command line, the
- * program version info is printed before exit.
+ * program version info is printed before exit. If `--stats` or `--stats=json`
+ * is seen, program statistics are written to `stderr` at exit.
  */
 #define PDCPL_HANDLE_INFO_OPTS() \
   do { \
@@ -625,6 +845,7 @@ pdcpl_program_options_printf(const pdcpl_clioption *opts)
         PDCPL_PRINT_VERSION_INFO(); \
         return EXIT_SUCCESS; \
       } \
+      pdcpl_cliopt_handle_stats(PDCPL_ARGV[i]); \
     } \
   } \
   while (0)
@@ -648,7 +869,11 @@ pdcpl_program_options_printf(const pdcpl_clioption *opts)
     pdcpl_clioption *prog_options; \
     pdcpl_clioption *cur_opt = NULL; \
     int opt_status; \
+    PDCPL_CLIOPT_INPUTS_BEGIN(); \
     for (int i = 1; i < PDCPL_ARGC; i++) { \
+      if (pdcpl_cliopt_stats_option(PDCPL_ARGV[i]) >= 0) \
+        continue; \
+      PDCPL_CLIOPT_HANDLE_INPUT(i) \
       prog_options = PDCPL_PROGRAM_OPTIONS; \
       while (prog_options->name) { \
         if ( \
@@ -663,6 +888,7 @@ pdcpl_program_options_printf(const pdcpl_clioption *opts)
         } \
         prog_options++; \
       } \
+      PDCPL_CLIOPT_MATCH_INPUTS_OPTION(i, cur_opt) \
       if (!cur_opt) { \
         PDCPL_PRINT_ERROR_EX("error: unknown option %s\n", PDCPL_ARGV[i]); \
         return EXIT_FAILURE; \
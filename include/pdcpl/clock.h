@@ -0,0 +1,54 @@
+/**
+ * @file clock.h
+ * @author Derek Huang
+ * @brief C/C++ header for a monotonic clock
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_CLOCK_H_
+#define PDCPL_CLOCK_H_
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#endif  // defined(_WIN32)
+
+#include <stdint.h>
+#include <time.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/features.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Return monotonic clock time in nanoseconds from an arbitrary starting point.
+ *
+ * If `CLOCK_MONOTONIC` is not available the time is from `timespec_get`, which
+ * is not guaranteed to be monotonic.
+ */
+PDCPL_INLINE uint64_t
+pdcpl_clock_ns(void)
+{
+#if defined(_WIN32)
+  LARGE_INTEGER count, freq;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+  // split into seconds and remainder so the product can't overflow
+  uint64_t ticks = (uint64_t) count.QuadPart;
+  uint64_t hz = (uint64_t) freq.QuadPart;
+  return (ticks / hz) * 1000000000u + (ticks % hz) * 1000000000u / hz;
+#else
+  struct timespec ts;
+#if defined(PDCPL_POSIX_1_B)
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  timespec_get(&ts, TIME_UTC);
+#endif  // !defined(PDCPL_POSIX_1_B)
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#endif  // !defined(_WIN32)
+}
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_CLOCK_H_
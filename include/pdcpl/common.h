@@ -25,6 +25,9 @@
 #define PDCPL_CONCAT_I(x, y) x ## y
 #define PDCPL_CONCAT(x, y) PDCPL_CONCAT_I(x, y)
 
+// number of elements in an array
+#define PDCPL_ARRAY_SIZE(a) (sizeof(a) / sizeof(*(a)))
+
 // allow C++-like use of inline in C code
 #ifdef __cplusplus
 #define PDCPL_INLINE inline
@@ -35,6 +38,15 @@
 // macro to indicate extern inline, i.e. never static inline
 #define PDCPL_EXTERN_INLINE inline
 
+// thread-local storage duration specifier
+#if defined(__cplusplus)
+#define PDCPL_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define PDCPL_THREAD_LOCAL __declspec(thread)
+#else
+#define PDCPL_THREAD_LOCAL _Thread_local
+#endif  // !defined(__cplusplus) && !defined(_MSC_VER)
+
 // macros for the C++ version numbers
 #define PDCPL_CPP_14 201402L
 #define PDCPL_CPP_17 201703L
@@ -23,11 +23,18 @@ PDCPL_EXTERN_C_BEGIN
 // this header in the translation unit that defines main().
 static const char *PDCPL_PROGRAM_NAME = "";
 
+// name of the function defined by the main() signature macros. the pdcpl
+// multi-call program links all the standalones together, so it compiles each
+// one with its own PDCPL_MAIN_NAME and dispatches to them from its own main()
+#ifndef PDCPL_MAIN_NAME
+#define PDCPL_MAIN_NAME main
+#endif  // PDCPL_MAIN_NAME
+
 // macros for common main() signatures
-#define PDCPL_MAIN int main()
+#define PDCPL_MAIN int PDCPL_MAIN_NAME()
 #define PDCPL_ARGC argc
 #define PDCPL_ARGV argv
-#define PDCPL_ARG_MAIN int main(int PDCPL_ARGC, char **PDCPL_ARGV)
+#define PDCPL_ARG_MAIN int PDCPL_MAIN_NAME(int PDCPL_ARGC, char **PDCPL_ARGV)
 
 // path separator macros
 #ifdef _WIN32
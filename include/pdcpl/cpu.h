@@ -0,0 +1,234 @@
+/**
+ * @file cpu.h
+ * @author Derek Huang
+ * @brief C header for runtime CPU feature detection and kernel dispatch
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_CPU_H_
+#define PDCPL_CPU_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pdcpl/atomic.h"
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+// x86 or x64 with a compiler that can emit code for instruction set extensions
+// not enabled at compile time, via target attributes or MSVC intrinsics
+#if defined(_M_X64) || defined(_M_IX86) || \
+  ((defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__))
+#define PDCPL_CPU_X86
+#endif  // !defined(_M_X64) && !defined(_M_IX86) && ...
+
+/**
+ * Mark a function as compiled for the given instruction set extensions.
+ *
+ * Functions with this attribute must only be called if `pdcpl_cpu_get_level`
+ * indicates the extensions are available, e.g. through `pdcpl_cpu_select`.
+ * MSVC does not need the attribute to use intrinsics.
+ *
+ * @param isa GCC target string, e.g. `"avx2,bmi2"`
+ */
+#if defined(__GNUC__)
+#define PDCPL_CPU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PDCPL_CPU_TARGET(isa)
+#endif  // !defined(__GNUC__)
+
+/**
+ * Name of the environment variable used to cap the CPU level, e.g. to test
+ * kernels for lower levels. Values are the names from `pdcpl_cpu_level_name`.
+ */
+#define PDCPL_CPU_LEVEL_ENV "PDCPL_CPU_LEVEL"
+
+/**
+ * CPU feature flags.
+ */
+typedef enum {
+  PDCPL_CPU_SSE2 = 1u << 0,
+  PDCPL_CPU_SSE4_2 = 1u << 1,
+  PDCPL_CPU_POPCNT = 1u << 2,
+  PDCPL_CPU_AVX = 1u << 3,
+  PDCPL_CPU_AVX2 = 1u << 4,
+  PDCPL_CPU_BMI2 = 1u << 5,
+  PDCPL_CPU_AVX512F = 1u << 6,
+  PDCPL_CPU_AVX512BW = 1u << 7,
+  PDCPL_CPU_NEON = 1u << 8
+} pdcpl_cpu_feature;
+
+/**
+ * CPU levels, each requiring all the features of the previous level.
+ *
+ * `PDCPL_CPU_LEVEL_SSE4_2` also requires POPCNT, `PDCPL_CPU_LEVEL_AVX2` also
+ * requires BMI2, and `PDCPL_CPU_LEVEL_AVX512` requires AVX-512 F and BW.
+ */
+typedef enum {
+  PDCPL_CPU_LEVEL_BASELINE,
+  PDCPL_CPU_LEVEL_SSE2,
+  PDCPL_CPU_LEVEL_SSE4_2,
+  PDCPL_CPU_LEVEL_AVX,
+  PDCPL_CPU_LEVEL_AVX2,
+  PDCPL_CPU_LEVEL_AVX512,
+  PDCPL_CPU_LEVEL_MAX
+} pdcpl_cpu_level;
+
+/**
+ * Generic function pointer type for dispatch tables.
+ *
+ * Kernels are cast to this type in the table and cast back when selected.
+ */
+typedef void (*pdcpl_cpu_func)(void);
+
+/**
+ * Dispatch table entry.
+ *
+ * @param level Minimum CPU level required by the function
+ * @param func Function, cast to `pdcpl_cpu_func`
+ */
+typedef struct {
+  pdcpl_cpu_level level;
+  pdcpl_cpu_func func;
+} pdcpl_cpu_impl;
+
+/**
+ * Define a dispatched kernel pointer resolved on first call.
+ *
+ * This defines `name_kernel`, a pointer initially to a resolver that selects
+ * the kernel from `impls` for `pdcpl_cpu_get_level()`, stores it in `name_kernel`,
+ * and calls it. Later calls through `PDCPL_CPU_KERNEL` call the selected kernel
+ * directly, so the only per-call cost is an indirect call. Kernels must return
+ * `void`. Converting between function and object pointers is supported by
+ * POSIX and Windows, which lets the pointer be loaded and stored atomically.
+ *
+ * @param func_type Kernel function pointer type
+ * @param name Name prefix for the definitions
+ * @param impls `pdcpl_cpu_impl` array of kernels
+ * @param params Parenthesized kernel parameter list
+ * @param args Parenthesized argument list forwarding `params`
+ */
+#define PDCPL_CPU_DISPATCH(func_type, name, impls, params, args) \
+  static void PDCPL_CONCAT(name, _resolve) params; \
+  static void *PDCPL_CONCAT(name, _kernel) = \
+    (void *) PDCPL_CONCAT(name, _resolve); \
+  static void PDCPL_CONCAT(name, _resolve) params \
+  { \
+    func_type kernel = (func_type) pdcpl_cpu_select( \
+      impls, PDCPL_ARRAY_SIZE(impls), pdcpl_cpu_get_level() \
+    ); \
+    pdcpl_atomic_store_ptr(&PDCPL_CONCAT(name, _kernel), (void *) kernel); \
+    kernel args; \
+  }
+
+/**
+ * Return the kernel pointer defined by `PDCPL_CPU_DISPATCH`.
+ *
+ * @param func_type Kernel function pointer type
+ * @param name Name prefix passed to `PDCPL_CPU_DISPATCH`
+ */
+#define PDCPL_CPU_KERNEL(func_type, name) \
+  ((func_type) pdcpl_atomic_load_ptr(&PDCPL_CONCAT(name, _kernel)))
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Detect the features of the CPU the program is running on.
+ *
+ * This queries the CPU on every call and ignores `PDCPL_CPU_LEVEL_ENV`.
+ *
+ * @returns Bitwise OR of `pdcpl_cpu_feature` flags that are usable
+ */
+PDCPL_PUBLIC unsigned int
+pdcpl_cpu_detect(void);
+
+/**
+ * Return the CPU features that kernels may use.
+ *
+ * On first call, the features are detected and, if `PDCPL_CPU_LEVEL_ENV` names
+ * a valid level, limited to the features required by that level. The result
+ * is cached so later calls are cheap.
+ *
+ * @returns Bitwise OR of `pdcpl_cpu_feature` flags
+ */
+PDCPL_PUBLIC unsigned int
+pdcpl_cpu_features(void);
+
+/**
+ * Return the highest CPU level that kernels may use.
+ *
+ * Computed from `pdcpl_cpu_features`.
+ */
+PDCPL_PUBLIC pdcpl_cpu_level
+pdcpl_cpu_get_level(void);
+
+/**
+ * Return the features required by a CPU level.
+ *
+ * @param level CPU level
+ * @returns Bitwise OR of `pdcpl_cpu_feature` flags, 0 for an invalid level
+ */
+PDCPL_PUBLIC unsigned int
+pdcpl_cpu_level_features(pdcpl_cpu_level level);
+
+/**
+ * Return the highest CPU level whose required features are all present.
+ *
+ * @param features Bitwise OR of `pdcpl_cpu_feature` flags
+ */
+PDCPL_PUBLIC pdcpl_cpu_level
+pdcpl_cpu_features_level(unsigned int features);
+
+/**
+ * Return the name of a CPU level.
+ *
+ * @param level CPU level
+ * @returns Name, e.g. `"avx2"`, `NULL` for an invalid level
+ */
+PDCPL_PUBLIC const char *
+pdcpl_cpu_level_name(pdcpl_cpu_level level);
+
+/**
+ * Parse a CPU level name, ignoring case.
+ *
+ * @param name Level name, e.g. `"avx2"`
+ * @param level Address of `pdcpl_cpu_level` to write to
+ * @returns 0 on success, -EINVAL if `name` or `level` is `NULL` or if `name`
+ *  is not a valid level name
+ */
+PDCPL_PUBLIC int
+pdcpl_cpu_level_parse(
+  PDCPL_SA(In) const char *name, PDCPL_SA(Out) pdcpl_cpu_level *level);
+
+/**
+ * Select the first function in a dispatch table usable at a CPU level.
+ *
+ * Entries should be ordered from highest to lowest level and the last entry
+ * should be `PDCPL_CPU_LEVEL_BASELINE` so that a function is always found.
+ *
+ * @param impls Dispatch table
+ * @param n_impls Number of dispatch table entries
+ * @param level CPU level, usually `pdcpl_cpu_get_level()`
+ * @returns Selected function, `NULL` if no entry is usable
+ */
+PDCPL_PUBLIC pdcpl_cpu_func
+pdcpl_cpu_select(
+  PDCPL_SA(In) const pdcpl_cpu_impl *impls,
+  size_t n_impls,
+  pdcpl_cpu_level level);
+
+/**
+ * Check if a CPU feature may be used by kernels.
+ *
+ * @param feature CPU feature
+ */
+PDCPL_INLINE bool
+pdcpl_cpu_has(pdcpl_cpu_feature feature)
+{
+  return (pdcpl_cpu_features() & (unsigned int) feature) != 0;
+}
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_CPU_H_
@@ -0,0 +1,161 @@
+/**
+ * @file dsv.h
+ * @author Derek Huang
+ * @brief C header for a delimiter-separated values reader
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_DSV_H_
+#define PDCPL_DSV_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/memory.h"
+#include "pdcpl/sa.h"
+#include "pdcpl/variant.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Options for parsing delimiter-separated values, e.g. TSV or CSV.
+ *
+ * @param delim Field delimiter, e.g. `'\t'` or `','`
+ * @param quote Quote character, e.g. `'"'`, or `'\0'` to disable quoting. A
+ *  field starting with the quote character extends to the matching closing
+ *  quote and may contain delimiters and newlines. Doubled quote characters
+ *  inside a quoted field represent a single quote character.
+ * @param header `true` to treat the first record as column names
+ * @param types Per-source-column `pdcpl_variant` type flags, where zero means
+ *  the type is inferred. Can be `NULL` to infer all column types.
+ * @param n_types Number of elements in `types`
+ * @param columns Indices of source columns to read, in output order. Can be
+ *  `NULL` to read all columns, in which case the number of columns is the
+ *  number of fields in the first record.
+ * @param n_columns Number of elements in `columns`
+ */
+typedef struct {
+  char delim;
+  char quote;
+  bool header;
+  const unsigned int *types;
+  size_t n_types;
+  const size_t *columns;
+  size_t n_columns;
+} pdcpl_dsv_options;
+
+/**
+ * Return default options for the given delimiter.
+ *
+ * Quoting uses `'"'`, there is no header, and all columns are read with their
+ * types inferred.
+ *
+ * @param delim Field delimiter
+ */
+PDCPL_INLINE pdcpl_dsv_options
+pdcpl_dsv_options_default(char delim)
+{
+  pdcpl_dsv_options opts;
+  opts.delim = delim;
+  opts.quote = '"';
+  opts.header = false;
+  opts.types = NULL;
+  opts.n_types = 0;
+  opts.columns = NULL;
+  opts.n_columns = 0;
+  return opts;
+}
+
+/**
+ * Column of parsed values.
+ *
+ * @param index Source column index
+ * @param type `pdcpl_variant` type flag of all values in the column
+ * @param name Column name from the header, `NULL` if there is no header
+ * @param values Buffer holding `pdcpl_variant` values, one per row
+ */
+typedef struct {
+  size_t index;
+  unsigned int type;
+  const char *name;
+  pdcpl_buffer values;
+} pdcpl_dsv_column;
+
+/**
+ * Table of parsed columns.
+ *
+ * @param columns Columns, in output order
+ * @param n_columns Number of columns
+ * @param n_rows Number of rows, i.e. values in each column
+ * @param error_record On a parse error, the zero-based index of the record,
+ *  including any header, where the error occurred
+ */
+typedef struct {
+  pdcpl_dsv_column *columns;
+  size_t n_columns;
+  size_t n_rows;
+  size_t error_record;
+} pdcpl_dsv_table;
+
+/**
+ * Return pointer to the values of a column.
+ *
+ * @param col Column
+ */
+PDCPL_INLINE pdcpl_variant *
+pdcpl_dsv_column_values(PDCPL_SA(In) const pdcpl_dsv_column *col)
+{
+  return (pdcpl_variant *) col->values.data;
+}
+
+/**
+ * Parse a buffer of delimiter-separated records into typed columns.
+ *
+ * Records are separated by `'\n'` and a trailing `'\r'` is stripped from the
+ * last field of each record. Empty lines are skipped.
+ *
+ * Fields are parsed in place. Only fields of selected columns are converted,
+ * with integers parsed directly, `double` values parsed with
+ * `pdcpl_strtod_fast`, and `float` values parsed with `strtof`.
+ * String fields, including column names, are null-terminated in place and
+ * stored as `pdcpl_variant_init_string_ref` slices of `buf`, so `buf` is
+ * modified and must outlive the table. `buf` must be writable for `size + 1`
+ * bytes so the last field can always be terminated.
+ *
+ * Supported column types are `pdcpl_variant_char`, `pdcpl_variant_int`,
+ * `pdcpl_variant_uint`, `pdcpl_variant_size`, `pdcpl_variant_double`,
+ * `pdcpl_variant_float`, and `pdcpl_variant_string`. Types not given in the
+ * options are inferred from the first data record as `int`, `double`, or
+ * string, in that order of preference.
+ *
+ * @param buf Buffer of records, writable for `size + 1` bytes
+ * @param size Number of bytes of records in `buf`
+ * @param opts Parsing options
+ * @param table Table to write parsed columns to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`, if an
+ *  option is invalid, if a record is missing a selected column, or if a field
+ *  cannot be converted to its column type, -ERANGE if a numeric field is out
+ *  of range, -ENOMEM if memory allocation fails. On error, `table` holds no
+ *  memory and `table->error_record` is set if the error is in a record.
+ */
+PDCPL_PUBLIC int
+pdcpl_dsv_parse(
+  PDCPL_SA(In_Out) char *buf,
+  size_t size,
+  PDCPL_SA(In) const pdcpl_dsv_options *opts,
+  PDCPL_SA(Out) pdcpl_dsv_table *table);
+
+/**
+ * Free the memory held by a table.
+ *
+ * @param table Table to free
+ * @returns 0 on success, -EINVAL if `table` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_dsv_table_free(PDCPL_SA(In_Out) pdcpl_dsv_table *table);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_DSV_H_
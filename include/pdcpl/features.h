@@ -82,4 +82,17 @@
 #endif  // __STDC_VERSION__ < 201710L
 #endif  // __STDC_VERSION__
 
+// test for x86 SIMD instruction set extensions enabled at compile time. SSE2
+// is part of the x86-64 baseline, but AVX, AVX2 need e.g. -mavx, /arch:AVX
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PDCPL_HAS_SSE2
+#endif  // !defined(__SSE2__) && !defined(_M_X64) && ...
+#ifdef __AVX__
+#define PDCPL_HAS_AVX
+#endif  // __AVX__
+#ifdef __AVX2__
+#define PDCPL_HAS_AVX2
+#endif  // __AVX2__
+
 #endif  // PDCPL_FEATURES_H_
@@ -15,11 +15,13 @@
 #include <Windows.h>
 #endif  // _WIN32
 
+#include <stddef.h>
 #include <stdio.h>
 
 #include "pdcpl/common.h"
 #include "pdcpl/dllexport.h"
 #include "pdcpl/features.h"
+#include "pdcpl/sa.h"
 
 PDCPL_EXTERN_C_BEGIN
 
@@ -106,6 +108,55 @@ PDCPL_PUBLIC FILE *
 pdcpl_win_tempfile(HRESULT *win_err);
 #endif  // _WIN32
 
+/**
+ * Read-only view of a file's contents followed by zero padding bytes.
+ *
+ * The contents are writable but writes are private to the process, i.e. they
+ * are never carried through to the file, so buffers can be scanned in place by
+ * code that writes into its input, e.g. Flex scanners.
+ *
+ * @param data File contents, followed by the requested number of zero bytes
+ * @param size Size of the file contents in bytes, excluding the padding
+ * @param map_size Size of the memory mapping, 0 if `data` is on the heap
+ */
+typedef struct {
+  char *data;
+  size_t size;
+  size_t map_size;
+} pdcpl_file_map;
+
+/**
+ * Map a file's contents into memory with trailing zero padding.
+ *
+ * On POSIX systems that support anonymous mappings, the file is mapped
+ * copy-on-write directly after reserving room for the padding, so no bytes
+ * are copied. Otherwise, the contents are read into a heap buffer. Empty files
+ * are always given a heap buffer holding just the padding.
+ *
+ * @note If the file is truncated by another process while it is mapped,
+ *  accessing the truncated part of the mapping raises `SIGBUS`.
+ *
+ * @param map Address of the file map to initialize
+ * @param path File path
+ * @param padding Number of zero bytes to follow the file contents
+ * @returns 0 on success, -EINVAL if `map` or `path` is `NULL`, -ENOMEM if
+ *  the file is too large or on allocation failure, -errno on I/O error
+ */
+PDCPL_PUBLIC int
+pdcpl_file_map_open(
+  PDCPL_SA(Out) pdcpl_file_map *map,
+  PDCPL_SA(In) const char *path,
+  size_t padding);
+
+/**
+ * Unmap or free a file's contents mapped by `pdcpl_file_map_open`.
+ *
+ * @param map File map to close, which is reset to all zeros on success
+ * @returns 0 on success, -EINVAL if `map` is `NULL`, -errno on unmap error
+ */
+PDCPL_PUBLIC int
+pdcpl_file_map_close(PDCPL_SA(In) pdcpl_file_map *map);
+
 PDCPL_EXTERN_C_END
 
 // don't pollute translation units
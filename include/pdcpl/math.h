@@ -11,8 +11,11 @@
 #include <float.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
 #include "pdcpl/features.h"
 
 PDCPL_EXTERN_C_BEGIN
@@ -122,6 +125,81 @@ pdcpl_float_eq(float a, float b)
   return pdcpl_float_near(a, b, FLT_EPSILON);
 }
 
+/**
+ * Return the number of 64-bit mask words needed for `n` comparison results.
+ *
+ * @param n Number of comparison results
+ */
+PDCPL_INLINE size_t
+pdcpl_mask_words(size_t n)
+{
+  return (n + 63) / 64;
+}
+
+/**
+ * Check element-wise if two arrays of doubles are within an absolute tolerance.
+ *
+ * Equivalent to calling `pdcpl_double_near` on each pair of elements, with the
+ * result for element `i` written to bit `i % 64` of `mask[i / 64]`. Unused
+ * high bits of the last mask word are zero. Uses AVX or SSE2 if the CPU
+ * supports them.
+ *
+ * @param a First array
+ * @param b Second array
+ * @param n Number of elements in each array
+ * @param eps Absolute tolerance
+ * @param mask Array of `pdcpl_mask_words(n)` words to write results to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_double_near_array(
+  const double *a, const double *b, size_t n, double eps, uint64_t *mask);
+
+/**
+ * Return the distance between two doubles in units in the last place.
+ *
+ * This is the number of representable doubles between `a` and `b`, where
+ * -0.0 and +0.0 are treated as the same value.
+ *
+ * @param a First double
+ * @param b Second double
+ * @returns ULP distance, `UINT64_MAX` if either value is NaN
+ */
+PDCPL_PUBLIC uint64_t
+pdcpl_double_ulp_distance(double a, double b);
+
+/**
+ * Check if two doubles are within a given number of units in the last place.
+ *
+ * Unlike an absolute tolerance, this scales with the magnitude of the values.
+ *
+ * @param a First double
+ * @param b Second double
+ * @param max_ulp Maximum ULP distance
+ */
+PDCPL_INLINE bool
+pdcpl_double_ulp_near(double a, double b, uint64_t max_ulp)
+{
+  return pdcpl_double_ulp_distance(a, b) <= max_ulp;
+}
+
+/**
+ * Check element-wise if two arrays of doubles are within a ULP distance.
+ *
+ * Results are written as a bitmask in the same way as for
+ * `pdcpl_double_near_array`.
+ *
+ * @param a First array
+ * @param b Second array
+ * @param n Number of elements in each array
+ * @param max_ulp Maximum ULP distance
+ * @param mask Array of `pdcpl_mask_words(n)` words to write results to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_double_ulp_near_array(
+  const double *a, const double *b, size_t n, uint64_t max_ulp, uint64_t *mask);
+
 PDCPL_EXTERN_C_END
 
 #endif  // PDCPL_MATH_H_
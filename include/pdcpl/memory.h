@@ -17,6 +17,7 @@
 
 #include "pdcpl/common.h"
 #include "pdcpl/dllexport.h"
+#include "pdcpl/stats.h"
 
 PDCPL_EXTERN_C_BEGIN
 
@@ -112,6 +113,8 @@ pdcpl_buffer_new(size_t buf_size)
   pdcpl_buffer buf;
   buf.data = (buf_size) ? malloc(buf_size) : NULL;
   buf.size = (buf.data) ? buf_size : 0;
+  if (buf_size)
+    pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
   return buf;
 }
 
@@ -145,6 +148,7 @@ pdcpl_buffer_realloc(pdcpl_buffer *buf, size_t new_size)
   if (!buf || !new_size)
     return -EINVAL;
   void *new_data = realloc(buf->data, new_size);
+  pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
   if (!new_data)
     return -ENOMEM;
   buf->data = new_data;
@@ -192,6 +196,7 @@ pdcpl_buffer_copy(const pdcpl_buffer *src, pdcpl_buffer *dst)
     return -EINVAL;
   // try to allocate new memory for dst
   void *data = malloc(src->size);
+  pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
   if (!data)
     return -ENOMEM;
   // if successful, copy buffer contents, buffer pointer and size + exit
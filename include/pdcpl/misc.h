@@ -8,7 +8,11 @@
 #ifndef PDCPL_MISC_H_
 #define PDCPL_MISC_H_
 
+#include <stddef.h>
+
 #include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/memory.h"
 
 PDCPL_EXTERN_C_BEGIN
 
@@ -28,6 +32,108 @@ pdcpl_f2ctemp(double temp) { return 5 * (temp - 32) / 9; }
 PDCPL_INLINE double
 pdcpl_c2ftemp(double temp) { return 9 * temp / 5 + 32; }
 
+/**
+ * Converts an array of Fahrenheit temperatures to Celsius.
+ *
+ * Gives the same results as `pdcpl_f2ctemp` on each element, using AVX or
+ * SSE2 if the CPU supports them. `in` and `out` may be the same array.
+ *
+ * @param in Temperatures in Fahrenheit
+ * @param out Array to write temperatures in Celsius to
+ * @param n Number of elements in `in` and `out`
+ */
+PDCPL_PUBLIC void
+pdcpl_f2ctemp_array(const double *in, double *out, size_t n);
+
+/**
+ * Converts an array of Celsius temperatures to Fahrenheit.
+ *
+ * Gives the same results as `pdcpl_c2ftemp` on each element, using AVX or
+ * SSE2 if the CPU supports them. `in` and `out` may be the same array.
+ *
+ * @param in Temperatures in Celsius
+ * @param out Array to write temperatures in Fahrenheit to
+ * @param n Number of elements in `in` and `out`
+ */
+PDCPL_PUBLIC void
+pdcpl_c2ftemp_array(const double *in, double *out, size_t n);
+
+/**
+ * Array conversion function, e.g. `pdcpl_f2ctemp_array`.
+ */
+typedef void (*pdcpl_convarray_func)(const double *, double *, size_t);
+
+/**
+ * Maximum width and precision of a conversion table column.
+ */
+#define PDCPL_CONVTABLE_WIDTH_MAX 32
+
+/**
+ * Format of a conversion table column.
+ *
+ * @param label Column label, at most `width` chars
+ * @param width Minimum width of column values, from 1 to
+ *  `PDCPL_CONVTABLE_WIDTH_MAX`
+ * @param precision Digits after the decimal point of column values, at most
+ *  `PDCPL_CONVTABLE_WIDTH_MAX`
+ */
+typedef struct {
+  const char *label;
+  unsigned int width;
+  unsigned int precision;
+} pdcpl_convtable_column;
+
+/**
+ * Specification for a two-column conversion table.
+ *
+ * Rows start at `start` and go up to and including `stop` in increments of
+ * `step`, which is negative for a descending table.
+ *
+ * @param in Format of the input column
+ * @param out Format of the output column
+ * @param start First input value
+ * @param stop Last input value
+ * @param step Input value increment
+ * @param conv Function converting input values to output values
+ */
+typedef struct {
+  pdcpl_convtable_column in;
+  pdcpl_convtable_column out;
+  double start;
+  double stop;
+  double step;
+  pdcpl_convarray_func conv;
+} pdcpl_convtable_spec;
+
+/**
+ * Format a bordered two-column conversion table into a buffer.
+ *
+ * All output values are computed with a single array conversion call and the
+ * formatted table is written as a null-terminated string, so it can be
+ * written out with a single `fwrite`. For example, with input and output
+ * widths of 6 and precisions of 0 and 1, the table is
+ *
+ * @code{.c}
+ * +--------+--------+
+ * |     F. |     C. |
+ * +--------+--------+
+ * |      0 |  -17.8 |
+ * ...
+ * +--------+--------+
+ * @endcode
+ *
+ * @param spec Table specification
+ * @param out Buffer to allocate and write the table to. On success, the
+ *  caller must call `pdcpl_buffer_clear` to free the buffer.
+ * @param np Address to write the table length, excluding the null, to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`, if a
+ *  column width or precision is out of range, or if the step is zero or does
+ *  not go from `start` toward `stop`, -ENOMEM if memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_convtable_format(
+  const pdcpl_convtable_spec *spec, pdcpl_buffer *out, size_t *np);
+
 PDCPL_EXTERN_C_END
 
 #endif  // PDCPL_MISC_H_
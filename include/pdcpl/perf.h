@@ -0,0 +1,192 @@
+/**
+ * @file perf.h
+ * @author Derek Huang
+ * @brief C header for hardware performance counters
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_PERF_H_
+#define PDCPL_PERF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Enum for the hardware events that can be counted.
+ *
+ * Counters are only available on Linux through `perf_event_open`.
+ */
+typedef enum {
+  PDCPL_PERF_CYCLES,
+  PDCPL_PERF_INSTRUCTIONS,
+  PDCPL_PERF_CACHE_REFERENCES,
+  PDCPL_PERF_CACHE_MISSES,
+  PDCPL_PERF_BRANCH_MISSES,
+  PDCPL_PERF_L1D_MISSES,
+  PDCPL_PERF_EVENT_MAX
+} pdcpl_perf_event;
+
+/**
+ * Struct for a group of counters that are enabled and read together.
+ *
+ * Events the CPU or kernel does not support are left out of the group.
+ *
+ * @param fds File descriptors indexed by `pdcpl_perf_event`, -1 if not opened
+ * @param events Bitwise OR of `1u << event` for each opened event
+ */
+typedef struct {
+  int fds[PDCPL_PERF_EVENT_MAX];
+  unsigned int events;
+} pdcpl_perf_group;
+
+/**
+ * Struct holding counter values read from a `pdcpl_perf_group`.
+ *
+ * If the kernel multiplexed the counters, the values are scaled up by the
+ * fraction of time they were running to estimate the full counts.
+ *
+ * @param events Bitwise OR of `1u << event` for each counted event, 0 if
+ *  counters are unavailable
+ * @param values Counter values indexed by `pdcpl_perf_event`
+ */
+typedef struct {
+  unsigned int events;
+  uint64_t values[PDCPL_PERF_EVENT_MAX];
+} pdcpl_perf_counters;
+
+/**
+ * Return the name of a hardware event.
+ *
+ * @param event Hardware event
+ * @returns Name, e.g. `"cycles"`, `NULL` for an invalid event
+ */
+PDCPL_PUBLIC const char *
+pdcpl_perf_event_name(pdcpl_perf_event event);
+
+/**
+ * Open a group of hardware counters for the calling thread.
+ *
+ * Only user-space events are counted so that a `perf_event_paranoid` level of
+ * 2 is sufficient. The counters start disabled.
+ *
+ * @param group Address of `pdcpl_perf_group` to write to
+ * @returns 0 on success, -EINVAL if `group` is `NULL`, -ENOSYS if counters
+ *  are not supported on this platform, negative `errno` value from
+ *  `perf_event_open` if no counters could be opened, e.g. -EACCES or -ENOENT
+ *  in containers or virtual machines where perf events are restricted
+ */
+PDCPL_PUBLIC int
+pdcpl_perf_open(PDCPL_SA(Out) pdcpl_perf_group *group);
+
+/**
+ * Reset and enable the counters in a group.
+ *
+ * @param group Opened counter group
+ * @returns 0 on success, -EINVAL if `group` is `NULL` or not opened, negative
+ *  `errno` value on error
+ */
+PDCPL_PUBLIC int
+pdcpl_perf_start(PDCPL_SA(In) pdcpl_perf_group *group);
+
+/**
+ * Read the counters in a group.
+ *
+ * The counters are not disabled, so this can be used to take snapshots.
+ *
+ * @param group Opened counter group
+ * @param counters Address of `pdcpl_perf_counters` to write to
+ * @returns 0 on success, -EINVAL if `group` or `counters` is `NULL` or if
+ *  `group` is not opened, -EIO if the read is short, negative `errno` value
+ *  on other errors
+ */
+PDCPL_PUBLIC int
+pdcpl_perf_read(
+  PDCPL_SA(In) pdcpl_perf_group *group,
+  PDCPL_SA(Out) pdcpl_perf_counters *counters);
+
+/**
+ * Disable the counters in a group and read them.
+ *
+ * @param group Opened counter group
+ * @param counters Address of `pdcpl_perf_counters` to write to
+ * @returns 0 on success, -EINVAL if `group` or `counters` is `NULL` or if
+ *  `group` is not opened, -EIO if the read is short, negative `errno` value
+ *  on other errors
+ */
+PDCPL_PUBLIC int
+pdcpl_perf_stop(
+  PDCPL_SA(In) pdcpl_perf_group *group,
+  PDCPL_SA(Out) pdcpl_perf_counters *counters);
+
+/**
+ * Close the counters in a group.
+ *
+ * Safe to call on a group that failed to open.
+ *
+ * @param group Counter group
+ */
+PDCPL_PUBLIC void
+pdcpl_perf_close(PDCPL_SA(Opt) pdcpl_perf_group *group);
+
+/**
+ * Write counter values and derived rates to a stream.
+ *
+ * IPC and cache miss rate are written if their events were counted, while
+ * per-byte rates are written if `bytes` is nonzero. If no events were
+ * counted, the counters are reported as unavailable.
+ *
+ * @param f Stream to write to
+ * @param counters Counter values
+ * @param bytes Number of bytes processed while counting, 0 if not known
+ * @param json `true` to write a JSON object without a trailing newline,
+ *  `false` to write lines of text
+ * @returns 0 on success, -EINVAL if `f` or `counters` is `NULL`, -EIO on
+ *  write error
+ */
+PDCPL_PUBLIC int
+pdcpl_perf_fprintf(
+  PDCPL_SA(In) FILE *f,
+  PDCPL_SA(In) const pdcpl_perf_counters *counters,
+  uint64_t bytes,
+  bool json);
+
+/**
+ * Check if an event was counted.
+ *
+ * @param counters Counter values
+ * @param event Hardware event
+ */
+PDCPL_INLINE bool
+pdcpl_perf_has(const pdcpl_perf_counters *counters, pdcpl_perf_event event)
+{
+  return (counters->events & (1u << event)) != 0;
+}
+
+/**
+ * Return instructions per cycle, 0 if either event was not counted.
+ *
+ * @param counters Counter values
+ */
+PDCPL_INLINE double
+pdcpl_perf_ipc(const pdcpl_perf_counters *counters)
+{
+  if (
+    !pdcpl_perf_has(counters, PDCPL_PERF_CYCLES) ||
+    !pdcpl_perf_has(counters, PDCPL_PERF_INSTRUCTIONS) ||
+    !counters->values[PDCPL_PERF_CYCLES]
+  )
+    return 0;
+  return (double) counters->values[PDCPL_PERF_INSTRUCTIONS] /
+    (double) counters->values[PDCPL_PERF_CYCLES];
+}
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_PERF_H_
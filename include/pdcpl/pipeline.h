@@ -0,0 +1,146 @@
+/**
+ * @file pipeline.h
+ * @author Derek Huang
+ * @brief C header for in-process text filter pipelines
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_PIPELINE_H_
+#define PDCPL_PIPELINE_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Default number of input bytes a pipeline transforms at a time.
+ */
+#define PDCPL_PIPELINE_BLOCK_SIZE 65536
+
+/**
+ * Opaque chain of text filter stages run in a single process.
+ *
+ * A pipeline is created from a shell-like specification such as
+ * `"detab 4 | squeeze | lower"`, where each stage is a block transform that
+ * carries its state from one block to the next. The available stages are:
+ *
+ * `detab [N]`
+ *   Replace tabs with blanks up to the next multiple of N columns, default 8
+ * `escape`
+ *   Escape tabs, backspaces, and backslashes like exercise 1-10
+ * `lower`
+ *   Convert text to lowercase like exercise 7-1
+ * `squeeze`
+ *   Replace multiple blanks with a single blank like exercise 1-9
+ * `upper`
+ *   Convert text to uppercase like exercise 7-1
+ * `words`
+ *   Print one word per line like exercise 1-12
+ *
+ * All stages share two buffers sized for the largest possible expansion of a
+ * block. Stages that never grow their input transform the previous stage's
+ * output in place, so data is only copied when a stage may expand it.
+ */
+typedef struct pdcpl_pipeline pdcpl_pipeline;
+
+/**
+ * Create a new pipeline from a specification.
+ *
+ * @param pipeline Address of `pdcpl_pipeline *` to write the new handle to
+ * @param spec Stages separated by `|`, each a stage name followed by its
+ *  optional argument, with any amount of surrounding whitespace
+ * @param block_size Maximum number of input bytes per block, 0 for
+ *  `PDCPL_PIPELINE_BLOCK_SIZE`
+ * @returns 0 on success, -EINVAL if `pipeline` or `spec` is `NULL`, `spec`
+ *  has an empty, unknown, or malformed stage, or the buffers would be too
+ *  large, -ENOMEM if memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_pipeline_create(
+  PDCPL_SA(Out) pdcpl_pipeline **pipeline,
+  PDCPL_SA(In) const char *spec,
+  size_t block_size);
+
+/**
+ * Free a pipeline.
+ *
+ * @param pipeline Pipeline handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `pipeline` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_pipeline_destroy(PDCPL_SA(In) pdcpl_pipeline *pipeline);
+
+/**
+ * Return the number of stages in a pipeline.
+ *
+ * @param pipeline Pipeline handle
+ */
+PDCPL_PUBLIC size_t
+pdcpl_pipeline_size(PDCPL_SA(In) const pdcpl_pipeline *pipeline);
+
+/**
+ * Return the maximum number of input bytes per block of a pipeline.
+ *
+ * @param pipeline Pipeline handle
+ */
+PDCPL_PUBLIC size_t
+pdcpl_pipeline_block_size(PDCPL_SA(In) const pdcpl_pipeline *pipeline);
+
+/**
+ * Reset the state of each stage as if no input had been transformed.
+ *
+ * @param pipeline Pipeline handle
+ * @returns 0 on success, -EINVAL if `pipeline` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_pipeline_reset(PDCPL_SA(In) pdcpl_pipeline *pipeline);
+
+/**
+ * Transform a block of input through each stage of a pipeline.
+ *
+ * Consecutive blocks are treated as one continuous input, so a block may end
+ * in the middle of a line or word. The output points into the pipeline's own
+ * buffers and is only valid until the next call.
+ *
+ * @param pipeline Pipeline handle
+ * @param in Input bytes, can be `NULL` if `in_size` is 0
+ * @param in_size Number of input bytes, at most the pipeline block size
+ * @param out Address of `const char *` to write the output pointer to
+ * @param out_size Address of `size_t` to write the output size to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL` or
+ *  `in_size` is larger than the pipeline block size
+ */
+PDCPL_PUBLIC int
+pdcpl_pipeline_process(
+  PDCPL_SA(In) pdcpl_pipeline *pipeline,
+  PDCPL_SA(Opt(In)) const void *in,
+  size_t in_size,
+  PDCPL_SA(Out) const char **out,
+  PDCPL_SA(Out) size_t *out_size);
+
+/**
+ * Transform a stream through a pipeline until end of input.
+ *
+ * Blocks are read directly into the pipeline's buffers, so the only copies
+ * are the read, the write, and any stage that may expand its input.
+ *
+ * @param pipeline Pipeline handle
+ * @param in Stream to read from
+ * @param out Stream to write to
+ * @returns 0 on success, -EINVAL if any argument is `NULL`, -EIO on read or
+ *  write error
+ */
+PDCPL_PUBLIC int
+pdcpl_pipeline_run(
+  PDCPL_SA(In) pdcpl_pipeline *pipeline,
+  PDCPL_SA(In) FILE *in,
+  PDCPL_SA(In) FILE *out);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_PIPELINE_H_
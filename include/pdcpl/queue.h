@@ -0,0 +1,332 @@
+/**
+ * @file queue.h
+ * @author Derek Huang
+ * @brief C header for bounded lock-free buffer queues
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_QUEUE_H_
+#define PDCPL_QUEUE_H_
+
+#include <stddef.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/memory.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Opaque bounded single-producer single-consumer queue of buffers.
+ *
+ * Implemented as a Lamport ring where each side keeps a cached copy of the
+ * other side's index, so the shared index is only read when the queue looks
+ * full or empty. The producer and consumer indices are on separate cache
+ * lines. Only one thread may push and only one thread may pop at a time.
+ *
+ * Queued buffers are owned by the queue and are moved in and out by value.
+ */
+typedef struct pdcpl_spsc_queue pdcpl_spsc_queue;
+
+/**
+ * Opaque bounded multi-producer multi-consumer queue of buffers.
+ *
+ * Implemented as a Vyukov ring where each cell has a sequence number that
+ * tells producers and consumers whether it is ready for them, so any number
+ * of threads can push and pop with one compare-and-swap per operation.
+ *
+ * Queued buffers are owned by the queue and are moved in and out by value.
+ */
+typedef struct pdcpl_mpmc_queue pdcpl_mpmc_queue;
+
+/**
+ * Create a new single-producer single-consumer queue.
+ *
+ * @param queue Address of `pdcpl_spsc_queue *` to write the new handle to
+ * @param capacity Minimum capacity, rounded up to a power of 2
+ * @returns 0 on success, -EINVAL if `queue` is `NULL` or `capacity` is 0 or
+ *  too large, -ENOMEM if memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_spsc_queue_create(
+  PDCPL_SA(Out) pdcpl_spsc_queue **queue, size_t capacity);
+
+/**
+ * Free a single-producer single-consumer queue and any buffers left in it.
+ *
+ * @param queue Queue handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_spsc_queue_destroy(PDCPL_SA(In) pdcpl_spsc_queue *queue);
+
+/**
+ * Return the capacity of a single-producer single-consumer queue.
+ *
+ * @param queue Queue handle
+ */
+PDCPL_PUBLIC size_t
+pdcpl_spsc_queue_capacity(PDCPL_SA(In) const pdcpl_spsc_queue *queue);
+
+/**
+ * Push a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Buffer to move into the queue on success
+ * @returns 0 on success, -EAGAIN if the queue is full
+ */
+PDCPL_PUBLIC int
+pdcpl_spsc_queue_push(
+  PDCPL_SA(In) pdcpl_spsc_queue *queue, PDCPL_SA(In) const pdcpl_buffer *buf);
+
+/**
+ * Pop a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Address of buffer to move the popped buffer to
+ * @returns 0 on success, -EAGAIN if the queue is empty
+ */
+PDCPL_PUBLIC int
+pdcpl_spsc_queue_pop(
+  PDCPL_SA(In) pdcpl_spsc_queue *queue, PDCPL_SA(Out) pdcpl_buffer *buf);
+
+/**
+ * Push as many buffers as fit without blocking.
+ *
+ * The buffers are published to the consumer together.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move into the queue, in order
+ * @param n Number of buffers
+ * @returns Number of buffers pushed, the first ones in `bufs`
+ */
+PDCPL_PUBLIC size_t
+pdcpl_spsc_queue_push_n(
+  PDCPL_SA(In) pdcpl_spsc_queue *queue,
+  PDCPL_SA(In) const pdcpl_buffer *bufs,
+  size_t n);
+
+/**
+ * Pop up to `n` buffers without blocking.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move the popped buffers to, in order
+ * @param n Maximum number of buffers
+ * @returns Number of buffers popped
+ */
+PDCPL_PUBLIC size_t
+pdcpl_spsc_queue_pop_n(
+  PDCPL_SA(In) pdcpl_spsc_queue *queue,
+  PDCPL_SA(Out) pdcpl_buffer *bufs,
+  size_t n);
+
+/**
+ * Create a new multi-producer multi-consumer queue.
+ *
+ * @param queue Address of `pdcpl_mpmc_queue *` to write the new handle to
+ * @param capacity Minimum capacity, rounded up to a power of 2 at least 2
+ * @returns 0 on success, -EINVAL if `queue` is `NULL` or `capacity` is 0 or
+ *  too large, -ENOMEM if memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_mpmc_queue_create(
+  PDCPL_SA(Out) pdcpl_mpmc_queue **queue, size_t capacity);
+
+/**
+ * Free a multi-producer multi-consumer queue and any buffers left in it.
+ *
+ * @param queue Queue handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_mpmc_queue_destroy(PDCPL_SA(In) pdcpl_mpmc_queue *queue);
+
+/**
+ * Return the capacity of a multi-producer multi-consumer queue.
+ *
+ * @param queue Queue handle
+ */
+PDCPL_PUBLIC size_t
+pdcpl_mpmc_queue_capacity(PDCPL_SA(In) const pdcpl_mpmc_queue *queue);
+
+/**
+ * Push a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Buffer to move into the queue on success
+ * @returns 0 on success, -EAGAIN if the queue is full
+ */
+PDCPL_PUBLIC int
+pdcpl_mpmc_queue_push(
+  PDCPL_SA(In) pdcpl_mpmc_queue *queue, PDCPL_SA(In) const pdcpl_buffer *buf);
+
+/**
+ * Pop a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Address of buffer to move the popped buffer to
+ * @returns 0 on success, -EAGAIN if the queue is empty
+ */
+PDCPL_PUBLIC int
+pdcpl_mpmc_queue_pop(
+  PDCPL_SA(In) pdcpl_mpmc_queue *queue, PDCPL_SA(Out) pdcpl_buffer *buf);
+
+/**
+ * Push as many buffers as fit without blocking.
+ *
+ * A run of free cells is claimed with a single compare-and-swap, so the
+ * buffers pushed by one call are contiguous in the queue.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move into the queue, in order
+ * @param n Number of buffers
+ * @returns Number of buffers pushed, the first ones in `bufs`
+ */
+PDCPL_PUBLIC size_t
+pdcpl_mpmc_queue_push_n(
+  PDCPL_SA(In) pdcpl_mpmc_queue *queue,
+  PDCPL_SA(In) const pdcpl_buffer *bufs,
+  size_t n);
+
+/**
+ * Pop up to `n` buffers without blocking.
+ *
+ * A run of full cells is claimed with a single compare-and-swap.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move the popped buffers to, in order
+ * @param n Maximum number of buffers
+ * @returns Number of buffers popped
+ */
+PDCPL_PUBLIC size_t
+pdcpl_mpmc_queue_pop_n(
+  PDCPL_SA(In) pdcpl_mpmc_queue *queue,
+  PDCPL_SA(Out) pdcpl_buffer *bufs,
+  size_t n);
+
+/**
+ * Enum for the lock-free queue underlying a blocking queue.
+ */
+typedef enum {
+  PDCPL_QUEUE_SPSC,
+  PDCPL_QUEUE_MPMC
+} pdcpl_queue_kind;
+
+/**
+ * Opaque blocking queue of buffers.
+ *
+ * Wraps a lock-free queue so that pushes wait while it is full and pops wait
+ * while it is empty. Operations only take a mutex when they have to wait or
+ * when the other side is known to be waiting, so a queue that is neither
+ * full nor empty has the cost of the underlying queue. A `PDCPL_QUEUE_SPSC`
+ * queue keeps the single-producer single-consumer restriction.
+ *
+ * A queue is closed when its producers are done. Pops then return the
+ * remaining buffers before failing with -EPIPE.
+ */
+typedef struct pdcpl_blocking_queue pdcpl_blocking_queue;
+
+/**
+ * Create a new blocking queue.
+ *
+ * @param queue Address of `pdcpl_blocking_queue *` to write the new handle to
+ * @param kind Kind of underlying lock-free queue
+ * @param capacity Minimum capacity, rounded up to a power of 2
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`, `kind` is invalid, or
+ *  `capacity` is 0 or too large, -ENOMEM if memory allocation fails, other
+ *  negative errno value if the mutex or condition variables cannot be made
+ */
+PDCPL_PUBLIC int
+pdcpl_blocking_queue_create(
+  PDCPL_SA(Out) pdcpl_blocking_queue **queue,
+  pdcpl_queue_kind kind,
+  size_t capacity);
+
+/**
+ * Free a blocking queue and any buffers left in it.
+ *
+ * No threads may be waiting on the queue.
+ *
+ * @param queue Queue handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_blocking_queue_destroy(PDCPL_SA(In) pdcpl_blocking_queue *queue);
+
+/**
+ * Close a blocking queue, waking all waiting threads.
+ *
+ * Later pushes fail and pops fail once the queue is empty.
+ *
+ * @param queue Queue handle
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_blocking_queue_close(PDCPL_SA(In) pdcpl_blocking_queue *queue);
+
+/**
+ * Push a buffer, waiting while the queue is full.
+ *
+ * @param queue Queue handle
+ * @param buf Buffer to move into the queue on success
+ * @returns 0 on success, -EINVAL if `queue` or `buf` is `NULL`, -EPIPE if
+ *  the queue is closed, in which case the caller keeps the buffer
+ */
+PDCPL_PUBLIC int
+pdcpl_blocking_queue_push(
+  PDCPL_SA(In) pdcpl_blocking_queue *queue,
+  PDCPL_SA(In) const pdcpl_buffer *buf);
+
+/**
+ * Pop a buffer, waiting while the queue is empty and open.
+ *
+ * @param queue Queue handle
+ * @param buf Address of buffer to move the popped buffer to
+ * @returns 0 on success, -EINVAL if `queue` or `buf` is `NULL`, -EPIPE if
+ *  the queue is closed and empty
+ */
+PDCPL_PUBLIC int
+pdcpl_blocking_queue_pop(
+  PDCPL_SA(In) pdcpl_blocking_queue *queue, PDCPL_SA(Out) pdcpl_buffer *buf);
+
+/**
+ * Push buffers, waiting while the queue is full until all are pushed.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move into the queue, in order
+ * @param n Number of buffers
+ * @param n_pushed Address to write the number of buffers pushed to, can be
+ *  `NULL`. Less than `n` only if the queue was closed
+ * @returns 0 on success, -EINVAL if `queue` or `bufs` is `NULL`, -EPIPE if
+ *  the queue was closed before all the buffers were pushed
+ */
+PDCPL_PUBLIC int
+pdcpl_blocking_queue_push_n(
+  PDCPL_SA(In) pdcpl_blocking_queue *queue,
+  PDCPL_SA(In) const pdcpl_buffer *bufs,
+  size_t n,
+  PDCPL_SA(Opt(Out)) size_t *n_pushed);
+
+/**
+ * Pop up to `n` buffers, waiting while the queue is empty and open.
+ *
+ * Returns as soon as at least one buffer is popped.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move the popped buffers to, in order
+ * @param n Maximum number of buffers, positive
+ * @param n_popped Address to write the number of buffers popped to
+ * @returns 0 on success, -EINVAL if `queue`, `bufs`, or `n_popped` is `NULL`
+ *  or `n` is 0, -EPIPE if the queue is closed and empty
+ */
+PDCPL_PUBLIC int
+pdcpl_blocking_queue_pop_n(
+  PDCPL_SA(In) pdcpl_blocking_queue *queue,
+  PDCPL_SA(Out) pdcpl_buffer *bufs,
+  size_t n,
+  PDCPL_SA(Out) size_t *n_popped);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_QUEUE_H_
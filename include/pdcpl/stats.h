@@ -0,0 +1,230 @@
+/**
+ * @file stats.h
+ * @author Derek Huang
+ * @brief C header for program resource usage and throughput statistics
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_STATS_H_
+#define PDCPL_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/perf.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Enum for the statistics counters incremented by library functions.
+ */
+typedef enum {
+  PDCPL_STATS_BYTES_READ,
+  PDCPL_STATS_BYTES_WRITTEN,
+  PDCPL_STATS_LINES,
+  PDCPL_STATS_ALLOCS,
+  PDCPL_STATS_COUNTER_MAX
+} pdcpl_stats_counter;
+
+/**
+ * Enum for the statistics output formats.
+ */
+typedef enum {
+  PDCPL_STATS_FORMAT_TEXT,
+  PDCPL_STATS_FORMAT_JSON
+} pdcpl_stats_format;
+
+/**
+ * Struct holding a snapshot of the program statistics.
+ *
+ * @param wall_time Wall time in seconds since `pdcpl_stats_start` was called
+ * @param user_time User CPU time in seconds
+ * @param sys_time System CPU time in seconds
+ * @param peak_rss Peak resident set size in bytes, 0 if not available
+ * @param counters Counter totals indexed by `pdcpl_stats_counter`
+ * @param perf Hardware counters for the thread that called
+ *  `pdcpl_stats_start`, with no events if counters are unavailable
+ */
+typedef struct {
+  double wall_time;
+  double user_time;
+  double sys_time;
+  size_t peak_rss;
+  uint64_t counters[PDCPL_STATS_COUNTER_MAX];
+  pdcpl_perf_counters perf;
+} pdcpl_stats;
+
+/**
+ * Return the calling thread's counters, indexed by `pdcpl_stats_counter`.
+ *
+ * Only needed by `pdcpl_stats_add` when the counters can't be accessed
+ * directly. Use `pdcpl_stats_add` to add to a counter.
+ */
+PDCPL_PUBLIC uint64_t *
+pdcpl_stats_local_counters(void);
+
+// thread-local data can't have a DLL interface on Windows, so users of the
+// DLL get the counters through a function call instead
+#if defined(_WIN32) && defined(PDCPL_DLL) && !defined(PDCPL_BUILD_DLL)
+#define PDCPL_STATS_LOCAL pdcpl_stats_local_counters()
+#else
+// the initial-exec TLS model lets code in and outside a shared pdcpl reach the
+// counters directly instead of calling __tls_get_addr on every access
+#if defined(__GNUC__) && !defined(_WIN32)
+#define PDCPL_STATS_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+#define PDCPL_STATS_TLS_MODEL
+#endif  // !defined(__GNUC__) || defined(_WIN32)
+// thread-local counters, added to the totals on flush. only declared here so
+// that pdcpl_stats_add can be inlined, use pdcpl_stats_add to add to them
+extern PDCPL_THREAD_LOCAL PDCPL_STATS_TLS_MODEL
+uint64_t pdcpl_stats_local[PDCPL_STATS_COUNTER_MAX];
+#define PDCPL_STATS_LOCAL pdcpl_stats_local
+#endif  // !defined(_WIN32) || !defined(PDCPL_DLL) || defined(PDCPL_BUILD_DLL)
+
+/**
+ * Add to a statistics counter.
+ *
+ * The counter is thread-local and this is inline, so this is cheap enough to
+ * call per character. The thread's counters are added to the program totals
+ * by `pdcpl_stats_flush`.
+ *
+ * @param counter Counter to add to
+ * @param n Amount to add
+ */
+PDCPL_INLINE void
+pdcpl_stats_add(pdcpl_stats_counter counter, uint64_t n)
+{
+  if ((unsigned int) counter < PDCPL_STATS_COUNTER_MAX)
+    PDCPL_STATS_LOCAL[counter] += n;
+}
+
+/**
+ * Read a char from a stream and count it.
+ *
+ * Counts the char as a byte read and a newline as a line. Use in place of
+ * `fgetc` or `getchar` in read loops so that `--stats` reports the input.
+ *
+ * @param f Stream to read from
+ * @returns Char read as an `unsigned char` cast to `int`, `EOF` on end of
+ *  input or error
+ */
+PDCPL_INLINE int
+pdcpl_stats_getc(PDCPL_SA(In) FILE *f)
+{
+  int c = fgetc(f);
+  if (c != EOF) {
+    PDCPL_STATS_LOCAL[PDCPL_STATS_BYTES_READ]++;
+    if (c == '\n')
+      PDCPL_STATS_LOCAL[PDCPL_STATS_LINES]++;
+  }
+  return c;
+}
+
+/**
+ * Write a char to a stream and count it.
+ *
+ * Use in place of `fputc` or `putchar` in write loops so that `--stats`
+ * reports the output.
+ *
+ * @param c Char to write
+ * @param f Stream to write to
+ * @returns Char written as an `unsigned char` cast to `int`, `EOF` on error
+ */
+PDCPL_INLINE int
+pdcpl_stats_putc(int c, PDCPL_SA(In) FILE *f)
+{
+  c = fputc(c, f);
+  if (c != EOF)
+    PDCPL_STATS_LOCAL[PDCPL_STATS_BYTES_WRITTEN]++;
+  return c;
+}
+
+/**
+ * Write a null-terminated string to a stream and count it.
+ *
+ * Like `fputs`, no newline is appended.
+ *
+ * @param s String to write
+ * @param f Stream to write to
+ * @returns Nonnegative value on success, `EOF` on error
+ */
+PDCPL_INLINE int
+pdcpl_stats_puts(PDCPL_SA(In) const char *s, PDCPL_SA(In) FILE *f)
+{
+  int status = fputs(s, f);
+  if (status != EOF)
+    PDCPL_STATS_LOCAL[PDCPL_STATS_BYTES_WRITTEN] += strlen(s);
+  return status;
+}
+
+/**
+ * Count the bytes written by a `printf`-like call.
+ *
+ * For example, `pdcpl_stats_written(printf("%zu\n", n))`.
+ *
+ * @param n Value returned by the call, negative on error
+ * @returns `n`
+ */
+PDCPL_INLINE int
+pdcpl_stats_written(int n)
+{
+  if (n > 0)
+    PDCPL_STATS_LOCAL[PDCPL_STATS_BYTES_WRITTEN] += (uint64_t) n;
+  return n;
+}
+
+/**
+ * Add the calling thread's counters to the program totals and reset them.
+ *
+ * Threads that call library functions should call this before they exit,
+ * otherwise their counts are lost. `pdcpl_stats_get` calls this for the
+ * calling thread.
+ */
+PDCPL_PUBLIC void
+pdcpl_stats_flush(void);
+
+/**
+ * Record the wall time that `pdcpl_stats_get` measures elapsed time from.
+ *
+ * Hardware counters are also started for the calling thread if available.
+ * Threads started later are not counted.
+ */
+PDCPL_PUBLIC void
+pdcpl_stats_start(void);
+
+/**
+ * Get a snapshot of the program statistics.
+ *
+ * @param stats Address of `pdcpl_stats` to write to
+ * @returns 0 on success, -EINVAL if `stats` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_stats_get(PDCPL_SA(Out) pdcpl_stats *stats);
+
+/**
+ * Write program statistics to a stream.
+ *
+ * Throughput in MB/s is computed from the bytes read and wall time, while
+ * hardware counter rates are per byte read.
+ *
+ * @param f Stream to write to
+ * @param stats Statistics to write
+ * @param format Output format
+ * @returns 0 on success, -EINVAL if `f` or `stats` is `NULL` or if `format`
+ *  is not valid, -EIO on write error
+ */
+PDCPL_PUBLIC int
+pdcpl_stats_fprintf(
+  PDCPL_SA(In) FILE *f,
+  PDCPL_SA(In) const pdcpl_stats *stats,
+  pdcpl_stats_format format);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_STATS_H_
@@ -0,0 +1,90 @@
+/**
+ * @file strtod.h
+ * @author Derek Huang
+ * @brief C header for fast string to number conversion
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_STRTOD_H_
+#define PDCPL_STRTOD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Convert the start of a string to a `double`.
+ *
+ * Accepts the same syntax as `strtod` in the `"C"` locale, i.e. leading
+ * whitespace, an optional sign, and a decimal, hexadecimal, infinity, or NaN
+ * value, and gives the same correctly rounded result. Decimal values with up
+ * to 19 significant digits are converted with exact `double` arithmetic when
+ * possible, e.g. for pure-digit tokens below 2^53, and otherwise with the
+ * Eisel-Lemire algorithm. Other values, results that overflow or are
+ * subnormal, and the rare values Eisel-Lemire cannot round are converted with
+ * `strtod`, so `errno` is set exactly as `strtod` would set it.
+ *
+ * Unlike `strtod`, the string need not be null-terminated, as at most `size`
+ * chars are read, and the current locale is ignored on the fast paths.
+ *
+ * @param str String to convert
+ * @param size Maximum number of chars to read from `str`
+ * @param out Address to write the converted value to, 0 if no conversion
+ * @returns Number of chars consumed, including leading whitespace, or 0 if
+ *  no conversion could be performed
+ */
+PDCPL_PUBLIC size_t
+pdcpl_strtod_fast(
+  PDCPL_SA(In) const char *str, size_t size, PDCPL_SA(Out) double *out);
+
+/**
+ * Convert the start of a string to an `intmax_t`.
+ *
+ * Accepts leading whitespace, an optional sign, and decimal digits. On
+ * overflow, the value is clamped to `INTMAX_MIN` or `INTMAX_MAX` and `errno`
+ * is set to `ERANGE`, as with `strtoimax` in base 10.
+ *
+ * @param str String to convert
+ * @param size Maximum number of chars to read from `str`
+ * @param out Address to write the converted value to, 0 if no conversion
+ * @returns Number of chars consumed, including leading whitespace, or 0 if
+ *  no conversion could be performed
+ */
+PDCPL_PUBLIC size_t
+pdcpl_strtoj_fast(
+  PDCPL_SA(In) const char *str, size_t size, PDCPL_SA(Out) intmax_t *out);
+
+/**
+ * Convert whitespace-separated values in a buffer to `double` values.
+ *
+ * Conversion stops at the end of the buffer, after `max_n` values, or at the
+ * first token that is not a number. Each value must be followed by whitespace
+ * or the end of the buffer.
+ *
+ * @param in Buffer to read from
+ * @param size Number of bytes in `in`
+ * @param out Array to write converted values to
+ * @param max_n Maximum number of values to write to `out`
+ * @param np Address to write number of values converted to
+ * @param nrp Address to write number of bytes consumed to, which on error is
+ *  the offset of the whitespace before the token that could not be converted
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL` or if a
+ *  token could not be converted
+ */
+PDCPL_PUBLIC int
+pdcpl_strtod_batch(
+  PDCPL_SA(In) const char *in,
+  size_t size,
+  PDCPL_SA(Out) double *out,
+  size_t max_n,
+  PDCPL_SA(Out) size_t *np,
+  PDCPL_SA(Out) size_t *nrp);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_STRTOD_H_
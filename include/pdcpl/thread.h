@@ -0,0 +1,185 @@
+/**
+ * @file thread.h
+ * @author Derek Huang
+ * @brief C header for portable threads, mutexes, and condition variables
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_THREAD_H_
+#define PDCPL_THREAD_H_
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Opaque thread handle.
+ *
+ * Implemented with POSIX threads on *nix systems and Win32 threads on Windows.
+ */
+typedef struct pdcpl_thread pdcpl_thread;
+
+/**
+ * Thread start function.
+ *
+ * @param arg User-defined argument
+ * @returns User-defined result retrievable with `pdcpl_thread_join`
+ */
+typedef void *(*pdcpl_thread_func)(void *arg);
+
+/**
+ * Start a new thread.
+ *
+ * @param thread Address of `pdcpl_thread *` to write the new thread handle to
+ * @param func Function to run in the new thread
+ * @param arg Argument to pass to `func`
+ * @returns 0 on success, -EINVAL if `thread` or `func` is `NULL`, -ENOMEM if
+ *  memory allocation fails, -EAGAIN if the thread could not be created
+ */
+PDCPL_PUBLIC int
+pdcpl_thread_create(
+  PDCPL_SA(Out) pdcpl_thread **thread,
+  PDCPL_SA(In) pdcpl_thread_func func,
+  PDCPL_SA(Opt(In)) void *arg);
+
+/**
+ * Wait for a thread to finish and free its handle.
+ *
+ * @param thread Thread handle, which is invalid after the call
+ * @param result Address to write the thread function's result to, can be
+ *  `NULL` if the result is not needed
+ * @returns 0 on success, -EINVAL if `thread` is `NULL`, other negative errno
+ *  value if the thread could not be joined
+ */
+PDCPL_PUBLIC int
+pdcpl_thread_join(
+  PDCPL_SA(In) pdcpl_thread *thread, PDCPL_SA(Opt(Out)) void **result);
+
+/**
+ * Return the number of hardware threads available, at least 1.
+ */
+PDCPL_PUBLIC unsigned int
+pdcpl_thread_hardware_concurrency(void);
+
+/**
+ * Yield the rest of the calling thread's time slice.
+ */
+PDCPL_PUBLIC void
+pdcpl_thread_yield(void);
+
+/**
+ * Pin the calling thread to a CPU.
+ *
+ * @param cpu Zero-based CPU index, less than the hardware concurrency
+ * @returns 0 on success, -EINVAL if `cpu` is out of range, -ENOSYS if thread
+ *  affinity is not supported on this platform, other negative errno value if
+ *  the affinity could not be set
+ */
+PDCPL_PUBLIC int
+pdcpl_thread_pin(unsigned int cpu);
+
+/**
+ * Opaque mutex handle.
+ *
+ * Implemented with POSIX mutexes on *nix systems and slim reader/writer locks
+ * on Windows. The mutex is not recursive.
+ */
+typedef struct pdcpl_mutex pdcpl_mutex;
+
+/**
+ * Create a new mutex.
+ *
+ * @param mutex Address of `pdcpl_mutex *` to write the new mutex handle to
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`, -ENOMEM if memory
+ *  allocation fails, other negative errno value on initialization error
+ */
+PDCPL_PUBLIC int
+pdcpl_mutex_create(PDCPL_SA(Out) pdcpl_mutex **mutex);
+
+/**
+ * Lock a mutex, blocking until it is available.
+ *
+ * @param mutex Mutex handle
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_mutex_lock(PDCPL_SA(In) pdcpl_mutex *mutex);
+
+/**
+ * Unlock a mutex locked by the calling thread.
+ *
+ * @param mutex Mutex handle
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_mutex_unlock(PDCPL_SA(In) pdcpl_mutex *mutex);
+
+/**
+ * Destroy an unlocked mutex and free its handle.
+ *
+ * @param mutex Mutex handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_mutex_destroy(PDCPL_SA(In) pdcpl_mutex *mutex);
+
+/**
+ * Opaque condition variable handle.
+ *
+ * Implemented with POSIX condition variables on *nix systems and Win32
+ * condition variables on Windows. Waits may wake spuriously.
+ */
+typedef struct pdcpl_cond pdcpl_cond;
+
+/**
+ * Create a new condition variable.
+ *
+ * @param cond Address of `pdcpl_cond *` to write the new handle to
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`, -ENOMEM if memory
+ *  allocation fails, other negative errno value on initialization error
+ */
+PDCPL_PUBLIC int
+pdcpl_cond_create(PDCPL_SA(Out) pdcpl_cond **cond);
+
+/**
+ * Unlock a mutex, wait until woken, and lock the mutex again.
+ *
+ * @param cond Condition variable handle
+ * @param mutex Mutex handle locked by the calling thread
+ * @returns 0 on success, -EINVAL if `cond` or `mutex` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_cond_wait(PDCPL_SA(In) pdcpl_cond *cond, PDCPL_SA(In) pdcpl_mutex *mutex);
+
+/**
+ * Wake one thread waiting on a condition variable.
+ *
+ * @param cond Condition variable handle
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_cond_signal(PDCPL_SA(In) pdcpl_cond *cond);
+
+/**
+ * Wake all threads waiting on a condition variable.
+ *
+ * @param cond Condition variable handle
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_cond_broadcast(PDCPL_SA(In) pdcpl_cond *cond);
+
+/**
+ * Destroy a condition variable with no waiters and free its handle.
+ *
+ * @param cond Condition variable handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_cond_destroy(PDCPL_SA(In) pdcpl_cond *cond);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_THREAD_H_
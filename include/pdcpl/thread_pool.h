@@ -0,0 +1,182 @@
+/**
+ * @file thread_pool.h
+ * @author Derek Huang
+ * @brief C header for a work-stealing thread pool
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_THREAD_POOL_H_
+#define PDCPL_THREAD_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Opaque work-stealing thread pool handle.
+ *
+ * Each worker owns a Chase-Lev deque. Tasks submitted from a worker are
+ * pushed to the bottom of its deque and popped LIFO for locality, while idle
+ * workers steal FIFO from the top of randomly chosen victims. Tasks submitted
+ * from other threads go through a shared injection queue.
+ */
+typedef struct pdcpl_thread_pool pdcpl_thread_pool;
+
+/**
+ * Task function.
+ *
+ * @param arg User-defined argument
+ */
+typedef void (*pdcpl_task_func)(void *arg);
+
+/**
+ * Function called on a subrange of a parallel loop.
+ *
+ * @param begin First index of the subrange
+ * @param end One past the last index of the subrange
+ * @param arg User-defined argument
+ */
+typedef void (*pdcpl_range_func)(size_t begin, size_t end, void *arg);
+
+/**
+ * Struct for thread pool options.
+ *
+ * @param n_threads Number of worker threads, 0 to use the number of hardware
+ *  threads
+ * @param pin `true` to pin worker `i` to CPU `i` modulo the number of
+ *  hardware threads. Pinning is best-effort and is skipped where thread
+ *  affinity is unsupported or restricted, e.g. in some containers
+ */
+typedef struct {
+  unsigned int n_threads;
+  bool pin;
+} pdcpl_thread_pool_options;
+
+/**
+ * Default thread pool options.
+ */
+#define PDCPL_THREAD_POOL_OPTIONS_DEFAULT {0, false}
+
+/**
+ * Struct for a group of tasks that can be waited on together.
+ *
+ * Must be initialized with `PDCPL_TASK_GROUP_INIT` before use and must
+ * outlive its tasks, e.g. by waiting on it before it goes out of scope.
+ *
+ * @param pending Number of tasks not yet finished
+ */
+typedef struct {
+  volatile uint64_t pending;
+} pdcpl_task_group;
+
+/**
+ * Initializer for an empty task group.
+ */
+#define PDCPL_TASK_GROUP_INIT {0}
+
+/**
+ * Create a new thread pool and start its workers.
+ *
+ * @param pool Address of `pdcpl_thread_pool *` to write the new handle to
+ * @param opts Pool options, `NULL` for `PDCPL_THREAD_POOL_OPTIONS_DEFAULT`
+ * @returns 0 on success, -EINVAL if `pool` is `NULL`, -ENOMEM if memory
+ *  allocation fails, other negative errno value if a worker could not start
+ */
+PDCPL_PUBLIC int
+pdcpl_thread_pool_create(
+  PDCPL_SA(Out) pdcpl_thread_pool **pool,
+  PDCPL_SA(Opt(In)) const pdcpl_thread_pool_options *opts);
+
+/**
+ * Run all remaining tasks, stop the workers, and free the pool.
+ *
+ * Must not be called from a task running on the pool.
+ *
+ * @param pool Thread pool handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `pool` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_thread_pool_destroy(PDCPL_SA(In) pdcpl_thread_pool *pool);
+
+/**
+ * Return the number of worker threads, 0 if `pool` is `NULL`.
+ *
+ * @param pool Thread pool handle
+ */
+PDCPL_PUBLIC unsigned int
+pdcpl_thread_pool_size(PDCPL_SA(Opt(In)) const pdcpl_thread_pool *pool);
+
+/**
+ * Submit a task to a thread pool.
+ *
+ * If called from one of the pool's workers, the task is pushed onto that
+ * worker's deque, and is run immediately by the caller if the deque cannot
+ * grow. Otherwise it is added to the pool's injection queue.
+ *
+ * @param pool Thread pool handle
+ * @param group Task group to add the task to, `NULL` for no group
+ * @param func Task function
+ * @param arg User-defined argument passed to `func`
+ * @returns 0 on success, -EINVAL if `pool` or `func` is `NULL`, -ENOMEM if
+ *  memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_thread_pool_submit(
+  PDCPL_SA(In) pdcpl_thread_pool *pool,
+  PDCPL_SA(Opt(In_Out)) pdcpl_task_group *group,
+  PDCPL_SA(In) pdcpl_task_func func,
+  PDCPL_SA(Opt(In)) void *arg);
+
+/**
+ * Wait until all the tasks in a group have finished.
+ *
+ * The calling thread runs pending tasks from the pool while it waits, so it
+ * is safe to call from a task running on the pool. If no tasks can be found
+ * for a while, the thread sleeps until the group finishes or there is work.
+ *
+ * @param pool Thread pool handle the group's tasks were submitted to
+ * @param group Task group
+ * @returns 0 on success, -EINVAL if `pool` or `group` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_task_group_wait(
+  PDCPL_SA(In) pdcpl_thread_pool *pool,
+  PDCPL_SA(In_Out) pdcpl_task_group *group);
+
+/**
+ * Call a function on subranges of `[begin, end)` in parallel.
+ *
+ * The range is split in halves recursively until subranges have at most
+ * `grain` indices, with the right halves made available for stealing, so
+ * splitting only goes as deep as idle workers make it worthwhile. The
+ * calling thread takes part in the loop and returns when all the subranges
+ * are done. If a task cannot be allocated, its subrange is run by the thread
+ * that was splitting it.
+ *
+ * @param pool Thread pool handle
+ * @param begin First index
+ * @param end One past the last index
+ * @param grain Maximum subrange size, 0 to choose one from the range size
+ *  and the number of workers
+ * @param func Function called on each subrange
+ * @param arg User-defined argument passed to `func`
+ * @returns 0 on success, -EINVAL if `pool` or `func` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_parallel_for(
+  PDCPL_SA(In) pdcpl_thread_pool *pool,
+  size_t begin,
+  size_t end,
+  size_t grain,
+  PDCPL_SA(In) pdcpl_range_func func,
+  PDCPL_SA(Opt(In)) void *arg);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_THREAD_POOL_H_
@@ -0,0 +1,242 @@
+/**
+ * @file thread_pool.hh
+ * @author Derek Huang
+ * @brief C++ header for a work-stealing thread pool
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_THREAD_POOL_HH_
+#define PDCPL_THREAD_POOL_HH_
+
+#include <cerrno>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "pdcpl/thread_pool.h"
+
+namespace pdcpl {
+
+namespace detail {
+
+/**
+ * Holder for the first exception thrown by tasks run on a pool.
+ *
+ * Exceptions cannot propagate through the C library, so tasks catch them and
+ * the waiting thread rethrows the first one.
+ */
+class task_exception {
+public:
+  /**
+   * Record the current exception if none has been recorded yet.
+   */
+  void capture() noexcept
+  {
+    std::lock_guard lock{mutex_};
+    if (!error_)
+      error_ = std::current_exception();
+  }
+
+  /**
+   * Rethrow and clear the recorded exception, if any.
+   */
+  void rethrow()
+  {
+    std::exception_ptr error;
+    {
+      std::lock_guard lock{mutex_};
+      error = std::exchange(error_, nullptr);
+    }
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+private:
+  std::mutex mutex_;
+  std::exception_ptr error_;
+};
+
+/**
+ * Throw a `std::system_error` for a negative errno status.
+ *
+ * @param status Negative errno status
+ * @param what Message
+ */
+inline void throw_if_error(int status, const char* what)
+{
+  if (status == -ENOMEM)
+    throw std::bad_alloc{};
+  if (status)
+    throw std::system_error{-status, std::generic_category(), what};
+}
+
+}  // namespace detail
+
+/**
+ * RAII work-stealing thread pool.
+ */
+class thread_pool {
+public:
+  /**
+   * Ctor.
+   *
+   * @param n_threads Number of worker threads, 0 to use the number of
+   *  hardware threads
+   * @param pin `true` to pin workers to CPUs, best-effort
+   */
+  explicit thread_pool(unsigned int n_threads = 0, bool pin = false)
+  {
+    pdcpl_thread_pool_options opts{n_threads, pin};
+    detail::throw_if_error(
+      pdcpl_thread_pool_create(&pool_, &opts), "pdcpl_thread_pool_create"
+    );
+  }
+
+  /**
+   * Dtor.
+   *
+   * Runs remaining tasks and stops the workers.
+   */
+  ~thread_pool()
+  {
+    pdcpl_thread_pool_destroy(pool_);
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  /**
+   * Return the underlying C handle.
+   */
+  auto handle() const noexcept { return pool_; }
+
+  /**
+   * Return the number of worker threads.
+   */
+  auto size() const noexcept { return pdcpl_thread_pool_size(pool_); }
+
+  /**
+   * Call a function on subranges of `[begin, end)` in parallel.
+   *
+   * If any call throws, the remaining subranges still run and the first
+   * exception is rethrown once all are done.
+   *
+   * @tparam F Callable with `void(std::size_t, std::size_t)` signature
+   *
+   * @param begin First index
+   * @param end One past the last index
+   * @param func Callable invoked on each subrange `[b, e)`
+   * @param grain Maximum subrange size, 0 to choose automatically
+   */
+  template <typename F>
+  void parallel_for(
+    std::size_t begin, std::size_t end, F&& func, std::size_t grain = 0)
+  {
+    struct context {
+      std::remove_reference_t<F>& func;
+      detail::task_exception error;
+    } ctx{func, {}};
+    auto range_func = [](std::size_t b, std::size_t e, void* arg)
+    {
+      auto ctx = static_cast<context*>(arg);
+      try {
+        ctx->func(b, e);
+      }
+      catch (...) {
+        ctx->error.capture();
+      }
+    };
+    detail::throw_if_error(
+      pdcpl_parallel_for(pool_, begin, end, grain, range_func, &ctx),
+      "pdcpl_parallel_for"
+    );
+    ctx.error.rethrow();
+  }
+
+private:
+  pdcpl_thread_pool* pool_;
+};
+
+/**
+ * Group of tasks run on a thread pool that can be waited on together.
+ *
+ * The destructor waits for outstanding tasks, discarding their exceptions.
+ */
+class task_group {
+public:
+  /**
+   * Ctor.
+   *
+   * @param pool Thread pool to run tasks on, must outlive the group
+   */
+  explicit task_group(thread_pool& pool) noexcept
+    : pool_{pool}, group_ PDCPL_TASK_GROUP_INIT
+  {}
+
+  /**
+   * Dtor.
+   */
+  ~task_group()
+  {
+    pdcpl_task_group_wait(pool_.handle(), &group_);
+  }
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  /**
+   * Submit a task to the pool.
+   *
+   * @tparam F Callable with `void()` signature
+   *
+   * @param func Callable to run, copied or moved into the task
+   */
+  template <typename F>
+  void run(F&& func)
+  {
+    struct task {
+      std::decay_t<F> func;
+      detail::task_exception& error;
+    };
+    auto task_func = [](void* arg)
+    {
+      std::unique_ptr<task> t{static_cast<task*>(arg)};
+      try {
+        t->func();
+      }
+      catch (...) {
+        t->error.capture();
+      }
+    };
+    auto t = std::make_unique<task>(task{std::forward<F>(func), error_});
+    detail::throw_if_error(
+      pdcpl_thread_pool_submit(pool_.handle(), &group_, task_func, t.get()),
+      "pdcpl_thread_pool_submit"
+    );
+    // task_func owns the task now
+    t.release();
+  }
+
+  /**
+   * Wait for all submitted tasks, rethrowing the first exception thrown.
+   */
+  void wait()
+  {
+    pdcpl_task_group_wait(pool_.handle(), &group_);
+    error_.rethrow();
+  }
+
+private:
+  thread_pool& pool_;
+  pdcpl_task_group group_;
+  detail::task_exception error_;
+};
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_THREAD_POOL_HH_
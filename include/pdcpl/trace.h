@@ -0,0 +1,115 @@
+/**
+ * @file trace.h
+ * @author Derek Huang
+ * @brief C header for lightweight tracing with trace-event JSON output
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_TRACE_H_
+#define PDCPL_TRACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/sa.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Number of events kept per thread, a power of two.
+ *
+ * Each thread records events in its own ring buffer, overwriting the oldest
+ * events when full, so only the most recent events are dumped.
+ */
+#define PDCPL_TRACE_RING_SIZE 16384
+
+/**
+ * Name of the environment variable giving the path of the trace written at
+ * exit. If not set, the trace is written to `pdcpl_trace.json`.
+ */
+#define PDCPL_TRACE_FILE_ENV "PDCPL_TRACE_FILE"
+
+/**
+ * Return the current trace timestamp in implementation-defined ticks.
+ *
+ * On x86 processors this reads the time stamp counter, otherwise it reads a
+ * monotonic clock in nanoseconds. Ticks are converted when the trace is dumped.
+ */
+PDCPL_PUBLIC uint64_t
+pdcpl_trace_now(void);
+
+/**
+ * Record a span that started at the given timestamp and ends now.
+ *
+ * The first event recorded in a thread allocates that thread's ring buffer. If
+ * the library was built with `PDCPL_ENABLE_TRACE`, the first event recorded in
+ * the program also registers an `atexit` handler that dumps the trace.
+ *
+ * @param name Span name, must have static storage duration
+ * @param start Span start timestamp from `pdcpl_trace_now`
+ */
+PDCPL_PUBLIC void
+pdcpl_trace_span(PDCPL_SA(In) const char *name, uint64_t start);
+
+/**
+ * Record the current value of a named counter.
+ *
+ * @param name Counter name, must have static storage duration
+ * @param value Counter value
+ */
+PDCPL_PUBLIC void
+pdcpl_trace_counter(PDCPL_SA(In) const char *name, int64_t value);
+
+/**
+ * Write all recorded events as Chrome/Perfetto trace-event JSON.
+ *
+ * No other threads should be recording events during the dump.
+ *
+ * @param f Stream to write to
+ * @returns 0 on success, -EINVAL if `f` is `NULL`, -EIO on write error
+ */
+PDCPL_PUBLIC int
+pdcpl_trace_dump(PDCPL_SA(In) FILE *f);
+
+/**
+ * Discard all recorded events.
+ *
+ * No other threads should be recording events when this is called.
+ */
+PDCPL_PUBLIC void
+pdcpl_trace_clear(void);
+
+#if defined(PDCPL_ENABLE_TRACE)
+/**
+ * Declare a variable holding the start timestamp of a span.
+ *
+ * @param var Name of the timestamp variable
+ */
+#define PDCPL_TRACE_BEGIN(var) uint64_t var = pdcpl_trace_now()
+
+/**
+ * Record a span started with `PDCPL_TRACE_BEGIN`.
+ *
+ * @param var Name of the timestamp variable
+ * @param name Span name, must have static storage duration
+ */
+#define PDCPL_TRACE_END(var, name) pdcpl_trace_span(name, var)
+
+/**
+ * Record the current value of a named counter.
+ *
+ * @param name Counter name, must have static storage duration
+ * @param value Counter value
+ */
+#define PDCPL_TRACE_COUNTER(name, value) pdcpl_trace_counter(name, value)
+#else
+#define PDCPL_TRACE_BEGIN(var)
+#define PDCPL_TRACE_END(var, name)
+#define PDCPL_TRACE_COUNTER(name, value)
+#endif  // !defined(PDCPL_ENABLE_TRACE)
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_TRACE_H_
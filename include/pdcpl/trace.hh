@@ -0,0 +1,64 @@
+/**
+ * @file trace.hh
+ * @author Derek Huang
+ * @brief C++ header for scoped tracing spans
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_TRACE_HH_
+#define PDCPL_TRACE_HH_
+
+#include <cstdint>
+
+#include "pdcpl/common.h"
+#include "pdcpl/trace.h"
+
+namespace pdcpl {
+
+/**
+ * RAII span that records the time from construction to destruction.
+ */
+class trace_scope {
+public:
+  /**
+   * Ctor.
+   *
+   * @param name Span name, must have static storage duration
+   */
+  explicit trace_scope(const char* name) noexcept
+    : name_{name}, start_{pdcpl_trace_now()}
+  {}
+
+  /**
+   * Dtor.
+   *
+   * Records the span.
+   */
+  ~trace_scope()
+  {
+    pdcpl_trace_span(name_, start_);
+  }
+
+  trace_scope(const trace_scope&) = delete;
+  trace_scope& operator=(const trace_scope&) = delete;
+
+private:
+  const char* name_;
+  std::uint64_t start_;
+};
+
+}  // namespace pdcpl
+
+#if defined(PDCPL_ENABLE_TRACE)
+/**
+ * Record a span covering the rest of the enclosing scope.
+ *
+ * @param name Span name, must have static storage duration
+ */
+#define PDCPL_TRACE_SCOPE(name) \
+  pdcpl::trace_scope PDCPL_CONCAT(pdcpl_trace_scope_, __LINE__){name}
+#else
+#define PDCPL_TRACE_SCOPE(name)
+#endif  // !defined(PDCPL_ENABLE_TRACE)
+
+#endif  // PDCPL_TRACE_HH_
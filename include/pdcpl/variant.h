@@ -236,6 +236,53 @@ pdcpl_variant_shared_type(const pdcpl_variant *va, const pdcpl_variant *vb)
 PDCPL_PUBLIC int
 pdcpl_variant_compare(const pdcpl_variant* va, const pdcpl_variant *vb);
 
+/**
+ * Check if two variants are equal.
+ *
+ * Unlike `pdcpl_variant_compare`, which uses epsilon-based comparison for
+ * floating types and treats mismatched types as ties, this is an exact,
+ * type-aware equality consistent with `pdcpl_variant_hash`. Variants of
+ * different intrinsic types are never equal, `-0.0` and `+0.0` are equal, and
+ * all NaN values of a floating type are equal to each other. Two `NULL`
+ * strings are equal. Memory ownership flags are ignored.
+ *
+ * @param va First variant
+ * @param vb Second variant
+ * @returns `true` if the variants are equal, `false` otherwise or on error
+ */
+PDCPL_PUBLIC bool
+pdcpl_variant_equal(const pdcpl_variant *va, const pdcpl_variant *vb);
+
+/**
+ * Compute a hash value for a variant.
+ *
+ * The hash is type-aware, i.e. variants of different intrinsic types holding
+ * the same bits will almost always hash differently, and is consistent with
+ * `pdcpl_variant_equal`, so `-0.0` and `+0.0` hash the same as do all NaN
+ * values of a floating type. String and `void *` contents are hashed, not the
+ * pointers. Memory ownership flags are ignored.
+ *
+ * @param vt Variant to hash
+ * @returns Hash value, zero if `vt` is `NULL`
+ */
+PDCPL_PUBLIC uint64_t
+pdcpl_variant_hash(const pdcpl_variant *vt);
+
+/**
+ * Copy a variant, making a deep copy of any string or buffer.
+ *
+ * String and `void *` data are always copied into owned memory, even if
+ * `src` only borrows its data, so `dst` never depends on the lifetime of `src`.
+ * `dst` should not manage any memory or else that memory will be leaked.
+ *
+ * @param dst Variant to copy to
+ * @param src Variant to copy from
+ * @returns 0 on success, -EINVAL if `dst` or `src` are `NULL` or if `src` has
+ *  no known type, -ENOMEM if memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_copy(pdcpl_variant *dst, const pdcpl_variant *src);
+
 /**
  * Typedef for `pdcpl_variant` free function.
  *
@@ -0,0 +1,245 @@
+/**
+ * @file variant_codec.h
+ * @author Derek Huang
+ * @brief C header for binary `pdcpl_variant` serialization
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_VARIANT_CODEC_H_
+#define PDCPL_VARIANT_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/memory.h"
+#include "pdcpl/variant.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * Binary encoding of a `pdcpl_variant`.
+ *
+ * Each encoded variant starts with a single tag byte identifying the type,
+ * followed by the value. All multi-byte scalars are little-endian and all
+ * sizes are unsigned LEB128 varints.
+ *
+ * | type     | payload                                                  |
+ * | -------- | -------------------------------------------------------- |
+ * | `char`   | 1 byte                                                   |
+ * | `int`    | 4 bytes, two's complement                                |
+ * | `uint`   | 4 bytes                                                  |
+ * | `size`   | varint                                                   |
+ * | `double` | 8 bytes, IEEE 754 binary64                               |
+ * | `float`  | 4 bytes, IEEE 754 binary32                               |
+ * | `string` | varint `n`, then `n` bytes including null terminator, or |
+ * |          | `n` of zero for a `NULL` string                          |
+ * | `void`   | nonzero varint `n`, then `n` bytes                       |
+ *
+ * An array of variants is encoded as a varint count followed by the encoded
+ * variants, while a frame is a varint byte length followed by an array.
+ *
+ * Since strings are encoded with their null terminator, decoded string and
+ * `void *` variants can borrow directly from the input buffer.
+ */
+enum {
+  pdcpl_variant_tag_char = 1,
+  pdcpl_variant_tag_int = 2,
+  pdcpl_variant_tag_uint = 3,
+  pdcpl_variant_tag_size = 4,
+  pdcpl_variant_tag_double = 5,
+  pdcpl_variant_tag_float = 6,
+  pdcpl_variant_tag_string = 7,
+  pdcpl_variant_tag_void = 8
+};
+
+/**
+ * Maximum number of bytes a 64-bit varint can be encoded with.
+ */
+#define PDCPL_VARINT_MAX_SIZE 10
+
+/**
+ * Return the number of bytes needed to encode a value as a varint.
+ *
+ * @param value Value to encode
+ */
+PDCPL_PUBLIC size_t
+pdcpl_varint_size(uint64_t value);
+
+/**
+ * Encode a value as an unsigned LEB128 varint.
+ *
+ * @param value Value to encode
+ * @param out Output buffer with at least `pdcpl_varint_size(value)` bytes
+ * @returns Number of bytes written to `out`
+ */
+PDCPL_PUBLIC size_t
+pdcpl_varint_encode(uint64_t value, void *out);
+
+/**
+ * Decode an unsigned LEB128 varint.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param value Address to write decoded value to
+ * @param nrp Address to write number of bytes consumed to
+ * @returns 0 on success, -EINVAL if `in`, `value`, `nrp` are `NULL` or if the
+ *  varint is malformed, -ERANGE if `in` is truncated
+ */
+PDCPL_PUBLIC int
+pdcpl_varint_decode(const void *in, size_t size, uint64_t *value, size_t *nrp);
+
+/**
+ * Compute the number of bytes needed to encode a variant.
+ *
+ * @param vt Variant to encode
+ * @param np Address to write number of bytes to
+ * @returns 0 on success, -EINVAL if `vt` or `np` are `NULL` or if `vt` has no
+ *  known type or is an empty `void *` buffer
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_encoded_size(const pdcpl_variant *vt, size_t *np);
+
+/**
+ * Encode a variant into a buffer.
+ *
+ * @param vt Variant to encode
+ * @param out Output buffer
+ * @param size Number of bytes available in `out`
+ * @param nwp Address to write number of bytes written to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `vt` or `out` are `NULL` or if `vt` has no
+ *  known type or is an empty `void *` buffer, -ERANGE if `out` is too small
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_encode(
+  const pdcpl_variant *vt, void *out, size_t size, size_t *nwp);
+
+/**
+ * Decode a variant from a buffer.
+ *
+ * No memory is allocated. String and `void *` variants are initialized with
+ * `pdcpl_variant_init_string_ref` and `pdcpl_variant_init_void_ref`, pointing
+ * directly into `in`, so `in` must outlive the variant. Borrowed data should be
+ * treated as read-only, as `in` may be a read-only memory mapping.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param vt Variant to decode into
+ * @param nrp Address to write number of bytes consumed to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `in` or `vt` are `NULL` or if the encoded
+ *  variant is malformed, -ERANGE if `in` is truncated
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_decode(
+  const void *in, size_t size, pdcpl_variant *vt, size_t *nrp);
+
+/**
+ * Compute the number of bytes needed to encode an array of variants.
+ *
+ * @param vts Variants to encode, can be `NULL` if `n` is zero
+ * @param n Number of variants
+ * @param np Address to write number of bytes to
+ * @returns 0 on success, -EINVAL if `vts` or `np` are `NULL` or if any variant
+ *  has no known type
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_array_encoded_size(
+  const pdcpl_variant *vts, size_t n, size_t *np);
+
+/**
+ * Encode an array of variants into a buffer.
+ *
+ * @param vts Variants to encode, can be `NULL` if `n` is zero
+ * @param n Number of variants
+ * @param out Output buffer
+ * @param size Number of bytes available in `out`
+ * @param nwp Address to write number of bytes written to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `vts` or `out` are `NULL` or if any
+ *  variant has no known type, -ERANGE if `out` is too small
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_array_encode(
+  const pdcpl_variant *vts, size_t n, void *out, size_t size, size_t *nwp);
+
+/**
+ * Decode an array of variants from a buffer.
+ *
+ * Like `pdcpl_variant_decode`, no memory is allocated and the decoded
+ * variants borrow from `in`. If `max_n` is less than the encoded count, the
+ * count is still written to `np` so the caller can size `vts` and retry.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param vts Variants to decode into, can be `NULL` if `max_n` is zero
+ * @param max_n Number of variants `vts` can hold
+ * @param np Address to write number of decoded variants to
+ * @param nrp Address to write number of bytes consumed to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `in` or `np` are `NULL` or if the input is
+ *  malformed, -ERANGE if `in` is truncated or `vts` is too small
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_array_decode(
+  const void *in,
+  size_t size,
+  pdcpl_variant *vts,
+  size_t max_n,
+  size_t *np,
+  size_t *nrp);
+
+/**
+ * Write an array of variants to a stream as a length-prefixed frame.
+ *
+ * Variant payloads are written directly to the stream so no memory is
+ * allocated regardless of the size of the strings or buffers involved.
+ *
+ * @param f Stream to write to
+ * @param vts Variants to write, can be `NULL` if `n` is zero
+ * @param n Number of variants
+ * @returns 0 on success, -EINVAL if `f` or `vts` are `NULL` or if any variant
+ *  has no known type, -EIO on write error
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_frame_write(FILE *f, const pdcpl_variant *vts, size_t n);
+
+/**
+ * Read the payload of the next length-prefixed frame from a stream.
+ *
+ * The payload is read into `buf`, which is grown as necessary and can be
+ * reused across calls, so steady-state reading does not allocate. The payload
+ * can then be decoded with `pdcpl_variant_array_decode`. If the stream is at
+ * EOF before any frame bytes are read, zero is written to `np`.
+ *
+ * @param f Stream to read from
+ * @param buf Buffer to read payload into, can initially be empty
+ * @param np Address to write payload size to
+ * @returns 0 on success, -EINVAL if any argument is `NULL` or if the frame
+ *  header is malformed, -ENOMEM if `buf` cannot be grown, -EIO on read error
+ *  or if the frame is truncated
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_frame_read(FILE *f, pdcpl_buffer *buf, size_t *np);
+
+/**
+ * Locate the payload of the next length-prefixed frame in a buffer.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param payload Address to write payload pointer to
+ * @param payload_size Address to write payload size to
+ * @param nrp Address to write number of bytes the whole frame uses
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL` or if the
+ *  frame header is malformed, -ERANGE if `in` is truncated
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_frame_next(
+  const void *in,
+  size_t size,
+  const void **payload,
+  size_t *payload_size,
+  size_t *nrp);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_VARIANT_CODEC_H_
@@ -0,0 +1,163 @@
+/**
+ * @file variant_map.h
+ * @author Derek Huang
+ * @brief C header for a hash table keyed by `pdcpl_variant`
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_VARIANT_MAP_H_
+#define PDCPL_VARIANT_MAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdcpl/common.h"
+#include "pdcpl/dllexport.h"
+#include "pdcpl/variant.h"
+
+PDCPL_EXTERN_C_BEGIN
+
+/**
+ * `pdcpl_variant_map` flag constants.
+ */
+enum {
+  // store keys as given instead of deep-copying their strings or buffers
+  pdcpl_variant_map_borrow_keys = 0x1
+};
+
+/**
+ * Hash table entry.
+ *
+ * An entry is unused if its key has no flags set.
+ *
+ * @param key Entry key
+ * @param value Entry value
+ * @param hash Cached `pdcpl_variant_hash` of the key
+ */
+typedef struct {
+  pdcpl_variant key;
+  void *value;
+  uint64_t hash;
+} pdcpl_variant_map_entry;
+
+/**
+ * Open-addressing hash table keyed by `pdcpl_variant`.
+ *
+ * Keys are hashed with `pdcpl_variant_hash` and compared with
+ * `pdcpl_variant_equal`, so keys of different types never collide. Collisions
+ * are resolved by linear probing and the table grows when more than 3/4 full.
+ *
+ * By default, inserted string and `void *` keys are deep-copied and owned by
+ * the map. With the `pdcpl_variant_map_borrow_keys` flag, keys are stored as
+ * given and must outlive the map. Lookups never copy their key, so borrowed
+ * variants, e.g. from `pdcpl_variant_init_string_ref`, can be used freely.
+ *
+ * Entries can be iterated over by visiting each of the `capacity` entries and
+ * skipping those for which `pdcpl_variant_map_entry_used` returns `false`.
+ *
+ * @param entries Entry array
+ * @param capacity Number of entries, zero or a power of two
+ * @param size Number of used entries
+ * @param flags Map flags
+ */
+typedef struct {
+  pdcpl_variant_map_entry *entries;
+  size_t capacity;
+  size_t size;
+  unsigned int flags;
+} pdcpl_variant_map;
+
+/**
+ * Check if a map entry is in use.
+ *
+ * @param entry Map entry
+ */
+PDCPL_INLINE bool
+pdcpl_variant_map_entry_used(const pdcpl_variant_map_entry *entry)
+{
+  return !!entry->key.flags;
+}
+
+/**
+ * Initialize a variant map.
+ *
+ * @param map Map to initialize
+ * @param capacity Expected number of keys, can be zero
+ * @param flags Map flags
+ * @returns 0 on success, -EINVAL if `map` is `NULL`, -ENOMEM if memory
+ *  allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_map_init(
+  pdcpl_variant_map *map, size_t capacity, unsigned int flags);
+
+/**
+ * Free a variant map, including any keys it owns.
+ *
+ * Values are not freed since the map does not know what they point to.
+ *
+ * @param map Map to free
+ * @returns 0 on success, -EINVAL if `map` is `NULL`
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_map_free(pdcpl_variant_map *map);
+
+/**
+ * Find the value slot for a key.
+ *
+ * @param map Map to search
+ * @param key Key to look up
+ * @returns Address of the value for `key`, `NULL` if not found or on error
+ */
+PDCPL_PUBLIC void **
+pdcpl_variant_map_find(const pdcpl_variant_map *map, const pdcpl_variant *key);
+
+/**
+ * Find the value slot for a key, inserting the key if it is not present.
+ *
+ * Newly inserted keys have their value set to `NULL`. This allows a single
+ * lookup per key when grouping, e.g. incrementing a count stored in the value.
+ * The returned slot is invalidated by the next insertion.
+ *
+ * @param map Map to insert into
+ * @param key Key to look up or insert
+ * @param slot Address to write the value slot address to
+ * @param inserted Address to write whether `key` was inserted, can be `NULL`
+ * @returns 0 on success, -EINVAL if `map`, `key`, `slot` are `NULL` or if
+ *  `key` has no known type, -ENOMEM if memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_map_emplace(
+  pdcpl_variant_map *map,
+  const pdcpl_variant *key,
+  void ***slot,
+  bool *inserted);
+
+/**
+ * Insert a key and value into the map, replacing any existing value.
+ *
+ * @param map Map to insert into
+ * @param key Key to insert
+ * @param value Value to insert
+ * @returns 0 on success, -EINVAL if `map` or `key` are `NULL` or if `key` has
+ *  no known type, -ENOMEM if memory allocation fails
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_map_insert(
+  pdcpl_variant_map *map, const pdcpl_variant *key, void *value);
+
+/**
+ * Remove a key and its value from the map.
+ *
+ * @param map Map to remove from
+ * @param key Key to remove
+ * @returns 0 on success, -EINVAL if `map` or `key` are `NULL`, -ENOENT if the
+ *  key is not in the map
+ */
+PDCPL_PUBLIC int
+pdcpl_variant_map_erase(pdcpl_variant_map *map, const pdcpl_variant *key);
+
+PDCPL_EXTERN_C_END
+
+#endif  // PDCPL_VARIANT_MAP_H_
@@ -0,0 +1,635 @@
+/**
+ * @file variant_value.hh
+ * @author Derek Huang
+ * @brief C++ header for an owning `pdcpl_variant` wrapper
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_VARIANT_VALUE_HH_
+#define PDCPL_VARIANT_VALUE_HH_
+
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "pdcpl/variant.h"
+
+namespace pdcpl {
+
+/**
+ * Intrinsic type of a `pdcpl_variant`.
+ *
+ * Enumerator values are the corresponding `pdcpl_variant` type flags.
+ */
+enum class variant_type : unsigned int {
+  empty = 0U,
+  char_value = pdcpl_variant_char,
+  int_value = pdcpl_variant_int,
+  uint_value = pdcpl_variant_uint,
+  size_value = pdcpl_variant_size,
+  double_value = pdcpl_variant_double,
+  float_value = pdcpl_variant_float,
+  string_value = pdcpl_variant_string,
+  void_value = pdcpl_variant_void
+};
+
+/**
+ * Mask selecting the type flags of a `pdcpl_variant`.
+ */
+inline constexpr unsigned int variant_type_mask = 0xffU;
+
+/**
+ * Read-only view of a `void *` variant buffer.
+ */
+class variant_bytes {
+public:
+  /**
+   * Ctor.
+   *
+   * @param data Buffer address
+   * @param size Number of bytes in buffer
+   */
+  constexpr variant_bytes(const void* data, std::size_t size) noexcept
+    : data_{static_cast<const unsigned char*>(data)}, size_{size}
+  {}
+
+  /**
+   * Return pointer to the first byte.
+   */
+  constexpr auto data() const noexcept { return data_; }
+
+  /**
+   * Return number of bytes.
+   */
+  constexpr auto size() const noexcept { return size_; }
+
+  /**
+   * Check if there are no bytes.
+   */
+  constexpr bool empty() const noexcept { return !size_; }
+
+  /**
+   * Return iterator to the first byte.
+   */
+  constexpr auto begin() const noexcept { return data_; }
+
+  /**
+   * Return iterator one past the last byte.
+   */
+  constexpr auto end() const noexcept { return data_ + size_; }
+
+  /**
+   * Return the byte at the given index.
+   *
+   * @param i Index, must be less than `size()`
+   */
+  constexpr auto operator[](std::size_t i) const noexcept { return data_[i]; }
+
+private:
+  const unsigned char* data_;
+  std::size_t size_;
+};
+
+/**
+ * Traits type mapping a `variant_type` to its C++ value type and accessor.
+ *
+ * @tparam T Variant type
+ */
+template <variant_type T>
+struct variant_traits {};
+
+/**
+ * Define a `variant_traits` specialization for a scalar type.
+ *
+ * @param type_ `variant_type` enumerator
+ * @param value_type_ C++ value type
+ * @param field `pdcpl_variant::data` field
+ */
+#define PDCPL_VARIANT_SCALAR_TRAITS(type_, value_type_, field) \
+  template <> \
+  struct variant_traits<variant_type::type_> { \
+    using value_type = value_type_; \
+    static constexpr auto get(const pdcpl_variant& vt) noexcept \
+    { \
+      return vt.data.field; \
+    } \
+  }
+
+PDCPL_VARIANT_SCALAR_TRAITS(char_value, char, c);
+PDCPL_VARIANT_SCALAR_TRAITS(int_value, int, i);
+PDCPL_VARIANT_SCALAR_TRAITS(uint_value, unsigned int, u);
+PDCPL_VARIANT_SCALAR_TRAITS(size_value, std::size_t, z);
+PDCPL_VARIANT_SCALAR_TRAITS(double_value, double, d);
+PDCPL_VARIANT_SCALAR_TRAITS(float_value, float, f);
+
+#undef PDCPL_VARIANT_SCALAR_TRAITS
+
+/**
+ * `variant_traits` specialization for strings.
+ *
+ * A `NULL` string is viewed as an empty `std::string_view` with null data.
+ */
+template <>
+struct variant_traits<variant_type::string_value> {
+  using value_type = std::string_view;
+  static auto get(const pdcpl_variant& vt) noexcept
+  {
+    return (vt.data.s) ? std::string_view{vt.data.s} : std::string_view{};
+  }
+};
+
+/**
+ * `variant_traits` specialization for `void *` buffers.
+ */
+template <>
+struct variant_traits<variant_type::void_value> {
+  using value_type = variant_bytes;
+  static constexpr auto get(const pdcpl_variant& vt) noexcept
+  {
+    return variant_bytes{vt.data.v.b, vt.data.v.z};
+  }
+};
+
+/**
+ * Value type corresponding to a `variant_type`.
+ *
+ * @tparam T Variant type
+ */
+template <variant_type T>
+using variant_value_t = typename variant_traits<T>::value_type;
+
+/**
+ * Traits type mapping a C++ scalar type to its `variant_type`.
+ *
+ * `std::size_t` maps to `variant_type::size_value` only when it is distinct
+ * from `unsigned int`, otherwise it is treated as `unsigned int`.
+ *
+ * @tparam T C++ type
+ */
+template <typename T, typename = void>
+struct variant_type_of {};
+
+/**
+ * Define a `variant_type_of` specialization.
+ *
+ * @param value_type_ C++ value type
+ * @param type_ `variant_type` enumerator
+ */
+#define PDCPL_VARIANT_TYPE_OF(value_type_, type_) \
+  template <> \
+  struct variant_type_of<value_type_> \
+    : std::integral_constant<variant_type, variant_type::type_> {}
+
+PDCPL_VARIANT_TYPE_OF(char, char_value);
+PDCPL_VARIANT_TYPE_OF(int, int_value);
+PDCPL_VARIANT_TYPE_OF(unsigned int, uint_value);
+PDCPL_VARIANT_TYPE_OF(double, double_value);
+PDCPL_VARIANT_TYPE_OF(float, float_value);
+
+#undef PDCPL_VARIANT_TYPE_OF
+
+/**
+ * `variant_type_of` specialization for `std::size_t`.
+ */
+template <typename T>
+struct variant_type_of<
+  T,
+  std::enable_if_t<
+    std::is_same_v<T, std::size_t> && !std::is_same_v<T, unsigned int>> >
+  : std::integral_constant<variant_type, variant_type::size_value> {};
+
+/**
+ * `variant_type` corresponding to a C++ scalar type.
+ *
+ * @tparam T C++ type
+ */
+template <typename T>
+inline constexpr auto variant_type_v = variant_type_of<T>::value;
+
+namespace detail {
+
+/**
+ * Three-way comparison of two values of a totally ordered type.
+ *
+ * @tparam T Value type
+ */
+template <typename T>
+constexpr int three_way(const T& a, const T& b) noexcept
+{
+  return (b < a) - (a < b);
+}
+
+/**
+ * Three-way comparison of two variants of the same type.
+ *
+ * Floating values order NaN after all other values and treat all NaN values
+ * as equal, while `-0.0` and `+0.0` compare equal. A `NULL` string orders
+ * before all other strings. `void *` buffers order by size, then by bytes.
+ *
+ * @tparam T Variant type shared by both variants
+ */
+template <variant_type T>
+int variant_compare_same(
+  const pdcpl_variant& a, const pdcpl_variant& b) noexcept
+{
+  using traits = variant_traits<T>;
+  if constexpr (T == variant_type::string_value) {
+    if (!a.data.s || !b.data.s)
+      return !!a.data.s - !!b.data.s;
+    return three_way(std::strcmp(a.data.s, b.data.s), 0);
+  }
+  else if constexpr (T == variant_type::void_value) {
+    if (a.data.v.z != b.data.v.z)
+      return three_way(a.data.v.z, b.data.v.z);
+    return three_way(std::memcmp(a.data.v.b, b.data.v.b, a.data.v.z), 0);
+  }
+  else if constexpr (std::is_floating_point_v<typename traits::value_type>) {
+    auto x = traits::get(a);
+    auto y = traits::get(b);
+    if (std::isnan(x) || std::isnan(y))
+      return !!std::isnan(x) - !!std::isnan(y);
+    return three_way(x, y);
+  }
+  else
+    return three_way(traits::get(a), traits::get(b));
+}
+
+/**
+ * Three-way comparison function pointer type.
+ */
+using variant_compare_function = int (*)(
+  const pdcpl_variant&, const pdcpl_variant&) noexcept;
+
+/**
+ * Comparison function table indexed by type flag.
+ *
+ * Since each type flag is a distinct power of two below 256, indexing by the
+ * masked flags selects the right template instantiation in a single load.
+ */
+inline constexpr auto variant_compare_table = []
+{
+  std::array<variant_compare_function, variant_type_mask + 1> table{};
+  table[pdcpl_variant_char] = variant_compare_same<variant_type::char_value>;
+  table[pdcpl_variant_int] = variant_compare_same<variant_type::int_value>;
+  table[pdcpl_variant_uint] = variant_compare_same<variant_type::uint_value>;
+  table[pdcpl_variant_size] = variant_compare_same<variant_type::size_value>;
+  table[pdcpl_variant_double] =
+    variant_compare_same<variant_type::double_value>;
+  table[pdcpl_variant_float] = variant_compare_same<variant_type::float_value>;
+  table[pdcpl_variant_string] =
+    variant_compare_same<variant_type::string_value>;
+  table[pdcpl_variant_void] = variant_compare_same<variant_type::void_value>;
+  return table;
+}();
+
+}  // namespace detail
+
+/**
+ * Owning, move-only C++ wrapper for a `pdcpl_variant`.
+ *
+ * The wrapped variant is freed with `pdcpl_variant_free` on destruction. Moves
+ * just copy the C struct and empty the source, so they never allocate, never
+ * throw, and are as cheap as a `memcpy`, which lets standard containers
+ * relocate elements with moves. Copies must be requested with `copy()`.
+ *
+ * Comparison defines a total order: variants first order by type, in order of
+ * their type flags, with empty variants first, and then by value. Equality is
+ * exact and consistent with `pdcpl_variant_equal` and `pdcpl_variant_hash`.
+ */
+class variant_value {
+public:
+  /**
+   * Default ctor.
+   *
+   * Creates an empty variant.
+   */
+  variant_value() noexcept : value_{} {}
+
+  /**
+   * Ctor.
+   *
+   * Constructs from a scalar value.
+   *
+   * @tparam T Scalar type with a `variant_type_of` specialization
+   *
+   * @param value Value
+   */
+  template <typename T, typename = decltype(variant_type_of<T>::value)>
+  variant_value(T value) noexcept : value_{}
+  {
+    value_.flags = static_cast<unsigned int>(variant_type_v<T>);
+    set(value);
+  }
+
+  /**
+   * Ctor.
+   *
+   * Constructs an owned string by copying the contents of `str`.
+   *
+   * @param str String to copy
+   */
+  explicit variant_value(std::string_view str) : value_{}
+  {
+    auto buf = static_cast<char*>(std::malloc(str.size() + 1));
+    if (!buf)
+      throw std::bad_alloc{};
+    std::memcpy(buf, str.data(), str.size());
+    buf[str.size()] = '\0';
+    value_.flags = pdcpl_variant_string | pdcpl_variant_mem_own;
+    value_.data.s = buf;
+  }
+
+  /**
+   * Ctor.
+   *
+   * Constructs an owned string from a null-terminated string.
+   *
+   * @param str String to copy
+   * @throws std::invalid_argument if `str` is `nullptr`
+   */
+  explicit variant_value(const char* str)
+    : variant_value{
+        (str) ?
+          std::string_view{str} :
+          throw std::invalid_argument{"variant_value: null string"}
+      }
+  {}
+
+  /**
+   * Ctor.
+   *
+   * Constructs an owned `void *` buffer by copying the given bytes.
+   *
+   * @param data Buffer to copy
+   * @param size Number of bytes to copy, must be positive
+   */
+  variant_value(const void* data, std::size_t size) : value_{}
+  {
+    handle_status(PDCPL_VARIANT_INIT(void)(&value_, data, size));
+  }
+
+  /**
+   * Deleted copy ctor.
+   */
+  variant_value(const variant_value&) = delete;
+
+  /**
+   * Move ctor.
+   *
+   * @param other Variant to move from, left empty
+   */
+  variant_value(variant_value&& other) noexcept : value_{other.release()} {}
+
+  /**
+   * Dtor.
+   */
+  ~variant_value()
+  {
+    pdcpl_variant_free(&value_);
+  }
+
+  /**
+   * Deleted copy assignment operator.
+   */
+  variant_value& operator=(const variant_value&) = delete;
+
+  /**
+   * Move assignment operator.
+   *
+   * @param other Variant to move from, left empty
+   */
+  variant_value& operator=(variant_value&& other) noexcept
+  {
+    if (this != &other) {
+      pdcpl_variant_free(&value_);
+      value_ = other.release();
+    }
+    return *this;
+  }
+
+  /**
+   * Take ownership of an existing C variant.
+   *
+   * Borrowed variants, e.g. from `pdcpl_variant_init_string_ref` or from
+   * `pdcpl_variant_decode`, can be wrapped as well and will not be freed.
+   *
+   * @param value Variant to take ownership of
+   */
+  static variant_value wrap(pdcpl_variant value) noexcept
+  {
+    variant_value vv;
+    vv.value_ = value;
+    return vv;
+  }
+
+  /**
+   * Return a deep copy of the variant.
+   *
+   * Strings and buffers are always copied into owned memory.
+   */
+  variant_value copy() const
+  {
+    variant_value vv;
+    if (!empty())
+      handle_status(pdcpl_variant_copy(&vv.value_, &value_));
+    return vv;
+  }
+
+  /**
+   * Release ownership of the C variant.
+   *
+   * The variant is left empty and the caller becomes responsible for calling
+   * `pdcpl_variant_free` on the returned variant.
+   */
+  pdcpl_variant release() noexcept
+  {
+    auto value = value_;
+    value_ = pdcpl_variant{};
+    return value;
+  }
+
+  /**
+   * Return const reference to the C variant.
+   */
+  const auto& c_variant() const noexcept { return value_; }
+
+  /**
+   * Return the variant type.
+   */
+  auto type() const noexcept
+  {
+    return static_cast<variant_type>(value_.flags & variant_type_mask);
+  }
+
+  /**
+   * Check if the variant is empty.
+   */
+  bool empty() const noexcept { return type() == variant_type::empty; }
+
+  /**
+   * Check if the variant is not empty.
+   */
+  explicit operator bool() const noexcept { return !empty(); }
+
+  /**
+   * Check if the variant owns its string or buffer memory.
+   */
+  bool owns_memory() const noexcept
+  {
+    return !!(value_.flags & pdcpl_variant_mem_own);
+  }
+
+  /**
+   * Check if the variant holds the given type.
+   *
+   * @tparam T Variant type
+   */
+  template <variant_type T>
+  bool holds() const noexcept { return type() == T; }
+
+  /**
+   * Return the value held by the variant.
+   *
+   * Strings are returned as `std::string_view` and `void *` buffers are
+   * returned as `variant_bytes`, both viewing the variant's memory.
+   *
+   * @tparam T Variant type
+   * @throws std::bad_variant_access if the variant does not hold `T`
+   */
+  template <variant_type T>
+  variant_value_t<T> get() const
+  {
+    if (!holds<T>())
+      throw std::bad_variant_access{};
+    return variant_traits<T>::get(value_);
+  }
+
+  /**
+   * Return the string view of a string variant.
+   *
+   * @throws std::bad_variant_access if the variant is not a string
+   */
+  auto as_string() const { return get<variant_type::string_value>(); }
+
+  /**
+   * Return the byte view of a `void *` buffer variant.
+   *
+   * @throws std::bad_variant_access if the variant is not a buffer
+   */
+  auto as_bytes() const { return get<variant_type::void_value>(); }
+
+  /**
+   * Three-way comparison with another variant.
+   *
+   * @param other Variant to compare to
+   * @returns < 0 if `*this` orders first, > 0 if `other` orders first, 0 if
+   *  the two variants are equal
+   */
+  int compare(const variant_value& other) const noexcept
+  {
+    auto ta = value_.flags & variant_type_mask;
+    auto tb = other.value_.flags & variant_type_mask;
+    if (ta != tb)
+      return detail::three_way(ta, tb);
+    // valid type flags always have a table entry
+    auto compare_fn = detail::variant_compare_table[ta];
+    return (compare_fn) ? compare_fn(value_, other.value_) : 0;
+  }
+
+  /**
+   * Return the hash of the variant.
+   */
+  auto hash() const noexcept { return pdcpl_variant_hash(&value_); }
+
+private:
+  pdcpl_variant value_;
+
+  /**
+   * Throw an appropriate exception for a negative `errno` status.
+   *
+   * @param status Status returned from a `pdcpl_variant` function
+   */
+  static void handle_status(int status)
+  {
+    if (status == -ENOMEM)
+      throw std::bad_alloc{};
+    if (status)
+      throw std::invalid_argument{"invalid pdcpl_variant operation"};
+  }
+
+  /**
+   * Set the scalar value of the variant.
+   *
+   * @tparam T Scalar type
+   *
+   * @param value Value
+   */
+  template <typename T>
+  void set(T value) noexcept
+  {
+    constexpr auto type = variant_type_v<T>;
+    if constexpr (type == variant_type::char_value)
+      value_.data.c = value;
+    else if constexpr (type == variant_type::int_value)
+      value_.data.i = value;
+    else if constexpr (type == variant_type::uint_value)
+      value_.data.u = value;
+    else if constexpr (type == variant_type::size_value)
+      value_.data.z = value;
+    else if constexpr (type == variant_type::double_value)
+      value_.data.d = value;
+    else
+      value_.data.f = value;
+  }
+};
+
+/**
+ * Define a `variant_value` comparison operator in terms of `compare`.
+ *
+ * @param op Comparison operator
+ */
+#define PDCPL_VARIANT_VALUE_COMPARE_OP(op) \
+  inline bool operator op(const variant_value& a, const variant_value& b) \
+    noexcept \
+  { \
+    return a.compare(b) op 0; \
+  }
+
+PDCPL_VARIANT_VALUE_COMPARE_OP(==)
+PDCPL_VARIANT_VALUE_COMPARE_OP(!=)
+PDCPL_VARIANT_VALUE_COMPARE_OP(<)
+PDCPL_VARIANT_VALUE_COMPARE_OP(<=)
+PDCPL_VARIANT_VALUE_COMPARE_OP(>)
+PDCPL_VARIANT_VALUE_COMPARE_OP(>=)
+
+#undef PDCPL_VARIANT_VALUE_COMPARE_OP
+
+}  // namespace pdcpl
+
+namespace std {
+
+/**
+ * `std::hash` specialization for `pdcpl::variant_value`.
+ */
+template <>
+struct hash<pdcpl::variant_value> {
+  auto operator()(const pdcpl::variant_value& value) const noexcept
+  {
+    return static_cast<std::size_t>(value.hash());
+  }
+};
+
+}  // namespace std
+
+#endif  // PDCPL_VARIANT_VALUE_HH_
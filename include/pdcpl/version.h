@@ -0,0 +1,53 @@
+/**
+ * @file version.h
+ * @author Derek Huang
+ * @brief C/C++ header for project version macros
+ */
+
+#ifndef PDCPL_VERSION_H_
+#define PDCPL_VERSION_H_
+
+/**
+ * Project major version.
+ */
+#define PDCPL_VERSION_MAJOR 0
+
+/**
+ * Project minor version.
+ */
+#define PDCPL_VERSION_MINOR 1
+
+/**
+ * Project patch version.
+ */
+#define PDCPL_VERSION_PATCH 0
+
+/**
+ * Project version string.
+ *
+ * @note Could be constructed by concatenating the major, minor, patch versions
+ *  and then stringifying. The requisite macros are in `common.h`.
+ */
+#define PDCPL_VERSION_STRING "0.1.0"
+
+/**
+ * Project build type.
+ */
+#define PDCPL_BUILD_TYPE "Debug"
+
+/**
+ * Project target OS name.
+ */
+#define PDCPL_SYSTEM_NAME "Linux"
+
+/**
+ * Project target system version.
+ */
+#define PDCPL_SYSTEM_VERSION "6.18.44-fc-v139"
+
+/**
+ * Project target system architecture.
+ */
+#define PDCPL_SYSTEM_ARCH "x86_64"
+
+#endif  // PDCPL_VERSION_H_
@@ -13,6 +13,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
 
 PDCPL_PROGRAM_USAGE_DEF
@@ -30,15 +31,15 @@ PDCPL_PROGRAM_USAGE_DEF
 PDCPL_ARG_MAIN
 {
   PDCPL_PARSE_PROGRAM_OPTIONS();
-  // getchar() output
+  // input char
   int c;
   // loop for each character
-  while ((c = getchar()) != EOF) {
+  while ((c = pdcpl_stats_getc(stdin)) != EOF) {
     // print escaped string for tab, backspace, backslash
     if (c == '\t' || c == '\b' || c == '\\')
-      printf("%s", pdcpl_stresc(c));
+      pdcpl_stats_puts(pdcpl_stresc(c), stdout);
     else
-      putchar(c);
+      pdcpl_stats_putc(c, stdout);
   }
   return EXIT_SUCCESS;
 }
@@ -14,6 +14,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
 
 PDCPL_PROGRAM_USAGE_DEF
@@ -33,16 +34,16 @@ PDCPL_PROGRAM_USAGE_DEF
 PDCPL_ARG_MAIN
 {
   PDCPL_PARSE_PROGRAM_OPTIONS();
-  // getchar() output, number of words counted
+  // input char, number of words counted
   int c;
   size_t n_words = 0;
   // word in/out indicator and indicator for if we just exited a word. this
   // allows us to not print newlines for each whitespace.
   bool in_word = false, just_exited = false;
-  while ((c = getchar()) != EOF) {
+  while ((c = pdcpl_stats_getc(stdin)) != EOF) {
     // don't print whitespace
     if (!isspace(c))
-      putchar(c);
+      pdcpl_stats_putc(c, stdout);
     // after macro call, in_word is either true or false
     PDCPL_WC_CHECK_WORD(c, in_word, n_words);
     // if in_word true (in word), we set just_exited to false. if false and we
@@ -51,7 +52,7 @@ PDCPL_ARG_MAIN
       just_exited = false;
     // no need to test !in_word, in_word is false already in this branch
     else if (!just_exited) {
-      putchar('\n');
+      pdcpl_stats_putc('\n', stdout);
       just_exited = true;
     }
   }
@@ -11,6 +11,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
 
 PDCPL_PROGRAM_USAGE_DEF
@@ -56,7 +57,7 @@ PDCPL_ARG_MAIN
   }
   // print out the max line (max_line NULL otherwise), free out of habit
   if (max_line)
-    printf("%s\n%zu chars\n", max_line, max_len);
+    pdcpl_stats_written(printf("%s\n%zu chars\n", max_line, max_len));
   free(max_line);
   return EXIT_SUCCESS;
 }
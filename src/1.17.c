@@ -11,6 +11,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
 
 PDCPL_PROGRAM_USAGE_DEF
@@ -35,7 +36,7 @@ PDCPL_ARG_MAIN
       return EXIT_FAILURE;
     // print if greater than 80 chars in length + free
     if (len > 80)
-      printf("%s\n", line);
+      pdcpl_stats_written(printf("%s\n", line));
     free(line);
   }
   return EXIT_SUCCESS;
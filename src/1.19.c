@@ -10,6 +10,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
 
 PDCPL_PROGRAM_USAGE_DEF
@@ -40,7 +41,7 @@ PDCPL_ARG_MAIN
       return EXIT_FAILURE;
     // no more need for the original, print the reversed one + free
     free(line);
-    printf("%s\n", line_r);
+    pdcpl_stats_written(printf("%s\n", line_r));
     free(line_r);
   }
   return EXIT_SUCCESS;
@@ -11,7 +11,9 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/memory.h"
 #include "pdcpl/misc.h"
+#include "pdcpl/stats.h"
 
 // lower, upper, and step for celenheit values
 #define CEL_LOWER 0
@@ -30,13 +32,21 @@ PDCPL_PROGRAM_USAGE_DEF
 PDCPL_ARG_MAIN
 {
   PDCPL_PARSE_PROGRAM_OPTIONS();
-  printf(
-    "+--------+--------+\n"
-    "|     C. |     F. |\n"
-    "+--------+--------+\n"
+  // format the whole table at once and write it with a single call
+  pdcpl_convtable_spec spec = {
+    {"C.", 6, 0},
+    {"F.", 6, 1},
+    CEL_LOWER,
+    CEL_UPPER,
+    CEL_STEP,
+    pdcpl_c2ftemp_array
+  };
+  pdcpl_buffer table;
+  size_t table_size;
+  PDCPL_MAIN_ERRNO_EXIT(pdcpl_convtable_format(&spec, &table, &table_size));
+  pdcpl_stats_add(
+    PDCPL_STATS_BYTES_WRITTEN, fwrite(table.data, 1, table_size, stdout)
   );
-  for (int cel = CEL_LOWER; cel <= CEL_UPPER; cel += CEL_STEP)
-    printf("| %6.0f | %6.1f |\n", (double) cel, pdcpl_c2ftemp(cel));
-  printf("+--------+--------+\n");
+  pdcpl_buffer_clear(&table);
   return EXIT_SUCCESS;
 }
@@ -11,7 +11,9 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/memory.h"
 #include "pdcpl/misc.h"
+#include "pdcpl/stats.h"
 
 // lower, upper, and step for Fahrenheit values
 #define FAHR_LOWER 0
@@ -30,13 +32,21 @@ PDCPL_PROGRAM_USAGE_DEF
 PDCPL_ARG_MAIN
 {
   PDCPL_PARSE_PROGRAM_OPTIONS();
-  printf(
-    "+--------+--------+\n"
-    "|     F. |     C. |\n"
-    "+--------+--------+\n"
+  // format the whole table at once and write it with a single call
+  pdcpl_convtable_spec spec = {
+    {"F.", 6, 0},
+    {"C.", 6, 1},
+    FAHR_UPPER,
+    FAHR_LOWER,
+    -FAHR_STEP,
+    pdcpl_f2ctemp_array
+  };
+  pdcpl_buffer table;
+  size_t table_size;
+  PDCPL_MAIN_ERRNO_EXIT(pdcpl_convtable_format(&spec, &table, &table_size));
+  pdcpl_stats_add(
+    PDCPL_STATS_BYTES_WRITTEN, fwrite(table.data, 1, table_size, stdout)
   );
-  for (int fahr = FAHR_UPPER; fahr >= FAHR_LOWER; fahr -= FAHR_STEP)
-    printf("| %6.0f | %6.1f |\n", (double) fahr, pdcpl_f2ctemp(fahr));
-  printf("+--------+--------+\n");
+  pdcpl_buffer_clear(&table);
   return EXIT_SUCCESS;
 }
@@ -5,33 +5,50 @@
  * @copyright MIT License
  */
 
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#define PDCPL_HAS_PROGRAM_INPUTS
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 
 PDCPL_PROGRAM_USAGE_DEF
 (
-  "Prints the number of blanks, tabs, and newlines read from stdin.\n"
+  "Prints the number of blanks, tabs, and newlines read from stdin or files.\n"
   "\n"
   "Results are displayed with the total character count in wc style, except\n"
   "with column headers. E.g. if `printf \"\\t\\nhello my name is dan\"' were\n"
   "piped into this program, one would get output like\n"
   "\n"
   "   blanks      tabs  newlines     total\n"
-  "        4         1         1        22"
+  "        4         1         1        22\n"
+  "\n"
+  "If files are given, the header is printed once and each file's counts are\n"
+  "printed on their own line followed by the file name."
 )
 
-PDCPL_ARG_MAIN
+/**
+ * Count blanks, tabs, newlines, and total characters in a stream.
+ *
+ * @param in Input stream
+ * @param out Output stream
+ * @param path Input stream path
+ * @param ctx `bool *` indicating whether to print the path after the counts
+ * @returns 0 on success, -EIO on read error
+ */
+static int
+count_stream(FILE *in, FILE *out, const char *path, void *ctx)
 {
-  PDCPL_PARSE_PROGRAM_OPTIONS();
-  // getchar() output + number of blanks, tabs, newlines, total characters
+  // getc() output + number of blanks, tabs, newlines, total characters
   int c;
   size_t nb = 0, nt = 0, nn = 0, nc = 0;
   // loop for each character
-  while ((c = getchar()) != EOF) {
+  while ((c = getc(in)) != EOF) {
     switch (c) {
       case ' ':
         nb++;
@@ -45,10 +62,25 @@ PDCPL_ARG_MAIN
     }
     nc++;
   }
-  // print out wc-style summary (but with headers)
-  printf(
-    "   blanks      tabs  newlines     total\n%9zu %9zu %9zu %9zu\n",
-    nb, nt, nn, nc
-  );
+  if (ferror(in))
+    return -EIO;
+  pdcpl_stats_add(PDCPL_STATS_BYTES_READ, nc);
+  pdcpl_stats_add(PDCPL_STATS_LINES, nn);
+  // print out wc-style counts, with path if requested
+  pdcpl_stats_written(fprintf(out, "%9zu %9zu %9zu %9zu", nb, nt, nn, nc));
+  if (*((const bool *) ctx))
+    pdcpl_stats_written(fprintf(out, " %s", path));
+  pdcpl_stats_putc('\n', out);
+  return 0;
+}
+
+PDCPL_ARG_MAIN
+{
+  PDCPL_PARSE_PROGRAM_OPTIONS();
+  // print wc-style headers once, with paths only if files were given
+  bool print_path = PDCPL_PROGRAM_N_INPUTS;
+  pdcpl_stats_written(printf("   blanks      tabs  newlines     total\n"));
+  if (PDCPL_PROGRAM_RUN_INPUTS(count_stream, &print_path))
+    return EXIT_FAILURE;
   return EXIT_SUCCESS;
 }
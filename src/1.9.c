@@ -13,6 +13,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 
 PDCPL_PROGRAM_USAGE_DEF
 (
@@ -27,11 +28,11 @@ PDCPL_PROGRAM_USAGE_DEF
 PDCPL_ARG_MAIN
 {
   PDCPL_PARSE_PROGRAM_OPTIONS();
-  // getchar() output + indicator if we saw a blank or not
+  // input char + indicator if we saw a blank or not
   int c;
   bool got_blank = false;
   // loop for each character
-  while ((c = getchar()) != EOF) {
+  while ((c = pdcpl_stats_getc(stdin)) != EOF) {
     // if got a blank, set got_blank to true, otherwise set to false
     if (c == ' ') {
       // if got_blank is already true, don't print
@@ -42,7 +43,7 @@ PDCPL_ARG_MAIN
     else
       got_blank = false;
     // print the character as usual
-    putchar(c);
+    pdcpl_stats_putc(c, stdout);
   }
   return EXIT_SUCCESS;
 }
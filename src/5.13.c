@@ -5,14 +5,17 @@
  * @copyright MIT License
  */
 
+#include <errno.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#define PDCPL_HAS_PROGRAM_INPUTS
 #define PDCPL_HAS_PROGRAM_USAGE
 #define PDCPL_HAS_PROGRAM_OPTIONS
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
 
 static unsigned int lines_target = 10;
@@ -35,7 +38,7 @@ PDCPL_CLIOPT_ACTION(lines_action)
 
 PDCPL_PROGRAM_USAGE_DEF
 (
-  "A minimal tail clone reading only from stdin.\n"
+  "A minimal tail clone reading from stdin or files.\n"
   "\n"
   "Any line with size less than SIZE_MAX can be consumed properly. The\n"
   "program keeps a rolling window of the last few lines through a block of\n"
@@ -46,7 +49,10 @@ PDCPL_PROGRAM_USAGE_DEF
   "possible the contiguous storage is more cache friendly and so faster.\n"
   "\n"
   "Note that input with a trailing newline will count as having an extra\n"
-  "empty line. Some additional logic could be added to handle this case."
+  "empty line. Some additional logic could be added to handle this case.\n"
+  "\n"
+  "If multiple files are given, each file's lines are preceded by a header\n"
+  "line of the form ==> FILE <==, with headers separated by a blank line."
 )
 
 PDCPL_PROGRAM_OPTIONS_DEF
@@ -61,48 +67,75 @@ PDCPL_PROGRAM_OPTIONS_DEF
   PDCPL_PROGRAM_OPTIONS_END
 };
 
-PDCPL_ARG_MAIN
+/**
+ * Print the last `lines_target` lines of a stream.
+ *
+ * @param in Input stream
+ * @param out Output stream
+ * @param path Input stream path
+ * @param ctx Unused
+ * @returns 0 on success, -ENOMEM on allocation failure, other negative errno
+ *  value on read error
+ */
+static int
+tail_stream(FILE *in, FILE *out, const char *path, void *ctx)
 {
-  PDCPL_PARSE_PROGRAM_OPTIONS();
+  (void) ctx;
+  // print file header if there are multiple files. since the first input's
+  // path is also the first paths[] pointer, comparing pointers is enough
+  if (PDCPL_PROGRAM_N_INPUTS > 1)
+    pdcpl_stats_written(
+      fprintf(
+        out,
+        "%s==> %s <==\n",
+        (path == PDCPL_PROGRAM_INPUTS[0]) ? "" : "\n",
+        path
+      )
+    );
   // lines read + block of lines_target char * we use to store the lines
   size_t n_read = 0;
   char **lines = malloc(lines_target * sizeof *lines);
-  if (!lines) {
-    PDCPL_PRINT_ERROR("ENOMEM\n");
-    return EXIT_FAILURE;
-  }
-  // get lines, filling the lines buffer + exit on error
+  if (!lines)
+    return -ENOMEM;
+  // get lines, filling the lines buffer + stop on error
   int status;
   for (; n_read < lines_target; n_read++) {
-    // handle error if any
-    if ((status = pdcpl_getline(stdin, lines + n_read, NULL))) {
-      PDCPL_PRINT_ERROR_EX("%s\n", strerror(status));
-      return EXIT_FAILURE;
-    }
+    if ((status = pdcpl_getline(in, lines + n_read, NULL)))
+      goto done;
     // if *(lines + n_read) is NULL, no more lines to get, so break
     if (!*(lines + n_read))
       break;
   }
   // now buffer is full, so rotate for each read (no-op if done reading)
   char *cur_line;
-  while (status = pdcpl_getline(stdin, &cur_line, NULL), cur_line) {
-    if (status) {
-      PDCPL_PRINT_ERROR_EX("%s\n", strerror(status));
-      return EXIT_FAILURE;
-    }
+  while (status = pdcpl_getline(in, &cur_line, NULL), cur_line) {
+    if (status)
+      goto done;
     // free unneeded line, rotate lines, insert new line
     free(lines[0]);
     for (size_t i = 1; i < lines_target; i++)
       lines[i - 1] = lines[i];
     lines[lines_target - 1] = cur_line;
   }
-  // done, so print + free all the lines before freeing the char * block. since
-  // n_read can be less than lines_target, just use the minimum
-  size_t n_write = (n_read < lines_target) ? n_read : lines_target;
-  for (size_t i = 0; i < n_write; i++) {
-    printf("%s\n", lines[i]);
-    free(lines[i]);
+done:
+  // print + free all the lines before freeing the char * block. since n_read
+  // can be less than lines_target, just use the minimum
+  {
+    size_t n_write = (n_read < lines_target) ? n_read : lines_target;
+    for (size_t i = 0; i < n_write; i++) {
+      if (!status)
+        pdcpl_stats_written(fprintf(out, "%s\n", lines[i]));
+      free(lines[i]);
+    }
   }
   free(lines);
+  return status;
+}
+
+PDCPL_ARG_MAIN
+{
+  PDCPL_PARSE_PROGRAM_OPTIONS();
+  if (PDCPL_PROGRAM_RUN_INPUTS(tail_stream, NULL))
+    return EXIT_FAILURE;
   return EXIT_SUCCESS;
 }
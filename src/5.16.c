@@ -17,13 +17,17 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define PDCPL_HAS_PROGRAM_USAGE
 #define PDCPL_HAS_PROGRAM_OPTIONS
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
 #include "pdcpl/memory.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
+#include "pdcpl/strtod.h"
+#include "pdcpl/trace.h"
 
 /**
  * Number of lines to expand line buffer by on each reallocation.
@@ -254,39 +258,86 @@ strptr_lcmp_r(const char **a, const char **b)
 }
 
 /**
- * Compare two strings by their `atof` double value.
+ * Line with its precomputed numeric sort key.
+ *
+ * Parsing each line once up front avoids converting both lines on each of the
+ * O(n log n) comparisons made while sorting.
+ *
+ * @param key Numeric value of the line, as `atof` would return
+ * @param line Line string
+ */
+typedef struct {
+  double key;
+  char *line;
+} numeric_line;
+
+/**
+ * Compare two lines by their precomputed `atof` double value.
  *
  * Clone of `numcmp` from section 5.11 in book, page 121.
  *
- * @param a Address of first string
- * @param b Address of second string
- * @returns -1 if `atof(*a)` is less than `atof(*b)`, 0 if the `atof` values
- *  are equal, 1 when `atof(*b)` is less than `atof(*a)`
+ * @param a Address of first line
+ * @param b Address of second line
+ * @returns -1 if `a->key` is less than `b->key`, 0 if the keys are equal, 1
+ *  when `b->key` is less than `a->key`
  */
 static int
-strptr_ncmp(const char **a, const char **b)
+numeric_line_cmp(const numeric_line *a, const numeric_line *b)
 {
-  double va = atof(*a);
-  double vb = atof(*b);
-  if (va < vb)
+  if (a->key < b->key)
     return -1;
-  if (vb < va)
+  if (b->key < a->key)
     return 1;
   return 0;
 }
 
 /**
- * Compare two strings in reverse by their `atof` double value.
+ * Compare two lines in reverse by their precomputed `atof` double value.
  *
- * @param a Address of first string
- * @param b Address of second string
- * @returns -1 if `atof(*b)` is less than `atof(*a)`, 0 if the `atof` values
- *  are equal, 1 when `atof(*a)` is less than `atof(*b)`
+ * @param a Address of first line
+ * @param b Address of second line
+ * @returns -1 if `b->key` is less than `a->key`, 0 if the keys are equal, 1
+ *  when `a->key` is less than `b->key`
  */
 static inline int
-strptr_ncmp_r(const char **a, const char **b)
+numeric_line_cmp_r(const numeric_line *a, const numeric_line *b)
 {
-  return -strptr_ncmp(a, b);
+  return -numeric_line_cmp(a, b);
+}
+
+/**
+ * Sort lines by their numeric value.
+ *
+ * Each line is converted once with `pdcpl_strtod_fast`, which gives the same
+ * value as `atof` in the `"C"` locale, with 0 used if there is no number.
+ *
+ * @param lines Array of lines to sort in place
+ * @param n_lines Number of lines
+ * @param rev_sort `true` to sort in reverse, `false` not to
+ * @returns 0 on success, -ENOMEM if memory allocation fails
+ */
+static int
+numeric_sort(char **lines, size_t n_lines, bool rev_sort)
+{
+  pdcpl_buffer keybuf = pdcpl_buffer_new(n_lines * sizeof(numeric_line));
+  if (!pdcpl_buffer_ready(&keybuf))
+    return -ENOMEM;
+  numeric_line *keyed = (numeric_line *) keybuf.data;
+  for (size_t i = 0; i < n_lines; i++) {
+    // on no conversion, key is 0, as with atof
+    pdcpl_strtod_fast(lines[i], strlen(lines[i]), &keyed[i].key);
+    keyed[i].line = lines[i];
+  }
+  qsort(
+    keyed,
+    n_lines,
+    sizeof(numeric_line),
+    (rev_sort) ? (qsort_cmp) numeric_line_cmp_r : (qsort_cmp) numeric_line_cmp
+  );
+  for (size_t i = 0; i < n_lines; i++)
+    lines[i] = keyed[i].line;
+  pdcpl_buffer_clear(&keybuf);
+  return 0;
 }
 
 /**
@@ -400,10 +451,12 @@ strptr_ldcmp_r(const char **a, const char **b)
 /**
  * Determine which `qsort` compare function should be used.
  *
+ * `SORT_MODE_NUMERIC` is not handled here, as `numeric_sort` is used instead.
+ *
  * @param out Address to a `qsort_cmp` to use as the compare function
  * @param mode Program sort mode
  * @param rev_sort `true` to sort in reverse, `false` not to
- * @returns 0 on success, -EINVAL if `out` is `NULL`
+ * @returns 0 on success, -EINVAL if `out` is `NULL` or `mode` is not valid
  */
 static int
 set_qsort_cmp(qsort_cmp *out, sort_mode mode, bool rev_sort)
@@ -417,9 +470,6 @@ set_qsort_cmp(qsort_cmp *out, sort_mode mode, bool rev_sort)
     case SORT_MODE_DEFAULT_IGNORE_CASE:
       *out = (rev_sort) ? (qsort_cmp) strptr_lcmp_r : (qsort_cmp) strptr_lcmp;
       break;
-    case SORT_MODE_NUMERIC:
-      *out = (rev_sort) ? (qsort_cmp) strptr_ncmp_r : (qsort_cmp) strptr_ncmp;
-      break;
     case SORT_MODE_DIRECTORY:
       *out = (rev_sort) ? (qsort_cmp) strptr_dcmp_r : (qsort_cmp) strptr_dcmp;
       break;
@@ -449,6 +499,7 @@ PDCPL_ARG_MAIN
   size_t n_lines;
   char *line;
   // read the lines until there are no more
+  PDCPL_TRACE_BEGIN(read_start);
   for (n_lines = 0; ; n_lines++) {
     // handle line reading error + break if no lines to read
     ERRNO_EXIT(pdcpl_getline(stdin, &line, NULL));
@@ -461,19 +512,34 @@ PDCPL_ARG_MAIN
     // treat the buffer as a char ** to store the line strings
     PDCPL_INDEX((char **) linebuf.data, n_lines) = line;
   }
+  PDCPL_TRACE_END(read_start, "sort_read");
+  PDCPL_TRACE_COUNTER("sort_lines", (int64_t) n_lines);
   // if no lines, just exit, otherwise realloc linebuf to n_lines lines
   if (!n_lines)
     return EXIT_SUCCESS;
   ERRNO_EXIT(pdcpl_buffer_realloc(&linebuf, n_lines * sizeof(char **)));
-  // set compare function according to options
-  qsort_cmp cmp;
-  ERRNO_EXIT(set_qsort_cmp(&cmp, sort_program_mode, reverse_target));
-  qsort(linebuf.data, n_lines, sizeof(char **), cmp);
+  PDCPL_TRACE_BEGIN(sort_start);
+  // numeric sort precomputes keys, otherwise set compare function according
+  // to options and sort the lines directly
+  if (sort_program_mode == SORT_MODE_NUMERIC)
+    ERRNO_EXIT(
+      numeric_sort((char **) linebuf.data, n_lines, reverse_target)
+    );
+  else {
+    qsort_cmp cmp;
+    ERRNO_EXIT(set_qsort_cmp(&cmp, sort_program_mode, reverse_target));
+    qsort(linebuf.data, n_lines, sizeof(char **), cmp);
+  }
+  PDCPL_TRACE_END(sort_start, "sort_sort");
   // print out + free the lines stored in linebuf's data pointer
+  PDCPL_TRACE_BEGIN(print_start);
   for (size_t i = 0; i < n_lines; i++) {
-    printf("%s\n", PDCPL_INDEX((char **) linebuf.data, i));
+    pdcpl_stats_written(
+      printf("%s\n", PDCPL_INDEX((char **) linebuf.data, i))
+    );
     free(PDCPL_INDEX((char **) linebuf.data, i));
   }
+  PDCPL_TRACE_END(print_start, "sort_print");
   // clean up line buffer + exit
   pdcpl_buffer_clear(&linebuf);
   return EXIT_SUCCESS;
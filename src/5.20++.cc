@@ -5,16 +5,21 @@
  * @copyright MIT License
  */
 
+#include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 
+#define PDCPL_HAS_PROGRAM_INPUTS
 #define PDCPL_HAS_PROGRAM_USAGE
 #define PDCPL_HAS_PROGRAM_OPTIONS
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
 
+#include "pdcpl/cdcl_batch_parser.hh"
 #include "pdcpl/cdcl_parser.hh"
+#include "pdcpl/trace.hh"
 
 /**
  * Static globals set during program option parsing.
@@ -22,6 +27,7 @@
 static std::filesystem::path input_path;
 static bool trace_lexer = false;
 static bool trace_parser = false;
+static bool check_redeclared = true;
 
 /**
  * Action to get the specified input path if provided.
@@ -63,6 +69,17 @@ PDCPL_CLIOPT_ACTION(trace_parser_action)
   return PDCPL_CLIOPT_PARSE_OK;
 }
 
+/**
+ * Action to disable checking for redeclared identifiers.
+ */
+static
+PDCPL_CLIOPT_ACTION(allow_redeclared_action)
+{
+  PDCPL_CLIOPT_ACTION_NO_WARN_UNUSED
+  check_redeclared = false;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
 /**
  * Acttion to determine whether or not to enable full parser tracing.
  */
@@ -84,8 +101,15 @@ PDCPL_PROGRAM_USAGE_DEF
   "struct, array, pointer and arbitrary types in the declarations, as well as\n"
   "cv-qualifiers and storage specifiers. Function parameters need not be named.\n"
   "\n"
-  "Currently, the descriptions for each declaration are not printed in their\n"
-  "order of appearance in the input. This may change in a later version."
+  "The description of each declaration is printed as soon as it is parsed, in\n"
+  "order of appearance in the input, so arbitrarily large input can be piped\n"
+  "through. Only a hash of each identifier is kept to detect redeclarations,\n"
+  "which can be disabled with -r so memory use does not grow with the input.\n"
+  "\n"
+  "If FILE arguments are given, they are parsed in parallel using -j jobs and\n"
+  "their declarations merged, each identifier declared at most once across\n"
+  "all the files. Any -i input file is parsed first. Tracing is only\n"
+  "supported when parsing a single input with -i or from stdin."
 )
 
 PDCPL_PROGRAM_OPTIONS_DEF
@@ -99,6 +123,14 @@ PDCPL_PROGRAM_OPTIONS_DEF
     input_path_action,
     NULL
   },
+  {
+    "-r",
+    "--allow-redeclared",
+    "Don't check for redeclared identifiers when parsing a single input",
+    0,
+    allow_redeclared_action,
+    NULL
+  },
   {
     "-T=lexer",
     "--trace-lexer",
@@ -125,18 +157,51 @@ PDCPL_PROGRAM_OPTIONS_DEF
   PDCPL_PROGRAM_OPTIONS_END
 };
 
+/**
+ * Parse multiple files in parallel and print the merged declarations.
+ *
+ * @returns `EXIT_SUCCESS` on success, `EXIT_FAILURE` on parse error or conflict
+ */
+static int
+batch_main()
+{
+  pdcpl::cdcl_batch_parser::paths_type files;
+  if (!input_path.empty())
+    files.push_back(input_path);
+  for (std::size_t i = 0; i < PDCPL_PROGRAM_N_INPUTS; i++)
+    files.emplace_back(PDCPL_PROGRAM_INPUTS[i]);
+  pdcpl::cdcl_batch_parser parser{PDCPL_PROGRAM_JOBS};
+  auto status = parser.parse(files);
+  for (const auto& error : parser.errors())
+    std::cerr << PDCPL_PROGRAM_NAME << ": " << error << std::endl;
+  PDCPL_TRACE_SCOPE("cdcl_print");
+  for (const auto& dcln : parser.results())
+    std::cout << dcln << std::endl;
+  return (status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 PDCPL_ARG_MAIN
 {
   PDCPL_PARSE_PROGRAM_OPTIONS();
-  // create parser
+  // multiple files are parsed with the batch parser
+  if (PDCPL_PROGRAM_N_INPUTS)
+    return batch_main();
+  // create parser that prints each declaration as it is parsed. we avoid
+  // std::endl so that output is not flushed for every declaration
   pdcpl::cdcl_parser parser;
+  parser.set_sink(
+    [](const pdcpl::cdcl_dcln& dcln, const pdcpl::cdcl_position&)
+    {
+      std::cout << dcln << '\n';
+    },
+    check_redeclared
+  );
   // parse + print error if failed
-  if (!parser.parse(input_path, trace_lexer, trace_parser)) {
+  auto status = parser.parse(input_path, trace_lexer, trace_parser);
+  std::cout.flush();
+  if (!status) {
     std::cerr << PDCPL_PROGRAM_NAME << ": " << parser.last_error() << std::endl;
     return EXIT_FAILURE;
   }
-  // loop through parsed declarations and print them to the screen
-  for (const auto& dcln : parser.results())
-    std::cout << dcln << std::endl;
   return EXIT_SUCCESS;
 }
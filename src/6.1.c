@@ -13,6 +13,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 #include "pdcpl/string.h"
 
 PDCPL_PROGRAM_USAGE_DEF
@@ -51,7 +52,7 @@ PDCPL_ARG_MAIN
       return EXIT_FAILURE;
     }
     // otherwise, just print on new line and free
-    printf("%s\n", word);
+    pdcpl_stats_written(printf("%s\n", word));
     free(word);
   }
   return EXIT_SUCCESS;
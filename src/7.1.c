@@ -12,6 +12,7 @@
 #define PDCPL_HAS_PROGRAM_USAGE
 #include "pdcpl/cliopts.h"
 #include "pdcpl/core.h"
+#include "pdcpl/stats.h"
 
 /**
  * Enum to indicate stream operation state.
@@ -22,6 +23,22 @@ typedef enum {
   stream_state_error_output
 } stream_state;
 
+/**
+ * Add chars read and written and lines read to the program statistics.
+ *
+ * Each char read is written converted, so the read and written counts match.
+ *
+ * @param n_chars Number of chars read and written
+ * @param n_lines Number of newlines read
+ */
+static void
+count_chars(size_t n_chars, size_t n_lines)
+{
+  pdcpl_stats_add(PDCPL_STATS_BYTES_READ, n_chars);
+  pdcpl_stats_add(PDCPL_STATS_BYTES_WRITTEN, n_chars);
+  pdcpl_stats_add(PDCPL_STATS_LINES, n_lines);
+}
+
 /**
  * Convert input read from `in` to lowercase and write to `out`.
  *
@@ -32,9 +49,15 @@ static stream_state
 convert_lower(FILE *in, FILE *out)
 {
   int c;
-  while ((c = fgetc(in)) != EOF)
+  // chars are counted locally and added to the statistics once at the end
+  size_t n_chars = 0, n_lines = 0;
+  while ((c = fgetc(in)) != EOF) {
     if (fputc(tolower(c), out) == EOF && ferror(out))
       return stream_state_error_output;
+    n_chars++;
+    n_lines += (c == '\n');
+  }
+  count_chars(n_chars, n_lines);
   return (ferror(in)) ? stream_state_error_input : stream_state_success;
 }
 
@@ -48,9 +71,15 @@ static stream_state
 convert_upper(FILE *in, FILE *out)
 {
   int c;
-  while ((c = fgetc(in)) != EOF)
+  // chars are counted locally and added to the statistics once at the end
+  size_t n_chars = 0, n_lines = 0;
+  while ((c = fgetc(in)) != EOF) {
     if (fputc(toupper(c), out) == EOF && ferror(out))
       return stream_state_error_output;
+    n_chars++;
+    n_lines += (c == '\n');
+  }
+  count_chars(n_chars, n_lines);
   return (ferror(in)) ? stream_state_error_input : stream_state_success;
 }
 
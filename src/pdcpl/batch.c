@@ -0,0 +1,287 @@
+/**
+ * @file batch.c
+ * @author Derek Huang
+ * @brief C source for running a stream function over many files in parallel
+ * @copyright MIT License
+ */
+
+#include "pdcpl/batch.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdcpl/features.h"
+#include "pdcpl/stats.h"
+#include "pdcpl/thread.h"
+
+// open_memstream is POSIX.1-2008, otherwise we fall back to tmpfile
+#ifdef PDCPL_POSIX_1_2008
+#define PDCPL_BATCH_MEMSTREAM
+#endif  // PDCPL_POSIX_1_2008
+
+/**
+ * Number of bytes copied at once when flushing a temporary file.
+ */
+#define PDCPL_BATCH_COPY_SIZE 8192
+
+/**
+ * Buffered output of a single file.
+ *
+ * @param stream Stream the file's output is written to
+ * @param data `open_memstream` buffer, only used with memory streams
+ * @param size `open_memstream` buffer size, only used with memory streams
+ * @param status Status returned when processing the file
+ * @param done `true` when the file has been processed
+ */
+typedef struct {
+  FILE *stream;
+#ifdef PDCPL_BATCH_MEMSTREAM
+  char *data;
+  size_t size;
+#endif  // PDCPL_BATCH_MEMSTREAM
+  int status;
+  bool done;
+} pdcpl_batch_output;
+
+/**
+ * Shared state for the batch workers.
+ *
+ * @param paths Array of input file paths
+ * @param n_paths Number of input file paths
+ * @param func Function to process each file
+ * @param ctx User-defined context passed to `func`
+ * @param out Stream to write outputs to
+ * @param name Prefix for error messages, can be `NULL`
+ * @param outputs Buffered outputs, one per path
+ * @param mutex Mutex guarding `next`, `next_flush`, `status`, and `done`
+ * @param next Index of the next file to process
+ * @param next_flush Index of the next file whose output is to be written
+ * @param status Status of the first failed file in argument order
+ */
+typedef struct {
+  const char *const *paths;
+  size_t n_paths;
+  pdcpl_batch_func func;
+  void *ctx;
+  FILE *out;
+  const char *name;
+  pdcpl_batch_output *outputs;
+  pdcpl_mutex *mutex;
+  size_t next;
+  size_t next_flush;
+  int status;
+} pdcpl_batch_state;
+
+/**
+ * Open a file and process it with the batch function.
+ *
+ * @param state Batch state
+ * @param path Path of the file to process
+ * @param out Stream to write output to
+ * @returns 0 on success, negative errno value on error
+ */
+static int
+pdcpl_batch_process(pdcpl_batch_state *state, const char *path, FILE *out)
+{
+  bool use_stdin = !strcmp(path, "-");
+  FILE *in = (use_stdin) ? stdin : fopen(path, "r");
+  if (!in)
+    return (errno) ? -errno : -EIO;
+  int status = state->func(in, out, path, state->ctx);
+  if (!use_stdin)
+    fclose(in);
+  return status;
+}
+
+/**
+ * Report a file's error status to `stderr` if it failed.
+ *
+ * @param state Batch state
+ * @param i Index of the file
+ * @param status Status returned when processing the file
+ */
+static void
+pdcpl_batch_report(pdcpl_batch_state *state, size_t i, int status)
+{
+  if (!status)
+    return;
+  if (state->name)
+    fprintf(stderr, "%s: ", state->name);
+  fprintf(
+    stderr,
+    "%s: %s\n",
+    state->paths[i],
+    strerror((status < 0) ? -status : status)
+  );
+  if (!state->status)
+    state->status = status;
+}
+
+/**
+ * Open a buffered output stream.
+ *
+ * @param output Buffered output
+ * @returns 0 on success, negative errno value on error
+ */
+static int
+pdcpl_batch_output_open(pdcpl_batch_output *output)
+{
+#ifdef PDCPL_BATCH_MEMSTREAM
+  output->data = NULL;
+  output->size = 0;
+  output->stream = open_memstream(&output->data, &output->size);
+#else
+  output->stream = tmpfile();
+#endif  // !PDCPL_BATCH_MEMSTREAM
+  if (!output->stream)
+    return (errno) ? -errno : -ENOMEM;
+  return 0;
+}
+
+/**
+ * Write a buffered output to a stream and close it, if it was opened.
+ *
+ * @param output Buffered output
+ * @param out Stream to write to
+ */
+static void
+pdcpl_batch_output_flush(pdcpl_batch_output *output, FILE *out)
+{
+  // stream could not be opened
+  if (!output->stream)
+    return;
+#ifdef PDCPL_BATCH_MEMSTREAM
+  // closing updates data and size
+  fclose(output->stream);
+  fwrite(output->data, 1, output->size, out);
+  free(output->data);
+#else
+  char buf[PDCPL_BATCH_COPY_SIZE];
+  size_t n_read;
+  rewind(output->stream);
+  while ((n_read = fread(buf, 1, sizeof buf, output->stream)))
+    fwrite(buf, 1, n_read, out);
+  fclose(output->stream);
+#endif  // !PDCPL_BATCH_MEMSTREAM
+  output->stream = NULL;
+}
+
+/**
+ * Batch worker thread function.
+ *
+ * Claims files one at a time and after each file, writes out the outputs of
+ * all the consecutive files that are done, in argument order.
+ *
+ * @param arg `pdcpl_batch_state *` shared state
+ * @returns `NULL`
+ */
+static void *
+pdcpl_batch_worker(void *arg)
+{
+  pdcpl_batch_state *state = (pdcpl_batch_state *) arg;
+  for (;;) {
+    pdcpl_mutex_lock(state->mutex);
+    size_t i = state->next++;
+    pdcpl_mutex_unlock(state->mutex);
+    if (i >= state->n_paths)
+      break;
+    // output is opened only when the file is claimed to bound open streams
+    pdcpl_batch_output *output = state->outputs + i;
+    int status = pdcpl_batch_output_open(output);
+    if (!status)
+      status = pdcpl_batch_process(state, state->paths[i], output->stream);
+    pdcpl_mutex_lock(state->mutex);
+    output->status = status;
+    output->done = true;
+    for (
+      ;
+      state->next_flush < state->n_paths &&
+        state->outputs[state->next_flush].done;
+      state->next_flush++
+    ) {
+      pdcpl_batch_output *ready = state->outputs + state->next_flush;
+      pdcpl_batch_output_flush(ready, state->out);
+      pdcpl_batch_report(state, state->next_flush, ready->status);
+    }
+    pdcpl_mutex_unlock(state->mutex);
+  }
+  // counters are thread-local, so add them to the totals before exiting
+  pdcpl_stats_flush();
+  return NULL;
+}
+
+/**
+ * Run a stream function over a list of files, possibly in parallel.
+ *
+ * @param paths Array of input file paths
+ * @param n_paths Number of input file paths
+ * @param n_jobs Maximum number of threads to use, 0 to use the number of
+ *  hardware threads
+ * @param func Function to process each file
+ * @param ctx User-defined context passed to `func`
+ * @param out Stream to write outputs to
+ * @param name Prefix for error messages, e.g. program name, can be `NULL`
+ * @returns 0 if all files were processed successfully, -EINVAL if `paths`,
+ *  `func`, or `out` is `NULL`, -ENOMEM if memory allocation fails, otherwise
+ *  the error status of the first file in argument order that failed
+ */
+int
+pdcpl_batch_run(
+  const char *const *paths,
+  size_t n_paths,
+  unsigned int n_jobs,
+  pdcpl_batch_func func,
+  void *ctx,
+  FILE *out,
+  const char *name)
+{
+  if (!paths || !func || !out)
+    return -EINVAL;
+  pdcpl_batch_state state;
+  memset(&state, 0, sizeof state);
+  state.paths = paths;
+  state.n_paths = n_paths;
+  state.func = func;
+  state.ctx = ctx;
+  state.out = out;
+  state.name = name;
+  if (!n_jobs)
+    n_jobs = pdcpl_thread_hardware_concurrency();
+  if (n_jobs > n_paths)
+    n_jobs = (unsigned int) n_paths;
+  // run serially without buffering if there is no parallelism
+  if (n_jobs <= 1) {
+    for (size_t i = 0; i < n_paths; i++)
+      pdcpl_batch_report(&state, i, pdcpl_batch_process(&state, paths[i], out));
+    return state.status;
+  }
+  state.outputs = calloc(n_paths, sizeof *state.outputs);
+  if (!state.outputs)
+    return -ENOMEM;
+  int status = pdcpl_mutex_create(&state.mutex);
+  if (status) {
+    free(state.outputs);
+    return status;
+  }
+  // extra threads. if creation fails, we just use fewer threads
+  pdcpl_thread **threads = malloc((n_jobs - 1) * sizeof *threads);
+  unsigned int n_threads = 0;
+  if (threads) {
+    for (; n_threads < n_jobs - 1; n_threads++) {
+      if (pdcpl_thread_create(threads + n_threads, pdcpl_batch_worker, &state))
+        break;
+    }
+  }
+  // calling thread works too, so all files are done even with no threads
+  pdcpl_batch_worker(&state);
+  for (unsigned int i = 0; i < n_threads; i++)
+    pdcpl_thread_join(threads[i], NULL);
+  free(threads);
+  pdcpl_mutex_destroy(state.mutex);
+  free(state.outputs);
+  return state.status;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file cpu.c
+ * @author Derek Huang
+ * @brief C source for runtime CPU feature detection and kernel dispatch
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cpu.h"
+
+#if defined(_MSC_VER) && defined(PDCPL_CPU_X86)
+#include <intrin.h>
+#elif defined(PDCPL_CPU_X86)
+#include <cpuid.h>
+#elif defined(__linux__) && defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif  // !defined(_MSC_VER) || !defined(PDCPL_CPU_X86) && ...
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pdcpl/atomic.h"
+
+// cached result of pdcpl_cpu_features in the low 32 bits. bit 32 is set once
+// the result is valid. racing threads compute and store the same value.
+static uint64_t pdcpl_cpu_cache;
+#define PDCPL_CPU_CACHE_VALID ((uint64_t) 1 << 32)
+
+/**
+ * Names of the CPU levels, indexed by level.
+ */
+static const char *const pdcpl_cpu_level_names[] = {
+  "baseline", "sse2", "sse4.2", "avx", "avx2", "avx512"
+};
+
+/**
+ * Features required by each CPU level, indexed by level.
+ */
+static const unsigned int pdcpl_cpu_level_required[] = {
+  0,
+  PDCPL_CPU_SSE2,
+  PDCPL_CPU_SSE2 | PDCPL_CPU_SSE4_2 | PDCPL_CPU_POPCNT,
+  PDCPL_CPU_SSE2 | PDCPL_CPU_SSE4_2 | PDCPL_CPU_POPCNT | PDCPL_CPU_AVX,
+  PDCPL_CPU_SSE2 | PDCPL_CPU_SSE4_2 | PDCPL_CPU_POPCNT | PDCPL_CPU_AVX |
+    PDCPL_CPU_AVX2 | PDCPL_CPU_BMI2,
+  PDCPL_CPU_SSE2 | PDCPL_CPU_SSE4_2 | PDCPL_CPU_POPCNT | PDCPL_CPU_AVX |
+    PDCPL_CPU_AVX2 | PDCPL_CPU_BMI2 | PDCPL_CPU_AVX512F | PDCPL_CPU_AVX512BW
+};
+
+#if defined(PDCPL_CPU_X86)
+/**
+ * Execute `cpuid` for a leaf and subleaf.
+ *
+ * @param leaf Leaf, i.e. `eax` value
+ * @param subleaf Subleaf, i.e. `ecx` value
+ * @param regs Array to write `eax`, `ebx`, `ecx`, `edx` to
+ * @returns `true` if the leaf is supported, `false` otherwise
+ */
+static bool
+pdcpl_cpu_cpuid(unsigned int leaf, unsigned int subleaf, unsigned int *regs)
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, (int) (leaf & 0x80000000u));
+  if ((unsigned int) info[0] < leaf)
+    return false;
+  __cpuidex(info, (int) leaf, (int) subleaf);
+  for (int i = 0; i < 4; i++)
+    regs[i] = (unsigned int) info[i];
+  return true;
+#else
+  return __get_cpuid_count(leaf, subleaf, regs, regs + 1, regs + 2, regs + 3);
+#endif  // !defined(_MSC_VER)
+}
+
+/**
+ * Return the low 32 bits of the `XCR0` register, i.e. the OS-enabled state.
+ *
+ * Must only be called if `cpuid` reports OSXSAVE.
+ */
+static unsigned int
+pdcpl_cpu_xgetbv(void)
+{
+#if defined(_MSC_VER)
+  return (unsigned int) _xgetbv(0);
+#else
+  // inline asm so that -mxsave is not needed
+  unsigned int eax, edx;
+  __asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+  return eax;
+#endif  // !defined(_MSC_VER)
+}
+#endif  // defined(PDCPL_CPU_X86)
+
+/**
+ * Detect the features of the CPU the program is running on.
+ *
+ * This queries the CPU on every call and ignores `PDCPL_CPU_LEVEL_ENV`.
+ *
+ * @returns Bitwise OR of `pdcpl_cpu_feature` flags that are usable
+ */
+unsigned int
+pdcpl_cpu_detect(void)
+{
+  unsigned int features = 0;
+#if defined(PDCPL_CPU_X86)
+  unsigned int regs[4];
+  if (!pdcpl_cpu_cpuid(1, 0, regs))
+    return 0;
+  unsigned int ecx1 = regs[2], edx1 = regs[3];
+  if (edx1 & (1u << 26))
+    features |= PDCPL_CPU_SSE2;
+  if (ecx1 & (1u << 20))
+    features |= PDCPL_CPU_SSE4_2;
+  if (ecx1 & (1u << 23))
+    features |= PDCPL_CPU_POPCNT;
+  // AVX state must also be enabled by the OS, checked with OSXSAVE + XCR0
+  unsigned int xcr0 = (ecx1 & (1u << 27)) ? pdcpl_cpu_xgetbv() : 0;
+  bool avx_state = (xcr0 & 0x6) == 0x6;
+  bool avx512_state = avx_state && (xcr0 & 0xe0) == 0xe0;
+  if (avx_state && (ecx1 & (1u << 28)))
+    features |= PDCPL_CPU_AVX;
+  if (pdcpl_cpu_cpuid(7, 0, regs)) {
+    unsigned int ebx7 = regs[1];
+    if (avx_state && (ebx7 & (1u << 5)))
+      features |= PDCPL_CPU_AVX2;
+    if (ebx7 & (1u << 8))
+      features |= PDCPL_CPU_BMI2;
+    if (avx512_state && (ebx7 & (1u << 16)))
+      features |= PDCPL_CPU_AVX512F;
+    if (avx512_state && (ebx7 & (1u << 30)))
+      features |= PDCPL_CPU_AVX512BW;
+  }
+#elif defined(__linux__) && defined(__aarch64__)
+  if (getauxval(AT_HWCAP) & HWCAP_ASIMD)
+    features |= PDCPL_CPU_NEON;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  // Advanced SIMD is part of the AArch64 baseline
+  features |= PDCPL_CPU_NEON;
+#endif  // !defined(PDCPL_CPU_X86) && ...
+  return features;
+}
+
+/**
+ * Return the CPU features that kernels may use.
+ *
+ * On first call, the features are detected and, if `PDCPL_CPU_LEVEL_ENV` names
+ * a valid level, limited to the features required by that level. The result
+ * is cached so later calls are cheap.
+ *
+ * @returns Bitwise OR of `pdcpl_cpu_feature` flags
+ */
+unsigned int
+pdcpl_cpu_features(void)
+{
+  uint64_t cache = pdcpl_atomic_load_u64(&pdcpl_cpu_cache);
+  if (cache & PDCPL_CPU_CACHE_VALID)
+    return (unsigned int) cache;
+  unsigned int features = pdcpl_cpu_detect();
+  // the override can only lower the level, since forcing features the CPU
+  // lacks would crash. non-level features like NEON are kept
+  pdcpl_cpu_level cap;
+  if (!pdcpl_cpu_level_parse(getenv(PDCPL_CPU_LEVEL_ENV), &cap)) {
+    unsigned int x86 = pdcpl_cpu_level_required[PDCPL_CPU_LEVEL_MAX - 1];
+    features &= ~x86 | pdcpl_cpu_level_required[cap];
+  }
+  pdcpl_atomic_store_u64(&pdcpl_cpu_cache, features | PDCPL_CPU_CACHE_VALID);
+  return features;
+}
+
+/**
+ * Return the highest CPU level that kernels may use.
+ *
+ * Computed from `pdcpl_cpu_features`.
+ */
+pdcpl_cpu_level
+pdcpl_cpu_get_level(void)
+{
+  return pdcpl_cpu_features_level(pdcpl_cpu_features());
+}
+
+/**
+ * Return the features required by a CPU level.
+ *
+ * @param level CPU level
+ * @returns Bitwise OR of `pdcpl_cpu_feature` flags, 0 for an invalid level
+ */
+unsigned int
+pdcpl_cpu_level_features(pdcpl_cpu_level level)
+{
+  if ((unsigned int) level >= PDCPL_CPU_LEVEL_MAX)
+    return 0;
+  return pdcpl_cpu_level_required[level];
+}
+
+/**
+ * Return the highest CPU level whose required features are all present.
+ *
+ * @param features Bitwise OR of `pdcpl_cpu_feature` flags
+ */
+pdcpl_cpu_level
+pdcpl_cpu_features_level(unsigned int features)
+{
+  pdcpl_cpu_level level = PDCPL_CPU_LEVEL_BASELINE;
+  for (unsigned int i = 1; i < PDCPL_CPU_LEVEL_MAX; i++) {
+    unsigned int required = pdcpl_cpu_level_required[i];
+    if ((features & required) != required)
+      break;
+    level = (pdcpl_cpu_level) i;
+  }
+  return level;
+}
+
+/**
+ * Return the name of a CPU level.
+ *
+ * @param level CPU level
+ * @returns Name, e.g. `"avx2"`, `NULL` for an invalid level
+ */
+const char *
+pdcpl_cpu_level_name(pdcpl_cpu_level level)
+{
+  if ((unsigned int) level >= PDCPL_CPU_LEVEL_MAX)
+    return NULL;
+  return pdcpl_cpu_level_names[level];
+}
+
+/**
+ * Parse a CPU level name, ignoring case.
+ *
+ * @param name Level name, e.g. `"avx2"`
+ * @param level Address of `pdcpl_cpu_level` to write to
+ * @returns 0 on success, -EINVAL if `name` or `level` is `NULL` or if `name`
+ *  is not a valid level name
+ */
+int
+pdcpl_cpu_level_parse(const char *name, pdcpl_cpu_level *level)
+{
+  if (!name || !level)
+    return -EINVAL;
+  for (unsigned int i = 0; i < PDCPL_CPU_LEVEL_MAX; i++) {
+    const char *a = name, *b = pdcpl_cpu_level_names[i];
+    while (*a && tolower((unsigned char) *a) == *b) {
+      a++;
+      b++;
+    }
+    if (!*a && !*b) {
+      *level = (pdcpl_cpu_level) i;
+      return 0;
+    }
+  }
+  return -EINVAL;
+}
+
+/**
+ * Select the first function in a dispatch table usable at a CPU level.
+ *
+ * Entries should be ordered from highest to lowest level and the last entry
+ * should be `PDCPL_CPU_LEVEL_BASELINE` so that a function is always found.
+ *
+ * @param impls Dispatch table
+ * @param n_impls Number of dispatch table entries
+ * @param level CPU level, usually `pdcpl_cpu_get_level()`
+ * @returns Selected function, `NULL` if no entry is usable
+ */
+pdcpl_cpu_func
+pdcpl_cpu_select(
+  const pdcpl_cpu_impl *impls, size_t n_impls, pdcpl_cpu_level level)
+{
+  if (!impls)
+    return NULL;
+  for (size_t i = 0; i < n_impls; i++) {
+    if (impls[i].level <= level)
+      return impls[i].func;
+  }
+  return NULL;
+}
@@ -0,0 +1,599 @@
+/**
+ * @file dsv.c
+ * @author Derek Huang
+ * @brief C source for a delimiter-separated values reader
+ * @copyright MIT License
+ */
+
+#include "pdcpl/dsv.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdcpl/features.h"
+#include "pdcpl/memory.h"
+#include "pdcpl/stats.h"
+#include "pdcpl/strtod.h"
+#include "pdcpl/variant.h"
+
+#ifdef PDCPL_HAS_SSE2
+#include <emmintrin.h>
+#endif  // PDCPL_HAS_SSE2
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
+/**
+ * Number of bytes scanned at once for delimiters and newlines.
+ */
+#define PDCPL_DSV_BLOCK_SIZE 64
+
+/**
+ * Initial number of values allocated per column.
+ */
+#define PDCPL_DSV_INIT_ROWS 256
+
+/**
+ * Index value indicating that a source column is not selected.
+ */
+#define PDCPL_DSV_SKIP SIZE_MAX
+
+/**
+ * Return the number of trailing zero bits in a nonzero 64-bit value.
+ *
+ * @param x Nonzero value
+ */
+static inline unsigned int
+pdcpl_dsv_ctz(uint64_t x)
+{
+#if defined(__GNUC__)
+  return (unsigned int) __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long i;
+  _BitScanForward64(&i, x);
+  return (unsigned int) i;
+#else
+  unsigned int n = 0;
+  while (!(x & 1)) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif  // !defined(__GNUC__) && !(defined(_MSC_VER) && defined(_M_X64))
+}
+
+/**
+ * Compute the bitmask of delimiter and newline positions in a block.
+ *
+ * Bit `i` is set if `p[i]` is a delimiter or newline. Only bytes before `end`
+ * are examined, so the last block of a buffer may be partial.
+ *
+ * @param p Start of block
+ * @param end End of buffer
+ * @param delim Field delimiter
+ */
+static inline uint64_t
+pdcpl_dsv_block_mask(const char *p, const char *end, char delim)
+{
+  uint64_t mask = 0;
+#ifdef PDCPL_HAS_SSE2
+  if (end - p >= PDCPL_DSV_BLOCK_SIZE) {
+    __m128i vd = _mm_set1_epi8(delim);
+    __m128i vn = _mm_set1_epi8('\n');
+    for (unsigned int i = 0; i < PDCPL_DSV_BLOCK_SIZE / 16; i++) {
+      __m128i v = _mm_loadu_si128((const __m128i *) (p + 16 * i));
+      __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, vd), _mm_cmpeq_epi8(v, vn));
+      mask |= (uint64_t) (unsigned int) _mm_movemask_epi8(m) << (16 * i);
+    }
+    return mask;
+  }
+#endif  // PDCPL_HAS_SSE2
+  ptrdiff_t n = end - p;
+  if (n > PDCPL_DSV_BLOCK_SIZE)
+    n = PDCPL_DSV_BLOCK_SIZE;
+  for (ptrdiff_t i = 0; i < n; i++) {
+    if (p[i] == delim || p[i] == '\n')
+      mask |= (uint64_t) 1 << i;
+  }
+  return mask;
+}
+
+/**
+ * Scanner state for finding delimiters and newlines a block at a time.
+ *
+ * @param base Start of the current block
+ * @param end End of buffer
+ * @param mask Delimiter and newline bitmask of the current block
+ * @param delim Field delimiter
+ */
+typedef struct {
+  char *base;
+  char *end;
+  uint64_t mask;
+  char delim;
+} pdcpl_dsv_scanner;
+
+/**
+ * Return the first delimiter or newline at or after a position.
+ *
+ * The block bitmask is reused across calls so that short fields cost a few
+ * bit operations instead of a scan each.
+ *
+ * @param s Scanner
+ * @param pos Position to scan from
+ * @returns Pointer to the delimiter or newline, `s->end` if there is none
+ */
+static inline char *
+pdcpl_dsv_scan(pdcpl_dsv_scanner *s, char *pos)
+{
+  if (pos >= s->end)
+    return s->end;
+  // move to a new block starting at pos if pos is outside the current block
+  if (pos < s->base || pos - s->base >= PDCPL_DSV_BLOCK_SIZE) {
+    s->base = pos;
+    s->mask = pdcpl_dsv_block_mask(pos, s->end, s->delim);
+  }
+  uint64_t m = s->mask & (~(uint64_t) 0 << (pos - s->base));
+  while (!m) {
+    if (s->end - s->base <= PDCPL_DSV_BLOCK_SIZE)
+      return s->end;
+    s->base += PDCPL_DSV_BLOCK_SIZE;
+    s->mask = m = pdcpl_dsv_block_mask(s->base, s->end, s->delim);
+  }
+  return s->base + pdcpl_dsv_ctz(m);
+}
+
+/**
+ * Read the next field of a record.
+ *
+ * Quoted fields are unquoted in place. A trailing `'\r'` is excluded from the
+ * last field of a record.
+ *
+ * @param s Scanner
+ * @param p Start of field
+ * @param quote Quote character, `'\0'` if quoting is disabled
+ * @param fs Address to write the start of the field contents to
+ * @param fe Address to write the end of the field contents to
+ * @param next Address to write the start of the next field to
+ * @param eor Address to write whether the field ends the record to
+ * @returns 0 on success, -EINVAL if a quoted field is malformed
+ */
+static int
+pdcpl_dsv_next_field(
+  pdcpl_dsv_scanner *s,
+  char *p,
+  char quote,
+  char **fs,
+  char **fe,
+  char **next,
+  bool *eor)
+{
+  char *end = s->end;
+  char *t;
+  *fs = p;
+  if (quote && p < end && *p == quote) {
+    // compact quoted contents toward the start of the field
+    char *w = p, *r = p + 1;
+    for (;;) {
+      char *q = memchr(r, quote, end - r);
+      if (!q)
+        return -EINVAL;
+      memmove(w, r, q - r);
+      w += q - r;
+      r = q + 1;
+      if (r < end && *r == quote) {
+        *w++ = quote;
+        r++;
+        continue;
+      }
+      break;
+    }
+    *fe = w;
+    if (r < end && *r == '\r' && (r + 1 == end || r[1] == '\n'))
+      r++;
+    if (r < end && *r != s->delim && *r != '\n')
+      return -EINVAL;
+    t = r;
+  }
+  else
+    t = *fe = pdcpl_dsv_scan(s, p);
+  if (t == end) {
+    *next = end;
+    *eor = true;
+  }
+  else {
+    *next = t + 1;
+    *eor = (*t == '\n');
+  }
+  if (*eor && *fe > *fs && (*fe)[-1] == '\r')
+    (*fe)--;
+  return 0;
+}
+
+/**
+ * Count the fields in the record starting at `p` without modifying it.
+ *
+ * @param p Start of record
+ * @param end End of buffer
+ * @param delim Field delimiter
+ * @param quote Quote character, `'\0'` if quoting is disabled
+ */
+static size_t
+pdcpl_dsv_count_fields(const char *p, const char *end, char delim, char quote)
+{
+  size_t n = 1;
+  bool field_start = true;
+  for (; p < end && *p != '\n'; p++) {
+    // skip over quoted contents, where doubled quotes just look like two
+    // adjacent quoted sections
+    if (quote && field_start && *p == quote) {
+      do {
+        const char *q = memchr(p + 1, quote, end - p - 1);
+        if (!q)
+          return n;
+        p = q + 1;
+      } while (p < end && *p == quote);
+      if (p >= end || *p == '\n')
+        break;
+    }
+    field_start = (*p == delim);
+    if (field_start)
+      n++;
+  }
+  return n;
+}
+
+/**
+ * Parse an unsigned decimal integer occupying all of `[s, e)`.
+ *
+ * @param s Start of field
+ * @param e End of field
+ * @param neg Address to write whether a leading minus sign was present to
+ * @param vp Address to write magnitude to
+ * @returns 0 on success, -EINVAL if the field is not an integer, -ERANGE if
+ *  the magnitude is too large
+ */
+static int
+pdcpl_dsv_parse_integer(const char *s, const char *e, bool *neg, uintmax_t *vp)
+{
+  *neg = false;
+  if (s < e && (*s == '-' || *s == '+'))
+    *neg = (*s++ == '-');
+  if (s == e)
+    return -EINVAL;
+  uintmax_t v = 0;
+  for (; s < e; s++) {
+    unsigned int d = (unsigned char) *s - '0';
+    if (d > 9)
+      return -EINVAL;
+    if (v > (UINTMAX_MAX - d) / 10)
+      return -ERANGE;
+    v = 10 * v + d;
+  }
+  *vp = v;
+  return 0;
+}
+
+/**
+ * Convert a null-terminated field to a variant of the given type.
+ *
+ * @param s Start of field
+ * @param e End of field, where `*e` is `'\0'`
+ * @param type `pdcpl_variant` type flag
+ * @param vt Variant to write to
+ * @returns 0 on success, -EINVAL if the field cannot be converted, -ERANGE if
+ *  a numeric field is out of range
+ */
+static int
+pdcpl_dsv_convert(char *s, char *e, unsigned int type, pdcpl_variant *vt)
+{
+  bool neg;
+  uintmax_t v;
+  double d;
+  char *endp;
+  int status;
+  switch (type) {
+    case pdcpl_variant_char:
+      if (e - s != 1)
+        return -EINVAL;
+      return PDCPL_VARIANT_INIT(char)(vt, *s);
+    case pdcpl_variant_int:
+      if ((status = pdcpl_dsv_parse_integer(s, e, &neg, &v)))
+        return status;
+      if (v > (uintmax_t) INT_MAX + neg)
+        return -ERANGE;
+      // avoid negating INT_MIN
+      return PDCPL_VARIANT_INIT(int)(
+        vt, (neg) ? (int) -(intmax_t) v : (int) v
+      );
+    case pdcpl_variant_uint:
+    case pdcpl_variant_size:
+      if ((status = pdcpl_dsv_parse_integer(s, e, &neg, &v)))
+        return status;
+      if (neg && v)
+        return -ERANGE;
+      if (type == pdcpl_variant_uint) {
+        if (v > UINT_MAX)
+          return -ERANGE;
+        return PDCPL_VARIANT_INIT(uint)(vt, (unsigned int) v);
+      }
+      if (v > SIZE_MAX)
+        return -ERANGE;
+      return PDCPL_VARIANT_INIT(size)(vt, (size_t) v);
+    case pdcpl_variant_double:
+      if (s == e)
+        return -EINVAL;
+      errno = 0;
+      if (pdcpl_strtod_fast(s, (size_t) (e - s), &d) != (size_t) (e - s))
+        return -EINVAL;
+      PDCPL_VARIANT_INIT(double)(vt, d);
+      return (errno == ERANGE) ? -ERANGE : 0;
+    case pdcpl_variant_float:
+      if (s == e)
+        return -EINVAL;
+      errno = 0;
+      PDCPL_VARIANT_INIT(float)(vt, strtof(s, &endp));
+      if (endp != e)
+        return -EINVAL;
+      return (errno == ERANGE) ? -ERANGE : 0;
+    case pdcpl_variant_string:
+      return PDCPL_VARIANT_INIT(string_ref)(vt, s);
+  }
+  return -EINVAL;
+}
+
+/**
+ * Infer the type of a null-terminated field.
+ *
+ * @param s Start of field
+ * @param e End of field, where `*e` is `'\0'`
+ */
+static unsigned int
+pdcpl_dsv_infer(char *s, char *e)
+{
+  pdcpl_variant vt;
+  if (!pdcpl_dsv_convert(s, e, pdcpl_variant_int, &vt))
+    return pdcpl_variant_int;
+  if (!pdcpl_dsv_convert(s, e, pdcpl_variant_double, &vt))
+    return pdcpl_variant_double;
+  return pdcpl_variant_string;
+}
+
+/**
+ * Check if a type flag is a supported column type.
+ *
+ * @param type `pdcpl_variant` type flag
+ */
+static bool
+pdcpl_dsv_type_supported(unsigned int type)
+{
+  switch (type) {
+    case pdcpl_variant_char:
+    case pdcpl_variant_int:
+    case pdcpl_variant_uint:
+    case pdcpl_variant_size:
+    case pdcpl_variant_double:
+    case pdcpl_variant_float:
+    case pdcpl_variant_string:
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Free the memory held by a table.
+ *
+ * @param table Table to free
+ * @returns 0 on success, -EINVAL if `table` is `NULL`
+ */
+int
+pdcpl_dsv_table_free(pdcpl_dsv_table *table)
+{
+  if (!table)
+    return -EINVAL;
+  for (size_t i = 0; i < table->n_columns; i++)
+    pdcpl_buffer_clear(&table->columns[i].values);
+  free(table->columns);
+  table->columns = NULL;
+  table->n_columns = 0;
+  table->n_rows = 0;
+  return 0;
+}
+
+/**
+ * Field slice.
+ *
+ * @param s Start of field contents
+ * @param e End of field contents
+ */
+typedef struct {
+  char *s;
+  char *e;
+} pdcpl_dsv_slice;
+
+/**
+ * Parse a buffer of delimiter-separated records into typed columns.
+ *
+ * Records are separated by `'\n'` and a trailing `'\r'` is stripped from the
+ * last field of each record. Empty lines are skipped.
+ *
+ * Fields are parsed in place. Only fields of selected columns are converted,
+ * with integers parsed directly, `double` values parsed with
+ * `pdcpl_strtod_fast`, and `float` values parsed with `strtof`.
+ * String fields, including column names, are null-terminated in place and
+ * stored as `pdcpl_variant_init_string_ref` slices of `buf`, so `buf` is
+ * modified and must outlive the table. `buf` must be writable for `size + 1`
+ * bytes so the last field can always be terminated.
+ *
+ * Supported column types are `pdcpl_variant_char`, `pdcpl_variant_int`,
+ * `pdcpl_variant_uint`, `pdcpl_variant_size`, `pdcpl_variant_double`,
+ * `pdcpl_variant_float`, and `pdcpl_variant_string`. Types not given in the
+ * options are inferred from the first data record as `int`, `double`, or
+ * string, in that order of preference.
+ *
+ * @param buf Buffer of records, writable for `size + 1` bytes
+ * @param size Number of bytes of records in `buf`
+ * @param opts Parsing options
+ * @param table Table to write parsed columns to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`, if an
+ *  option is invalid, if a record is missing a selected column, or if a field
+ *  cannot be converted to its column type, -ERANGE if a numeric field is out
+ *  of range, -ENOMEM if memory allocation fails. On error, `table` holds no
+ *  memory and `table->error_record` is set if the error is in a record.
+ */
+int
+pdcpl_dsv_parse(
+  char *buf, size_t size, const pdcpl_dsv_options *opts, pdcpl_dsv_table *table)
+{
+  if (!buf || !opts || !table)
+    return -EINVAL;
+  memset(table, 0, sizeof *table);
+  char delim = opts->delim;
+  char quote = opts->quote;
+  if (
+    delim == '\n' || delim == '\r' || delim == quote ||
+    (opts->n_types && !opts->types) || (opts->columns && !opts->n_columns)
+  )
+    return -EINVAL;
+  char *end = buf + size;
+  // skip leading empty lines so the first record is a real record
+  char *p = buf;
+  while (p < end && (*p == '\n' || *p == '\r'))
+    p++;
+  // determine selected columns and the largest selected source index
+  size_t n_out = (opts->columns) ?
+    opts->n_columns : pdcpl_dsv_count_fields(p, end, delim, quote);
+  size_t max_src = 0;
+  for (size_t k = 0; k < n_out; k++) {
+    size_t src = (opts->columns) ? opts->columns[k] : k;
+    if (src == PDCPL_DSV_SKIP)
+      return -EINVAL;
+    if (src > max_src)
+      max_src = src;
+  }
+  int status = -ENOMEM;
+  pdcpl_dsv_slice *slices = NULL;
+  // map from source column to output column
+  size_t *proj = malloc((max_src + 1) * sizeof *proj);
+  table->columns = calloc(n_out, sizeof *table->columns);
+  if (!proj || !table->columns)
+    goto error;
+  slices = malloc(n_out * sizeof *slices);
+  if (!slices)
+    goto error;
+  table->n_columns = n_out;
+  for (size_t i = 0; i <= max_src; i++)
+    proj[i] = PDCPL_DSV_SKIP;
+  for (size_t k = 0; k < n_out; k++) {
+    pdcpl_dsv_column *col = table->columns + k;
+    col->index = (opts->columns) ? opts->columns[k] : k;
+    // duplicate selection
+    if (proj[col->index] != PDCPL_DSV_SKIP) {
+      status = -EINVAL;
+      goto error;
+    }
+    proj[col->index] = k;
+    col->type = (col->index < opts->n_types) ? opts->types[col->index] : 0;
+    if (col->type && !pdcpl_dsv_type_supported(col->type)) {
+      status = -EINVAL;
+      goto error;
+    }
+  }
+  pdcpl_dsv_scanner scanner;
+  scanner.base = buf;
+  scanner.end = end;
+  scanner.delim = delim;
+  scanner.mask = pdcpl_dsv_block_mask(buf, end, delim);
+  bool inferred = false;
+  size_t capacity = 0;
+  for (size_t record = 0; p < end; record++) {
+    table->error_record = record;
+    size_t col = 0, n_found = 0;
+    bool eor = false;
+    while (!eor) {
+      // past the last selected column, so skip the rest of the record
+      if (col > max_src && !quote) {
+        char *nl = memchr(p, '\n', end - p);
+        p = (nl) ? nl + 1 : end;
+        break;
+      }
+      char *fs, *fe;
+      status = pdcpl_dsv_next_field(&scanner, p, quote, &fs, &fe, &p, &eor);
+      if (status)
+        goto error;
+      size_t k = (col <= max_src) ? proj[col] : PDCPL_DSV_SKIP;
+      if (k != PDCPL_DSV_SKIP) {
+        *fe = '\0';
+        slices[k].s = fs;
+        slices[k].e = fe;
+        n_found++;
+      }
+      col++;
+    }
+    // skip any following empty lines
+    while (p < end && (*p == '\n' || *p == '\r'))
+      p++;
+    if (n_found < n_out) {
+      status = -EINVAL;
+      goto error;
+    }
+    // header record only provides column names
+    if (!record && opts->header) {
+      for (size_t k = 0; k < n_out; k++)
+        table->columns[k].name = slices[k].s;
+      continue;
+    }
+    // infer any missing types from the first data record
+    if (!inferred) {
+      for (size_t k = 0; k < n_out; k++) {
+        if (!table->columns[k].type)
+          table->columns[k].type = pdcpl_dsv_infer(slices[k].s, slices[k].e);
+      }
+      inferred = true;
+    }
+    // grow all columns together
+    if (table->n_rows == capacity) {
+      capacity = (capacity) ? 2 * capacity : PDCPL_DSV_INIT_ROWS;
+      for (size_t k = 0; k < n_out; k++) {
+        status = pdcpl_buffer_realloc(
+          &table->columns[k].values, capacity * sizeof(pdcpl_variant)
+        );
+        if (status)
+          goto error;
+      }
+    }
+    for (size_t k = 0; k < n_out; k++) {
+      pdcpl_dsv_column *c = table->columns + k;
+      status = pdcpl_dsv_convert(
+        slices[k].s,
+        slices[k].e,
+        c->type,
+        pdcpl_dsv_column_values(c) + table->n_rows
+      );
+      if (status)
+        goto error;
+    }
+    table->n_rows++;
+  }
+  // columns never seen in a data record default to strings
+  for (size_t k = 0; k < n_out; k++) {
+    if (!table->columns[k].type)
+      table->columns[k].type = pdcpl_variant_string;
+  }
+  pdcpl_stats_add(PDCPL_STATS_BYTES_READ, size);
+  pdcpl_stats_add(PDCPL_STATS_LINES, table->n_rows);
+  free(slices);
+  free(proj);
+  return 0;
+error:
+  free(slices);
+  free(proj);
+  pdcpl_dsv_table_free(table);
+  return status;
+}
@@ -17,10 +17,24 @@
 #include <errno.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "pdcpl/features.h"
 
+#ifdef PDCPL_POSIX_1_2001
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // PDCPL_POSIX_1_2001
+
+// map files directly only when padding pages can be reserved anonymously
+#if defined(PDCPL_POSIX_1_2001) && defined(MAP_ANONYMOUS)
+#define PDCPL_FILE_MAP_MMAP
+#endif  // !defined(PDCPL_POSIX_1_2001) || !defined(MAP_ANONYMOUS)
+
 #ifdef _WIN32
 /**
  * Get the path of the directory designated for temporary files on Windows.
@@ -250,3 +264,153 @@ pdcpl_win_tempfile(HRESULT *win_err)
   return f;
 }
 #endif  // _WIN32
+
+/**
+ * Read a file's contents into a heap buffer with trailing zero padding.
+ *
+ * @param map File map to initialize
+ * @param path File path
+ * @param padding Number of zero bytes to follow the file contents
+ * @returns 0 on success, -ENOMEM on allocation failure, -errno on I/O error
+ */
+static int
+pdcpl_file_map_read(pdcpl_file_map *map, const char *path, size_t padding)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return -errno;
+  size_t size = 0;
+  size_t capacity = 0;
+  char *data = NULL;
+  int status = 0;
+  do {
+    // grow geometrically so unseekable files can be read too
+    if (capacity - size < BUFSIZ + padding) {
+      capacity = capacity ? 2 * capacity : BUFSIZ + padding;
+      char *new_data = realloc(data, capacity);
+      if (!new_data) {
+        status = -ENOMEM;
+        break;
+      }
+      data = new_data;
+    }
+    size += fread(data + size, 1, capacity - padding - size, f);
+    if (ferror(f))
+      status = -EIO;
+  } while (!status && !feof(f));
+  fclose(f);
+  if (status) {
+    free(data);
+    return status;
+  }
+  memset(data + size, 0, padding);
+  map->data = data;
+  map->size = size;
+  map->map_size = 0;
+  return 0;
+}
+
+/**
+ * Map a file's contents into memory with trailing zero padding.
+ *
+ * On POSIX systems that support anonymous mappings, the file is mapped
+ * copy-on-write directly after reserving room for the padding, so no bytes
+ * are copied. Otherwise, the contents are read into a heap buffer. Empty files
+ * are always given a heap buffer holding just the padding.
+ *
+ * @note If the file is truncated by another process while it is mapped,
+ *  accessing the truncated part of the mapping raises `SIGBUS`.
+ *
+ * @param map Address of the file map to initialize
+ * @param path File path
+ * @param padding Number of zero bytes to follow the file contents
+ * @returns 0 on success, -EINVAL if `map` or `path` is `NULL`, -ENOMEM if
+ *  the file is too large or on allocation failure, -errno on I/O error
+ */
+int
+pdcpl_file_map_open(pdcpl_file_map *map, const char *path, size_t padding)
+{
+  if (!map || !path)
+    return -EINVAL;
+#if defined(PDCPL_FILE_MAP_MMAP)
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return -errno;
+  struct stat st;
+  if (fstat(fd, &st)) {
+    int status = -errno;
+    close(fd);
+    return status;
+  }
+  // only regular, nonempty files can be mapped
+  if (!S_ISREG(st.st_mode) || !st.st_size) {
+    close(fd);
+    return pdcpl_file_map_read(map, path, padding);
+  }
+  if ((unsigned long long) st.st_size > SIZE_MAX - padding) {
+    close(fd);
+    return -ENOMEM;
+  }
+  size_t size = (size_t) st.st_size;
+  // reserve zeroed pages for the contents + padding, then map the file over
+  // the start of the reservation. the rest of the file's last page is zeroed
+  // by mmap and any remaining padding falls in the anonymous pages
+  size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+  size_t map_size = (size + padding + page_size - 1) / page_size * page_size;
+  void *data = mmap(
+    NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+  );
+  if (data == MAP_FAILED) {
+    int status = -errno;
+    close(fd);
+    return status;
+  }
+  if (
+    mmap(
+      data,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_FIXED,
+      fd,
+      0
+    ) == MAP_FAILED
+  ) {
+    int status = -errno;
+    munmap(data, map_size);
+    close(fd);
+    return status;
+  }
+  // mapping stays valid after the descriptor is closed
+  close(fd);
+  map->data = data;
+  map->size = size;
+  map->map_size = map_size;
+  return 0;
+#else
+  return pdcpl_file_map_read(map, path, padding);
+#endif  // !defined(PDCPL_FILE_MAP_MMAP)
+}
+
+/**
+ * Unmap or free a file's contents mapped by `pdcpl_file_map_open`.
+ *
+ * @param map File map to close, which is reset to all zeros on success
+ * @returns 0 on success, -EINVAL if `map` is `NULL`, -errno on unmap error
+ */
+int
+pdcpl_file_map_close(pdcpl_file_map *map)
+{
+  if (!map)
+    return -EINVAL;
+#if defined(PDCPL_FILE_MAP_MMAP)
+  if (map->map_size) {
+    if (munmap(map->data, map->map_size))
+      return -errno;
+  }
+  else
+#endif  // !defined(PDCPL_FILE_MAP_MMAP)
+    free(map->data);
+  map->data = NULL;
+  map->size = map->map_size = 0;
+  return 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file math.c
+ * @author Derek Huang
+ * @brief C source for math functions
+ * @copyright MIT License
+ */
+
+#include "pdcpl/math.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pdcpl/cpu.h"
+
+#if defined(PDCPL_CPU_X86)
+#include <immintrin.h>
+#endif  // defined(PDCPL_CPU_X86)
+
+/**
+ * Compute the `pdcpl_double_near` mask word for elements `i` through `end`.
+ *
+ * @param a First array
+ * @param b Second array
+ * @param i Index of first element, relative to `base`
+ * @param end Index one past the last element
+ * @param base Index of element corresponding to bit 0 of the mask word
+ * @param eps Nonnegative absolute tolerance
+ */
+static inline uint64_t
+pdcpl_double_near_bits(
+  const double *a,
+  const double *b,
+  size_t i,
+  size_t end,
+  size_t base,
+  double eps)
+{
+  uint64_t bits = 0;
+  for (; i < end; i++)
+    bits |= (uint64_t) pdcpl_double_near(a[i], b[i], eps) << (i - base);
+  return bits;
+}
+
+/**
+ * Signature of `pdcpl_double_near_array` kernels.
+ *
+ * Arguments are not checked and `eps` must be nonnegative.
+ */
+typedef void (*pdcpl_double_near_array_func)(
+  const double *a, const double *b, size_t n, double eps, uint64_t *mask);
+
+/**
+ * Portable `pdcpl_double_near_array` kernel.
+ */
+static void
+pdcpl_double_near_array_scalar(
+  const double *a, const double *b, size_t n, double eps, uint64_t *mask)
+{
+  for (size_t base = 0; base < n; base += 64) {
+    size_t end = (n - base < 64) ? n : base + 64;
+    mask[base / 64] = pdcpl_double_near_bits(a, b, base, end, base, eps);
+  }
+}
+
+#if defined(PDCPL_CPU_X86)
+// |a - b| is computed by clearing the sign bit. ordered compares are false for
+// NaN, as is the scalar <= comparison
+
+/**
+ * SSE2 `pdcpl_double_near_array` kernel.
+ */
+PDCPL_CPU_TARGET("sse2")
+static void
+pdcpl_double_near_array_sse2(
+  const double *a, const double *b, size_t n, double eps, uint64_t *mask)
+{
+  const __m128d veps = _mm_set1_pd(eps);
+  const __m128d vsign = _mm_set1_pd(-0.);
+  for (size_t base = 0; base < n; base += 64) {
+    size_t end = (n - base < 64) ? n : base + 64;
+    size_t i = base;
+    uint64_t bits = 0;
+    for (; i + 2 <= end; i += 2) {
+      __m128d d = _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+      __m128d le = _mm_cmple_pd(_mm_andnot_pd(vsign, d), veps);
+      bits |= (uint64_t) (unsigned int) _mm_movemask_pd(le) << (i - base);
+    }
+    mask[base / 64] = bits | pdcpl_double_near_bits(a, b, i, end, base, eps);
+  }
+}
+
+/**
+ * AVX `pdcpl_double_near_array` kernel.
+ */
+PDCPL_CPU_TARGET("avx")
+static void
+pdcpl_double_near_array_avx(
+  const double *a, const double *b, size_t n, double eps, uint64_t *mask)
+{
+  const __m256d veps = _mm256_set1_pd(eps);
+  const __m256d vsign = _mm256_set1_pd(-0.);
+  for (size_t base = 0; base < n; base += 64) {
+    size_t end = (n - base < 64) ? n : base + 64;
+    size_t i = base;
+    uint64_t bits = 0;
+    for (; i + 4 <= end; i += 4) {
+      __m256d d = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+      __m256d le = _mm256_cmp_pd(_mm256_andnot_pd(vsign, d), veps, _CMP_LE_OQ);
+      bits |= (uint64_t) (unsigned int) _mm256_movemask_pd(le) << (i - base);
+    }
+    mask[base / 64] = bits | pdcpl_double_near_bits(a, b, i, end, base, eps);
+  }
+}
+#endif  // defined(PDCPL_CPU_X86)
+
+/**
+ * `pdcpl_double_near_array` kernels, from highest to lowest CPU level.
+ */
+static const pdcpl_cpu_impl pdcpl_double_near_array_impls[] = {
+#if defined(PDCPL_CPU_X86)
+  {PDCPL_CPU_LEVEL_AVX, (pdcpl_cpu_func) pdcpl_double_near_array_avx},
+  {PDCPL_CPU_LEVEL_SSE2, (pdcpl_cpu_func) pdcpl_double_near_array_sse2},
+#endif  // defined(PDCPL_CPU_X86)
+  {PDCPL_CPU_LEVEL_BASELINE, (pdcpl_cpu_func) pdcpl_double_near_array_scalar}
+};
+
+PDCPL_CPU_DISPATCH(
+  pdcpl_double_near_array_func,
+  pdcpl_double_near_array,
+  pdcpl_double_near_array_impls,
+  (const double *a, const double *b, size_t n, double eps, uint64_t *mask),
+  (a, b, n, eps, mask)
+)
+
+/**
+ * Check element-wise if two arrays of doubles are within an absolute tolerance.
+ *
+ * @param a First array
+ * @param b Second array
+ * @param n Number of elements in each array
+ * @param eps Absolute tolerance
+ * @param mask Array of `pdcpl_mask_words(n)` words to write results to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`
+ */
+int
+pdcpl_double_near_array(
+  const double *a, const double *b, size_t n, double eps, uint64_t *mask)
+{
+  if (!a || !b || !mask)
+    return -EINVAL;
+  PDCPL_CPU_KERNEL(pdcpl_double_near_array_func, pdcpl_double_near_array)(
+    a, b, n, fabs(eps), mask
+  );
+  return 0;
+}
+
+/**
+ * Map a double's bits to an integer that is ordered the same as the double.
+ *
+ * Negative values have their magnitude bits negated so that the integers
+ * increase monotonically from -inf to +inf, with -0.0 and +0.0 both mapped
+ * to zero. The value must not be NaN.
+ *
+ * @param x Double to map
+ */
+static inline int64_t
+pdcpl_double_ordered_bits(double x)
+{
+  int64_t bits;
+  memcpy(&bits, &x, sizeof bits);
+  return (bits < 0) ? INT64_MIN - bits : bits;
+}
+
+/**
+ * Return the distance between two doubles in units in the last place.
+ *
+ * @param a First double
+ * @param b Second double
+ * @returns ULP distance, `UINT64_MAX` if either value is NaN
+ */
+uint64_t
+pdcpl_double_ulp_distance(double a, double b)
+{
+  if (isnan(a) || isnan(b))
+    return UINT64_MAX;
+  int64_t ia = pdcpl_double_ordered_bits(a);
+  int64_t ib = pdcpl_double_ordered_bits(b);
+  // unsigned subtraction so the full range doesn't overflow
+  return (ia < ib) ? (uint64_t) ib - (uint64_t) ia :
+    (uint64_t) ia - (uint64_t) ib;
+}
+
+/**
+ * Check element-wise if two arrays of doubles are within a ULP distance.
+ *
+ * @param a First array
+ * @param b Second array
+ * @param n Number of elements in each array
+ * @param max_ulp Maximum ULP distance
+ * @param mask Array of `pdcpl_mask_words(n)` words to write results to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`
+ */
+int
+pdcpl_double_ulp_near_array(
+  const double *a, const double *b, size_t n, uint64_t max_ulp, uint64_t *mask)
+{
+  if (!a || !b || !mask)
+    return -EINVAL;
+  for (size_t base = 0; base < n; base += 64) {
+    size_t end = (n - base < 64) ? n : base + 64;
+    uint64_t bits = 0;
+    for (size_t i = base; i < end; i++) {
+      bool near = pdcpl_double_ulp_near(a[i], b[i], max_ulp);
+      bits |= (uint64_t) near << (i - base);
+    }
+    mask[base / 64] = bits;
+  }
+  return 0;
+}
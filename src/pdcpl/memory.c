@@ -13,6 +13,7 @@
 #include <stdlib.h>
 
 #include "pdcpl/common.h"
+#include "pdcpl/stats.h"
 
 /**
  * Expand the buffer by the specified number of bytes.
@@ -30,6 +31,7 @@ pdcpl_buffer_expand_exact(pdcpl_buffer *buf, size_t expand_size)
   if (!expand_size)
     return 0;
   void *new_data = realloc(buf->data, buf->size + expand_size);
+  pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
   if (!new_data)
     return -ENOMEM;
   buf->data = new_data;
@@ -80,6 +82,7 @@ pdcpl_buffer_dynexpand_custom(
       return (int) ex_size;
     // attempt realloc, and if successful, update buf struct
     void *new_data = realloc(buf->data, buf->size + ex_size);
+    pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
     if (!new_data)
       return -ENOMEM;
     buf->data = new_data;
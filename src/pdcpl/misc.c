@@ -0,0 +1,342 @@
+/**
+ * @file misc.c
+ * @author Derek Huang
+ * @brief C source for miscellaneous functions
+ * @copyright MIT License
+ */
+
+#include "pdcpl/misc.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pdcpl/cpu.h"
+#include "pdcpl/memory.h"
+
+#if defined(PDCPL_CPU_X86)
+#include <immintrin.h>
+#endif  // defined(PDCPL_CPU_X86)
+
+// vector kernels do the same operations in the same order as the scalar
+// conversions, so results are bitwise identical
+
+/**
+ * Portable `pdcpl_f2ctemp_array` kernel.
+ */
+static void
+pdcpl_f2ctemp_array_scalar(const double *in, double *out, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = pdcpl_f2ctemp(in[i]);
+}
+
+/**
+ * Portable `pdcpl_c2ftemp_array` kernel.
+ */
+static void
+pdcpl_c2ftemp_array_scalar(const double *in, double *out, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = pdcpl_c2ftemp(in[i]);
+}
+
+#if defined(PDCPL_CPU_X86)
+/**
+ * SSE2 `pdcpl_f2ctemp_array` kernel.
+ */
+PDCPL_CPU_TARGET("sse2")
+static void
+pdcpl_f2ctemp_array_sse2(const double *in, double *out, size_t n)
+{
+  const __m128d v5 = _mm_set1_pd(5), v9 = _mm_set1_pd(9);
+  const __m128d v32 = _mm_set1_pd(32);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d t = _mm_sub_pd(_mm_loadu_pd(in + i), v32);
+    _mm_storeu_pd(out + i, _mm_div_pd(_mm_mul_pd(v5, t), v9));
+  }
+  pdcpl_f2ctemp_array_scalar(in + i, out + i, n - i);
+}
+
+/**
+ * AVX `pdcpl_f2ctemp_array` kernel.
+ */
+PDCPL_CPU_TARGET("avx")
+static void
+pdcpl_f2ctemp_array_avx(const double *in, double *out, size_t n)
+{
+  const __m256d v5 = _mm256_set1_pd(5), v9 = _mm256_set1_pd(9);
+  const __m256d v32 = _mm256_set1_pd(32);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d t = _mm256_sub_pd(_mm256_loadu_pd(in + i), v32);
+    _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_mul_pd(v5, t), v9));
+  }
+  pdcpl_f2ctemp_array_scalar(in + i, out + i, n - i);
+}
+
+/**
+ * SSE2 `pdcpl_c2ftemp_array` kernel.
+ */
+PDCPL_CPU_TARGET("sse2")
+static void
+pdcpl_c2ftemp_array_sse2(const double *in, double *out, size_t n)
+{
+  const __m128d v5 = _mm_set1_pd(5), v9 = _mm_set1_pd(9);
+  const __m128d v32 = _mm_set1_pd(32);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d t = _mm_mul_pd(v9, _mm_loadu_pd(in + i));
+    _mm_storeu_pd(out + i, _mm_add_pd(_mm_div_pd(t, v5), v32));
+  }
+  pdcpl_c2ftemp_array_scalar(in + i, out + i, n - i);
+}
+
+/**
+ * AVX `pdcpl_c2ftemp_array` kernel.
+ */
+PDCPL_CPU_TARGET("avx")
+static void
+pdcpl_c2ftemp_array_avx(const double *in, double *out, size_t n)
+{
+  const __m256d v5 = _mm256_set1_pd(5), v9 = _mm256_set1_pd(9);
+  const __m256d v32 = _mm256_set1_pd(32);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d t = _mm256_mul_pd(v9, _mm256_loadu_pd(in + i));
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_div_pd(t, v5), v32));
+  }
+  pdcpl_c2ftemp_array_scalar(in + i, out + i, n - i);
+}
+#endif  // defined(PDCPL_CPU_X86)
+
+/**
+ * `pdcpl_f2ctemp_array` kernels, from highest to lowest CPU level.
+ */
+static const pdcpl_cpu_impl pdcpl_f2ctemp_array_impls[] = {
+#if defined(PDCPL_CPU_X86)
+  {PDCPL_CPU_LEVEL_AVX, (pdcpl_cpu_func) pdcpl_f2ctemp_array_avx},
+  {PDCPL_CPU_LEVEL_SSE2, (pdcpl_cpu_func) pdcpl_f2ctemp_array_sse2},
+#endif  // defined(PDCPL_CPU_X86)
+  {PDCPL_CPU_LEVEL_BASELINE, (pdcpl_cpu_func) pdcpl_f2ctemp_array_scalar}
+};
+
+/**
+ * `pdcpl_c2ftemp_array` kernels, from highest to lowest CPU level.
+ */
+static const pdcpl_cpu_impl pdcpl_c2ftemp_array_impls[] = {
+#if defined(PDCPL_CPU_X86)
+  {PDCPL_CPU_LEVEL_AVX, (pdcpl_cpu_func) pdcpl_c2ftemp_array_avx},
+  {PDCPL_CPU_LEVEL_SSE2, (pdcpl_cpu_func) pdcpl_c2ftemp_array_sse2},
+#endif  // defined(PDCPL_CPU_X86)
+  {PDCPL_CPU_LEVEL_BASELINE, (pdcpl_cpu_func) pdcpl_c2ftemp_array_scalar}
+};
+
+PDCPL_CPU_DISPATCH(
+  pdcpl_convarray_func,
+  pdcpl_f2ctemp_array,
+  pdcpl_f2ctemp_array_impls,
+  (const double *in, double *out, size_t n),
+  (in, out, n)
+)
+
+PDCPL_CPU_DISPATCH(
+  pdcpl_convarray_func,
+  pdcpl_c2ftemp_array,
+  pdcpl_c2ftemp_array_impls,
+  (const double *in, double *out, size_t n),
+  (in, out, n)
+)
+
+/**
+ * Converts an array of Fahrenheit temperatures to Celsius.
+ *
+ * @param in Temperatures in Fahrenheit
+ * @param out Array to write temperatures in Celsius to
+ * @param n Number of elements in `in` and `out`
+ */
+void
+pdcpl_f2ctemp_array(const double *in, double *out, size_t n)
+{
+  PDCPL_CPU_KERNEL(pdcpl_convarray_func, pdcpl_f2ctemp_array)(in, out, n);
+}
+
+/**
+ * Converts an array of Celsius temperatures to Fahrenheit.
+ *
+ * @param in Temperatures in Celsius
+ * @param out Array to write temperatures in Fahrenheit to
+ * @param n Number of elements in `in` and `out`
+ */
+void
+pdcpl_c2ftemp_array(const double *in, double *out, size_t n)
+{
+  PDCPL_CPU_KERNEL(pdcpl_convarray_func, pdcpl_c2ftemp_array)(in, out, n);
+}
+
+/**
+ * Append formatted text to a buffer, growing the buffer if necessary.
+ *
+ * @param out Buffer to write to
+ * @param pos Address of current write offset, updated on success
+ * @param fmt `printf` format string
+ * @returns 0 on success, -EINVAL on formatting error, -ENOMEM if memory
+ *  allocation fails
+ */
+static int
+pdcpl_convtable_printf(pdcpl_buffer *out, size_t *pos, const char *fmt, ...)
+{
+  va_list args;
+  for (;;) {
+    size_t avail = out->size - *pos;
+    va_start(args, fmt);
+    int n = vsnprintf((char *) out->data + *pos, avail, fmt, args);
+    va_end(args);
+    if (n < 0)
+      return -EINVAL;
+    if ((size_t) n < avail) {
+      *pos += (size_t) n;
+      return 0;
+    }
+    // only happens if values are wider than the columns
+    int status = pdcpl_buffer_realloc(out, 2 * out->size + (size_t) n);
+    if (status)
+      return status;
+  }
+}
+
+/**
+ * Check that a conversion table column has a label and an in-range format.
+ *
+ * @param col Column format
+ */
+static bool
+pdcpl_convtable_column_valid(const pdcpl_convtable_column *col)
+{
+  return
+    col->label &&
+    col->width &&
+    col->width <= PDCPL_CONVTABLE_WIDTH_MAX &&
+    col->precision <= PDCPL_CONVTABLE_WIDTH_MAX;
+}
+
+/**
+ * Append a conversion table border line to a buffer.
+ *
+ * @param spec Table specification
+ * @param out Buffer to write to
+ * @param pos Address of current write offset, updated on success
+ * @returns 0 on success, -EINVAL on formatting error, -ENOMEM if memory
+ *  allocation fails
+ */
+static int
+pdcpl_convtable_border(
+  const pdcpl_convtable_spec *spec, pdcpl_buffer *out, size_t *pos)
+{
+  // PDCPL_CONVTABLE_WIDTH_MAX + 2 dashes for the widest padded column
+  static const char dashes[] = "----------------------------------";
+  return pdcpl_convtable_printf(
+    out,
+    pos,
+    "+%.*s+%.*s+\n",
+    (int) spec->in.width + 2,
+    dashes,
+    (int) spec->out.width + 2,
+    dashes
+  );
+}
+
+/**
+ * Format a bordered two-column conversion table into a buffer.
+ *
+ * @param spec Table specification
+ * @param out Buffer to allocate and write the table to
+ * @param np Address to write the table length, excluding the null, to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL`, if a
+ *  column width or precision is out of range, or if the step is zero or does
+ *  not go from `start` toward `stop`, -ENOMEM if memory allocation fails
+ */
+int
+pdcpl_convtable_format(
+  const pdcpl_convtable_spec *spec, pdcpl_buffer *out, size_t *np)
+{
+  if (!spec || !spec->conv)
+    return -EINVAL;
+  if (
+    !pdcpl_convtable_column_valid(&spec->in) ||
+    !pdcpl_convtable_column_valid(&spec->out)
+  )
+    return -EINVAL;
+  if (!out || !np)
+    return -EINVAL;
+  // number of steps, with a little slack for inexact non-integral steps
+  double steps = (spec->stop - spec->start) / spec->step;
+  if (!isfinite(steps) || steps < 0)
+    return -EINVAL;
+  // too many rows to allocate
+  if (steps >= (double) (SIZE_MAX / (2 * sizeof(double))))
+    return -ENOMEM;
+  size_t n_rows = (size_t) floor(steps + 1e-9) + 1;
+  // compute input values and then convert all of them at once. there is
+  // always at least one row
+  pdcpl_buffer values = pdcpl_buffer_new(2 * n_rows * sizeof(double));
+  if (!pdcpl_buffer_ready(&values))
+    return -ENOMEM;
+  double *in = (double *) values.data;
+  double *conv = in + n_rows;
+  in[0] = spec->start;
+  for (size_t i = 1; i < n_rows; i++)
+    in[i] = spec->start + (double) i * spec->step;
+  spec->conv(in, conv, n_rows);
+  // rows plus 4 border/header lines and null terminator. each line is the
+  // column widths plus 8 chars of padding, separators, and newline
+  size_t line_size = spec->in.width + spec->out.width + 8;
+  *out = pdcpl_buffer_new((n_rows + 4) * line_size + 1);
+  if (!pdcpl_buffer_ready(out)) {
+    pdcpl_buffer_clear(&values);
+    return -ENOMEM;
+  }
+  int in_width = (int) spec->in.width;
+  int out_width = (int) spec->out.width;
+  size_t pos = 0;
+  int status = pdcpl_convtable_border(spec, out, &pos);
+  if (!status)
+    status = pdcpl_convtable_printf(
+      out,
+      &pos,
+      "| %*s | %*s |\n",
+      in_width,
+      spec->in.label,
+      out_width,
+      spec->out.label
+    );
+  if (!status)
+    status = pdcpl_convtable_border(spec, out, &pos);
+  for (size_t i = 0; !status && i < n_rows; i++)
+    status = pdcpl_convtable_printf(
+      out,
+      &pos,
+      "| %*.*f | %*.*f |\n",
+      in_width,
+      (int) spec->in.precision,
+      in[i],
+      out_width,
+      (int) spec->out.precision,
+      conv[i]
+    );
+  if (!status)
+    status = pdcpl_convtable_border(spec, out, &pos);
+  pdcpl_buffer_clear(&values);
+  if (status) {
+    pdcpl_buffer_clear(out);
+    return status;
+  }
+  *np = pos;
+  return 0;
+}
@@ -0,0 +1,345 @@
+/**
+ * @file perf.c
+ * @author Derek Huang
+ * @brief C source for hardware performance counters
+ * @copyright MIT License
+ */
+
+#include "pdcpl/perf.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // !defined(__linux__)
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pdcpl/common.h"
+
+/**
+ * Names of the hardware events, indexed by event.
+ */
+static const char *const pdcpl_perf_event_names[] = {
+  "cycles",
+  "instructions",
+  "cache-references",
+  "cache-misses",
+  "branch-misses",
+  "l1d-misses"
+};
+
+/**
+ * Return the name of a hardware event.
+ *
+ * @param event Hardware event
+ * @returns Name, e.g. `"cycles"`, `NULL` for an invalid event
+ */
+const char *
+pdcpl_perf_event_name(pdcpl_perf_event event)
+{
+  if ((unsigned int) event >= PDCPL_PERF_EVENT_MAX)
+    return NULL;
+  return pdcpl_perf_event_names[event];
+}
+
+#if defined(__linux__)
+/**
+ * `perf_event_attr` type and config for each event, indexed by event.
+ */
+static const struct {
+  uint32_t type;
+  uint64_t config;
+} pdcpl_perf_event_configs[] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  {
+    PERF_TYPE_HW_CACHE,
+    PERF_COUNT_HW_CACHE_L1D |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+  }
+};
+
+/**
+ * Open a counter for the calling thread.
+ *
+ * @param event Hardware event
+ * @param group_fd Group leader file descriptor, -1 to open a group leader
+ * @returns File descriptor on success, negative `errno` value on error
+ */
+static int
+pdcpl_perf_event_open(pdcpl_perf_event event, int group_fd)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  attr.type = pdcpl_perf_event_configs[event].type;
+  attr.config = pdcpl_perf_event_configs[event].config;
+  // only the leader starts disabled. members are scheduled with the leader
+  attr.disabled = (group_fd < 0);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP |
+    PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  long fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+  return (fd < 0) ? -errno : (int) fd;
+}
+
+/**
+ * Return the file descriptor of a group's leader, -1 if not opened.
+ *
+ * The leader is the first opened event.
+ *
+ * @param group Counter group
+ */
+static int
+pdcpl_perf_leader(const pdcpl_perf_group *group)
+{
+  for (unsigned int i = 0; i < PDCPL_PERF_EVENT_MAX; i++) {
+    if (group->events & (1u << i))
+      return group->fds[i];
+  }
+  return -1;
+}
+#endif  // defined(__linux__)
+
+/**
+ * Open a group of hardware counters for the calling thread.
+ *
+ * Only user-space events are counted so that a `perf_event_paranoid` level of
+ * 2 is sufficient. The counters start disabled.
+ *
+ * @param group Address of `pdcpl_perf_group` to write to
+ * @returns 0 on success, -EINVAL if `group` is `NULL`, -ENOSYS if counters
+ *  are not supported on this platform, negative `errno` value from
+ *  `perf_event_open` if no counters could be opened, e.g. -EACCES or -ENOENT
+ *  in containers or virtual machines where perf events are restricted
+ */
+int
+pdcpl_perf_open(pdcpl_perf_group *group)
+{
+  if (!group)
+    return -EINVAL;
+  group->events = 0;
+  for (unsigned int i = 0; i < PDCPL_PERF_EVENT_MAX; i++)
+    group->fds[i] = -1;
+#if defined(__linux__)
+  // events that fail to open are skipped, e.g. L1D events on some CPUs. the
+  // first error is returned if no events could be opened
+  int status = 0;
+  for (unsigned int i = 0; i < PDCPL_PERF_EVENT_MAX; i++) {
+    int fd = pdcpl_perf_event_open(
+      (pdcpl_perf_event) i, pdcpl_perf_leader(group)
+    );
+    if (fd < 0) {
+      if (!status)
+        status = fd;
+      continue;
+    }
+    group->fds[i] = fd;
+    group->events |= 1u << i;
+  }
+  return (group->events) ? 0 : status;
+#else
+  return -ENOSYS;
+#endif  // !defined(__linux__)
+}
+
+/**
+ * Reset and enable the counters in a group.
+ *
+ * @param group Opened counter group
+ * @returns 0 on success, -EINVAL if `group` is `NULL` or not opened, negative
+ *  `errno` value on error
+ */
+int
+pdcpl_perf_start(pdcpl_perf_group *group)
+{
+  if (!group || !group->events)
+    return -EINVAL;
+#if defined(__linux__)
+  int leader = pdcpl_perf_leader(group);
+  if (
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) < 0 ||
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) < 0
+  )
+    return -errno;
+  return 0;
+#else
+  return -ENOSYS;
+#endif  // !defined(__linux__)
+}
+
+/**
+ * Read the counters in a group.
+ *
+ * The counters are not disabled, so this can be used to take snapshots.
+ *
+ * @param group Opened counter group
+ * @param counters Address of `pdcpl_perf_counters` to write to
+ * @returns 0 on success, -EINVAL if `group` or `counters` is `NULL` or if
+ *  `group` is not opened, -EIO if the read is short, negative `errno` value
+ *  on other errors
+ */
+int
+pdcpl_perf_read(pdcpl_perf_group *group, pdcpl_perf_counters *counters)
+{
+  if (!group || !group->events || !counters)
+    return -EINVAL;
+#if defined(__linux__)
+  // group read format is nr, time_enabled, time_running, then the values in
+  // the order the events were opened
+  uint64_t buf[3 + PDCPL_PERF_EVENT_MAX];
+  ssize_t n_read = read(pdcpl_perf_leader(group), buf, sizeof buf);
+  if (n_read < 0)
+    return -errno;
+  if (
+    (size_t) n_read < 3 * sizeof *buf ||
+    (size_t) n_read < (3 + buf[0]) * sizeof *buf
+  )
+    return -EIO;
+  // scale for multiplexing. if the group never ran, the counts are 0
+  double scale = (buf[2]) ? (double) buf[1] / (double) buf[2] : 0;
+  counters->events = group->events;
+  for (unsigned int i = 0, j = 3; i < PDCPL_PERF_EVENT_MAX; i++) {
+    if (group->events & (1u << i))
+      counters->values[i] = (uint64_t) (scale * (double) buf[j++]);
+    else
+      counters->values[i] = 0;
+  }
+  return 0;
+#else
+  return -ENOSYS;
+#endif  // !defined(__linux__)
+}
+
+/**
+ * Disable the counters in a group and read them.
+ *
+ * @param group Opened counter group
+ * @param counters Address of `pdcpl_perf_counters` to write to
+ * @returns 0 on success, -EINVAL if `group` or `counters` is `NULL` or if
+ *  `group` is not opened, -EIO if the read is short, negative `errno` value
+ *  on other errors
+ */
+int
+pdcpl_perf_stop(pdcpl_perf_group *group, pdcpl_perf_counters *counters)
+{
+  if (!group || !group->events || !counters)
+    return -EINVAL;
+#if defined(__linux__)
+  int leader = pdcpl_perf_leader(group);
+  if (ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP) < 0)
+    return -errno;
+  return pdcpl_perf_read(group, counters);
+#else
+  return -ENOSYS;
+#endif  // !defined(__linux__)
+}
+
+/**
+ * Close the counters in a group.
+ *
+ * Safe to call on a group that failed to open.
+ *
+ * @param group Counter group
+ */
+void
+pdcpl_perf_close(pdcpl_perf_group *group)
+{
+  if (!group)
+    return;
+#if defined(__linux__)
+  // close members before the leader
+  for (unsigned int i = PDCPL_PERF_EVENT_MAX; i-- > 0; ) {
+    if (group->events & (1u << i))
+      close(group->fds[i]);
+    group->fds[i] = -1;
+  }
+#endif  // defined(__linux__)
+  group->events = 0;
+}
+
+/**
+ * Write counter values and derived rates to a stream.
+ *
+ * IPC and cache miss rate are written if their events were counted, while
+ * per-byte rates are written if `bytes` is nonzero. If no events were
+ * counted, the counters are reported as unavailable.
+ *
+ * @param f Stream to write to
+ * @param counters Counter values
+ * @param bytes Number of bytes processed while counting, 0 if not known
+ * @param json `true` to write a JSON object without a trailing newline,
+ *  `false` to write lines of text
+ * @returns 0 on success, -EINVAL if `f` or `counters` is `NULL`, -EIO on
+ *  write error
+ */
+int
+pdcpl_perf_fprintf(
+  FILE *f, const pdcpl_perf_counters *counters, uint64_t bytes, bool json)
+{
+  if (!f || !counters)
+    return -EINVAL;
+  if (!counters->events) {
+    fprintf(f, (json) ? "null" : "perf counters:  unavailable\n");
+    return (ferror(f)) ? -EIO : 0;
+  }
+  // JSON members are separated by commas
+  const char *sep = "";
+  if (json)
+    fprintf(f, "{");
+  char label[32];
+  for (unsigned int i = 0; i < PDCPL_PERF_EVENT_MAX; i++) {
+    if (!pdcpl_perf_has(counters, (pdcpl_perf_event) i))
+      continue;
+    const char *name = pdcpl_perf_event_names[i];
+    unsigned long long value = (unsigned long long) counters->values[i];
+    double per_byte = (bytes) ? (double) value / (double) bytes : 0;
+    if (json) {
+      fprintf(f, "%s\"%s\": %llu", sep, name, value);
+      if (bytes)
+        fprintf(f, ", \"%s_per_byte\": %.4f", name, per_byte);
+    }
+    else {
+      snprintf(label, sizeof label, "%s:", name);
+      fprintf(f, "%-17s %llu\n", label, value);
+      if (bytes) {
+        snprintf(label, sizeof label, "%s/byte:", name);
+        fprintf(f, "%-17s %.4f\n", label, per_byte);
+      }
+    }
+    sep = ", ";
+  }
+  double ipc = pdcpl_perf_ipc(counters);
+  if (ipc > 0) {
+    if (json)
+      fprintf(f, "%s\"ipc\": %.3f", sep, ipc);
+    else
+      fprintf(f, "%-17s %.3f\n", "ipc:", ipc);
+  }
+  if (
+    pdcpl_perf_has(counters, PDCPL_PERF_CACHE_REFERENCES) &&
+    pdcpl_perf_has(counters, PDCPL_PERF_CACHE_MISSES) &&
+    counters->values[PDCPL_PERF_CACHE_REFERENCES]
+  ) {
+    double miss_rate = (double) counters->values[PDCPL_PERF_CACHE_MISSES] /
+      (double) counters->values[PDCPL_PERF_CACHE_REFERENCES];
+    if (json)
+      fprintf(f, ", \"cache_miss_rate\": %.4f", miss_rate);
+    else
+      fprintf(f, "%-17s %.2f%%\n", "cache miss rate:", 100 * miss_rate);
+  }
+  if (json)
+    fprintf(f, "}");
+  return (ferror(f)) ? -EIO : 0;
+}
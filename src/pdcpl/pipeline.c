@@ -0,0 +1,552 @@
+/**
+ * @file pipeline.c
+ * @author Derek Huang
+ * @brief C source for in-process text filter pipelines
+ * @copyright MIT License
+ */
+
+#include "pdcpl/pipeline.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdcpl/stats.h"
+
+/**
+ * Largest tab size accepted by the `detab` stage.
+ *
+ * A tab can expand to this many blanks, so this bounds the buffer size.
+ */
+#define PDCPL_PIPELINE_MAX_TABSIZE 64
+
+// forward declaration for the stage type
+typedef struct pdcpl_pipeline_stage pdcpl_pipeline_stage;
+
+/**
+ * Typedef for a stage block transform.
+ *
+ * `out` has room for the input size times the stage expansion factor. If the
+ * expansion factor is 1, `out` may equal `in`, so transforms that never grow
+ * their input must not write past the input position they have read up to.
+ *
+ * @param stage Stage to transform with, whose state is updated
+ * @param in Input bytes
+ * @param in_size Number of input bytes
+ * @param out Output buffer
+ * @returns Number of output bytes written
+ */
+typedef size_t (*pdcpl_pipeline_transform)(
+  pdcpl_pipeline_stage *stage, const char *in, size_t in_size, char *out);
+
+/**
+ * Stage definition.
+ *
+ * @param name Stage name used in pipeline specifications
+ * @param transform Block transform
+ * @param expand Maximum output bytes per input byte, 0 if it is the argument
+ * @param default_arg Default argument, 0 if the stage takes no argument
+ */
+typedef struct {
+  const char *name;
+  pdcpl_pipeline_transform transform;
+  size_t expand;
+  size_t default_arg;
+} pdcpl_pipeline_stage_def;
+
+/**
+ * Pipeline stage.
+ *
+ * @param def Stage definition
+ * @param arg Stage argument, e.g. the `detab` tab size
+ * @param expand Maximum output bytes per input byte
+ * @param column Current output column, used by `detab`
+ * @param blank `true` if the last byte was a blank, used by `squeeze`, or if
+ *  the last word has been ended with a newline, used by `words`
+ * @param in_word `true` if the last byte was part of a word, used by `words`
+ */
+struct pdcpl_pipeline_stage {
+  const pdcpl_pipeline_stage_def *def;
+  size_t arg;
+  size_t expand;
+  size_t column;
+  bool blank;
+  bool in_word;
+};
+
+/**
+ * Pipeline implementation.
+ *
+ * @param n_stages Number of stages
+ * @param stages Stages in the order they are applied
+ * @param block_size Maximum number of input bytes per block
+ * @param buf_size Size of each buffer, the block size times the product of
+ *  each stage's expansion factor
+ * @param bufs Buffers the stages read from and write to
+ */
+struct pdcpl_pipeline {
+  size_t n_stages;
+  pdcpl_pipeline_stage *stages;
+  size_t block_size;
+  size_t buf_size;
+  char *bufs[2];
+};
+
+/**
+ * Replace tabs with blanks up to the next tab stop.
+ */
+static size_t
+pdcpl_pipeline_detab(
+  pdcpl_pipeline_stage *stage, const char *in, size_t in_size, char *out)
+{
+  size_t n_out = 0;
+  size_t column = stage->column;
+  for (size_t i = 0; i < in_size; i++) {
+    if (in[i] == '\t') {
+      size_t n_blanks = stage->arg - column % stage->arg;
+      memset(out + n_out, ' ', n_blanks);
+      n_out += n_blanks;
+      column += n_blanks;
+    }
+    else {
+      out[n_out++] = in[i];
+      column = (in[i] == '\n') ? 0 : column + 1;
+    }
+  }
+  stage->column = column;
+  return n_out;
+}
+
+/**
+ * Escape tabs, backspaces, and backslashes.
+ */
+static size_t
+pdcpl_pipeline_escape(
+  pdcpl_pipeline_stage *stage, const char *in, size_t in_size, char *out)
+{
+  (void) stage;
+  size_t n_out = 0;
+  for (size_t i = 0; i < in_size; i++) {
+    switch (in[i]) {
+      case '\t':
+        out[n_out++] = '\\';
+        out[n_out++] = 't';
+        break;
+      case '\b':
+        out[n_out++] = '\\';
+        out[n_out++] = 'b';
+        break;
+      case '\\':
+        out[n_out++] = '\\';
+        out[n_out++] = '\\';
+        break;
+      default:
+        out[n_out++] = in[i];
+    }
+  }
+  return n_out;
+}
+
+/**
+ * Convert text to lowercase.
+ */
+static size_t
+pdcpl_pipeline_lower(
+  pdcpl_pipeline_stage *stage, const char *in, size_t in_size, char *out)
+{
+  (void) stage;
+  for (size_t i = 0; i < in_size; i++)
+    out[i] = (char) tolower((unsigned char) in[i]);
+  return in_size;
+}
+
+/**
+ * Replace multiple blanks with a single blank.
+ */
+static size_t
+pdcpl_pipeline_squeeze(
+  pdcpl_pipeline_stage *stage, const char *in, size_t in_size, char *out)
+{
+  size_t n_out = 0;
+  bool blank = stage->blank;
+  for (size_t i = 0; i < in_size; i++) {
+    if (in[i] == ' ') {
+      if (blank)
+        continue;
+      blank = true;
+    }
+    else
+      blank = false;
+    out[n_out++] = in[i];
+  }
+  stage->blank = blank;
+  return n_out;
+}
+
+/**
+ * Convert text to uppercase.
+ */
+static size_t
+pdcpl_pipeline_upper(
+  pdcpl_pipeline_stage *stage, const char *in, size_t in_size, char *out)
+{
+  (void) stage;
+  for (size_t i = 0; i < in_size; i++)
+    out[i] = (char) toupper((unsigned char) in[i]);
+  return in_size;
+}
+
+/**
+ * Write one word per line, dropping other whitespace.
+ *
+ * A run of whitespace is replaced with a single newline, so the output is no
+ * longer than the input.
+ */
+static size_t
+pdcpl_pipeline_words(
+  pdcpl_pipeline_stage *stage, const char *in, size_t in_size, char *out)
+{
+  size_t n_out = 0;
+  bool in_word = stage->in_word, just_exited = stage->blank;
+  for (size_t i = 0; i < in_size; i++) {
+    if (!isspace((unsigned char) in[i])) {
+      out[n_out++] = in[i];
+      in_word = true;
+      just_exited = false;
+    }
+    else {
+      in_word = false;
+      if (!just_exited) {
+        out[n_out++] = '\n';
+        just_exited = true;
+      }
+    }
+  }
+  stage->in_word = in_word;
+  stage->blank = just_exited;
+  return n_out;
+}
+
+/**
+ * Stage definitions sorted by name.
+ */
+static const pdcpl_pipeline_stage_def pdcpl_pipeline_stage_defs[] = {
+  {"detab", pdcpl_pipeline_detab, 0, 8},
+  {"escape", pdcpl_pipeline_escape, 2, 0},
+  {"lower", pdcpl_pipeline_lower, 1, 0},
+  {"squeeze", pdcpl_pipeline_squeeze, 1, 0},
+  {"upper", pdcpl_pipeline_upper, 1, 0},
+  {"words", pdcpl_pipeline_words, 1, 0}
+};
+
+/**
+ * Number of stage definitions.
+ */
+#define PDCPL_PIPELINE_N_STAGE_DEFS \
+  (sizeof pdcpl_pipeline_stage_defs / sizeof *pdcpl_pipeline_stage_defs)
+
+/**
+ * Return the next whitespace-delimited token in a stage specification.
+ *
+ * @param sp Address of current position, updated to one past the token
+ * @param end One past the last character of the stage specification
+ * @param np Address to write the token length to, 0 if there are no tokens
+ * @returns Pointer to the start of the token
+ */
+static const char *
+pdcpl_pipeline_token(const char **sp, const char *end, size_t *np)
+{
+  const char *s = *sp;
+  while (s < end && isspace((unsigned char) *s))
+    s++;
+  const char *token = s;
+  while (s < end && !isspace((unsigned char) *s))
+    s++;
+  *sp = s;
+  *np = (size_t) (s - token);
+  return token;
+}
+
+/**
+ * Initialize a stage from its specification.
+ *
+ * @param stage Stage to initialize
+ * @param s Start of the stage specification
+ * @param end One past the last character of the stage specification
+ * @returns 0 on success, -EINVAL if the specification is empty, names an
+ *  unknown stage, or has a bad or extra argument
+ */
+static int
+pdcpl_pipeline_stage_init(
+  pdcpl_pipeline_stage *stage, const char *s, const char *end)
+{
+  size_t n;
+  const char *name = pdcpl_pipeline_token(&s, end, &n);
+  if (!n)
+    return -EINVAL;
+  // find the stage definition by name
+  const pdcpl_pipeline_stage_def *def = NULL;
+  for (size_t i = 0; i < PDCPL_PIPELINE_N_STAGE_DEFS; i++) {
+    const char *def_name = pdcpl_pipeline_stage_defs[i].name;
+    if (strlen(def_name) == n && !strncmp(def_name, name, n)) {
+      def = pdcpl_pipeline_stage_defs + i;
+      break;
+    }
+  }
+  if (!def)
+    return -EINVAL;
+  memset(stage, 0, sizeof *stage);
+  stage->def = def;
+  stage->arg = def->default_arg;
+  // parse optional argument if the stage takes one
+  const char *arg = pdcpl_pipeline_token(&s, end, &n);
+  if (n) {
+    if (!def->default_arg)
+      return -EINVAL;
+    stage->arg = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (!isdigit((unsigned char) arg[i]))
+        return -EINVAL;
+      stage->arg = 10 * stage->arg + (size_t) (arg[i] - '0');
+      if (stage->arg > PDCPL_PIPELINE_MAX_TABSIZE)
+        return -EINVAL;
+    }
+    if (!stage->arg)
+      return -EINVAL;
+  }
+  // no trailing tokens allowed
+  pdcpl_pipeline_token(&s, end, &n);
+  if (n)
+    return -EINVAL;
+  stage->expand = (def->expand) ? def->expand : stage->arg;
+  return 0;
+}
+
+/**
+ * Create a new pipeline from a specification.
+ *
+ * @param pipeline Address of `pdcpl_pipeline *` to write the new handle to
+ * @param spec Stages separated by `|`, each a stage name followed by its
+ *  optional argument, with any amount of surrounding whitespace
+ * @param block_size Maximum number of input bytes per block, 0 for
+ *  `PDCPL_PIPELINE_BLOCK_SIZE`
+ * @returns 0 on success, -EINVAL if `pipeline` or `spec` is `NULL`, `spec`
+ *  has an empty, unknown, or malformed stage, or the buffers would be too
+ *  large, -ENOMEM if memory allocation fails
+ */
+int
+pdcpl_pipeline_create(
+  pdcpl_pipeline **pipeline, const char *spec, size_t block_size)
+{
+  if (!pipeline || !spec)
+    return -EINVAL;
+  if (!block_size)
+    block_size = PDCPL_PIPELINE_BLOCK_SIZE;
+  // one stage per separator plus one
+  size_t n_stages = 1;
+  for (const char *s = spec; *s; s++)
+    if (*s == '|')
+      n_stages++;
+  pdcpl_pipeline *pipe = calloc(1, sizeof *pipe);
+  if (!pipe)
+    return -ENOMEM;
+  pipe->stages = malloc(n_stages * sizeof *pipe->stages);
+  if (!pipe->stages) {
+    free(pipe);
+    return -ENOMEM;
+  }
+  pipe->n_stages = n_stages;
+  pipe->block_size = block_size;
+  // parse each stage and size the buffers for the largest expansion
+  int status;
+  size_t buf_size = block_size;
+  const char *s = spec;
+  for (size_t i = 0; i < n_stages; i++) {
+    const char *end = strchr(s, '|');
+    if (!end)
+      end = s + strlen(s);
+    if ((status = pdcpl_pipeline_stage_init(pipe->stages + i, s, end)))
+      goto error;
+    if (buf_size > SIZE_MAX / 2 / pipe->stages[i].expand) {
+      status = -EINVAL;
+      goto error;
+    }
+    buf_size *= pipe->stages[i].expand;
+    s = end + 1;
+  }
+  pipe->buf_size = buf_size;
+  for (size_t i = 0; i < 2; i++) {
+    if (!(pipe->bufs[i] = malloc(buf_size))) {
+      status = -ENOMEM;
+      goto error;
+    }
+  }
+  *pipeline = pipe;
+  return 0;
+error:
+  pdcpl_pipeline_destroy(pipe);
+  return status;
+}
+
+/**
+ * Free a pipeline.
+ *
+ * @param pipeline Pipeline handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `pipeline` is `NULL`
+ */
+int
+pdcpl_pipeline_destroy(pdcpl_pipeline *pipeline)
+{
+  if (!pipeline)
+    return -EINVAL;
+  free(pipeline->bufs[0]);
+  free(pipeline->bufs[1]);
+  free(pipeline->stages);
+  free(pipeline);
+  return 0;
+}
+
+/**
+ * Return the number of stages in a pipeline.
+ *
+ * @param pipeline Pipeline handle
+ */
+size_t
+pdcpl_pipeline_size(const pdcpl_pipeline *pipeline)
+{
+  return pipeline->n_stages;
+}
+
+/**
+ * Return the maximum number of input bytes per block of a pipeline.
+ *
+ * @param pipeline Pipeline handle
+ */
+size_t
+pdcpl_pipeline_block_size(const pdcpl_pipeline *pipeline)
+{
+  return pipeline->block_size;
+}
+
+/**
+ * Reset the state of each stage as if no input had been transformed.
+ *
+ * @param pipeline Pipeline handle
+ * @returns 0 on success, -EINVAL if `pipeline` is `NULL`
+ */
+int
+pdcpl_pipeline_reset(pdcpl_pipeline *pipeline)
+{
+  if (!pipeline)
+    return -EINVAL;
+  for (size_t i = 0; i < pipeline->n_stages; i++) {
+    pdcpl_pipeline_stage *stage = pipeline->stages + i;
+    stage->column = 0;
+    stage->blank = stage->in_word = false;
+  }
+  return 0;
+}
+
+/**
+ * Transform a block through each stage.
+ *
+ * Stages that never grow their input write over it when it is already in
+ * one of the pipeline buffers, otherwise they write to the other buffer.
+ *
+ * @param pipeline Pipeline handle
+ * @param in Input bytes
+ * @param in_size Number of input bytes
+ * @param in_buf Index of the pipeline buffer `in` points to, -1 if `in` is
+ *  not one of the pipeline buffers
+ * @param out Address of `const char *` to write the output pointer to
+ * @returns Number of output bytes
+ */
+static size_t
+pdcpl_pipeline_apply(
+  pdcpl_pipeline *pipeline,
+  const char *in,
+  size_t in_size,
+  int in_buf,
+  const char **out)
+{
+  for (size_t i = 0; i < pipeline->n_stages; i++) {
+    pdcpl_pipeline_stage *stage = pipeline->stages + i;
+    // write in place if possible, otherwise to the other buffer
+    int out_buf = (in_buf < 0) ? 0 : in_buf;
+    if (in_buf >= 0 && stage->expand > 1)
+      out_buf = !in_buf;
+    char *buf = pipeline->bufs[out_buf];
+    in_size = stage->def->transform(stage, in, in_size, buf);
+    in = buf;
+    in_buf = out_buf;
+  }
+  *out = in;
+  return in_size;
+}
+
+/**
+ * Transform a block of input through each stage of a pipeline.
+ *
+ * Consecutive blocks are treated as one continuous input, so a block may end
+ * in the middle of a line or word. The output points into the pipeline's own
+ * buffers and is only valid until the next call.
+ *
+ * @param pipeline Pipeline handle
+ * @param in Input bytes, can be `NULL` if `in_size` is 0
+ * @param in_size Number of input bytes, at most the pipeline block size
+ * @param out Address of `const char *` to write the output pointer to
+ * @param out_size Address of `size_t` to write the output size to
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL` or
+ *  `in_size` is larger than the pipeline block size
+ */
+int
+pdcpl_pipeline_process(
+  pdcpl_pipeline *pipeline,
+  const void *in,
+  size_t in_size,
+  const char **out,
+  size_t *out_size)
+{
+  if (!pipeline || (!in && in_size) || !out || !out_size)
+    return -EINVAL;
+  if (in_size > pipeline->block_size)
+    return -EINVAL;
+  *out_size = pdcpl_pipeline_apply(pipeline, in, in_size, -1, out);
+  return 0;
+}
+
+/**
+ * Transform a stream through a pipeline until end of input.
+ *
+ * Blocks are read directly into the pipeline's buffers, so the only copies
+ * are the read, the write, and any stage that may expand its input.
+ *
+ * @param pipeline Pipeline handle
+ * @param in Stream to read from
+ * @param out Stream to write to
+ * @returns 0 on success, -EINVAL if any argument is `NULL`, -EIO on read or
+ *  write error
+ */
+int
+pdcpl_pipeline_run(pdcpl_pipeline *pipeline, FILE *in, FILE *out)
+{
+  if (!pipeline || !in || !out)
+    return -EINVAL;
+  size_t n_read, n_write;
+  const char *block;
+  while ((n_read = fread(pipeline->bufs[0], 1, pipeline->block_size, in))) {
+    n_write = pdcpl_pipeline_apply(
+      pipeline, pipeline->bufs[0], n_read, 0, &block
+    );
+    if (fwrite(block, 1, n_write, out) != n_write)
+      return -EIO;
+    pdcpl_stats_add(PDCPL_STATS_BYTES_READ, n_read);
+    pdcpl_stats_add(PDCPL_STATS_BYTES_WRITTEN, n_write);
+  }
+  return (ferror(in)) ? -EIO : 0;
+}
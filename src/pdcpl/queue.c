@@ -0,0 +1,770 @@
+/**
+ * @file queue.c
+ * @author Derek Huang
+ * @brief C source for bounded lock-free buffer queues
+ * @copyright MIT License
+ */
+
+#include "pdcpl/queue.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pdcpl/atomic.h"
+#include "pdcpl/common.h"
+#include "pdcpl/memory.h"
+#include "pdcpl/thread.h"
+
+/**
+ * Assumed cache line size used to keep producer and consumer state apart.
+ */
+#define PDCPL_CACHE_LINE_SIZE 64
+
+/**
+ * Round a capacity up to a power of 2.
+ *
+ * @param capacity Requested capacity, positive
+ * @param min_capacity Minimum capacity, a power of 2
+ * @returns Rounded capacity, 0 if too large to index or allocate
+ */
+static size_t
+pdcpl_queue_capacity(size_t capacity, size_t min_capacity)
+{
+  size_t rounded = min_capacity;
+  while (rounded < capacity) {
+    if (rounded > SIZE_MAX / 2)
+      return 0;
+    rounded *= 2;
+  }
+  // cells are at most a few pointers wide, so this bounds their total size
+  return (rounded <= SIZE_MAX / 64) ? rounded : 0;
+}
+
+/**
+ * Single-producer single-consumer queue implementation.
+ *
+ * The padding keeps the read-only state, the producer state, and the
+ * consumer state on separate cache lines.
+ *
+ * @param mask Capacity minus 1, capacity is a power of 2
+ * @param slots Ring of buffers indexed by position modulo capacity
+ * @param tail Position one past the newest buffer, written by the producer
+ * @param cached_head Producer's copy of `head`
+ * @param head Position of the oldest buffer, written by the consumer
+ * @param cached_tail Consumer's copy of `tail`
+ */
+struct pdcpl_spsc_queue {
+  size_t mask;
+  pdcpl_buffer *slots;
+  char pad_1[PDCPL_CACHE_LINE_SIZE];
+  volatile uint64_t tail;
+  uint64_t cached_head;
+  char pad_2[PDCPL_CACHE_LINE_SIZE];
+  volatile uint64_t head;
+  uint64_t cached_tail;
+  char pad_3[PDCPL_CACHE_LINE_SIZE];
+};
+
+/**
+ * Create a new single-producer single-consumer queue.
+ *
+ * @param queue Address of `pdcpl_spsc_queue *` to write the new handle to
+ * @param capacity Minimum capacity, rounded up to a power of 2
+ * @returns 0 on success, -EINVAL if `queue` is `NULL` or `capacity` is 0 or
+ *  too large, -ENOMEM if memory allocation fails
+ */
+int
+pdcpl_spsc_queue_create(pdcpl_spsc_queue **queue, size_t capacity)
+{
+  if (!queue || !capacity || !(capacity = pdcpl_queue_capacity(capacity, 1)))
+    return -EINVAL;
+  pdcpl_spsc_queue *q = calloc(1, sizeof *q);
+  if (!q)
+    return -ENOMEM;
+  if (!(q->slots = malloc(capacity * sizeof *q->slots))) {
+    free(q);
+    return -ENOMEM;
+  }
+  q->mask = capacity - 1;
+  *queue = q;
+  return 0;
+}
+
+/**
+ * Free a single-producer single-consumer queue and any buffers left in it.
+ *
+ * @param queue Queue handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+int
+pdcpl_spsc_queue_destroy(pdcpl_spsc_queue *queue)
+{
+  if (!queue)
+    return -EINVAL;
+  for (uint64_t i = queue->head; i != queue->tail; i++)
+    pdcpl_buffer_clear(queue->slots + (i & queue->mask));
+  free(queue->slots);
+  free(queue);
+  return 0;
+}
+
+/**
+ * Return the capacity of a single-producer single-consumer queue.
+ *
+ * @param queue Queue handle
+ */
+size_t
+pdcpl_spsc_queue_capacity(const pdcpl_spsc_queue *queue)
+{
+  return queue->mask + 1;
+}
+
+/**
+ * Push a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Buffer to move into the queue on success
+ * @returns 0 on success, -EAGAIN if the queue is full
+ */
+int
+pdcpl_spsc_queue_push(pdcpl_spsc_queue *queue, const pdcpl_buffer *buf)
+{
+  return (pdcpl_spsc_queue_push_n(queue, buf, 1)) ? 0 : -EAGAIN;
+}
+
+/**
+ * Pop a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Address of buffer to move the popped buffer to
+ * @returns 0 on success, -EAGAIN if the queue is empty
+ */
+int
+pdcpl_spsc_queue_pop(pdcpl_spsc_queue *queue, pdcpl_buffer *buf)
+{
+  return (pdcpl_spsc_queue_pop_n(queue, buf, 1)) ? 0 : -EAGAIN;
+}
+
+/**
+ * Push as many buffers as fit without blocking.
+ *
+ * The buffers are published to the consumer together.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move into the queue, in order
+ * @param n Number of buffers
+ * @returns Number of buffers pushed, the first ones in `bufs`
+ */
+size_t
+pdcpl_spsc_queue_push_n(
+  pdcpl_spsc_queue *queue, const pdcpl_buffer *bufs, size_t n)
+{
+  uint64_t capacity = queue->mask + 1;
+  uint64_t tail = queue->tail;
+  // only read the consumer's index when the cached one says there is no room
+  uint64_t n_free = capacity - (tail - queue->cached_head);
+  if (n_free < n) {
+    queue->cached_head = pdcpl_atomic_load_u64(&queue->head);
+    n_free = capacity - (tail - queue->cached_head);
+  }
+  if (n > n_free)
+    n = (size_t) n_free;
+  for (size_t i = 0; i < n; i++)
+    queue->slots[(tail + i) & queue->mask] = bufs[i];
+  // release store publishes the buffers to the consumer
+  if (n)
+    pdcpl_atomic_store_u64(&queue->tail, tail + n);
+  return n;
+}
+
+/**
+ * Pop up to `n` buffers without blocking.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move the popped buffers to, in order
+ * @param n Maximum number of buffers
+ * @returns Number of buffers popped
+ */
+size_t
+pdcpl_spsc_queue_pop_n(pdcpl_spsc_queue *queue, pdcpl_buffer *bufs, size_t n)
+{
+  uint64_t head = queue->head;
+  // only read the producer's index when the cached one says there is too
+  // little to pop
+  uint64_t n_full = queue->cached_tail - head;
+  if (n_full < n) {
+    queue->cached_tail = pdcpl_atomic_load_u64(&queue->tail);
+    n_full = queue->cached_tail - head;
+  }
+  if (n > n_full)
+    n = (size_t) n_full;
+  for (size_t i = 0; i < n; i++)
+    bufs[i] = queue->slots[(head + i) & queue->mask];
+  // release store hands the slots back to the producer
+  if (n)
+    pdcpl_atomic_store_u64(&queue->head, head + n);
+  return n;
+}
+
+/**
+ * Multi-producer multi-consumer queue cell.
+ *
+ * For the cell at position `pos`, `seq` is `pos` when the cell is free for
+ * the producer claiming `pos` and `pos + 1` when it holds a buffer for the
+ * consumer claiming `pos`. Popping sets it to `pos + capacity`, the position
+ * of the cell on the next lap.
+ *
+ * @param seq Sequence number
+ * @param buf Buffer held by the cell
+ */
+typedef struct {
+  volatile uint64_t seq;
+  pdcpl_buffer buf;
+} pdcpl_mpmc_cell;
+
+/**
+ * Multi-producer multi-consumer queue implementation.
+ *
+ * @param mask Capacity minus 1, capacity is a power of 2
+ * @param cells Ring of cells indexed by position modulo capacity
+ * @param push_pos Next position to push to
+ * @param pop_pos Next position to pop from
+ */
+struct pdcpl_mpmc_queue {
+  size_t mask;
+  pdcpl_mpmc_cell *cells;
+  char pad_1[PDCPL_CACHE_LINE_SIZE];
+  volatile uint64_t push_pos;
+  char pad_2[PDCPL_CACHE_LINE_SIZE];
+  volatile uint64_t pop_pos;
+  char pad_3[PDCPL_CACHE_LINE_SIZE];
+};
+
+/**
+ * Create a new multi-producer multi-consumer queue.
+ *
+ * @param queue Address of `pdcpl_mpmc_queue *` to write the new handle to
+ * @param capacity Minimum capacity, rounded up to a power of 2 at least 2
+ * @returns 0 on success, -EINVAL if `queue` is `NULL` or `capacity` is 0 or
+ *  too large, -ENOMEM if memory allocation fails
+ */
+int
+pdcpl_mpmc_queue_create(pdcpl_mpmc_queue **queue, size_t capacity)
+{
+  // with one cell, a free cell and a full cell have the same sequence number
+  if (!queue || !capacity || !(capacity = pdcpl_queue_capacity(capacity, 2)))
+    return -EINVAL;
+  pdcpl_mpmc_queue *q = calloc(1, sizeof *q);
+  if (!q)
+    return -ENOMEM;
+  if (!(q->cells = malloc(capacity * sizeof *q->cells))) {
+    free(q);
+    return -ENOMEM;
+  }
+  for (size_t i = 0; i < capacity; i++)
+    q->cells[i].seq = i;
+  q->mask = capacity - 1;
+  *queue = q;
+  return 0;
+}
+
+/**
+ * Free a multi-producer multi-consumer queue and any buffers left in it.
+ *
+ * @param queue Queue handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+int
+pdcpl_mpmc_queue_destroy(pdcpl_mpmc_queue *queue)
+{
+  if (!queue)
+    return -EINVAL;
+  for (uint64_t i = queue->pop_pos; i != queue->push_pos; i++)
+    pdcpl_buffer_clear(&queue->cells[i & queue->mask].buf);
+  free(queue->cells);
+  free(queue);
+  return 0;
+}
+
+/**
+ * Return the capacity of a multi-producer multi-consumer queue.
+ *
+ * @param queue Queue handle
+ */
+size_t
+pdcpl_mpmc_queue_capacity(const pdcpl_mpmc_queue *queue)
+{
+  return queue->mask + 1;
+}
+
+/**
+ * Push a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Buffer to move into the queue on success
+ * @returns 0 on success, -EAGAIN if the queue is full
+ */
+int
+pdcpl_mpmc_queue_push(pdcpl_mpmc_queue *queue, const pdcpl_buffer *buf)
+{
+  return (pdcpl_mpmc_queue_push_n(queue, buf, 1)) ? 0 : -EAGAIN;
+}
+
+/**
+ * Pop a buffer without blocking.
+ *
+ * @param queue Queue handle
+ * @param buf Address of buffer to move the popped buffer to
+ * @returns 0 on success, -EAGAIN if the queue is empty
+ */
+int
+pdcpl_mpmc_queue_pop(pdcpl_mpmc_queue *queue, pdcpl_buffer *buf)
+{
+  return (pdcpl_mpmc_queue_pop_n(queue, buf, 1)) ? 0 : -EAGAIN;
+}
+
+/**
+ * Claim a run of up to `n` ready cells starting at a shared position.
+ *
+ * A cell at position `pos` is ready when its sequence number is
+ * `pos + offset`. The run is claimed by advancing the position past it.
+ *
+ * @param queue Queue handle
+ * @param pos_ptr Address of the shared position to claim from
+ * @param offset 0 to claim free cells, 1 to claim full cells
+ * @param n Maximum number of cells
+ * @param n_claimed Address to write the number of cells claimed to
+ * @returns First claimed position, only meaningful if `*n_claimed` > 0
+ */
+static uint64_t
+pdcpl_mpmc_queue_claim(
+  pdcpl_mpmc_queue *queue,
+  volatile uint64_t *pos_ptr,
+  uint64_t offset,
+  size_t n,
+  size_t *n_claimed)
+{
+  if (!n) {
+    *n_claimed = 0;
+    return 0;
+  }
+  if (n > queue->mask + 1)
+    n = queue->mask + 1;
+  uint64_t pos = pdcpl_atomic_load_u64(pos_ptr);
+  for (;;) {
+    size_t k = 0;
+    int64_t diff = 0;
+    // count ready cells. cells behind a claimed position are never ready
+    // for this lap again, so a run that passes the check is ours if the
+    // position has not moved
+    for (; k < n; k++) {
+      pdcpl_mpmc_cell *cell = queue->cells + ((pos + k) & queue->mask);
+      diff = (int64_t) (pdcpl_atomic_load_u64(&cell->seq) - (pos + k + offset));
+      if (diff)
+        break;
+    }
+    if (k) {
+      // on failure, pos is updated to the current position
+      if (pdcpl_atomic_cas_u64(pos_ptr, &pos, pos + k)) {
+        *n_claimed = k;
+        return pos;
+      }
+    }
+    // first cell is a lap behind, so the queue is full or empty
+    else if (diff < 0) {
+      *n_claimed = 0;
+      return pos;
+    }
+    // another thread claimed the first cell
+    else
+      pos = pdcpl_atomic_load_u64(pos_ptr);
+  }
+}
+
+/**
+ * Push as many buffers as fit without blocking.
+ *
+ * A run of free cells is claimed with a single compare-and-swap, so the
+ * buffers pushed by one call are contiguous in the queue.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move into the queue, in order
+ * @param n Number of buffers
+ * @returns Number of buffers pushed, the first ones in `bufs`
+ */
+size_t
+pdcpl_mpmc_queue_push_n(
+  pdcpl_mpmc_queue *queue, const pdcpl_buffer *bufs, size_t n)
+{
+  size_t k;
+  uint64_t pos = pdcpl_mpmc_queue_claim(queue, &queue->push_pos, 0, n, &k);
+  for (size_t i = 0; i < k; i++) {
+    pdcpl_mpmc_cell *cell = queue->cells + ((pos + i) & queue->mask);
+    cell->buf = bufs[i];
+    // release store publishes the buffer to the consumer of this position
+    pdcpl_atomic_store_u64(&cell->seq, pos + i + 1);
+  }
+  return k;
+}
+
+/**
+ * Pop up to `n` buffers without blocking.
+ *
+ * A run of full cells is claimed with a single compare-and-swap.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move the popped buffers to, in order
+ * @param n Maximum number of buffers
+ * @returns Number of buffers popped
+ */
+size_t
+pdcpl_mpmc_queue_pop_n(pdcpl_mpmc_queue *queue, pdcpl_buffer *bufs, size_t n)
+{
+  size_t k;
+  uint64_t pos = pdcpl_mpmc_queue_claim(queue, &queue->pop_pos, 1, n, &k);
+  for (size_t i = 0; i < k; i++) {
+    pdcpl_mpmc_cell *cell = queue->cells + ((pos + i) & queue->mask);
+    bufs[i] = cell->buf;
+    // release store hands the cell to the producer of the next lap
+    pdcpl_atomic_store_u64(&cell->seq, pos + i + queue->mask + 1);
+  }
+  return k;
+}
+
+/**
+ * Blocking queue implementation.
+ *
+ * A waiting thread increments its waiter count and then retries the queue
+ * while holding `mutex`, while the other side completes its operation and
+ * then checks the waiter count, with a full fence in between on each side so
+ * at least one of them sees the other.
+ *
+ * @param kind Kind of underlying queue
+ * @param queue Underlying `pdcpl_spsc_queue *` or `pdcpl_mpmc_queue *`
+ * @param mutex Mutex held while waiting
+ * @param not_empty Condition variable poppers wait on
+ * @param not_full Condition variable pushers wait on
+ * @param push_waiters Number of waiting pushers
+ * @param pop_waiters Number of waiting poppers
+ * @param closed Nonzero if the queue is closed
+ */
+struct pdcpl_blocking_queue {
+  pdcpl_queue_kind kind;
+  void *queue;
+  pdcpl_mutex *mutex;
+  pdcpl_cond *not_empty;
+  pdcpl_cond *not_full;
+  volatile uint64_t push_waiters;
+  volatile uint64_t pop_waiters;
+  volatile uint64_t closed;
+};
+
+/**
+ * Free a blocking queue and its members, any of which may be `NULL`.
+ *
+ * @param queue Queue handle
+ */
+static void
+pdcpl_blocking_queue_free(pdcpl_blocking_queue *queue)
+{
+  if (queue->queue) {
+    if (queue->kind == PDCPL_QUEUE_SPSC)
+      pdcpl_spsc_queue_destroy(queue->queue);
+    else
+      pdcpl_mpmc_queue_destroy(queue->queue);
+  }
+  if (queue->not_full)
+    pdcpl_cond_destroy(queue->not_full);
+  if (queue->not_empty)
+    pdcpl_cond_destroy(queue->not_empty);
+  if (queue->mutex)
+    pdcpl_mutex_destroy(queue->mutex);
+  free(queue);
+}
+
+/**
+ * Create a new blocking queue.
+ *
+ * @param queue Address of `pdcpl_blocking_queue *` to write the new handle to
+ * @param kind Kind of underlying lock-free queue
+ * @param capacity Minimum capacity, rounded up to a power of 2
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`, `kind` is invalid, or
+ *  `capacity` is 0 or too large, -ENOMEM if memory allocation fails, other
+ *  negative errno value if the mutex or condition variables cannot be made
+ */
+int
+pdcpl_blocking_queue_create(
+  pdcpl_blocking_queue **queue, pdcpl_queue_kind kind, size_t capacity)
+{
+  if (!queue || (kind != PDCPL_QUEUE_SPSC && kind != PDCPL_QUEUE_MPMC))
+    return -EINVAL;
+  pdcpl_blocking_queue *q = calloc(1, sizeof *q);
+  if (!q)
+    return -ENOMEM;
+  q->kind = kind;
+  int status;
+  if (kind == PDCPL_QUEUE_SPSC)
+    status = pdcpl_spsc_queue_create((pdcpl_spsc_queue **) &q->queue, capacity);
+  else
+    status = pdcpl_mpmc_queue_create((pdcpl_mpmc_queue **) &q->queue, capacity);
+  if (
+    status ||
+    (status = pdcpl_mutex_create(&q->mutex)) ||
+    (status = pdcpl_cond_create(&q->not_empty)) ||
+    (status = pdcpl_cond_create(&q->not_full))
+  ) {
+    pdcpl_blocking_queue_free(q);
+    return status;
+  }
+  *queue = q;
+  return 0;
+}
+
+/**
+ * Free a blocking queue and any buffers left in it.
+ *
+ * No threads may be waiting on the queue.
+ *
+ * @param queue Queue handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+int
+pdcpl_blocking_queue_destroy(pdcpl_blocking_queue *queue)
+{
+  if (!queue)
+    return -EINVAL;
+  pdcpl_blocking_queue_free(queue);
+  return 0;
+}
+
+/**
+ * Close a blocking queue, waking all waiting threads.
+ *
+ * Later pushes fail and pops fail once the queue is empty.
+ *
+ * @param queue Queue handle
+ * @returns 0 on success, -EINVAL if `queue` is `NULL`
+ */
+int
+pdcpl_blocking_queue_close(pdcpl_blocking_queue *queue)
+{
+  if (!queue)
+    return -EINVAL;
+  pdcpl_mutex_lock(queue->mutex);
+  pdcpl_atomic_store_u64(&queue->closed, 1);
+  pdcpl_cond_broadcast(queue->not_empty);
+  pdcpl_cond_broadcast(queue->not_full);
+  pdcpl_mutex_unlock(queue->mutex);
+  return 0;
+}
+
+/**
+ * Push buffers to the underlying queue without blocking.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to push
+ * @param n Number of buffers
+ * @returns Number of buffers pushed
+ */
+static size_t
+pdcpl_blocking_queue_try_push(
+  pdcpl_blocking_queue *queue, const pdcpl_buffer *bufs, size_t n)
+{
+  if (queue->kind == PDCPL_QUEUE_SPSC)
+    return pdcpl_spsc_queue_push_n(queue->queue, bufs, n);
+  return pdcpl_mpmc_queue_push_n(queue->queue, bufs, n);
+}
+
+/**
+ * Pop buffers from the underlying queue without blocking.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to pop to
+ * @param n Maximum number of buffers
+ * @returns Number of buffers popped
+ */
+static size_t
+pdcpl_blocking_queue_try_pop(
+  pdcpl_blocking_queue *queue, pdcpl_buffer *bufs, size_t n)
+{
+  if (queue->kind == PDCPL_QUEUE_SPSC)
+    return pdcpl_spsc_queue_pop_n(queue->queue, bufs, n);
+  return pdcpl_mpmc_queue_pop_n(queue->queue, bufs, n);
+}
+
+/**
+ * Wake threads waiting for the other side after a successful operation.
+ *
+ * @param queue Queue handle
+ * @param waiters Waiter count of the other side
+ * @param cond Condition variable the other side waits on
+ * @param n Number of buffers moved, one waiter is woken per buffer
+ */
+static void
+pdcpl_blocking_queue_notify(
+  pdcpl_blocking_queue *queue,
+  volatile uint64_t *waiters,
+  pdcpl_cond *cond,
+  size_t n)
+{
+  // pairs with the fence in pdcpl_blocking_queue_wait
+  pdcpl_atomic_fence();
+  if (!pdcpl_atomic_load_u64(waiters))
+    return;
+  pdcpl_mutex_lock(queue->mutex);
+  if (n > 1)
+    pdcpl_cond_broadcast(cond);
+  else
+    pdcpl_cond_signal(cond);
+  pdcpl_mutex_unlock(queue->mutex);
+}
+
+/**
+ * Retry an operation under the mutex, waiting until it moves a buffer.
+ *
+ * @param queue Queue handle
+ * @param push_bufs Buffers to push, `NULL` to pop
+ * @param pop_bufs Buffers to pop to, `NULL` to push
+ * @param n Number of buffers
+ * @returns Number of buffers moved, 0 if the queue was closed first
+ */
+static size_t
+pdcpl_blocking_queue_wait(
+  pdcpl_blocking_queue *queue,
+  const pdcpl_buffer *push_bufs,
+  pdcpl_buffer *pop_bufs,
+  size_t n)
+{
+  bool push = (push_bufs != NULL);
+  volatile uint64_t *waiters = (push) ?
+    &queue->push_waiters : &queue->pop_waiters;
+  pdcpl_cond *cond = (push) ? queue->not_full : queue->not_empty;
+  size_t k = 0;
+  pdcpl_mutex_lock(queue->mutex);
+  pdcpl_atomic_fetch_add_u64(waiters, 1);
+  // pairs with the fence in pdcpl_blocking_queue_notify
+  pdcpl_atomic_fence();
+  for (;;) {
+    // pushes fail as soon as the queue is closed. pops drain it first
+    if (push && pdcpl_atomic_load_u64(&queue->closed))
+      break;
+    k = (push) ?
+      pdcpl_blocking_queue_try_push(queue, push_bufs, n) :
+      pdcpl_blocking_queue_try_pop(queue, pop_bufs, n);
+    if (k || pdcpl_atomic_load_u64(&queue->closed))
+      break;
+    pdcpl_cond_wait(cond, queue->mutex);
+  }
+  pdcpl_atomic_fetch_add_u64(waiters, (uint64_t) -1);
+  pdcpl_mutex_unlock(queue->mutex);
+  return k;
+}
+
+/**
+ * Push a buffer, waiting while the queue is full.
+ *
+ * @param queue Queue handle
+ * @param buf Buffer to move into the queue on success
+ * @returns 0 on success, -EINVAL if `queue` or `buf` is `NULL`, -EPIPE if
+ *  the queue is closed, in which case the caller keeps the buffer
+ */
+int
+pdcpl_blocking_queue_push(
+  pdcpl_blocking_queue *queue, const pdcpl_buffer *buf)
+{
+  return pdcpl_blocking_queue_push_n(queue, buf, 1, NULL);
+}
+
+/**
+ * Pop a buffer, waiting while the queue is empty and open.
+ *
+ * @param queue Queue handle
+ * @param buf Address of buffer to move the popped buffer to
+ * @returns 0 on success, -EINVAL if `queue` or `buf` is `NULL`, -EPIPE if
+ *  the queue is closed and empty
+ */
+int
+pdcpl_blocking_queue_pop(pdcpl_blocking_queue *queue, pdcpl_buffer *buf)
+{
+  size_t n_popped;
+  return pdcpl_blocking_queue_pop_n(queue, buf, 1, &n_popped);
+}
+
+/**
+ * Push buffers, waiting while the queue is full until all are pushed.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move into the queue, in order
+ * @param n Number of buffers
+ * @param n_pushed Address to write the number of buffers pushed to, can be
+ *  `NULL`. Less than `n` only if the queue was closed
+ * @returns 0 on success, -EINVAL if `queue` or `bufs` is `NULL`, -EPIPE if
+ *  the queue was closed before all the buffers were pushed
+ */
+int
+pdcpl_blocking_queue_push_n(
+  pdcpl_blocking_queue *queue,
+  const pdcpl_buffer *bufs,
+  size_t n,
+  size_t *n_pushed)
+{
+  if (!queue || !bufs)
+    return -EINVAL;
+  int status = 0;
+  size_t done = 0;
+  while (done < n) {
+    if (pdcpl_atomic_load_u64(&queue->closed)) {
+      status = -EPIPE;
+      break;
+    }
+    size_t k = pdcpl_blocking_queue_try_push(queue, bufs + done, n - done);
+    if (!k) {
+      k = pdcpl_blocking_queue_wait(queue, bufs + done, NULL, n - done);
+      if (!k) {
+        status = -EPIPE;
+        break;
+      }
+    }
+    done += k;
+    pdcpl_blocking_queue_notify(
+      queue, &queue->pop_waiters, queue->not_empty, k
+    );
+  }
+  if (n_pushed)
+    *n_pushed = done;
+  return status;
+}
+
+/**
+ * Pop up to `n` buffers, waiting while the queue is empty and open.
+ *
+ * Returns as soon as at least one buffer is popped.
+ *
+ * @param queue Queue handle
+ * @param bufs Buffers to move the popped buffers to, in order
+ * @param n Maximum number of buffers, positive
+ * @param n_popped Address to write the number of buffers popped to
+ * @returns 0 on success, -EINVAL if `queue`, `bufs`, or `n_popped` is `NULL`
+ *  or `n` is 0, -EPIPE if the queue is closed and empty
+ */
+int
+pdcpl_blocking_queue_pop_n(
+  pdcpl_blocking_queue *queue,
+  pdcpl_buffer *bufs,
+  size_t n,
+  size_t *n_popped)
+{
+  if (!queue || !bufs || !n || !n_popped)
+    return -EINVAL;
+  size_t k = pdcpl_blocking_queue_try_pop(queue, bufs, n);
+  if (!k)
+    k = pdcpl_blocking_queue_wait(queue, NULL, bufs, n);
+  *n_popped = k;
+  if (!k)
+    return -EPIPE;
+  pdcpl_blocking_queue_notify(queue, &queue->push_waiters, queue->not_full, k);
+  return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ * @file stats.c
+ * @author Derek Huang
+ * @brief C source for program resource usage and throughput statistics
+ * @copyright MIT License
+ */
+
+#include "pdcpl/stats.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+// K32GetProcessMemoryInfo is in kernel32 with PSAPI_VERSION 2
+#define PSAPI_VERSION 2
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif  // !_WIN32
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pdcpl/atomic.h"
+#include "pdcpl/clock.h"
+#include "pdcpl/common.h"
+
+// thread-local counters, added to the totals on flush
+PDCPL_THREAD_LOCAL PDCPL_STATS_TLS_MODEL
+uint64_t pdcpl_stats_local[PDCPL_STATS_COUNTER_MAX];
+// program counter totals, only updated atomically
+static uint64_t pdcpl_stats_total[PDCPL_STATS_COUNTER_MAX];
+// monotonic clock time in nanoseconds when pdcpl_stats_start was called
+static uint64_t pdcpl_stats_start_ns;
+// hardware counters started by pdcpl_stats_start, no events if unavailable
+static pdcpl_perf_group pdcpl_stats_perf;
+
+/**
+ * Return the calling thread's counters, indexed by `pdcpl_stats_counter`.
+ *
+ * Only needed by `pdcpl_stats_add` when the counters can't be accessed
+ * directly. Use `pdcpl_stats_add` to add to a counter.
+ */
+uint64_t *
+pdcpl_stats_local_counters(void)
+{
+  return pdcpl_stats_local;
+}
+
+/**
+ * Add the calling thread's counters to the program totals and reset them.
+ *
+ * Threads that call library functions should call this before they exit,
+ * otherwise their counts are lost. `pdcpl_stats_get` calls this for the
+ * calling thread.
+ */
+void
+pdcpl_stats_flush(void)
+{
+  for (unsigned int i = 0; i < PDCPL_STATS_COUNTER_MAX; i++) {
+    if (pdcpl_stats_local[i]) {
+      pdcpl_atomic_fetch_add_u64(pdcpl_stats_total + i, pdcpl_stats_local[i]);
+      pdcpl_stats_local[i] = 0;
+    }
+  }
+}
+
+/**
+ * Record the wall time that `pdcpl_stats_get` measures elapsed time from.
+ *
+ * Hardware counters are also started for the calling thread if available.
+ * Threads started later are not counted.
+ */
+void
+pdcpl_stats_start(void)
+{
+  // counters are opened once and restarted on later calls
+  if (!pdcpl_stats_perf.events)
+    pdcpl_perf_open(&pdcpl_stats_perf);
+  if (pdcpl_stats_perf.events && pdcpl_perf_start(&pdcpl_stats_perf))
+    pdcpl_perf_close(&pdcpl_stats_perf);
+  pdcpl_stats_start_ns = pdcpl_clock_ns();
+}
+
+/**
+ * Get a snapshot of the program statistics.
+ *
+ * @param stats Address of `pdcpl_stats` to write to
+ * @returns 0 on success, -EINVAL if `stats` is `NULL`
+ */
+int
+pdcpl_stats_get(pdcpl_stats *stats)
+{
+  if (!stats)
+    return -EINVAL;
+  pdcpl_stats_flush();
+  for (unsigned int i = 0; i < PDCPL_STATS_COUNTER_MAX; i++)
+    stats->counters[i] = pdcpl_atomic_load_u64(pdcpl_stats_total + i);
+  // if never started, there is no meaningful elapsed time
+  stats->wall_time = (pdcpl_stats_start_ns) ?
+    1e-9 * (double) (pdcpl_clock_ns() - pdcpl_stats_start_ns) : 0;
+  if (
+    !pdcpl_stats_perf.events ||
+    pdcpl_perf_read(&pdcpl_stats_perf, &stats->perf)
+  )
+    stats->perf.events = 0;
+#if defined(_WIN32)
+  // FILETIME values are in 100 ns units
+  FILETIME creation, exit, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    stats->sys_time = 1e-7 * (double) k.QuadPart;
+    stats->user_time = 1e-7 * (double) u.QuadPart;
+  }
+  else
+    stats->sys_time = stats->user_time = 0;
+  PROCESS_MEMORY_COUNTERS pmc;
+  stats->peak_rss = (
+    K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc)
+  ) ? pmc.PeakWorkingSetSize : 0;
+#else
+  struct rusage usage;
+  if (!getrusage(RUSAGE_SELF, &usage)) {
+    stats->user_time = (double) usage.ru_utime.tv_sec +
+      1e-6 * (double) usage.ru_utime.tv_usec;
+    stats->sys_time = (double) usage.ru_stime.tv_sec +
+      1e-6 * (double) usage.ru_stime.tv_usec;
+    // ru_maxrss is in bytes on macOS, kilobytes elsewhere
+#if defined(__APPLE__)
+    stats->peak_rss = (size_t) usage.ru_maxrss;
+#else
+    stats->peak_rss = (size_t) usage.ru_maxrss * 1024;
+#endif  // !defined(__APPLE__)
+  }
+  else {
+    stats->user_time = stats->sys_time = 0;
+    stats->peak_rss = 0;
+  }
+#endif  // !defined(_WIN32)
+  return 0;
+}
+
+/**
+ * Write program statistics to a stream.
+ *
+ * Throughput in MB/s is computed from the bytes read and wall time, while
+ * hardware counter rates are per byte read.
+ *
+ * @param f Stream to write to
+ * @param stats Statistics to write
+ * @param format Output format
+ * @returns 0 on success, -EINVAL if `f` or `stats` is `NULL` or if `format`
+ *  is not valid, -EIO on write error
+ */
+int
+pdcpl_stats_fprintf(
+  FILE *f, const pdcpl_stats *stats, pdcpl_stats_format format)
+{
+  if (!f || !stats)
+    return -EINVAL;
+  const uint64_t *counters = stats->counters;
+  double mb_per_sec = (stats->wall_time > 0) ?
+    1e-6 * (double) counters[PDCPL_STATS_BYTES_READ] / stats->wall_time : 0;
+  int n;
+  switch (format) {
+    case PDCPL_STATS_FORMAT_TEXT:
+      n = fprintf(
+        f,
+        "wall time:      %.6f s\n"
+        "user time:      %.6f s\n"
+        "sys time:       %.6f s\n"
+        "bytes read:     %llu\n"
+        "bytes written:  %llu\n"
+        "lines:          %llu\n"
+        "throughput:     %.3f MB/s\n"
+        "peak rss:       %zu bytes\n"
+        "allocations:    %llu\n",
+        stats->wall_time,
+        stats->user_time,
+        stats->sys_time,
+        (unsigned long long) counters[PDCPL_STATS_BYTES_READ],
+        (unsigned long long) counters[PDCPL_STATS_BYTES_WRITTEN],
+        (unsigned long long) counters[PDCPL_STATS_LINES],
+        mb_per_sec,
+        stats->peak_rss,
+        (unsigned long long) counters[PDCPL_STATS_ALLOCS]
+      );
+      break;
+    case PDCPL_STATS_FORMAT_JSON:
+      n = fprintf(
+        f,
+        "{\"wall_time\": %.6f, \"user_time\": %.6f, \"sys_time\": %.6f, "
+        "\"bytes_read\": %llu, \"bytes_written\": %llu, \"lines\": %llu, "
+        "\"mb_per_sec\": %.3f, \"peak_rss\": %zu, \"allocs\": %llu, "
+        "\"perf\": ",
+        stats->wall_time,
+        stats->user_time,
+        stats->sys_time,
+        (unsigned long long) counters[PDCPL_STATS_BYTES_READ],
+        (unsigned long long) counters[PDCPL_STATS_BYTES_WRITTEN],
+        (unsigned long long) counters[PDCPL_STATS_LINES],
+        mb_per_sec,
+        stats->peak_rss,
+        (unsigned long long) counters[PDCPL_STATS_ALLOCS]
+      );
+      break;
+    default:
+      return -EINVAL;
+  }
+  if (n < 0)
+    return -EIO;
+  // hardware counters are the last member of the JSON object
+  int status = pdcpl_perf_fprintf(
+    f,
+    &stats->perf,
+    counters[PDCPL_STATS_BYTES_READ],
+    format == PDCPL_STATS_FORMAT_JSON
+  );
+  if (status)
+    return status;
+  if (format == PDCPL_STATS_FORMAT_JSON && fprintf(f, "}\n") < 0)
+    return -EIO;
+  return 0;
+}
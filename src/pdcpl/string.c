@@ -20,6 +20,8 @@
 #include "pdcpl/memory.h"
 #include "pdcpl/warnings.h"
 #include "pdcpl/sa.h"
+#include "pdcpl/stats.h"
+#include "pdcpl/trace.h"
 
 /**
  * Return columns needed to fit a specified signed int with specified padding.
@@ -116,6 +118,8 @@ pdcpl_fwc(PDCPL_SA(Opt(In)) FILE *f, PDCPL_SA(Out) pdcpl_wcresults *rp)
   // at least one line if nc >= 1, so increment nl to avoid undercount
   if (nc)
     nl++;
+  pdcpl_stats_add(PDCPL_STATS_BYTES_READ, nc);
+  pdcpl_stats_add(PDCPL_STATS_LINES, nl);
   // populate results and return
   PDCPL_SET_WCRESULTS(rp, nw, nc, nl);
   return 0;
@@ -154,9 +158,13 @@ pdcpl_getword(
   // fgetc() value, exit status, number of chars read
   int c, status;
   size_t nc = 0;
+  // number of leading whitespace chars and newlines, for the statistics
+  size_t n_space = 0, n_lines = 0;
   // skip any leading whitespace
-  while (c = fgetc(f), isspace(c))
-    ;
+  while (c = fgetc(f), isspace(c)) {
+    n_space++;
+    n_lines += (c == '\n');
+  }
   // loop until we hit whitespace or EOF. we get the new character at the end
   // of the loop, as previous while loop guarantees !isspace(c)
   for (; !isspace(c) && c != EOF; c = fgetc(f), nc++) {
@@ -174,6 +182,13 @@ pdcpl_getword(
     // write character to buffer
     PDCPL_INDEX_CHAR(buf.data, nc) = (char) c;
   }
+  // the whitespace char ending the word was also read, unless at EOF
+  if (c != EOF) {
+    n_space++;
+    n_lines += (c == '\n');
+  }
+  pdcpl_stats_add(PDCPL_STATS_BYTES_READ, n_space + nc);
+  pdcpl_stats_add(PDCPL_STATS_LINES, n_lines);
   // done. if nc is zero, clear buffer and update wp, ncp if necessary. in
   // general you cannot have a zero-length word, so we definitely reached EOF
   if (!nc) {
@@ -228,9 +243,11 @@ pdcpl_getline(
   // we allow ncp to be NULL
   if (!f || !sp)
     return -EINVAL;
+  PDCPL_TRACE_BEGIN(trace_start);
   // current buffer size, number of chars read, allocated buffer
   size_t buf_size = BUFSIZ, nc = 0;
   char *buf = malloc(buf_size * sizeof *buf);
+  pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
   if (!buf)
     return -ENOMEM;
   // fgetc() value, exit status, temporary buffer for realloc()
@@ -247,6 +264,7 @@ pdcpl_getline(
       }
       buf_size += BUFSIZ;
       buf_new = realloc(buf, buf_size);
+      pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
       // still need to free existing buffer if realloc fails
       if (!buf_new) {
         status = -ENOMEM;
@@ -266,12 +284,14 @@ pdcpl_getline(
     *sp = NULL;
     if (ncp)
       *ncp = 0;
+    PDCPL_TRACE_END(trace_start, "pdcpl_getline");
     return 0;
   }
   // otherwise, update buf_size + realloc (unless size is perfect)
   if (nc != buf_size - 1) {
     buf_size = nc + 1;
     buf_new = realloc(buf, buf_size);
+    pdcpl_stats_add(PDCPL_STATS_ALLOCS, 1);
     // still need to free existing buffer if realloc fails
     if (!buf_new) {
       status = -ENOMEM;
@@ -280,15 +300,20 @@ pdcpl_getline(
     // otherwise, reassign to buf
     buf = buf_new;
   }
+  // line and its newline, if any, were read
+  pdcpl_stats_add(PDCPL_STATS_BYTES_READ, nc + (c == '\n'));
+  pdcpl_stats_add(PDCPL_STATS_LINES, 1);
   // write '\0', update sp, optionally update ncp
   buf[nc] = '\0';
   *sp = buf;
   if (ncp)
     *ncp = nc;
+  PDCPL_TRACE_END(trace_start, "pdcpl_getline");
   return 0;
 // on error, need to free the existing buffer before returning
 error:
   free(buf);
+  PDCPL_TRACE_END(trace_start, "pdcpl_getline");
   return status;
 }
 
@@ -386,6 +411,8 @@ pdcpl_detab(
     }
     n_read++;
   }
+  pdcpl_stats_add(PDCPL_STATS_BYTES_READ, n_read);
+  pdcpl_stats_add(PDCPL_STATS_BYTES_WRITTEN, n_write);
   // check errors using errno
   if (ferror(in) || ferror(out))
     return -errno;
@@ -0,0 +1,419 @@
+/**
+ * @file thread.c
+ * @author Derek Huang
+ * @brief C source for portable threads, mutexes, and condition variables
+ * @copyright MIT License
+ */
+
+// needed for pthread_setaffinity_np. must be defined before any includes
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif  // !defined(__linux__) || defined(_GNU_SOURCE)
+
+#include "pdcpl/thread.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
+#include <errno.h>
+#include <stdlib.h>
+
+/**
+ * Thread handle implementation.
+ *
+ * The start function and argument are stored so that on Windows, the thread
+ * can be started with a trampoline matching the Win32 thread signature.
+ *
+ * @param func Thread start function
+ * @param arg Argument to pass to `func`
+ * @param result Result of `func`, valid after the thread finishes
+ * @param handle Native thread handle
+ */
+struct pdcpl_thread {
+  pdcpl_thread_func func;
+  void *arg;
+  void *result;
+#ifdef _WIN32
+  HANDLE handle;
+#else
+  pthread_t handle;
+#endif  // !_WIN32
+};
+
+#ifdef _WIN32
+/**
+ * Win32 thread start routine that calls the user start function.
+ *
+ * @param param `pdcpl_thread *` thread handle
+ */
+static DWORD WINAPI
+pdcpl_thread_trampoline(LPVOID param)
+{
+  pdcpl_thread *thread = (pdcpl_thread *) param;
+  thread->result = thread->func(thread->arg);
+  return 0;
+}
+#else
+/**
+ * POSIX thread start routine that calls the user start function.
+ *
+ * @param param `pdcpl_thread *` thread handle
+ */
+static void *
+pdcpl_thread_trampoline(void *param)
+{
+  pdcpl_thread *thread = (pdcpl_thread *) param;
+  thread->result = thread->func(thread->arg);
+  return NULL;
+}
+#endif  // !_WIN32
+
+/**
+ * Start a new thread.
+ *
+ * @param thread Address of `pdcpl_thread *` to write the new thread handle to
+ * @param func Function to run in the new thread
+ * @param arg Argument to pass to `func`
+ * @returns 0 on success, -EINVAL if `thread` or `func` is `NULL`, -ENOMEM if
+ *  memory allocation fails, -EAGAIN if the thread could not be created
+ */
+int
+pdcpl_thread_create(pdcpl_thread **thread, pdcpl_thread_func func, void *arg)
+{
+  if (!thread || !func)
+    return -EINVAL;
+  pdcpl_thread *t = malloc(sizeof *t);
+  if (!t)
+    return -ENOMEM;
+  t->func = func;
+  t->arg = arg;
+  t->result = NULL;
+#ifdef _WIN32
+  t->handle = CreateThread(NULL, 0, pdcpl_thread_trampoline, t, 0, NULL);
+  if (!t->handle) {
+    free(t);
+    return -EAGAIN;
+  }
+#else
+  int status = pthread_create(&t->handle, NULL, pdcpl_thread_trampoline, t);
+  if (status) {
+    free(t);
+    return -status;
+  }
+#endif  // !_WIN32
+  *thread = t;
+  return 0;
+}
+
+/**
+ * Wait for a thread to finish and free its handle.
+ *
+ * @param thread Thread handle, which is invalid after the call
+ * @param result Address to write the thread function's result to, can be
+ *  `NULL` if the result is not needed
+ * @returns 0 on success, -EINVAL if `thread` is `NULL`, other negative errno
+ *  value if the thread could not be joined
+ */
+int
+pdcpl_thread_join(pdcpl_thread *thread, void **result)
+{
+  if (!thread)
+    return -EINVAL;
+#ifdef _WIN32
+  if (WaitForSingleObject(thread->handle, INFINITE) != WAIT_OBJECT_0)
+    return -EINVAL;
+  CloseHandle(thread->handle);
+#else
+  int status = pthread_join(thread->handle, NULL);
+  if (status)
+    return -status;
+#endif  // !_WIN32
+  if (result)
+    *result = thread->result;
+  free(thread);
+  return 0;
+}
+
+/**
+ * Return the number of hardware threads available, at least 1.
+ */
+unsigned int
+pdcpl_thread_hardware_concurrency(void)
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (info.dwNumberOfProcessors) ? info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return (n > 0) ? (unsigned int) n : 1;
+#else
+  return 1;
+#endif  // !defined(_WIN32) && !defined(_SC_NPROCESSORS_ONLN)
+}
+
+/**
+ * Yield the rest of the calling thread's time slice.
+ */
+void
+pdcpl_thread_yield(void)
+{
+#ifdef _WIN32
+  SwitchToThread();
+#else
+  sched_yield();
+#endif  // !_WIN32
+}
+
+/**
+ * Pin the calling thread to a CPU.
+ *
+ * @param cpu Zero-based CPU index, less than the hardware concurrency
+ * @returns 0 on success, -EINVAL if `cpu` is out of range, -ENOSYS if thread
+ *  affinity is not supported on this platform, other negative errno value if
+ *  the affinity could not be set
+ */
+int
+pdcpl_thread_pin(unsigned int cpu)
+{
+  if (cpu >= pdcpl_thread_hardware_concurrency())
+    return -EINVAL;
+#if defined(_WIN32)
+  // affinity masks only cover the calling thread's processor group
+  if (cpu >= 8 * sizeof(DWORD_PTR))
+    return -EINVAL;
+  if (!SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << cpu))
+    return -EINVAL;
+  return 0;
+#elif defined(__linux__)
+  if (cpu >= CPU_SETSIZE)
+    return -EINVAL;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return -pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+#else
+  return -ENOSYS;
+#endif  // !defined(_WIN32) && !defined(__linux__)
+}
+
+/**
+ * Mutex handle implementation.
+ *
+ * @param lock Native lock
+ */
+struct pdcpl_mutex {
+#ifdef _WIN32
+  SRWLOCK lock;
+#else
+  pthread_mutex_t lock;
+#endif  // !_WIN32
+};
+
+/**
+ * Create a new mutex.
+ *
+ * @param mutex Address of `pdcpl_mutex *` to write the new mutex handle to
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`, -ENOMEM if memory
+ *  allocation fails, other negative errno value on initialization error
+ */
+int
+pdcpl_mutex_create(pdcpl_mutex **mutex)
+{
+  if (!mutex)
+    return -EINVAL;
+  pdcpl_mutex *m = malloc(sizeof *m);
+  if (!m)
+    return -ENOMEM;
+#ifdef _WIN32
+  InitializeSRWLock(&m->lock);
+#else
+  int status = pthread_mutex_init(&m->lock, NULL);
+  if (status) {
+    free(m);
+    return -status;
+  }
+#endif  // !_WIN32
+  *mutex = m;
+  return 0;
+}
+
+/**
+ * Lock a mutex, blocking until it is available.
+ *
+ * @param mutex Mutex handle
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`
+ */
+int
+pdcpl_mutex_lock(pdcpl_mutex *mutex)
+{
+  if (!mutex)
+    return -EINVAL;
+#ifdef _WIN32
+  AcquireSRWLockExclusive(&mutex->lock);
+  return 0;
+#else
+  return -pthread_mutex_lock(&mutex->lock);
+#endif  // !_WIN32
+}
+
+/**
+ * Unlock a mutex locked by the calling thread.
+ *
+ * @param mutex Mutex handle
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`
+ */
+int
+pdcpl_mutex_unlock(pdcpl_mutex *mutex)
+{
+  if (!mutex)
+    return -EINVAL;
+#ifdef _WIN32
+  ReleaseSRWLockExclusive(&mutex->lock);
+  return 0;
+#else
+  return -pthread_mutex_unlock(&mutex->lock);
+#endif  // !_WIN32
+}
+
+/**
+ * Destroy an unlocked mutex and free its handle.
+ *
+ * @param mutex Mutex handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `mutex` is `NULL`
+ */
+int
+pdcpl_mutex_destroy(pdcpl_mutex *mutex)
+{
+  if (!mutex)
+    return -EINVAL;
+#ifndef _WIN32
+  pthread_mutex_destroy(&mutex->lock);
+#endif  // _WIN32
+  free(mutex);
+  return 0;
+}
+
+/**
+ * Condition variable handle implementation.
+ *
+ * @param cond Native condition variable
+ */
+struct pdcpl_cond {
+#ifdef _WIN32
+  CONDITION_VARIABLE cond;
+#else
+  pthread_cond_t cond;
+#endif  // !_WIN32
+};
+
+/**
+ * Create a new condition variable.
+ *
+ * @param cond Address of `pdcpl_cond *` to write the new handle to
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`, -ENOMEM if memory
+ *  allocation fails, other negative errno value on initialization error
+ */
+int
+pdcpl_cond_create(pdcpl_cond **cond)
+{
+  if (!cond)
+    return -EINVAL;
+  pdcpl_cond *c = malloc(sizeof *c);
+  if (!c)
+    return -ENOMEM;
+#ifdef _WIN32
+  InitializeConditionVariable(&c->cond);
+#else
+  int status = pthread_cond_init(&c->cond, NULL);
+  if (status) {
+    free(c);
+    return -status;
+  }
+#endif  // !_WIN32
+  *cond = c;
+  return 0;
+}
+
+/**
+ * Unlock a mutex, wait until woken, and lock the mutex again.
+ *
+ * @param cond Condition variable handle
+ * @param mutex Mutex handle locked by the calling thread
+ * @returns 0 on success, -EINVAL if `cond` or `mutex` is `NULL`
+ */
+int
+pdcpl_cond_wait(pdcpl_cond *cond, pdcpl_mutex *mutex)
+{
+  if (!cond || !mutex)
+    return -EINVAL;
+#ifdef _WIN32
+  if (!SleepConditionVariableSRW(&cond->cond, &mutex->lock, INFINITE, 0))
+    return -EINVAL;
+  return 0;
+#else
+  return -pthread_cond_wait(&cond->cond, &mutex->lock);
+#endif  // !_WIN32
+}
+
+/**
+ * Wake one thread waiting on a condition variable.
+ *
+ * @param cond Condition variable handle
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`
+ */
+int
+pdcpl_cond_signal(pdcpl_cond *cond)
+{
+  if (!cond)
+    return -EINVAL;
+#ifdef _WIN32
+  WakeConditionVariable(&cond->cond);
+  return 0;
+#else
+  return -pthread_cond_signal(&cond->cond);
+#endif  // !_WIN32
+}
+
+/**
+ * Wake all threads waiting on a condition variable.
+ *
+ * @param cond Condition variable handle
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`
+ */
+int
+pdcpl_cond_broadcast(pdcpl_cond *cond)
+{
+  if (!cond)
+    return -EINVAL;
+#ifdef _WIN32
+  WakeAllConditionVariable(&cond->cond);
+  return 0;
+#else
+  return -pthread_cond_broadcast(&cond->cond);
+#endif  // !_WIN32
+}
+
+/**
+ * Destroy a condition variable with no waiters and free its handle.
+ *
+ * @param cond Condition variable handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `cond` is `NULL`
+ */
+int
+pdcpl_cond_destroy(pdcpl_cond *cond)
+{
+  if (!cond)
+    return -EINVAL;
+#ifndef _WIN32
+  pthread_cond_destroy(&cond->cond);
+#endif  // _WIN32
+  free(cond);
+  return 0;
+}
@@ -0,0 +1,897 @@
+/**
+ * @file thread_pool.c
+ * @author Derek Huang
+ * @brief C source for a work-stealing thread pool
+ * @copyright MIT License
+ */
+
+#include "pdcpl/thread_pool.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pdcpl/atomic.h"
+#include "pdcpl/common.h"
+#include "pdcpl/thread.h"
+
+/**
+ * Initial number of slots in a worker's deque, a power of 2.
+ */
+#define PDCPL_DEQUE_INITIAL_SIZE 256
+
+/**
+ * Number of passes over the other workers' deques before a worker sleeps.
+ */
+#define PDCPL_STEAL_ROUNDS 4
+
+/**
+ * Number of subranges per worker a parallel loop is split into by default.
+ */
+#define PDCPL_PARALLEL_FOR_SPLITS 8
+
+/**
+ * Number of times a task group waiter yields before it blocks.
+ */
+#define PDCPL_TASK_GROUP_SPINS 64
+
+/**
+ * Task queued on a pool.
+ *
+ * Range tasks have a `NULL` `func` and run part of a parallel loop.
+ *
+ * @param func Task function, `NULL` for a range task
+ * @param range_func Range function for a range task
+ * @param arg User-defined argument
+ * @param begin First index for a range task
+ * @param end One past the last index for a range task
+ * @param grain Maximum subrange size for a range task
+ * @param group Task group, can be `NULL`
+ * @param next Next task in the injection queue
+ */
+typedef struct pdcpl_task {
+  pdcpl_task_func func;
+  pdcpl_range_func range_func;
+  void *arg;
+  size_t begin;
+  size_t end;
+  size_t grain;
+  pdcpl_task_group *group;
+  struct pdcpl_task *next;
+} pdcpl_task;
+
+/**
+ * Circular array of task pointers backing a deque.
+ *
+ * Replaced arrays are kept until the pool is destroyed since a thief may
+ * still be reading from one.
+ *
+ * @param size Number of slots, a power of 2
+ * @param prev Previous smaller array, `NULL` for the initial array
+ * @param slots Task pointer slots indexed by position modulo `size`
+ */
+typedef struct pdcpl_deque_array {
+  uint64_t size;
+  struct pdcpl_deque_array *prev;
+  void *volatile slots[];
+} pdcpl_deque_array;
+
+/**
+ * Chase-Lev work-stealing deque.
+ *
+ * Only the owner pushes and takes at the bottom while any thread can steal
+ * from the top. Positions only increase, so comparisons use their signed
+ * difference to stay correct when the owner briefly decrements `bottom`.
+ *
+ * @param top Position of the oldest task, advanced by steals and last takes
+ * @param bottom Position one past the newest task
+ * @param array Current circular array
+ */
+typedef struct {
+  volatile uint64_t top;
+  volatile uint64_t bottom;
+  void *volatile array;
+} pdcpl_deque;
+
+/**
+ * Worker state.
+ *
+ * @param pool Pool the worker belongs to
+ * @param thread Worker thread
+ * @param deque Worker's deque
+ * @param index Worker index
+ * @param rng Random state for choosing victims
+ */
+typedef struct {
+  pdcpl_thread_pool *pool;
+  pdcpl_thread *thread;
+  pdcpl_deque deque;
+  unsigned int index;
+  uint64_t rng;
+} pdcpl_worker;
+
+/**
+ * Thread pool implementation.
+ *
+ * Idle workers sleep on `cond`. A sleeper increments `sleepers` and then
+ * checks for work while holding `mutex`, while a deque push publishes the
+ * task and then checks `sleepers`, with a full fence in between on each side
+ * so that at least one of them sees the other.
+ *
+ * Task group waiters that run out of tasks to run also sleep on `cond`, and
+ * are counted in both `sleepers` and `waiters` so that new tasks wake them.
+ * The task that finishes a group decrements its `pending` and then checks
+ * `waiters`, with a full fence in between, and if there are any waiters,
+ * broadcasts on `cond`, since it can't tell which sleeper is waiting.
+ *
+ * @param workers Worker states
+ * @param n_workers Number of workers
+ * @param pin `true` to pin workers to CPUs
+ * @param mutex Mutex guarding the injection queue and sleeping
+ * @param cond Condition variable idle workers sleep on
+ * @param inject_head First task in the injection queue
+ * @param inject_tail Last task in the injection queue
+ * @param injected Number of tasks in the injection queue
+ * @param sleepers Number of sleeping workers and task group waiters
+ * @param waiters Number of sleeping task group waiters
+ * @param stop Nonzero when the pool is being destroyed
+ */
+struct pdcpl_thread_pool {
+  pdcpl_worker *workers;
+  unsigned int n_workers;
+  bool pin;
+  pdcpl_mutex *mutex;
+  pdcpl_cond *cond;
+  pdcpl_task *inject_head;
+  pdcpl_task *inject_tail;
+  volatile uint64_t injected;
+  volatile uint64_t sleepers;
+  volatile uint64_t waiters;
+  volatile uint64_t stop;
+};
+
+/**
+ * Worker state of the calling thread, `NULL` if not a worker.
+ */
+static PDCPL_THREAD_LOCAL pdcpl_worker *pdcpl_current_worker;
+
+/**
+ * Return the calling thread's worker state if it belongs to a pool.
+ *
+ * @param pool Thread pool
+ */
+static pdcpl_worker *
+pdcpl_thread_pool_worker(pdcpl_thread_pool *pool)
+{
+  pdcpl_worker *worker = pdcpl_current_worker;
+  return (worker && worker->pool == pool) ? worker : NULL;
+}
+
+/**
+ * Return the next value of a xorshift generator.
+ *
+ * @param state Address of generator state, must be nonzero
+ */
+static uint64_t
+pdcpl_xorshift(uint64_t *state)
+{
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+/**
+ * Allocate a deque array.
+ *
+ * @param size Number of slots, a power of 2
+ * @param prev Previous array, `NULL` if none
+ * @returns New array, `NULL` on allocation failure
+ */
+static pdcpl_deque_array *
+pdcpl_deque_array_create(uint64_t size, pdcpl_deque_array *prev)
+{
+  pdcpl_deque_array *array = malloc(
+    sizeof *array + size * sizeof *array->slots
+  );
+  if (!array)
+    return NULL;
+  array->size = size;
+  array->prev = prev;
+  return array;
+}
+
+/**
+ * Initialize a deque.
+ *
+ * @param deque Deque to initialize
+ * @returns 0 on success, -ENOMEM on allocation failure
+ */
+static int
+pdcpl_deque_init(pdcpl_deque *deque)
+{
+  pdcpl_deque_array *array = pdcpl_deque_array_create(
+    PDCPL_DEQUE_INITIAL_SIZE, NULL
+  );
+  if (!array)
+    return -ENOMEM;
+  deque->top = deque->bottom = 0;
+  deque->array = array;
+  return 0;
+}
+
+/**
+ * Free a deque's arrays.
+ *
+ * @param deque Deque
+ */
+static void
+pdcpl_deque_free(pdcpl_deque *deque)
+{
+  pdcpl_deque_array *array = deque->array;
+  while (array) {
+    pdcpl_deque_array *prev = array->prev;
+    free(array);
+    array = prev;
+  }
+  deque->array = NULL;
+}
+
+/**
+ * Push a task to the bottom of a deque. Only called by the owner.
+ *
+ * @param deque Deque
+ * @param task Task to push
+ * @returns 0 on success, -ENOMEM if the deque is full and could not grow
+ */
+static int
+pdcpl_deque_push(pdcpl_deque *deque, pdcpl_task *task)
+{
+  uint64_t bottom = deque->bottom;
+  uint64_t top = pdcpl_atomic_load_u64(&deque->top);
+  pdcpl_deque_array *array = deque->array;
+  // double the array when full, copying the live positions
+  if (bottom - top >= array->size) {
+    pdcpl_deque_array *grown = pdcpl_deque_array_create(
+      2 * array->size, array
+    );
+    if (!grown)
+      return -ENOMEM;
+    for (uint64_t i = top; i < bottom; i++)
+      grown->slots[i & (grown->size - 1)] = array->slots[i & (array->size - 1)];
+    pdcpl_atomic_store_ptr(&deque->array, grown);
+    array = grown;
+  }
+  array->slots[bottom & (array->size - 1)] = task;
+  // release store publishes the slot to thieves
+  pdcpl_atomic_store_u64(&deque->bottom, bottom + 1);
+  return 0;
+}
+
+/**
+ * Take a task from the bottom of a deque. Only called by the owner.
+ *
+ * @param deque Deque
+ * @returns Task, `NULL` if the deque is empty or the last task was stolen
+ */
+static pdcpl_task *
+pdcpl_deque_take(pdcpl_deque *deque)
+{
+  uint64_t bottom = deque->bottom - 1;
+  pdcpl_deque_array *array = deque->array;
+  pdcpl_atomic_store_u64(&deque->bottom, bottom);
+  // bottom must be visible before reading top so a thief and the owner
+  // cannot both take the last task
+  pdcpl_atomic_fence();
+  uint64_t top = pdcpl_atomic_load_u64(&deque->top);
+  if ((int64_t) (bottom - top) < 0) {
+    pdcpl_atomic_store_u64(&deque->bottom, bottom + 1);
+    return NULL;
+  }
+  pdcpl_task *task = array->slots[bottom & (array->size - 1)];
+  if (bottom != top)
+    return task;
+  // last task, so race thieves for it by advancing top
+  if (!pdcpl_atomic_cas_u64(&deque->top, &top, top + 1))
+    task = NULL;
+  pdcpl_atomic_store_u64(&deque->bottom, bottom + 1);
+  return task;
+}
+
+/**
+ * Steal a task from the top of a deque.
+ *
+ * @param deque Deque
+ * @param contended Address of `bool` set to `true` if another thread took
+ *  the task first, in which case the deque may still have tasks
+ * @returns Task, `NULL` if the deque is empty or the steal lost a race
+ */
+static pdcpl_task *
+pdcpl_deque_steal(pdcpl_deque *deque, bool *contended)
+{
+  uint64_t top = pdcpl_atomic_load_u64(&deque->top);
+  pdcpl_atomic_fence();
+  uint64_t bottom = pdcpl_atomic_load_u64(&deque->bottom);
+  if ((int64_t) (bottom - top) <= 0)
+    return NULL;
+  pdcpl_deque_array *array = pdcpl_atomic_load_ptr(&deque->array);
+  pdcpl_task *task = pdcpl_atomic_load_ptr(
+    &array->slots[top & (array->size - 1)]
+  );
+  if (!pdcpl_atomic_cas_u64(&deque->top, &top, top + 1)) {
+    *contended = true;
+    return NULL;
+  }
+  return task;
+}
+
+/**
+ * Check if a deque looks non-empty.
+ *
+ * @param deque Deque
+ */
+static bool
+pdcpl_deque_has_tasks(pdcpl_deque *deque)
+{
+  uint64_t top = pdcpl_atomic_load_u64(&deque->top);
+  uint64_t bottom = pdcpl_atomic_load_u64(&deque->bottom);
+  return (int64_t) (bottom - top) > 0;
+}
+
+/**
+ * Wake a sleeping worker if there are any.
+ *
+ * @param pool Thread pool
+ */
+static void
+pdcpl_thread_pool_wake(pdcpl_thread_pool *pool)
+{
+  // pairs with the fence in pdcpl_thread_pool_sleep
+  pdcpl_atomic_fence();
+  if (!pdcpl_atomic_load_u64(&pool->sleepers))
+    return;
+  pdcpl_mutex_lock(pool->mutex);
+  pdcpl_cond_signal(pool->cond);
+  pdcpl_mutex_unlock(pool->mutex);
+}
+
+/**
+ * Add a task to the injection queue and wake a sleeping worker.
+ *
+ * @param pool Thread pool
+ * @param task Task to add
+ */
+static void
+pdcpl_thread_pool_inject(pdcpl_thread_pool *pool, pdcpl_task *task)
+{
+  task->next = NULL;
+  pdcpl_mutex_lock(pool->mutex);
+  if (pool->inject_tail)
+    pool->inject_tail->next = task;
+  else
+    pool->inject_head = task;
+  pool->inject_tail = task;
+  pdcpl_atomic_fetch_add_u64(&pool->injected, 1);
+  // sleepers hold the mutex while checking for work, so no fence is needed
+  if (pdcpl_atomic_load_u64(&pool->sleepers))
+    pdcpl_cond_signal(pool->cond);
+  pdcpl_mutex_unlock(pool->mutex);
+}
+
+/**
+ * Remove the first task from the injection queue.
+ *
+ * @param pool Thread pool
+ * @returns Task, `NULL` if the queue is empty
+ */
+static pdcpl_task *
+pdcpl_thread_pool_uninject(pdcpl_thread_pool *pool)
+{
+  // unlocked check to avoid taking the mutex when the queue is empty
+  if (!pdcpl_atomic_load_u64(&pool->injected))
+    return NULL;
+  pdcpl_mutex_lock(pool->mutex);
+  pdcpl_task *task = pool->inject_head;
+  if (task) {
+    if (!(pool->inject_head = task->next))
+      pool->inject_tail = NULL;
+    pdcpl_atomic_fetch_add_u64(&pool->injected, (uint64_t) -1);
+  }
+  pdcpl_mutex_unlock(pool->mutex);
+  return task;
+}
+
+/**
+ * Make a task available to the pool.
+ *
+ * Tasks pushed by a worker go to its own deque, other tasks go to the
+ * injection queue. The task's group must already count it as pending.
+ *
+ * @param pool Thread pool
+ * @param worker Calling thread's worker state, `NULL` if not a worker
+ * @param task Task to push
+ * @returns 0 on success, -ENOMEM if the worker's deque could not grow
+ */
+static int
+pdcpl_thread_pool_push(
+  pdcpl_thread_pool *pool, pdcpl_worker *worker, pdcpl_task *task)
+{
+  if (!worker) {
+    pdcpl_thread_pool_inject(pool, task);
+    return 0;
+  }
+  int status = pdcpl_deque_push(&worker->deque, task);
+  if (status)
+    return status;
+  pdcpl_thread_pool_wake(pool);
+  return 0;
+}
+
+/**
+ * Find a task to run.
+ *
+ * Workers take from their own deque first. Then the injection queue is
+ * checked and the other workers' deques are stolen from, starting at a
+ * random victim each pass.
+ *
+ * @param pool Thread pool
+ * @param worker Calling thread's worker state, `NULL` if not a worker
+ * @param rng Random state for choosing victims
+ * @returns Task, `NULL` if none was found
+ */
+static pdcpl_task *
+pdcpl_thread_pool_find(
+  pdcpl_thread_pool *pool, pdcpl_worker *worker, uint64_t *rng)
+{
+  pdcpl_task *task;
+  if (worker && (task = pdcpl_deque_take(&worker->deque)))
+    return task;
+  if ((task = pdcpl_thread_pool_uninject(pool)))
+    return task;
+  unsigned int n_workers = pool->n_workers;
+  for (unsigned int round = 0; round < PDCPL_STEAL_ROUNDS; round++) {
+    bool contended = false;
+    unsigned int start = (unsigned int) (pdcpl_xorshift(rng) % n_workers);
+    for (unsigned int i = 0; i < n_workers; i++) {
+      pdcpl_worker *victim = pool->workers + (start + i) % n_workers;
+      if (victim == worker)
+        continue;
+      if ((task = pdcpl_deque_steal(&victim->deque, &contended)))
+        return task;
+    }
+    // all deques were empty and no steal lost a race
+    if (!contended)
+      break;
+  }
+  return NULL;
+}
+
+static void
+pdcpl_thread_pool_run_range(
+  pdcpl_thread_pool *pool,
+  pdcpl_worker *worker,
+  pdcpl_range_func func,
+  void *arg,
+  size_t begin,
+  size_t end,
+  size_t grain,
+  pdcpl_task_group *group);
+
+/**
+ * Run a task, free it, and mark it finished in its group.
+ *
+ * @param pool Thread pool
+ * @param worker Calling thread's worker state, `NULL` if not a worker
+ * @param task Task to run
+ */
+static void
+pdcpl_thread_pool_run(
+  pdcpl_thread_pool *pool, pdcpl_worker *worker, pdcpl_task *task)
+{
+  pdcpl_task_group *group = task->group;
+  if (task->func)
+    task->func(task->arg);
+  else
+    pdcpl_thread_pool_run_range(
+      pool,
+      worker,
+      task->range_func,
+      task->arg,
+      task->begin,
+      task->end,
+      task->grain,
+      group
+    );
+  free(task);
+  if (!group)
+    return;
+  // the decrement releases the task's writes to the group's waiter. the
+  // group may be freed once pending is 0, so it is not touched after
+  if (pdcpl_atomic_fetch_add_release_u64(&group->pending, (uint64_t) -1) != 1)
+    return;
+  // pairs with the fence in pdcpl_task_group_block
+  pdcpl_atomic_fence();
+  if (!pdcpl_atomic_load_u64(&pool->waiters))
+    return;
+  pdcpl_mutex_lock(pool->mutex);
+  pdcpl_cond_broadcast(pool->cond);
+  pdcpl_mutex_unlock(pool->mutex);
+}
+
+/**
+ * Run part of a parallel loop, splitting off right halves as tasks.
+ *
+ * @param pool Thread pool
+ * @param worker Calling thread's worker state, `NULL` if not a worker
+ * @param func Range function
+ * @param arg User-defined argument passed to `func`
+ * @param begin First index
+ * @param end One past the last index
+ * @param grain Maximum subrange size, nonzero
+ * @param group Task group split-off tasks are added to
+ */
+static void
+pdcpl_thread_pool_run_range(
+  pdcpl_thread_pool *pool,
+  pdcpl_worker *worker,
+  pdcpl_range_func func,
+  void *arg,
+  size_t begin,
+  size_t end,
+  size_t grain,
+  pdcpl_task_group *group)
+{
+  while (end - begin > grain) {
+    size_t mid = begin + (end - begin) / 2;
+    pdcpl_task *task = malloc(sizeof *task);
+    // run the rest of the range here if no task can be made
+    if (!task)
+      break;
+    *task = (pdcpl_task) {
+      .range_func = func,
+      .arg = arg,
+      .begin = mid,
+      .end = end,
+      .grain = grain,
+      .group = group
+    };
+    pdcpl_atomic_fetch_add_u64(&group->pending, 1);
+    if (pdcpl_thread_pool_push(pool, worker, task)) {
+      pdcpl_atomic_fetch_add_u64(&group->pending, (uint64_t) -1);
+      free(task);
+      break;
+    }
+    end = mid;
+  }
+  func(begin, end, arg);
+}
+
+/**
+ * Sleep until there may be work or the pool is stopping.
+ *
+ * @param pool Thread pool
+ * @returns `true` if the pool is stopping, `false` otherwise
+ */
+static bool
+pdcpl_thread_pool_sleep(pdcpl_thread_pool *pool)
+{
+  pdcpl_mutex_lock(pool->mutex);
+  bool stop = pdcpl_atomic_load_u64(&pool->stop) != 0;
+  if (!stop) {
+    pdcpl_atomic_fetch_add_u64(&pool->sleepers, 1);
+    // pairs with the fence in pdcpl_thread_pool_wake
+    pdcpl_atomic_fence();
+    bool has_tasks = pool->inject_head != NULL;
+    for (unsigned int i = 0; i < pool->n_workers && !has_tasks; i++)
+      has_tasks = pdcpl_deque_has_tasks(&pool->workers[i].deque);
+    if (!has_tasks)
+      pdcpl_cond_wait(pool->cond, pool->mutex);
+    pdcpl_atomic_fetch_add_u64(&pool->sleepers, (uint64_t) -1);
+  }
+  pdcpl_mutex_unlock(pool->mutex);
+  return stop;
+}
+
+/**
+ * Block until a task group is finished or there may be work.
+ *
+ * @param pool Thread pool
+ * @param group Task group being waited on
+ */
+static void
+pdcpl_task_group_block(pdcpl_thread_pool *pool, pdcpl_task_group *group)
+{
+  pdcpl_mutex_lock(pool->mutex);
+  pdcpl_atomic_fetch_add_u64(&pool->sleepers, 1);
+  pdcpl_atomic_fetch_add_u64(&pool->waiters, 1);
+  // pairs with the fences in pdcpl_thread_pool_wake and pdcpl_thread_pool_run
+  pdcpl_atomic_fence();
+  bool ready = !pdcpl_atomic_load_u64(&group->pending) ||
+    pool->inject_head != NULL;
+  for (unsigned int i = 0; i < pool->n_workers && !ready; i++)
+    ready = pdcpl_deque_has_tasks(&pool->workers[i].deque);
+  if (!ready)
+    pdcpl_cond_wait(pool->cond, pool->mutex);
+  pdcpl_atomic_fetch_add_u64(&pool->waiters, (uint64_t) -1);
+  pdcpl_atomic_fetch_add_u64(&pool->sleepers, (uint64_t) -1);
+  pdcpl_mutex_unlock(pool->mutex);
+}
+
+/**
+ * Worker thread function.
+ *
+ * Runs tasks until the pool is stopping and no tasks can be found.
+ *
+ * @param arg `pdcpl_worker *` worker state
+ * @returns `NULL`
+ */
+static void *
+pdcpl_thread_pool_worker_main(void *arg)
+{
+  pdcpl_worker *worker = arg;
+  pdcpl_thread_pool *pool = worker->pool;
+  pdcpl_current_worker = worker;
+  // best-effort, so failure is ignored
+  if (pool->pin)
+    pdcpl_thread_pin(worker->index % pdcpl_thread_hardware_concurrency());
+  for (;;) {
+    pdcpl_task *task = pdcpl_thread_pool_find(pool, worker, &worker->rng);
+    if (task)
+      pdcpl_thread_pool_run(pool, worker, task);
+    else if (pdcpl_thread_pool_sleep(pool))
+      break;
+  }
+  pdcpl_current_worker = NULL;
+  return NULL;
+}
+
+/**
+ * Stop and join the first workers of a pool and free the pool.
+ *
+ * @param pool Thread pool
+ * @param n_started Number of workers whose threads were started
+ */
+static void
+pdcpl_thread_pool_free(pdcpl_thread_pool *pool, unsigned int n_started)
+{
+  if (pool->mutex && pool->cond) {
+    pdcpl_mutex_lock(pool->mutex);
+    pdcpl_atomic_store_u64(&pool->stop, 1);
+    pdcpl_cond_broadcast(pool->cond);
+    pdcpl_mutex_unlock(pool->mutex);
+  }
+  for (unsigned int i = 0; i < n_started; i++)
+    pdcpl_thread_join(pool->workers[i].thread, NULL);
+  if (pool->workers) {
+    for (unsigned int i = 0; i < pool->n_workers; i++)
+      pdcpl_deque_free(&pool->workers[i].deque);
+    free(pool->workers);
+  }
+  if (pool->cond)
+    pdcpl_cond_destroy(pool->cond);
+  if (pool->mutex)
+    pdcpl_mutex_destroy(pool->mutex);
+  free(pool);
+}
+
+/**
+ * Create a new thread pool and start its workers.
+ *
+ * @param pool Address of `pdcpl_thread_pool *` to write the new handle to
+ * @param opts Pool options, `NULL` for `PDCPL_THREAD_POOL_OPTIONS_DEFAULT`
+ * @returns 0 on success, -EINVAL if `pool` is `NULL`, -ENOMEM if memory
+ *  allocation fails, other negative errno value if a worker could not start
+ */
+int
+pdcpl_thread_pool_create(
+  pdcpl_thread_pool **pool, const pdcpl_thread_pool_options *opts)
+{
+  if (!pool)
+    return -EINVAL;
+  pdcpl_thread_pool_options default_opts = PDCPL_THREAD_POOL_OPTIONS_DEFAULT;
+  if (!opts)
+    opts = &default_opts;
+  pdcpl_thread_pool *p = calloc(1, sizeof *p);
+  if (!p)
+    return -ENOMEM;
+  p->n_workers = (opts->n_threads) ?
+    opts->n_threads : pdcpl_thread_hardware_concurrency();
+  p->pin = opts->pin;
+  int status;
+  if (
+    (status = pdcpl_mutex_create(&p->mutex)) ||
+    (status = pdcpl_cond_create(&p->cond))
+  )
+    goto error;
+  if (!(p->workers = calloc(p->n_workers, sizeof *p->workers))) {
+    status = -ENOMEM;
+    goto error;
+  }
+  // all deques must exist before any worker starts stealing
+  for (unsigned int i = 0; i < p->n_workers; i++) {
+    pdcpl_worker *worker = p->workers + i;
+    worker->pool = p;
+    worker->index = i;
+    // distinct nonzero seeds so workers pick different victims
+    worker->rng = 0x9e3779b97f4a7c15u * (i + 1);
+    if ((status = pdcpl_deque_init(&worker->deque)))
+      goto error;
+  }
+  unsigned int n_started = 0;
+  for (; n_started < p->n_workers; n_started++) {
+    pdcpl_worker *worker = p->workers + n_started;
+    status = pdcpl_thread_create(
+      &worker->thread, pdcpl_thread_pool_worker_main, worker
+    );
+    if (status) {
+      pdcpl_thread_pool_free(p, n_started);
+      return status;
+    }
+  }
+  *pool = p;
+  return 0;
+error:
+  pdcpl_thread_pool_free(p, 0);
+  return status;
+}
+
+/**
+ * Run all remaining tasks, stop the workers, and free the pool.
+ *
+ * Must not be called from a task running on the pool.
+ *
+ * @param pool Thread pool handle, which is invalid after the call
+ * @returns 0 on success, -EINVAL if `pool` is `NULL`
+ */
+int
+pdcpl_thread_pool_destroy(pdcpl_thread_pool *pool)
+{
+  if (!pool)
+    return -EINVAL;
+  // workers only exit once they find no tasks, so queued tasks still run
+  pdcpl_thread_pool_free(pool, pool->n_workers);
+  return 0;
+}
+
+/**
+ * Return the number of worker threads, 0 if `pool` is `NULL`.
+ *
+ * @param pool Thread pool handle
+ */
+unsigned int
+pdcpl_thread_pool_size(const pdcpl_thread_pool *pool)
+{
+  return (pool) ? pool->n_workers : 0;
+}
+
+/**
+ * Submit a task to a thread pool.
+ *
+ * If called from one of the pool's workers, the task is pushed onto that
+ * worker's deque, and is run immediately by the caller if the deque cannot
+ * grow. Otherwise it is added to the pool's injection queue.
+ *
+ * @param pool Thread pool handle
+ * @param group Task group to add the task to, `NULL` for no group
+ * @param func Task function
+ * @param arg User-defined argument passed to `func`
+ * @returns 0 on success, -EINVAL if `pool` or `func` is `NULL`, -ENOMEM if
+ *  memory allocation fails
+ */
+int
+pdcpl_thread_pool_submit(
+  pdcpl_thread_pool *pool,
+  pdcpl_task_group *group,
+  pdcpl_task_func func,
+  void *arg)
+{
+  if (!pool || !func)
+    return -EINVAL;
+  pdcpl_task *task = malloc(sizeof *task);
+  if (!task)
+    return -ENOMEM;
+  *task = (pdcpl_task) {.func = func, .arg = arg, .group = group};
+  if (group)
+    pdcpl_atomic_fetch_add_u64(&group->pending, 1);
+  pdcpl_worker *worker = pdcpl_thread_pool_worker(pool);
+  if (pdcpl_thread_pool_push(pool, worker, task))
+    pdcpl_thread_pool_run(pool, worker, task);
+  return 0;
+}
+
+/**
+ * Wait until all the tasks in a group have finished.
+ *
+ * The calling thread runs pending tasks from the pool while it waits, so it
+ * is safe to call from a task running on the pool. If no tasks can be found
+ * for a while, the thread sleeps until the group finishes or there is work.
+ *
+ * @param pool Thread pool handle the group's tasks were submitted to
+ * @param group Task group
+ * @returns 0 on success, -EINVAL if `pool` or `group` is `NULL`
+ */
+int
+pdcpl_task_group_wait(pdcpl_thread_pool *pool, pdcpl_task_group *group)
+{
+  if (!pool || !group)
+    return -EINVAL;
+  pdcpl_worker *worker = pdcpl_thread_pool_worker(pool);
+  // non-workers seed from the group address, which only affects victim order
+  uint64_t local_rng = (uint64_t) (uintptr_t) group | 1;
+  uint64_t *rng = (worker) ? &worker->rng : &local_rng;
+  unsigned int spins = 0;
+  while (pdcpl_atomic_load_u64(&group->pending)) {
+    pdcpl_task *task = pdcpl_thread_pool_find(pool, worker, rng);
+    if (task) {
+      pdcpl_thread_pool_run(pool, worker, task);
+      spins = 0;
+    }
+    // tasks of the group may be running on other threads, so briefly yield
+    // in case they finish soon before sleeping
+    else if (spins < PDCPL_TASK_GROUP_SPINS) {
+      pdcpl_thread_yield();
+      spins++;
+    }
+    else {
+      pdcpl_task_group_block(pool, group);
+      spins = 0;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Call a function on subranges of `[begin, end)` in parallel.
+ *
+ * The range is split in halves recursively until subranges have at most
+ * `grain` indices, with the right halves made available for stealing, so
+ * splitting only goes as deep as idle workers make it worthwhile. The
+ * calling thread takes part in the loop and returns when all the subranges
+ * are done. If a task cannot be allocated, its subrange is run by the thread
+ * that was splitting it.
+ *
+ * @param pool Thread pool handle
+ * @param begin First index
+ * @param end One past the last index
+ * @param grain Maximum subrange size, 0 to choose one from the range size
+ *  and the number of workers
+ * @param func Function called on each subrange
+ * @param arg User-defined argument passed to `func`
+ * @returns 0 on success, -EINVAL if `pool` or `func` is `NULL`
+ */
+int
+pdcpl_parallel_for(
+  pdcpl_thread_pool *pool,
+  size_t begin,
+  size_t end,
+  size_t grain,
+  pdcpl_range_func func,
+  void *arg)
+{
+  if (!pool || !func)
+    return -EINVAL;
+  if (begin >= end)
+    return 0;
+  // enough subranges per worker to balance uneven work without making tasks
+  // so small that scheduling dominates
+  if (!grain) {
+    grain = (end - begin) / (PDCPL_PARALLEL_FOR_SPLITS * pool->n_workers);
+    if (!grain)
+      grain = 1;
+  }
+  pdcpl_task_group group = PDCPL_TASK_GROUP_INIT;
+  pdcpl_thread_pool_run_range(
+    pool,
+    pdcpl_thread_pool_worker(pool),
+    func,
+    arg,
+    begin,
+    end,
+    grain,
+    &group
+  );
+  return pdcpl_task_group_wait(pool, &group);
+}
@@ -0,0 +1,322 @@
+/**
+ * @file trace.c
+ * @author Derek Huang
+ * @brief C source for lightweight tracing with trace-event JSON output
+ * @copyright MIT License
+ */
+
+#include "pdcpl/trace.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+// use the time stamp counter on x86 and x64
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define PDCPL_TRACE_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PDCPL_TRACE_TSC
+#endif  // !defined(_M_X64) && !defined(_M_IX86) && !defined(__x86_64__) && ...
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pdcpl/atomic.h"
+#include "pdcpl/clock.h"
+#include "pdcpl/common.h"
+
+/**
+ * Trace event phase values, as used in the trace-event JSON format.
+ */
+#define PDCPL_TRACE_PHASE_SPAN 'X'
+#define PDCPL_TRACE_PHASE_COUNTER 'C'
+
+/**
+ * Recorded trace event.
+ *
+ * @param name Event name
+ * @param ts Event timestamp in ticks
+ * @param arg Span duration in ticks or counter value
+ * @param phase Event phase
+ */
+typedef struct {
+  const char *name;
+  uint64_t ts;
+  uint64_t arg;
+  char phase;
+} pdcpl_trace_event;
+
+/**
+ * Per-thread ring buffer of trace events.
+ *
+ * Only the owning thread writes events. `head` is the total number of events
+ * written and is published with release semantics after each event.
+ *
+ * @param next Next ring in the global list of rings
+ * @param tid Sequential thread ID, starting from 1
+ * @param head Total number of events written
+ * @param events Event storage
+ */
+typedef struct pdcpl_trace_ring {
+  struct pdcpl_trace_ring *next;
+  uint64_t tid;
+  uint64_t head;
+  pdcpl_trace_event events[PDCPL_TRACE_RING_SIZE];
+} pdcpl_trace_ring;
+
+// calling thread's ring, allocated on first event
+static PDCPL_THREAD_LOCAL pdcpl_trace_ring *pdcpl_trace_local;
+// true if ring allocation failed for this thread, so events are dropped
+static PDCPL_THREAD_LOCAL bool pdcpl_trace_local_failed;
+// lock-free list of all rings. rings are never freed
+static pdcpl_trace_ring *pdcpl_trace_rings;
+// last assigned thread ID
+static uint64_t pdcpl_trace_last_tid;
+// tick and clock values when the first ring was allocated, for calibration
+static uint64_t pdcpl_trace_start_ticks;
+static uint64_t pdcpl_trace_start_ns;
+
+/**
+ * Return the current trace timestamp in implementation-defined ticks.
+ *
+ * On x86 processors this reads the time stamp counter, otherwise it reads a
+ * monotonic clock in nanoseconds. Ticks are converted when the trace is dumped.
+ */
+uint64_t
+pdcpl_trace_now(void)
+{
+#if defined(PDCPL_TRACE_TSC)
+  return __rdtsc();
+#else
+  return pdcpl_clock_ns();
+#endif  // !defined(PDCPL_TRACE_TSC)
+}
+
+#if defined(PDCPL_ENABLE_TRACE)
+/**
+ * Write the trace to the file named by `PDCPL_TRACE_FILE_ENV` at exit.
+ */
+static void
+pdcpl_trace_atexit(void)
+{
+  const char *path = getenv(PDCPL_TRACE_FILE_ENV);
+  if (!path || !*path)
+    path = "pdcpl_trace.json";
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return;
+  pdcpl_trace_dump(f);
+  fclose(f);
+}
+#endif  // defined(PDCPL_ENABLE_TRACE)
+
+/**
+ * Return the calling thread's ring, allocating it if necessary.
+ *
+ * @returns Ring on success, `NULL` if allocation failed
+ */
+static pdcpl_trace_ring *
+pdcpl_trace_ring_get(void)
+{
+  if (pdcpl_trace_local)
+    return pdcpl_trace_local;
+  if (pdcpl_trace_local_failed)
+    return NULL;
+  pdcpl_trace_ring *ring = malloc(sizeof *ring);
+  if (!ring) {
+    pdcpl_trace_local_failed = true;
+    return NULL;
+  }
+  ring->head = 0;
+  ring->tid = pdcpl_atomic_fetch_add_u64(&pdcpl_trace_last_tid, 1) + 1;
+  // first ring records the calibration start point + registers exit handler
+  if (ring->tid == 1) {
+    pdcpl_trace_start_ns = pdcpl_clock_ns();
+    pdcpl_trace_start_ticks = pdcpl_trace_now();
+#if defined(PDCPL_ENABLE_TRACE)
+    atexit(pdcpl_trace_atexit);
+#endif  // defined(PDCPL_ENABLE_TRACE)
+  }
+  // push onto the global list
+  void *head = pdcpl_atomic_load_ptr((void *const *) &pdcpl_trace_rings);
+  do {
+    ring->next = (pdcpl_trace_ring *) head;
+  }
+  while (!pdcpl_atomic_cas_ptr((void **) &pdcpl_trace_rings, &head, ring));
+  return pdcpl_trace_local = ring;
+}
+
+/**
+ * Record an event in the calling thread's ring.
+ *
+ * @param phase Event phase
+ * @param name Event name
+ * @param ts Event timestamp in ticks
+ * @param arg Span duration in ticks or counter value
+ */
+static void
+pdcpl_trace_record(char phase, const char *name, uint64_t ts, uint64_t arg)
+{
+  pdcpl_trace_ring *ring = pdcpl_trace_ring_get();
+  if (!ring)
+    return;
+  uint64_t head = ring->head;
+  pdcpl_trace_event *event =
+    ring->events + (head & (PDCPL_TRACE_RING_SIZE - 1));
+  event->name = name;
+  event->ts = ts;
+  event->arg = arg;
+  event->phase = phase;
+  pdcpl_atomic_store_u64(&ring->head, head + 1);
+}
+
+/**
+ * Record a span that started at the given timestamp and ends now.
+ *
+ * The first event recorded in a thread allocates that thread's ring buffer. If
+ * the library was built with `PDCPL_ENABLE_TRACE`, the first event recorded in
+ * the program also registers an `atexit` handler that dumps the trace.
+ *
+ * @param name Span name, must have static storage duration
+ * @param start Span start timestamp from `pdcpl_trace_now`
+ */
+void
+pdcpl_trace_span(const char *name, uint64_t start)
+{
+  uint64_t end = pdcpl_trace_now();
+  pdcpl_trace_record(PDCPL_TRACE_PHASE_SPAN, name, start, end - start);
+}
+
+/**
+ * Record the current value of a named counter.
+ *
+ * @param name Counter name, must have static storage duration
+ * @param value Counter value
+ */
+void
+pdcpl_trace_counter(const char *name, int64_t value)
+{
+  pdcpl_trace_record(
+    PDCPL_TRACE_PHASE_COUNTER, name, pdcpl_trace_now(), (uint64_t) value
+  );
+}
+
+/**
+ * Write a JSON string, escaping quotes, backslashes, and control characters.
+ *
+ * @param f Stream to write to
+ * @param s String to write
+ */
+static void
+pdcpl_trace_fputs_json(FILE *f, const char *s)
+{
+  fputc('"', f);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      fprintf(f, "\\%c", *s);
+    else if ((unsigned char) *s < 0x20)
+      fprintf(f, "\\u%04x", (unsigned int) (unsigned char) *s);
+    else
+      fputc(*s, f);
+  }
+  fputc('"', f);
+}
+
+/**
+ * Write all recorded events as Chrome/Perfetto trace-event JSON.
+ *
+ * No other threads should be recording events during the dump.
+ *
+ * @param f Stream to write to
+ * @returns 0 on success, -EINVAL if `f` is `NULL`, -EIO on write error
+ */
+int
+pdcpl_trace_dump(FILE *f)
+{
+  if (!f)
+    return -EINVAL;
+#if defined(_WIN32)
+  unsigned long pid = GetCurrentProcessId();
+#else
+  unsigned long pid = (unsigned long) getpid();
+#endif  // !defined(_WIN32)
+  // microseconds per tick, calibrated against the clock since the first ring
+  // was allocated if ticks are not nanoseconds
+#if defined(PDCPL_TRACE_TSC)
+  uint64_t ns = pdcpl_clock_ns() - pdcpl_trace_start_ns;
+  uint64_t ticks = pdcpl_trace_now() - pdcpl_trace_start_ticks;
+  double us_per_tick = (ticks) ? 1e-3 * (double) ns / (double) ticks : 0;
+#else
+  double us_per_tick = 1e-3;
+#endif  // !defined(PDCPL_TRACE_TSC)
+  pdcpl_trace_ring *rings = (pdcpl_trace_ring *) pdcpl_atomic_load_ptr(
+    (void *const *) &pdcpl_trace_rings
+  );
+  // timestamps are relative to the earliest event so they are non-negative
+  uint64_t origin = UINT64_MAX;
+  for (pdcpl_trace_ring *ring = rings; ring; ring = ring->next) {
+    uint64_t head = pdcpl_atomic_load_u64(&ring->head);
+    uint64_t i = (head > PDCPL_TRACE_RING_SIZE) ?
+      head - PDCPL_TRACE_RING_SIZE : 0;
+    for (; i < head; i++) {
+      uint64_t ts = ring->events[i & (PDCPL_TRACE_RING_SIZE - 1)].ts;
+      if (ts < origin)
+        origin = ts;
+    }
+  }
+  fprintf(f, "{\"traceEvents\": [");
+  bool first = true;
+  for (pdcpl_trace_ring *ring = rings; ring; ring = ring->next) {
+    uint64_t head = pdcpl_atomic_load_u64(&ring->head);
+    uint64_t i = (head > PDCPL_TRACE_RING_SIZE) ?
+      head - PDCPL_TRACE_RING_SIZE : 0;
+    for (; i < head; i++) {
+      const pdcpl_trace_event *event =
+        ring->events + (i & (PDCPL_TRACE_RING_SIZE - 1));
+      double ts = us_per_tick * (double) (event->ts - origin);
+      fprintf(f, "%s\n{\"name\": ", (first) ? "" : ",");
+      pdcpl_trace_fputs_json(f, event->name);
+      fprintf(
+        f,
+        ", \"ph\": \"%c\", \"pid\": %lu, \"tid\": %llu, \"ts\": %.3f",
+        event->phase,
+        pid,
+        (unsigned long long) ring->tid,
+        ts
+      );
+      if (event->phase == PDCPL_TRACE_PHASE_SPAN)
+        fprintf(f, ", \"dur\": %.3f}", us_per_tick * (double) event->arg);
+      else
+        fprintf(
+          f, ", \"args\": {\"value\": %lld}}", (long long) (int64_t) event->arg
+        );
+      first = false;
+    }
+  }
+  fprintf(f, "\n], \"displayTimeUnit\": \"ns\"}\n");
+  return (ferror(f)) ? -EIO : 0;
+}
+
+/**
+ * Discard all recorded events.
+ *
+ * No other threads should be recording events when this is called.
+ */
+void
+pdcpl_trace_clear(void)
+{
+  pdcpl_trace_ring *ring = (pdcpl_trace_ring *) pdcpl_atomic_load_ptr(
+    (void *const *) &pdcpl_trace_rings
+  );
+  for (; ring; ring = ring->next)
+    pdcpl_atomic_store_u64(&ring->head, 0);
+}
@@ -8,8 +8,10 @@
 #include "pdcpl/variant.h"
 
 #include <errno.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -60,8 +62,10 @@ PDCPL_VARIANT_INIT_DECL(string, const char *)
     return -EINVAL;
   // set type and ownership. allow incoming string to be NULL
   vt->flags = pdcpl_variant_string | pdcpl_variant_mem_own;
-  if (!val)
+  if (!val) {
+    vt->data.s = NULL;
     return 0;
+  }
   // otherwise, malloc. don't forget + 1 for null terminator
   vt->data.s = malloc(strlen(val) + 1);
   // -ENOMEM if malloc fails
@@ -206,6 +210,211 @@ pdcpl_variant_compare(const pdcpl_variant* va, const pdcpl_variant *vb)
   return 0;
 }
 
+/**
+ * Check if two variants are equal.
+ *
+ * Unlike `pdcpl_variant_compare`, which uses epsilon-based comparison for
+ * floating types and treats mismatched types as ties, this is an exact,
+ * type-aware equality consistent with `pdcpl_variant_hash`. Variants of
+ * different intrinsic types are never equal, `-0.0` and `+0.0` are equal, and
+ * all NaN values of a floating type are equal to each other. Two `NULL`
+ * strings are equal. Memory ownership flags are ignored.
+ *
+ * @param va First variant
+ * @param vb Second variant
+ * @returns `true` if the variants are equal, `false` otherwise or on error
+ */
+bool
+pdcpl_variant_equal(const pdcpl_variant *va, const pdcpl_variant *vb)
+{
+  if (!va || !vb)
+    return false;
+  // shared type must also be the only type of both variants
+  unsigned int vtype = pdcpl_variant_shared_type(va, vb);
+  if (
+    !vtype ||
+    vtype != ((va->flags | vb->flags) &
+      ~(pdcpl_variant_mem_own | pdcpl_variant_mem_borrow))
+  )
+    return false;
+  switch (vtype) {
+    case pdcpl_variant_char:
+      return va->data.c == vb->data.c;
+    case pdcpl_variant_int:
+      return va->data.i == vb->data.i;
+    case pdcpl_variant_uint:
+      return va->data.u == vb->data.u;
+    case pdcpl_variant_size:
+      return va->data.z == vb->data.z;
+    // note: -0.0 == +0.0 already, so only NaN needs special handling
+    case pdcpl_variant_double:
+      return
+        va->data.d == vb->data.d || (isnan(va->data.d) && isnan(vb->data.d));
+    case pdcpl_variant_float:
+      return
+        va->data.f == vb->data.f || (isnan(va->data.f) && isnan(vb->data.f));
+    case pdcpl_variant_string:
+      if (!va->data.s || !vb->data.s)
+        return va->data.s == vb->data.s;
+      return !strcmp(va->data.s, vb->data.s);
+    case pdcpl_variant_void:
+      return
+        va->data.v.z == vb->data.v.z &&
+        !memcmp(va->data.v.b, vb->data.v.b, va->data.v.z);
+  }
+  return false;
+}
+
+/**
+ * 64-bit multiplicative constant used for hashing, 2^64 / golden ratio.
+ */
+#define PDCPL_HASH_GOLDEN UINT64_C(0x9e3779b97f4a7c15)
+
+/**
+ * Mix the bits of a 64-bit value.
+ *
+ * This is the splitmix64 finalizer, which has good avalanche behavior.
+ *
+ * @param x Value to mix
+ */
+static inline uint64_t
+pdcpl_hash_mix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= UINT64_C(0xbf58476d1ce4e5b9);
+  x ^= x >> 27;
+  x *= UINT64_C(0x94d049bb133111eb);
+  x ^= x >> 31;
+  return x;
+}
+
+/**
+ * Hash a byte buffer a 64-bit word at a time.
+ *
+ * @param data Buffer to hash
+ * @param n Number of bytes in buffer
+ * @param seed Initial hash state
+ */
+static uint64_t
+pdcpl_hash_bytes(const void *data, size_t n, uint64_t seed)
+{
+  const unsigned char *p = data;
+  uint64_t h = seed ^ (n * PDCPL_HASH_GOLDEN);
+  uint64_t w;
+  for (; n >= sizeof w; n -= sizeof w, p += sizeof w) {
+    memcpy(&w, p, sizeof w);
+    h = (h ^ pdcpl_hash_mix(w)) * PDCPL_HASH_GOLDEN;
+  }
+  // remaining bytes packed into a final word
+  w = 0;
+  for (size_t i = 0; i < n; i++)
+    w |= (uint64_t) p[i] << (8 * i);
+  return pdcpl_hash_mix(h ^ pdcpl_hash_mix(w));
+}
+
+/**
+ * Compute a hash value for a variant.
+ *
+ * The hash is type-aware, i.e. variants of different intrinsic types holding
+ * the same bits will almost always hash differently, and is consistent with
+ * `pdcpl_variant_equal`, so `-0.0` and `+0.0` hash the same as do all NaN
+ * values of a floating type. String and `void *` contents are hashed, not the
+ * pointers. Memory ownership flags are ignored.
+ *
+ * @param vt Variant to hash
+ * @returns Hash value, zero if `vt` is `NULL`
+ */
+uint64_t
+pdcpl_variant_hash(const pdcpl_variant *vt)
+{
+  if (!vt)
+    return 0;
+  unsigned int vtype =
+    vt->flags & ~(pdcpl_variant_mem_own | pdcpl_variant_mem_borrow);
+  // the type flag seeds the hash so equal bits of different types differ
+  uint64_t seed = pdcpl_hash_mix(vtype * PDCPL_HASH_GOLDEN);
+  uint64_t bits;
+  switch (vtype) {
+    case pdcpl_variant_char:
+      bits = (unsigned char) vt->data.c;
+      break;
+    case pdcpl_variant_int:
+      bits = (uint64_t) (int64_t) vt->data.i;
+      break;
+    case pdcpl_variant_uint:
+      bits = vt->data.u;
+      break;
+    case pdcpl_variant_size:
+      bits = vt->data.z;
+      break;
+    // canonicalize signed zero and NaN before hashing the bits
+    case pdcpl_variant_double: {
+      double d = vt->data.d;
+      if (d == 0.)
+        d = 0.;
+      else if (isnan(d))
+        d = NAN;
+      memcpy(&bits, &d, sizeof bits);
+      break;
+    }
+    case pdcpl_variant_float: {
+      float f = vt->data.f;
+      uint32_t fbits;
+      if (f == 0.f)
+        f = 0.f;
+      else if (isnan(f))
+        f = NAN;
+      memcpy(&fbits, &f, sizeof fbits);
+      bits = fbits;
+      break;
+    }
+    // NULL string hashes differently from the empty string
+    case pdcpl_variant_string:
+      if (!vt->data.s)
+        return seed;
+      return pdcpl_hash_bytes(vt->data.s, strlen(vt->data.s), ~seed);
+    case pdcpl_variant_void:
+      return pdcpl_hash_bytes(vt->data.v.b, vt->data.v.z, seed);
+    default:
+      return seed;
+  }
+  return pdcpl_hash_mix(seed ^ bits);
+}
+
+/**
+ * Copy a variant, making a deep copy of any string or buffer.
+ *
+ * String and `void *` data are always copied into owned memory, even if
+ * `src` only borrows its data, so `dst` never depends on the lifetime of `src`.
+ * `dst` should not manage any memory or else that memory will be leaked.
+ *
+ * @param dst Variant to copy to
+ * @param src Variant to copy from
+ * @returns 0 on success, -EINVAL if `dst` or `src` are `NULL` or if `src` has
+ *  no known type, -ENOMEM if memory allocation fails
+ */
+int
+pdcpl_variant_copy(pdcpl_variant *dst, const pdcpl_variant *src)
+{
+  if (!dst || !src)
+    return -EINVAL;
+  switch (src->flags & ~(pdcpl_variant_mem_own | pdcpl_variant_mem_borrow)) {
+    case pdcpl_variant_char:
+    case pdcpl_variant_int:
+    case pdcpl_variant_uint:
+    case pdcpl_variant_size:
+    case pdcpl_variant_double:
+    case pdcpl_variant_float:
+      *dst = *src;
+      return 0;
+    case pdcpl_variant_string:
+      return PDCPL_VARIANT_INIT(string)(dst, src->data.s);
+    case pdcpl_variant_void:
+      return PDCPL_VARIANT_INIT(void)(dst, src->data.v.b, src->data.v.z);
+  }
+  return -EINVAL;
+}
+
 /**
  * Free a `pdcpl_variant`.
  *
@@ -0,0 +1,638 @@
+/**
+ * @file variant_codec.c
+ * @author Derek Huang
+ * @brief C source for binary `pdcpl_variant` serialization
+ * @copyright MIT License
+ */
+
+#include "pdcpl/variant_codec.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pdcpl/memory.h"
+#include "pdcpl/variant.h"
+
+/**
+ * Maximum number of bytes in an encoded variant head.
+ *
+ * The head is the tag byte followed by either the scalar value or, for string
+ * and `void *` variants, the varint size of the payload that follows it.
+ */
+#define PDCPL_VARIANT_HEAD_MAX_SIZE (1 + PDCPL_VARINT_MAX_SIZE)
+
+/**
+ * Write the low `n` bytes of a value in little-endian order.
+ *
+ * @param value Value to write
+ * @param out Output buffer with at least `n` bytes
+ * @param n Number of bytes to write
+ */
+static inline void
+pdcpl_store_le(uint64_t value, unsigned char *out, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    out[i] = (unsigned char) (value >> (8 * i));
+}
+
+/**
+ * Read an `n` byte little-endian value.
+ *
+ * @param in Input buffer with at least `n` bytes
+ * @param n Number of bytes to read
+ */
+static inline uint64_t
+pdcpl_load_le(const unsigned char *in, size_t n)
+{
+  uint64_t value = 0;
+  for (size_t i = 0; i < n; i++)
+    value |= (uint64_t) in[i] << (8 * i);
+  return value;
+}
+
+/**
+ * Return the number of bytes needed to encode a value as a varint.
+ *
+ * @param value Value to encode
+ */
+size_t
+pdcpl_varint_size(uint64_t value)
+{
+  size_t n = 1;
+  while (value >>= 7)
+    n++;
+  return n;
+}
+
+/**
+ * Encode a value as an unsigned LEB128 varint.
+ *
+ * @param value Value to encode
+ * @param out Output buffer with at least `pdcpl_varint_size(value)` bytes
+ * @returns Number of bytes written to `out`
+ */
+size_t
+pdcpl_varint_encode(uint64_t value, void *out)
+{
+  unsigned char *p = out;
+  size_t n = 0;
+  // low 7 bits first, high bit set if more bytes follow
+  while (value >= 0x80) {
+    p[n++] = (unsigned char) (value | 0x80);
+    value >>= 7;
+  }
+  p[n++] = (unsigned char) value;
+  return n;
+}
+
+/**
+ * Decode an unsigned LEB128 varint.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param value Address to write decoded value to
+ * @param nrp Address to write number of bytes consumed to
+ * @returns 0 on success, -EINVAL if `in`, `value`, `nrp` are `NULL` or if the
+ *  varint is malformed, -ERANGE if `in` is truncated
+ */
+int
+pdcpl_varint_decode(const void *in, size_t size, uint64_t *value, size_t *nrp)
+{
+  if (!in || !value || !nrp)
+    return -EINVAL;
+  const unsigned char *p = in;
+  uint64_t v = 0;
+  for (size_t i = 0; i < PDCPL_VARINT_MAX_SIZE; i++) {
+    if (i >= size)
+      return -ERANGE;
+    // the tenth byte can only contribute the top bit of a 64-bit value
+    if (i == PDCPL_VARINT_MAX_SIZE - 1 && p[i] > 1)
+      return -EINVAL;
+    v |= (uint64_t) (p[i] & 0x7f) << (7 * i);
+    if (!(p[i] & 0x80)) {
+      *value = v;
+      *nrp = i + 1;
+      return 0;
+    }
+  }
+  // continuation bit set on the last allowed byte
+  return -EINVAL;
+}
+
+/**
+ * Split a variant into its encoded head and its unencoded body.
+ *
+ * The head holds the tag byte and either the scalar value or the payload size.
+ * For string and `void *` variants, the body points to the bytes that follow
+ * the head verbatim, which lets callers write the body without copying it.
+ *
+ * @param vt Variant to encode
+ * @param head Buffer of at least `PDCPL_VARIANT_HEAD_MAX_SIZE` bytes
+ * @param nhp Address to write number of head bytes to
+ * @param body Address to write body pointer to, `NULL` for scalars
+ * @param nbp Address to write number of body bytes to
+ * @returns 0 on success, -EINVAL if `vt` has no known type or is an empty
+ *  `void *` buffer, -ERANGE if an `int` or `unsigned int` value does not fit
+ *  in 32 bits
+ */
+static int
+pdcpl_variant_encode_head(
+  const pdcpl_variant *vt,
+  unsigned char *head,
+  size_t *nhp,
+  const void **body,
+  size_t *nbp)
+{
+  uint64_t bits;
+  size_t n = 1;
+  *body = NULL;
+  *nbp = 0;
+  switch (vt->flags & ~(pdcpl_variant_mem_own | pdcpl_variant_mem_borrow)) {
+    case pdcpl_variant_char:
+      head[0] = pdcpl_variant_tag_char;
+      head[n++] = (unsigned char) vt->data.c;
+      break;
+    case pdcpl_variant_int:
+#if INT_MAX > INT32_MAX
+      if (vt->data.i > INT32_MAX || vt->data.i < INT32_MIN)
+        return -ERANGE;
+#endif  // INT_MAX <= INT32_MAX
+      head[0] = pdcpl_variant_tag_int;
+      pdcpl_store_le((uint32_t) vt->data.i, head + n, 4);
+      n += 4;
+      break;
+    case pdcpl_variant_uint:
+#if UINT_MAX > UINT32_MAX
+      if (vt->data.u > UINT32_MAX)
+        return -ERANGE;
+#endif  // UINT_MAX <= UINT32_MAX
+      head[0] = pdcpl_variant_tag_uint;
+      pdcpl_store_le(vt->data.u, head + n, 4);
+      n += 4;
+      break;
+    case pdcpl_variant_size:
+      head[0] = pdcpl_variant_tag_size;
+      n += pdcpl_varint_encode(vt->data.z, head + n);
+      break;
+    case pdcpl_variant_double:
+      head[0] = pdcpl_variant_tag_double;
+      memcpy(&bits, &vt->data.d, sizeof bits);
+      pdcpl_store_le(bits, head + n, 8);
+      n += 8;
+      break;
+    case pdcpl_variant_float: {
+      uint32_t fbits;
+      head[0] = pdcpl_variant_tag_float;
+      memcpy(&fbits, &vt->data.f, sizeof fbits);
+      pdcpl_store_le(fbits, head + n, 4);
+      n += 4;
+      break;
+    }
+    // size 0 means NULL, otherwise size includes the null terminator
+    case pdcpl_variant_string:
+      head[0] = pdcpl_variant_tag_string;
+      if (vt->data.s) {
+        *body = vt->data.s;
+        *nbp = strlen(vt->data.s) + 1;
+      }
+      n += pdcpl_varint_encode(*nbp, head + n);
+      break;
+    // size 0 is rejected since void_ref can't be initialized with it
+    case pdcpl_variant_void:
+      if (!vt->data.v.z)
+        return -EINVAL;
+      head[0] = pdcpl_variant_tag_void;
+      *body = vt->data.v.b;
+      *nbp = vt->data.v.z;
+      n += pdcpl_varint_encode(*nbp, head + n);
+      break;
+    default:
+      return -EINVAL;
+  }
+  *nhp = n;
+  return 0;
+}
+
+/**
+ * Compute the number of bytes needed to encode a variant.
+ *
+ * @param vt Variant to encode
+ * @param np Address to write number of bytes to
+ * @returns 0 on success, -EINVAL if `vt` or `np` are `NULL` or if `vt` has no
+ *  known type or is an empty `void *` buffer
+ */
+int
+pdcpl_variant_encoded_size(const pdcpl_variant *vt, size_t *np)
+{
+  if (!vt || !np)
+    return -EINVAL;
+  unsigned char head[PDCPL_VARIANT_HEAD_MAX_SIZE];
+  size_t nh, nb;
+  const void *body;
+  int status = pdcpl_variant_encode_head(vt, head, &nh, &body, &nb);
+  if (status)
+    return status;
+  *np = nh + nb;
+  return 0;
+}
+
+/**
+ * Encode a variant into a buffer.
+ *
+ * @param vt Variant to encode
+ * @param out Output buffer
+ * @param size Number of bytes available in `out`
+ * @param nwp Address to write number of bytes written to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `vt` or `out` are `NULL` or if `vt` has no
+ *  known type or is an empty `void *` buffer, -ERANGE if `out` is too small
+ */
+int
+pdcpl_variant_encode(
+  const pdcpl_variant *vt, void *out, size_t size, size_t *nwp)
+{
+  if (!vt || !out)
+    return -EINVAL;
+  unsigned char head[PDCPL_VARIANT_HEAD_MAX_SIZE];
+  size_t nh, nb;
+  const void *body;
+  int status = pdcpl_variant_encode_head(vt, head, &nh, &body, &nb);
+  if (status)
+    return status;
+  if (nh + nb > size)
+    return -ERANGE;
+  memcpy(out, head, nh);
+  if (nb)
+    memcpy(PDCPL_PTR_SHIFT(out, +, nh), body, nb);
+  if (nwp)
+    *nwp = nh + nb;
+  return 0;
+}
+
+/**
+ * Decode a variant from a buffer.
+ *
+ * No memory is allocated. String and `void *` variants are initialized with
+ * `pdcpl_variant_init_string_ref` and `pdcpl_variant_init_void_ref`, pointing
+ * directly into `in`, so `in` must outlive the variant. Borrowed data should be
+ * treated as read-only, as `in` may be a read-only memory mapping.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param vt Variant to decode into
+ * @param nrp Address to write number of bytes consumed to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `in` or `vt` are `NULL` or if the encoded
+ *  variant is malformed, -ERANGE if `in` is truncated
+ */
+int
+pdcpl_variant_decode(
+  const void *in, size_t size, pdcpl_variant *vt, size_t *nrp)
+{
+  if (!in || !vt)
+    return -EINVAL;
+  if (!size)
+    return -ERANGE;
+  const unsigned char *p = in;
+  uint64_t value;
+  size_t n = 1, nv;
+  int status;
+  // note: PDCPL_VARIANT_INIT calls cannot fail here since vt is not NULL
+  switch (p[0]) {
+    case pdcpl_variant_tag_char:
+      if (size < n + 1)
+        return -ERANGE;
+      PDCPL_VARIANT_INIT(char)(vt, (char) p[n++]);
+      break;
+    case pdcpl_variant_tag_int:
+      if (size < n + 4)
+        return -ERANGE;
+      value = pdcpl_load_le(p + n, 4);
+      // avoid implementation-defined unsigned to signed conversion
+      PDCPL_VARIANT_INIT(int)(
+        vt,
+        (value <= INT32_MAX) ?
+          (int) value : (int) (value - INT32_MAX - 1) + INT32_MIN
+      );
+      n += 4;
+      break;
+    case pdcpl_variant_tag_uint:
+      if (size < n + 4)
+        return -ERANGE;
+      PDCPL_VARIANT_INIT(uint)(vt, (unsigned int) pdcpl_load_le(p + n, 4));
+      n += 4;
+      break;
+    case pdcpl_variant_tag_size:
+      if ((status = pdcpl_varint_decode(p + n, size - n, &value, &nv)))
+        return status;
+      if (value > SIZE_MAX)
+        return -ERANGE;
+      PDCPL_VARIANT_INIT(size)(vt, (size_t) value);
+      n += nv;
+      break;
+    case pdcpl_variant_tag_double: {
+      double d;
+      if (size < n + 8)
+        return -ERANGE;
+      value = pdcpl_load_le(p + n, 8);
+      memcpy(&d, &value, sizeof d);
+      PDCPL_VARIANT_INIT(double)(vt, d);
+      n += 8;
+      break;
+    }
+    case pdcpl_variant_tag_float: {
+      float f;
+      uint32_t fbits;
+      if (size < n + 4)
+        return -ERANGE;
+      fbits = (uint32_t) pdcpl_load_le(p + n, 4);
+      memcpy(&f, &fbits, sizeof f);
+      PDCPL_VARIANT_INIT(float)(vt, f);
+      n += 4;
+      break;
+    }
+    case pdcpl_variant_tag_string:
+    case pdcpl_variant_tag_void:
+      if ((status = pdcpl_varint_decode(p + n, size - n, &value, &nv)))
+        return status;
+      n += nv;
+      if (value > size - n)
+        return -ERANGE;
+      // strings borrow from the buffer, so they must be null-terminated
+      if (p[0] == pdcpl_variant_tag_string) {
+        if (value && p[n + value - 1] != '\0')
+          return -EINVAL;
+        PDCPL_VARIANT_INIT(string_ref)(vt, (value) ? (char *) (p + n) : NULL);
+      }
+      // void_ref rejects empty buffers, which the encoder rejects too
+      else if (PDCPL_VARIANT_INIT(void_ref)(vt, (void *) (p + n), value))
+        return -EINVAL;
+      n += value;
+      break;
+    default:
+      return -EINVAL;
+  }
+  if (nrp)
+    *nrp = n;
+  return 0;
+}
+
+/**
+ * Compute the number of bytes needed to encode an array of variants.
+ *
+ * @param vts Variants to encode, can be `NULL` if `n` is zero
+ * @param n Number of variants
+ * @param np Address to write number of bytes to
+ * @returns 0 on success, -EINVAL if `vts` or `np` are `NULL` or if any variant
+ *  has no known type
+ */
+int
+pdcpl_variant_array_encoded_size(
+  const pdcpl_variant *vts, size_t n, size_t *np)
+{
+  if ((!vts && n) || !np)
+    return -EINVAL;
+  size_t total = pdcpl_varint_size(n), nv;
+  for (size_t i = 0; i < n; i++) {
+    int status = pdcpl_variant_encoded_size(vts + i, &nv);
+    if (status)
+      return status;
+    total += nv;
+  }
+  *np = total;
+  return 0;
+}
+
+/**
+ * Encode an array of variants into a buffer.
+ *
+ * @param vts Variants to encode, can be `NULL` if `n` is zero
+ * @param n Number of variants
+ * @param out Output buffer
+ * @param size Number of bytes available in `out`
+ * @param nwp Address to write number of bytes written to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `vts` or `out` are `NULL` or if any
+ *  variant has no known type, -ERANGE if `out` is too small
+ */
+int
+pdcpl_variant_array_encode(
+  const pdcpl_variant *vts, size_t n, void *out, size_t size, size_t *nwp)
+{
+  if ((!vts && n) || !out)
+    return -EINVAL;
+  if (pdcpl_varint_size(n) > size)
+    return -ERANGE;
+  size_t total = pdcpl_varint_encode(n, out), nv;
+  for (size_t i = 0; i < n; i++) {
+    int status = pdcpl_variant_encode(
+      vts + i, PDCPL_PTR_SHIFT(out, +, total), size - total, &nv
+    );
+    if (status)
+      return status;
+    total += nv;
+  }
+  if (nwp)
+    *nwp = total;
+  return 0;
+}
+
+/**
+ * Decode an array of variants from a buffer.
+ *
+ * Like `pdcpl_variant_decode`, no memory is allocated and the decoded
+ * variants borrow from `in`. If `max_n` is less than the encoded count, the
+ * count is still written to `np` so the caller can size `vts` and retry.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param vts Variants to decode into, can be `NULL` if `max_n` is zero
+ * @param max_n Number of variants `vts` can hold
+ * @param np Address to write number of decoded variants to
+ * @param nrp Address to write number of bytes consumed to, can be `NULL`
+ * @returns 0 on success, -EINVAL if `in` or `np` are `NULL` or if the input is
+ *  malformed, -ERANGE if `in` is truncated or `vts` is too small
+ */
+int
+pdcpl_variant_array_decode(
+  const void *in,
+  size_t size,
+  pdcpl_variant *vts,
+  size_t max_n,
+  size_t *np,
+  size_t *nrp)
+{
+  if (!in || (!vts && max_n) || !np)
+    return -EINVAL;
+  uint64_t count;
+  size_t total, nv;
+  int status = pdcpl_varint_decode(in, size, &count, &total);
+  if (status)
+    return status;
+  if (count > SIZE_MAX)
+    return -ERANGE;
+  *np = (size_t) count;
+  if (count > max_n)
+    return -ERANGE;
+  for (size_t i = 0; i < count; i++) {
+    status = pdcpl_variant_decode(
+      PDCPL_PTR_SHIFT(in, +, total), size - total, vts + i, &nv
+    );
+    if (status)
+      return status;
+    total += nv;
+  }
+  if (nrp)
+    *nrp = total;
+  return 0;
+}
+
+/**
+ * Write a varint to a stream.
+ *
+ * @param f Stream to write to
+ * @param value Value to write
+ * @returns 0 on success, -EIO on write error
+ */
+static int
+pdcpl_varint_fwrite(FILE *f, uint64_t value)
+{
+  unsigned char buf[PDCPL_VARINT_MAX_SIZE];
+  size_t n = pdcpl_varint_encode(value, buf);
+  return (fwrite(buf, 1, n, f) == n) ? 0 : -EIO;
+}
+
+/**
+ * Write an array of variants to a stream as a length-prefixed frame.
+ *
+ * Variant payloads are written directly to the stream so no memory is
+ * allocated regardless of the size of the strings or buffers involved.
+ *
+ * @param f Stream to write to
+ * @param vts Variants to write, can be `NULL` if `n` is zero
+ * @param n Number of variants
+ * @returns 0 on success, -EINVAL if `f` or `vts` are `NULL` or if any variant
+ *  has no known type, -EIO on write error
+ */
+int
+pdcpl_variant_frame_write(FILE *f, const pdcpl_variant *vts, size_t n)
+{
+  if (!f || (!vts && n))
+    return -EINVAL;
+  // payload size first, which also validates all the variants
+  size_t payload_size;
+  int status = pdcpl_variant_array_encoded_size(vts, n, &payload_size);
+  if (status)
+    return status;
+  if (
+    (status = pdcpl_varint_fwrite(f, payload_size)) ||
+    (status = pdcpl_varint_fwrite(f, n))
+  )
+    return status;
+  // write each head from the stack and each body straight from the variant
+  unsigned char head[PDCPL_VARIANT_HEAD_MAX_SIZE];
+  size_t nh, nb;
+  const void *body;
+  for (size_t i = 0; i < n; i++) {
+    // can't fail since the variants were validated, but keeps nh defined
+    if ((status = pdcpl_variant_encode_head(vts + i, head, &nh, &body, &nb)))
+      return status;
+    if (fwrite(head, 1, nh, f) != nh || (nb && fwrite(body, 1, nb, f) != nb))
+      return -EIO;
+  }
+  return 0;
+}
+
+/**
+ * Read the payload of the next length-prefixed frame from a stream.
+ *
+ * The payload is read into `buf`, which is grown as necessary and can be
+ * reused across calls, so steady-state reading does not allocate. The payload
+ * can then be decoded with `pdcpl_variant_array_decode`. If the stream is at
+ * EOF before any frame bytes are read, zero is written to `np`.
+ *
+ * @param f Stream to read from
+ * @param buf Buffer to read payload into, can initially be empty
+ * @param np Address to write payload size to
+ * @returns 0 on success, -EINVAL if any argument is `NULL` or if the frame
+ *  header is malformed, -ENOMEM if `buf` cannot be grown, -EIO on read error
+ *  or if the frame is truncated
+ */
+int
+pdcpl_variant_frame_read(FILE *f, pdcpl_buffer *buf, size_t *np)
+{
+  if (!f || !buf || !np)
+    return -EINVAL;
+  // read varint header byte by byte
+  unsigned char head[PDCPL_VARINT_MAX_SIZE];
+  size_t nh = 0;
+  int c;
+  do {
+    if ((c = fgetc(f)) == EOF) {
+      if (ferror(f))
+        return -EIO;
+      // clean EOF only if no header bytes have been read yet
+      if (!nh) {
+        *np = 0;
+        return 0;
+      }
+      return -EIO;
+    }
+    head[nh++] = (unsigned char) c;
+  } while ((c & 0x80) && nh < PDCPL_VARINT_MAX_SIZE);
+  uint64_t payload_size;
+  size_t nr;
+  int status = pdcpl_varint_decode(head, nh, &payload_size, &nr);
+  if (status)
+    return (status == -ERANGE) ? -EINVAL : status;
+  // a frame always holds at least the varint count of its array
+  if (!payload_size)
+    return -EINVAL;
+  if (payload_size > SIZE_MAX)
+    return -ENOMEM;
+  if (buf->size < payload_size) {
+    if ((status = pdcpl_buffer_realloc(buf, (size_t) payload_size)))
+      return status;
+  }
+  if (fread(buf->data, 1, (size_t) payload_size, f) != payload_size)
+    return -EIO;
+  *np = (size_t) payload_size;
+  return 0;
+}
+
+/**
+ * Locate the payload of the next length-prefixed frame in a buffer.
+ *
+ * @param in Input buffer
+ * @param size Number of bytes available in `in`
+ * @param payload Address to write payload pointer to
+ * @param payload_size Address to write payload size to
+ * @param nrp Address to write number of bytes the whole frame uses
+ * @returns 0 on success, -EINVAL if any pointer argument is `NULL` or if the
+ *  frame header is malformed, -ERANGE if `in` is truncated
+ */
+int
+pdcpl_variant_frame_next(
+  const void *in,
+  size_t size,
+  const void **payload,
+  size_t *payload_size,
+  size_t *nrp)
+{
+  if (!in || !payload || !payload_size || !nrp)
+    return -EINVAL;
+  uint64_t value;
+  size_t nh;
+  int status = pdcpl_varint_decode(in, size, &value, &nh);
+  if (status)
+    return status;
+  if (!value)
+    return -EINVAL;
+  if (value > size - nh)
+    return -ERANGE;
+  *payload = PDCPL_PTR_SHIFT(in, +, nh);
+  *payload_size = (size_t) value;
+  *nrp = nh + (size_t) value;
+  return 0;
+}
@@ -0,0 +1,310 @@
+/**
+ * @file variant_map.c
+ * @author Derek Huang
+ * @brief C source for a hash table keyed by `pdcpl_variant`
+ * @copyright MIT License
+ */
+
+#include "pdcpl/variant_map.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdcpl/variant.h"
+
+/**
+ * Minimum nonzero map capacity.
+ */
+#define PDCPL_VARIANT_MAP_MIN_CAPACITY 16
+
+/**
+ * Check if a map with the given capacity can hold the given number of keys.
+ *
+ * The maximum load factor is 3/4.
+ *
+ * @param capacity Map capacity
+ * @param size Number of keys
+ */
+#define PDCPL_VARIANT_MAP_FITS(capacity, size) ((size) <= (capacity) / 4 * 3)
+
+/**
+ * Check if a variant has exactly one known type flag set.
+ *
+ * @param vt Variant to check
+ */
+static bool
+pdcpl_variant_map_key_valid(const pdcpl_variant *vt)
+{
+  switch (vt->flags & ~(pdcpl_variant_mem_own | pdcpl_variant_mem_borrow)) {
+    case pdcpl_variant_char:
+    case pdcpl_variant_int:
+    case pdcpl_variant_uint:
+    case pdcpl_variant_size:
+    case pdcpl_variant_double:
+    case pdcpl_variant_float:
+    case pdcpl_variant_string:
+    case pdcpl_variant_void:
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Allocate the entry array for a map with the given capacity.
+ *
+ * Existing entries are rehashed into the new array using their cached hashes.
+ *
+ * @param map Map to resize
+ * @param capacity New capacity, must be a power of two that fits all keys
+ * @returns 0 on success, -ENOMEM if memory allocation fails
+ */
+static int
+pdcpl_variant_map_rehash(pdcpl_variant_map *map, size_t capacity)
+{
+  pdcpl_variant_map_entry *entries = calloc(capacity, sizeof *entries);
+  if (!entries)
+    return -ENOMEM;
+  size_t mask = capacity - 1;
+  for (size_t i = 0; i < map->capacity; i++) {
+    if (!pdcpl_variant_map_entry_used(map->entries + i))
+      continue;
+    // keys are known to be unique so we only need an empty slot
+    size_t j = (size_t) map->entries[i].hash & mask;
+    while (pdcpl_variant_map_entry_used(entries + j))
+      j = (j + 1) & mask;
+    entries[j] = map->entries[i];
+  }
+  free(map->entries);
+  map->entries = entries;
+  map->capacity = capacity;
+  return 0;
+}
+
+/**
+ * Initialize a variant map.
+ *
+ * @param map Map to initialize
+ * @param capacity Expected number of keys, can be zero
+ * @param flags Map flags
+ * @returns 0 on success, -EINVAL if `map` is `NULL`, -ENOMEM if memory
+ *  allocation fails
+ */
+int
+pdcpl_variant_map_init(
+  pdcpl_variant_map *map, size_t capacity, unsigned int flags)
+{
+  if (!map)
+    return -EINVAL;
+  map->entries = NULL;
+  map->capacity = 0;
+  map->size = 0;
+  map->flags = flags;
+  if (!capacity)
+    return 0;
+  // smallest power of two keeping the load factor in bounds
+  size_t n = PDCPL_VARIANT_MAP_MIN_CAPACITY;
+  while (!PDCPL_VARIANT_MAP_FITS(n, capacity)) {
+    if (n > SIZE_MAX / 2)
+      return -ENOMEM;
+    n *= 2;
+  }
+  return pdcpl_variant_map_rehash(map, n);
+}
+
+/**
+ * Free a variant map, including any keys it owns.
+ *
+ * Values are not freed since the map does not know what they point to.
+ *
+ * @param map Map to free
+ * @returns 0 on success, -EINVAL if `map` is `NULL`
+ */
+int
+pdcpl_variant_map_free(pdcpl_variant_map *map)
+{
+  if (!map)
+    return -EINVAL;
+  if (!(map->flags & pdcpl_variant_map_borrow_keys)) {
+    for (size_t i = 0; i < map->capacity; i++)
+      pdcpl_variant_free(&map->entries[i].key);
+  }
+  free(map->entries);
+  map->entries = NULL;
+  map->capacity = 0;
+  map->size = 0;
+  return 0;
+}
+
+/**
+ * Find the slot a key occupies or the empty slot it would be inserted into.
+ *
+ * The map must have nonzero capacity.
+ *
+ * @param map Map to search
+ * @param key Key to look up
+ * @param hash Hash of `key`
+ * @param found Address to write whether `key` was found to
+ * @returns Index of the slot
+ */
+static size_t
+pdcpl_variant_map_probe(
+  const pdcpl_variant_map *map,
+  const pdcpl_variant *key,
+  uint64_t hash,
+  bool *found)
+{
+  size_t mask = map->capacity - 1;
+  // load factor bound guarantees an empty slot terminates the loop
+  for (size_t i = (size_t) hash & mask; ; i = (i + 1) & mask) {
+    const pdcpl_variant_map_entry *entry = map->entries + i;
+    if (!pdcpl_variant_map_entry_used(entry)) {
+      *found = false;
+      return i;
+    }
+    if (entry->hash == hash && pdcpl_variant_equal(&entry->key, key)) {
+      *found = true;
+      return i;
+    }
+  }
+}
+
+/**
+ * Find the value slot for a key.
+ *
+ * @param map Map to search
+ * @param key Key to look up
+ * @returns Address of the value for `key`, `NULL` if not found or on error
+ */
+void **
+pdcpl_variant_map_find(const pdcpl_variant_map *map, const pdcpl_variant *key)
+{
+  if (!map || !key || !map->size)
+    return NULL;
+  bool found;
+  size_t i = pdcpl_variant_map_probe(map, key, pdcpl_variant_hash(key), &found);
+  return (found) ? &map->entries[i].value : NULL;
+}
+
+/**
+ * Find the value slot for a key, inserting the key if it is not present.
+ *
+ * Newly inserted keys have their value set to `NULL`. This allows a single
+ * lookup per key when grouping, e.g. incrementing a count stored in the value.
+ * The returned slot is invalidated by the next insertion.
+ *
+ * @param map Map to insert into
+ * @param key Key to look up or insert
+ * @param slot Address to write the value slot address to
+ * @param inserted Address to write whether `key` was inserted, can be `NULL`
+ * @returns 0 on success, -EINVAL if `map`, `key`, `slot` are `NULL` or if
+ *  `key` has no known type, -ENOMEM if memory allocation fails
+ */
+int
+pdcpl_variant_map_emplace(
+  pdcpl_variant_map *map,
+  const pdcpl_variant *key,
+  void ***slot,
+  bool *inserted)
+{
+  if (!map || !key || !slot || !pdcpl_variant_map_key_valid(key))
+    return -EINVAL;
+  uint64_t hash = pdcpl_variant_hash(key);
+  bool found;
+  size_t i;
+  int status;
+  // look up first so that existing keys never trigger a resize
+  if (map->size) {
+    i = pdcpl_variant_map_probe(map, key, hash, &found);
+    if (found) {
+      *slot = &map->entries[i].value;
+      if (inserted)
+        *inserted = false;
+      return 0;
+    }
+  }
+  // grow if inserting would exceed the load factor bound
+  if (!map->capacity || !PDCPL_VARIANT_MAP_FITS(map->capacity, map->size + 1)) {
+    size_t capacity = (map->capacity) ?
+      2 * map->capacity : PDCPL_VARIANT_MAP_MIN_CAPACITY;
+    if (capacity < map->capacity)
+      return -ENOMEM;
+    if ((status = pdcpl_variant_map_rehash(map, capacity)))
+      return status;
+  }
+  i = pdcpl_variant_map_probe(map, key, hash, &found);
+  pdcpl_variant_map_entry *entry = map->entries + i;
+  if (map->flags & pdcpl_variant_map_borrow_keys)
+    entry->key = *key;
+  else if ((status = pdcpl_variant_copy(&entry->key, key)))
+    return status;
+  entry->value = NULL;
+  entry->hash = hash;
+  map->size++;
+  *slot = &entry->value;
+  if (inserted)
+    *inserted = true;
+  return 0;
+}
+
+/**
+ * Insert a key and value into the map, replacing any existing value.
+ *
+ * @param map Map to insert into
+ * @param key Key to insert
+ * @param value Value to insert
+ * @returns 0 on success, -EINVAL if `map` or `key` are `NULL` or if `key` has
+ *  no known type, -ENOMEM if memory allocation fails
+ */
+int
+pdcpl_variant_map_insert(
+  pdcpl_variant_map *map, const pdcpl_variant *key, void *value)
+{
+  void **slot;
+  int status = pdcpl_variant_map_emplace(map, key, &slot, NULL);
+  if (status)
+    return status;
+  *slot = value;
+  return 0;
+}
+
+/**
+ * Remove a key and its value from the map.
+ *
+ * @param map Map to remove from
+ * @param key Key to remove
+ * @returns 0 on success, -EINVAL if `map` or `key` are `NULL`, -ENOENT if the
+ *  key is not in the map
+ */
+int
+pdcpl_variant_map_erase(pdcpl_variant_map *map, const pdcpl_variant *key)
+{
+  if (!map || !key)
+    return -EINVAL;
+  if (!map->size)
+    return -ENOENT;
+  bool found;
+  size_t i = pdcpl_variant_map_probe(map, key, pdcpl_variant_hash(key), &found);
+  if (!found)
+    return -ENOENT;
+  if (!(map->flags & pdcpl_variant_map_borrow_keys))
+    pdcpl_variant_free(&map->entries[i].key);
+  // backward shift deletion, so no tombstones are needed. an entry after the
+  // hole is moved into it unless its home slot lies cyclically in (i, j]
+  size_t mask = map->capacity - 1;
+  for (size_t j = (i + 1) & mask; ; j = (j + 1) & mask) {
+    if (!pdcpl_variant_map_entry_used(map->entries + j))
+      break;
+    size_t k = (size_t) map->entries[j].hash & mask;
+    if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+      continue;
+    map->entries[i] = map->entries[j];
+    i = j;
+  }
+  memset(map->entries + i, 0, sizeof *map->entries);
+  map->size--;
+  return 0;
+}
@@ -0,0 +1,579 @@
+/**
+ * @file cdcl_batch_parser.cc
+ * @author Derek Huang
+ * @brief C++ parallel batch parser for simplified C declarations
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cdcl_batch_parser.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cdcl_hash_set.hh"
+#include "cdcl_parser_impl.hh"
+#include "cdcl_symbol_table.hh"
+#include "pdcpl/thread_pool.hh"
+#include "pdcpl/trace.hh"
+
+namespace pdcpl {
+
+namespace {
+
+/**
+ * Parse results of a single input file.
+ *
+ * The arenas are declared first so that they outlive the declarations.
+ *
+ * @param arenas Arenas the parsed declarations are allocated from
+ * @param results Parsed declarations, empty if parsing failed
+ * @param positions Positions of the parsed declarations
+ * @param error Parse error, empty if parsing succeeded
+ */
+struct file_results {
+  std::vector<std::unique_ptr<cdcl_arena>> arenas;
+  std::vector<cdcl_dcln> results;
+  std::vector<cdcl_position> positions;
+  std::string error;
+};
+
+/**
+ * Return the merge partition an identifier belongs to.
+ *
+ * The high bits of the hash are used since the low bits pick the slots in
+ * each partition's symbol table.
+ *
+ * @param hash Identifier hash from `cdcl_hash()`
+ * @param n_partitions Number of partitions, must be nonzero
+ */
+inline std::size_t partition(std::uint64_t hash, std::size_t n_partitions)
+{
+  return static_cast<std::size_t>(hash >> 32) % n_partitions;
+}
+
+/**
+ * Write a source position in the `file:line.column` Bison location format.
+ *
+ * @param out Output stream
+ * @param files Input files
+ * @param pos Source position
+ */
+auto& write_position(
+  std::ostream& out,
+  const cdcl_batch_parser::paths_type& files,
+  const cdcl_source_position& pos)
+{
+  out << files[pos.file].string() << ":" << pos.position.line << "." <<
+    pos.position.column;
+  return out;
+}
+
+}  // namespace
+
+/**
+ * Batch parser implementation class for parsing C declarations.
+ */
+class cdcl_batch_parser_impl {
+public:
+  using paths_type = cdcl_batch_parser::paths_type;
+  using results_type = cdcl_batch_parser::results_type;
+
+  /**
+   * Ctor.
+   *
+   * @param n_jobs Number of files to parse in parallel, 0 to use the number
+   *  of hardware threads
+   */
+  explicit cdcl_batch_parser_impl(unsigned int n_jobs)
+    : n_jobs_{n_jobs}, partitions_(1)
+  {}
+
+  /**
+   * Return the number of files parsed in parallel, 0 for hardware threads.
+   */
+  auto n_jobs() const noexcept { return n_jobs_; }
+
+  /**
+   * Parse the specified input files, replacing any previous results.
+   *
+   * @param files Files to read input from, "-" for `stdin`
+   * @returns `true` if all files parsed without conflicts, `false` otherwise
+   */
+  bool parse(const paths_type& files);
+
+  /**
+   * Return the files of the last parse.
+   */
+  const auto& files() const noexcept { return files_; }
+
+  /**
+   * Return the parse errors followed by the conflict messages.
+   */
+  const auto& errors() const noexcept { return errors_; }
+
+  /**
+   * Return the redeclaration conflicts between files.
+   */
+  const auto& conflicts() const noexcept { return conflicts_; }
+
+  /**
+   * Return ordered vector of merged declarations.
+   */
+  const auto& results() const noexcept { return results_; }
+
+  /**
+   * Return `true` if the results have a declaration with the given identifier.
+   *
+   * @param iden Identifier to find matching C declaration for
+   */
+  bool results_contain(std::string_view iden) const
+  {
+    const auto hash = cdcl_hash(iden);
+    const auto& index = partitions_[partition(hash, partitions_.size())];
+    return index.find(iden, hash, result_iden()) != nullptr;
+  }
+
+  /**
+   * Look up a declaration object with the given identifier.
+   *
+   * @param iden Identifier to find matching C declaration for
+   */
+  const auto& result(std::string_view iden) const
+  {
+    const auto hash = cdcl_hash(iden);
+    const auto& index = partitions_[partition(hash, partitions_.size())];
+    auto idx = index.find(iden, hash, result_iden());
+    if (!idx)
+      throw std::out_of_range{
+        "no declaration with identifier " + std::string{iden}
+      };
+    return results_[*idx];
+  }
+
+  /**
+   * Return the source positions of the merged declarations.
+   */
+  const auto& result_positions() const noexcept { return positions_; }
+
+  /**
+   * Return the canonical types of the merged declarations.
+   *
+   * The declarations are interned in merged order on first use, so type ids
+   * do not depend on thread timing.
+   */
+  const auto& types() const
+  {
+    intern_types();
+    return types_;
+  }
+
+  /**
+   * Return the type ids of the merged declarations.
+   */
+  const auto& result_types() const
+  {
+    intern_types();
+    return result_types_;
+  }
+
+private:
+  unsigned int n_jobs_;
+  paths_type files_;
+  std::vector<std::string> errors_;
+  std::vector<cdcl_conflict> conflicts_;
+  // arenas backing results_, declared first so they are destroyed last
+  std::vector<std::unique_ptr<cdcl_arena>> arenas_;
+  results_type results_;
+  std::vector<cdcl_source_position> positions_;
+  // canonical types of results_ + the type id of each declaration, which are
+  // interned on demand so are empty until first requested
+  mutable cdcl_type_table types_;
+  mutable std::vector<cdcl_type_id> result_types_;
+  // identifier to results_ index maps, partitioned by identifier hash
+  std::vector<cdcl_symbol_table> partitions_;
+
+  /**
+   * Return a key function mapping a `results_` index to its identifier.
+   */
+  cdcl_iden_key<results_type> result_iden() const noexcept
+  {
+    return {&results_};
+  }
+
+  /**
+   * Intern the types of the merged declarations if not already interned.
+   */
+  void intern_types() const
+  {
+    result_types_.reserve(results_.size());
+    for (auto i = result_types_.size(); i < results_.size(); i++)
+      result_types_.push_back(types_.intern(results_[i]));
+  }
+};
+
+/**
+ * Parse the specified input files, replacing any previous results.
+ *
+ * Each worker reuses one parser, and so one scanner, for its files. The
+ * declarations are then merged one partition per task, where each partition
+ * keeps the first declaration of its identifiers in file order.
+ *
+ * @param files Files to read input from, "-" for `stdin`
+ * @returns `true` if all files parsed without conflicts, `false` otherwise
+ */
+bool cdcl_batch_parser_impl::parse(const paths_type& files)
+{
+  files_ = files;
+  errors_.clear();
+  conflicts_.clear();
+  results_.clear();
+  arenas_.clear();
+  positions_.clear();
+  types_.clear();
+  result_types_.clear();
+  thread_pool pool{n_jobs_};
+  // parse the files
+  std::vector<file_results> parsed(files_.size());
+  {
+    PDCPL_TRACE_SCOPE("cdcl_batch_parse");
+    pool.parallel_for(
+      0,
+      files_.size(),
+      [&](std::size_t begin, std::size_t end)
+      {
+        cdcl_parser_impl parser;
+        for (auto i = begin; i < end; i++) {
+          auto& out = parsed[i];
+          auto status = parser.parse(files_[i], false, false);
+          auto released = parser.release_results();
+          if (status) {
+            out.arenas = std::move(released.arenas);
+            out.results = std::move(released.results);
+            out.positions = std::move(released.positions);
+          }
+          else
+            out.error = parser.last_error();
+        }
+      }
+    );
+  }
+  PDCPL_TRACE_SCOPE("cdcl_batch_merge");
+  // offsets[i] is the merge index of the first declaration in file i
+  std::vector<std::size_t> offsets(files_.size() + 1);
+  for (std::size_t i = 0; i < files_.size(); i++)
+    offsets[i + 1] = offsets[i] + parsed[i].results.size();
+  const auto n_total = offsets.back();
+  // hash + partition each declaration by identifier. the views refer into
+  // the parsed declarations, so they are only valid until those are moved
+  const std::size_t n_partitions = pool.size();
+  std::vector<std::string_view> idens(n_total);
+  std::vector<std::uint64_t> hashes(n_total);
+  std::vector<std::size_t> parts(n_total);
+  pool.parallel_for(
+    0,
+    files_.size(),
+    [&](std::size_t begin, std::size_t end)
+    {
+      for (auto i = begin; i < end; i++) {
+        for (std::size_t j = 0; j < parsed[i].results.size(); j++) {
+          auto k = offsets[i] + j;
+          idens[k] = parsed[i].results[j].iden();
+          hashes[k] = cdcl_hash(idens[k]);
+          parts[k] = partition(hashes[k], n_partitions);
+        }
+      }
+    }
+  );
+  // bucket the merge indices by partition, keeping file order within each,
+  // so each merge task only visits its own declarations
+  std::vector<std::size_t> part_offsets(n_partitions + 1);
+  for (auto p : parts)
+    part_offsets[p + 1]++;
+  for (std::size_t p = 0; p < n_partitions; p++)
+    part_offsets[p + 1] += part_offsets[p];
+  std::vector<std::size_t> part_order(n_total);
+  {
+    auto next = part_offsets;
+    for (std::size_t k = 0; k < n_total; k++)
+      part_order[next[parts[k]]++] = k;
+  }
+  // merge each partition in file order so the first declaration is kept.
+  // index values are merge indices until the kept declarations are numbered.
+  // conflicts are (kept, redeclared) merge index pairs
+  partitions_.assign(n_partitions, {});
+  std::vector<unsigned char> kept(n_total);
+  auto merge_iden = [&](std::size_t k) { return idens[k]; };
+  std::vector<std::vector<std::pair<std::size_t, std::size_t>>> part_conflicts(
+    n_partitions
+  );
+  pool.parallel_for(
+    0,
+    n_partitions,
+    [&](std::size_t begin, std::size_t end)
+    {
+      for (auto p = begin; p < end; p++) {
+        auto& index = partitions_[p];
+        index.reserve(part_offsets[p + 1] - part_offsets[p]);
+        for (auto m = part_offsets[p]; m < part_offsets[p + 1]; m++) {
+          auto k = part_order[m];
+          auto [first, inserted] = index.insert(
+            idens[k], hashes[k], k, merge_iden
+          );
+          if (inserted)
+            kept[k] = 1;
+          else
+            part_conflicts[p].emplace_back(first, k);
+        }
+      }
+    },
+    1
+  );
+  // number the kept declarations, reusing parts for their result indices
+  std::size_t n_kept = 0;
+  for (std::size_t k = 0; k < n_total; k++) {
+    parts[k] = n_kept;
+    n_kept += kept[k];
+  }
+  // move kept declarations into place + update index values
+  results_.resize(n_kept);
+  positions_.resize(n_kept);
+  pool.parallel_for(
+    0,
+    files_.size(),
+    [&](std::size_t begin, std::size_t end)
+    {
+      for (auto i = begin; i < end; i++) {
+        for (std::size_t j = 0; j < parsed[i].results.size(); j++) {
+          auto k = offsets[i] + j;
+          if (!kept[k])
+            continue;
+          results_[parts[k]] = std::move(parsed[i].results[j]);
+          positions_[parts[k]] = {i, parsed[i].positions[j]};
+        }
+      }
+    }
+  );
+  // position of a declaration given its merge index
+  auto source_position = [&](std::size_t k)
+  {
+    auto i = static_cast<std::size_t>(
+      std::upper_bound(offsets.begin(), offsets.end(), k) - offsets.begin() - 1
+    );
+    return cdcl_source_position{i, parsed[i].positions[k - offsets[i]]};
+  };
+  // collect conflicts ordered by the redeclaration before index values change
+  std::vector<std::pair<std::size_t, std::size_t>> merged_conflicts;
+  for (const auto& conflicts : part_conflicts)
+    merged_conflicts.insert(
+      merged_conflicts.end(), conflicts.begin(), conflicts.end()
+    );
+  std::sort(
+    merged_conflicts.begin(),
+    merged_conflicts.end(),
+    [](const auto& a, const auto& b) { return a.second < b.second; }
+  );
+  for (const auto& [first, redeclared] : merged_conflicts)
+    conflicts_.push_back(
+      {
+        results_[parts[first]].iden(),
+        source_position(first),
+        source_position(redeclared)
+      }
+    );
+  pool.parallel_for(
+    0,
+    n_partitions,
+    [&](std::size_t begin, std::size_t end)
+    {
+      for (auto p = begin; p < end; p++)
+        partitions_[p].remap([&](std::size_t k) { return parts[k]; });
+    },
+    1
+  );
+  // merged declarations were moved with their arena allocators, so the
+  // arenas are kept, which also outlive the unmerged declarations
+  for (auto& file : parsed)
+    for (auto& arena : file.arenas)
+      arenas_.push_back(std::move(arena));
+  // errors are parse errors in file order followed by the conflicts
+  for (const auto& file : parsed)
+    if (file.error.size())
+      errors_.push_back(file.error);
+  for (const auto& conflict : conflicts_) {
+    std::stringstream ss;
+    write_position(ss, files_, conflict.redeclared) << ": identifier " <<
+      conflict.iden << " redeclared, first declared at ";
+    write_position(ss, files_, conflict.first);
+    errors_.push_back(ss.str());
+  }
+  return errors_.empty();
+}
+
+/**
+ * Ctor.
+ *
+ * @param n_jobs Number of files to parse in parallel, 0 to use the number
+ *  of hardware threads
+ */
+cdcl_batch_parser::cdcl_batch_parser(unsigned int n_jobs)
+  : impl_{new cdcl_batch_parser_impl{n_jobs}}
+{}
+
+/**
+ * Dtor.
+ */
+cdcl_batch_parser::~cdcl_batch_parser() = default;
+
+/**
+ * Return the number of files parsed in parallel, 0 for hardware threads.
+ */
+unsigned int cdcl_batch_parser::n_jobs() const noexcept
+{
+  return impl_->n_jobs();
+}
+
+/**
+ * Parse the specified input files, replacing any previous results.
+ *
+ * Files that fail to parse contribute no declarations to the results.
+ *
+ * @param files Files to read input from, "-" for `stdin`
+ * @returns `true` if all files parsed without conflicts, `false` otherwise
+ */
+bool cdcl_batch_parser::parse(const paths_type& files)
+{
+  return impl_->parse(files);
+}
+
+/**
+ * Return the files of the last parse.
+ */
+auto cdcl_batch_parser::files() const noexcept -> const paths_type&
+{
+  return impl_->files();
+}
+
+/**
+ * Return the errors of the last parse.
+ *
+ * Parse errors are given in file order followed by a message for each
+ * conflict, in the same order as `conflicts()`.
+ */
+const std::vector<std::string>& cdcl_batch_parser::errors() const noexcept
+{
+  return impl_->errors();
+}
+
+/**
+ * Return the redeclaration conflicts between files of the last parse.
+ *
+ * Conflicts are ordered by the position of the conflicting declaration.
+ */
+const std::vector<cdcl_conflict>& cdcl_batch_parser::conflicts() const noexcept
+{
+  return impl_->conflicts();
+}
+
+/**
+ * Return ordered vector of merged declarations.
+ *
+ * The declarations are ordered by file and then by the order in which they
+ * were parsed, skipping any conflicting redeclarations.
+ */
+auto cdcl_batch_parser::results() const noexcept -> const results_type&
+{
+  return impl_->results();
+}
+
+/**
+ * Return number of merged declarations.
+ */
+std::size_t cdcl_batch_parser::n_results() const noexcept
+{
+  return impl_->results().size();
+}
+
+/**
+ * Return `true` if the results have a declaration with the given identifier.
+ *
+ * @param iden Identifier to find matching C declaration for
+ */
+bool cdcl_batch_parser::results_contain(std::string_view iden) const
+{
+  return impl_->results_contain(iden);
+}
+
+/**
+ * Look up a declaration object with the given identifier.
+ *
+ * An exception will be thrown if no matching declaration is found. Use the
+ * `results_contain()` member to check if a matching declaration exists.
+ *
+ * @param iden Identifier to find matching C declaration for
+ */
+const cdcl_dcln& cdcl_batch_parser::result(std::string_view iden) const
+{
+  return impl_->result(iden);
+}
+
+/**
+ * Look up a declaration object via its position in the results vector.
+ *
+ * An exception will be thrown by the vector if `idx` is out of bounds.
+ *
+ * @param idx Index of a C declaration object in `results()`
+ */
+const cdcl_dcln& cdcl_batch_parser::result(std::size_t idx) const
+{
+  return impl_->results().at(idx);
+}
+
+/**
+ * Return the source position of a declaration in `results()`.
+ *
+ * An exception will be thrown if `idx` is out of bounds.
+ *
+ * @param idx Index of a C declaration object in `results()`
+ */
+const cdcl_source_position&
+cdcl_batch_parser::result_position(std::size_t idx) const
+{
+  return impl_->result_positions().at(idx);
+}
+
+/**
+ * Return the canonical types of the declarations in `results()`.
+ *
+ * Declarations have the same type if and only if their type ids are equal.
+ * The types are interned on first use, so this is not `noexcept` and is not
+ * safe to call concurrently with other calls to it or `result_type()`.
+ */
+const cdcl_type_table& cdcl_batch_parser::types() const
+{
+  return impl_->types();
+}
+
+/**
+ * Return the type id of a declaration via its position in `results()`.
+ *
+ * An exception will be thrown if `idx` is out of bounds.
+ *
+ * @param idx Index of a C declaration object in `results()`
+ */
+cdcl_type_id cdcl_batch_parser::result_type(std::size_t idx) const
+{
+  return impl_->result_types().at(idx);
+}
+
+}  // namespace pdcpl
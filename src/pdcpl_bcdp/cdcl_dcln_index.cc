@@ -0,0 +1,466 @@
+/**
+ * @file cdcl_dcln_index.cc
+ * @author Derek Huang
+ * @brief C++ source for query indexes over parsed C declarations
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cdcl_dcln_index.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "pdcpl/cdcl_batch_parser.hh"
+#include "pdcpl/cdcl_parser.hh"
+#include "pdcpl/cdcl_type_spec.hh"
+#include "pdcpl/cdcl_type_table.hh"
+
+#include "cdcl_symbol_table.hh"
+
+namespace pdcpl {
+
+namespace {
+
+using ids_type = cdcl_dcln_index::ids_type;
+
+/**
+ * Return the number of values of an enum whose values start from zero.
+ *
+ * @param last Last value of the enum
+ */
+template <typename E>
+constexpr std::size_t n_values(E last) noexcept
+{
+  return static_cast<std::size_t>(last) + 1;
+}
+
+/**
+ * Return the id list for an enum key, empty if the key is out of range.
+ *
+ * @param lists Id lists indexed by enum value
+ * @param key Enum key
+ * @param empty Empty id list
+ */
+template <typename E>
+inline const auto& enum_ids(
+  const std::vector<ids_type>& lists, E key, const ids_type& empty) noexcept
+{
+  auto idx = static_cast<std::size_t>(key);
+  return (idx < lists.size()) ? lists[idx] : empty;
+}
+
+/**
+ * Return the first position in a sorted range not less than a value.
+ *
+ * Positions are probed at doubling distances from the start before a binary
+ * search, so finding a value near the start of a long range is cheap.
+ *
+ * @param first Start of the sorted range
+ * @param last End of the sorted range
+ * @param value Value to find
+ */
+template <typename It, typename T>
+It gallop(It first, It last, const T& value)
+{
+  const auto n = std::distance(first, last);
+  decltype(std::distance(first, last)) bound = 1;
+  while (bound < n && first[bound] < value)
+    bound *= 2;
+  return std::lower_bound(
+    first + bound / 2, first + std::min(bound + 1, n), value
+  );
+}
+
+}  // namespace
+
+/**
+ * Declaration index implementation class.
+ */
+class cdcl_dcln_index_impl {
+public:
+  /**
+   * Ctor.
+   *
+   * Builds the indexes in one pass over a parser's results. Identifiers used
+   * by each canonical type are collected once per type beforehand, in type id
+   * order, since a type's target and parameter types have smaller ids.
+   *
+   * @tparam Parser `cdcl_parser` or `cdcl_batch_parser`
+   *
+   * @param parser Parser whose results are indexed
+   */
+  template <typename Parser>
+  explicit cdcl_dcln_index_impl(const Parser& parser)
+    : size_{parser.n_results()},
+      types_(n_values(cdcl_type::gtype)),
+      storages_(n_values(cdcl_storage::st_static)),
+      kinds_(n_values(cdcl_type_kind::function)),
+      type_ids_(parser.types().size())
+  {
+    if (size_ > std::numeric_limits<cdcl_dcln_index::id_type>::max())
+      throw std::length_error{"too many declarations to index"};
+    const auto& types = parser.types();
+    // identifiers used by each type as sorted, unique idens_ indices
+    std::vector<std::vector<std::size_t>> type_uses(types.size());
+    for (cdcl_type_id id = 0; id < types.size(); id++) {
+      const auto& node = types.node(id);
+      auto& uses = type_uses[id];
+      if (node.kind() == cdcl_type_kind::base) {
+        if (node.spec().iden().size())
+          uses.push_back(iden_entry(node.spec().iden()));
+        continue;
+      }
+      uses = type_uses[node.target()];
+      for (auto param : node.params())
+        uses.insert(
+          uses.end(), type_uses[param].begin(), type_uses[param].end()
+        );
+      std::sort(uses.begin(), uses.end());
+      uses.erase(std::unique(uses.begin(), uses.end()), uses.end());
+    }
+    // ids are pushed in ascending order so each list is sorted
+    for (std::size_t i = 0; i < size_; i++) {
+      const auto id = static_cast<cdcl_dcln_index::id_type>(i);
+      const auto& dcl_spec = parser.result(i).dcl_spec();
+      const auto& type_spec = dcl_spec.spec().spec();
+      const auto type_id = parser.result_type(i);
+      const auto& node = types.node(type_id);
+      types_.at(static_cast<std::size_t>(type_spec.type())).push_back(id);
+      storages_.at(static_cast<std::size_t>(dcl_spec.storage())).push_back(id);
+      kinds_[static_cast<std::size_t>(node.kind())].push_back(id);
+      if (node.kind() == cdcl_type_kind::function && node.variadic())
+        variadic_.push_back(id);
+      type_ids_[type_id].push_back(id);
+      if (type_spec.iden().size())
+        idens_[iden_entry(type_spec.iden())].dclns.push_back(id);
+      for (auto entry : type_uses[type_id])
+        idens_[entry].uses.push_back(id);
+    }
+  }
+
+  /**
+   * Return the number of indexed declarations.
+   */
+  auto size() const noexcept { return size_; }
+
+  /**
+   * Return the declarations with the given base type.
+   *
+   * @param type Base type
+   */
+  const auto& type(cdcl_type type) const noexcept
+  {
+    return enum_ids(types_, type, empty_);
+  }
+
+  /**
+   * Return the declarations whose base type has the given identifier.
+   *
+   * @param iden Struct, enum, or typedef name
+   */
+  const auto& type_iden(std::string_view iden) const noexcept
+  {
+    auto entry = iden_index_.find(iden, iden_key());
+    return (entry) ? idens_[*entry].dclns : empty_;
+  }
+
+  /**
+   * Return the declarations with a type using the given type identifier.
+   *
+   * @param iden Struct, enum, or typedef name
+   */
+  const auto& uses_iden(std::string_view iden) const noexcept
+  {
+    auto entry = iden_index_.find(iden, iden_key());
+    return (entry) ? idens_[*entry].uses : empty_;
+  }
+
+  /**
+   * Return the declarations with the given storage.
+   *
+   * @param storage Storage specifier
+   */
+  const auto& storage(cdcl_storage storage) const noexcept
+  {
+    return enum_ids(storages_, storage, empty_);
+  }
+
+  /**
+   * Return the declarations whose outermost declarator has the given kind.
+   *
+   * @param kind Type node kind
+   */
+  const auto& kind(cdcl_type_kind kind) const noexcept
+  {
+    return enum_ids(kinds_, kind, empty_);
+  }
+
+  /**
+   * Return the declarations of variadic functions.
+   */
+  const auto& variadic() const noexcept { return variadic_; }
+
+  /**
+   * Return the declarations with the given canonical type.
+   *
+   * @param id Type id in the parser's `types()`
+   */
+  const auto& type_id(cdcl_type_id id) const noexcept
+  {
+    return (id < type_ids_.size()) ? type_ids_[id] : empty_;
+  }
+
+private:
+  /**
+   * Declarations indexed by a type identifier.
+   *
+   * @param name Struct, enum, or typedef name
+   * @param dclns Declarations whose base type has the name
+   * @param uses Declarations with a type using the name
+   */
+  struct iden_entry_type {
+    std::string name;
+    ids_type dclns;
+    ids_type uses;
+
+    /**
+     * Return the name, used as the `cdcl_symbol_table` key.
+     */
+    const auto& iden() const noexcept { return name; }
+  };
+
+  std::size_t size_;
+  // id lists indexed by cdcl_type, cdcl_storage, and cdcl_type_kind values
+  std::vector<ids_type> types_;
+  std::vector<ids_type> storages_;
+  std::vector<ids_type> kinds_;
+  ids_type variadic_;
+  // id lists indexed by type id
+  std::vector<ids_type> type_ids_;
+  // id lists for each type identifier + type identifier to idens_ index map
+  std::vector<iden_entry_type> idens_;
+  cdcl_symbol_table iden_index_;
+  // returned for keys with no declarations
+  ids_type empty_;
+
+  /**
+   * Return a key function mapping an `idens_` index to its type identifier.
+   */
+  cdcl_iden_key<std::vector<iden_entry_type>> iden_key() const noexcept
+  {
+    return {&idens_};
+  }
+
+  /**
+   * Return the `idens_` index of a type identifier, adding it if it is new.
+   *
+   * @param iden Struct, enum, or typedef name
+   */
+  std::size_t iden_entry(std::string_view iden)
+  {
+    auto [entry, inserted] = iden_index_.insert(
+      iden, idens_.size(), iden_key()
+    );
+    if (inserted)
+      idens_.push_back({std::string{iden}, {}, {}});
+    return entry;
+  }
+};
+
+/**
+ * Ctor.
+ *
+ * Builds the indexes for the results of a parser.
+ *
+ * @param parser Parser whose results are indexed
+ */
+cdcl_dcln_index::cdcl_dcln_index(const cdcl_parser& parser)
+  : impl_{std::make_unique<cdcl_dcln_index_impl>(parser)}
+{}
+
+/**
+ * Ctor.
+ *
+ * Builds the indexes for the merged results of a batch parser.
+ *
+ * @param parser Batch parser whose results are indexed
+ */
+cdcl_dcln_index::cdcl_dcln_index(const cdcl_batch_parser& parser)
+  : impl_{std::make_unique<cdcl_dcln_index_impl>(parser)}
+{}
+
+/**
+ * Move ctor.
+ *
+ * The moved-from index can only be assigned to or destroyed.
+ */
+cdcl_dcln_index::cdcl_dcln_index(cdcl_dcln_index&&) noexcept = default;
+
+/**
+ * Move assignment operator.
+ *
+ * @param other Index to move from
+ */
+cdcl_dcln_index&
+cdcl_dcln_index::operator=(cdcl_dcln_index&&) noexcept = default;
+
+/**
+ * Dtor.
+ */
+cdcl_dcln_index::~cdcl_dcln_index() = default;
+
+/**
+ * Return the number of indexed declarations.
+ */
+std::size_t cdcl_dcln_index::size() const noexcept
+{
+  return impl_->size();
+}
+
+/**
+ * Return the declarations with the given base type.
+ *
+ * The base type is the type of the declaration specifier, e.g. `char` for
+ * `char *(*f)(int)`.
+ *
+ * @param type Base type
+ */
+const ids_type& cdcl_dcln_index::type(cdcl_type type) const noexcept
+{
+  return impl_->type(type);
+}
+
+/**
+ * Return the declarations whose base type has the given identifier.
+ *
+ * Struct, enum, and typedef names are not distinguished, so intersect with
+ * `type()` to select one kind of name.
+ *
+ * @param iden Struct, enum, or typedef name
+ */
+const ids_type&
+cdcl_dcln_index::type_iden(std::string_view iden) const noexcept
+{
+  return impl_->type_iden(iden);
+}
+
+/**
+ * Return the declarations with a type using the given type identifier.
+ *
+ * Unlike `type_iden()`, this also includes declarations where the name is
+ * only used in function parameter types.
+ *
+ * @param iden Struct, enum, or typedef name
+ */
+const ids_type&
+cdcl_dcln_index::uses_iden(std::string_view iden) const noexcept
+{
+  return impl_->uses_iden(iden);
+}
+
+/**
+ * Return the declarations with the given storage.
+ *
+ * @param storage Storage specifier
+ */
+const ids_type& cdcl_dcln_index::storage(cdcl_storage storage) const noexcept
+{
+  return impl_->storage(storage);
+}
+
+/**
+ * Return the declarations whose outermost declarator has the given kind.
+ *
+ * Declarations with no declarator specifiers have kind `base`.
+ *
+ * @param kind Type node kind
+ */
+const ids_type& cdcl_dcln_index::kind(cdcl_type_kind kind) const noexcept
+{
+  return impl_->kind(kind);
+}
+
+/**
+ * Return the declarations of variadic functions.
+ */
+const ids_type& cdcl_dcln_index::variadic() const noexcept
+{
+  return impl_->variadic();
+}
+
+/**
+ * Return the declarations with the given canonical type.
+ *
+ * @param id Type id in the parser's `types()`
+ */
+const ids_type& cdcl_dcln_index::type_id(cdcl_type_id id) const noexcept
+{
+  return impl_->type_id(id);
+}
+
+/**
+ * Return the ids in both sorted id lists.
+ *
+ * @param a First sorted id list
+ * @param b Second sorted id list
+ */
+ids_type cdcl_dcln_index::intersect(const ids_type& a, const ids_type& b)
+{
+  return intersect({a, b});
+}
+
+/**
+ * Return the ids in all sorted id lists.
+ *
+ * Lists are intersected from smallest to largest, and each remaining id is
+ * found with a galloping search, so the cost is roughly proportional to the
+ * size of the smallest list times the log of the list sizes.
+ *
+ * @param lists Sorted id lists, the result is empty if there are none
+ */
+ids_type cdcl_dcln_index::intersect(
+  std::initializer_list<std::reference_wrapper<const ids_type>> lists)
+{
+  if (!lists.size())
+    return {};
+  std::vector<std::reference_wrapper<const ids_type>> sorted{lists};
+  std::sort(
+    sorted.begin(),
+    sorted.end(),
+    [](const ids_type& a, const ids_type& b) { return a.size() < b.size(); }
+  );
+  // positions in the larger lists only move forward
+  std::vector<ids_type::const_iterator> positions;
+  for (std::size_t i = 1; i < sorted.size(); i++)
+    positions.push_back(sorted[i].get().begin());
+  ids_type ids;
+  for (auto id : sorted.front().get()) {
+    bool found = true;
+    for (std::size_t i = 1; i < sorted.size(); i++) {
+      auto& pos = positions[i - 1];
+      pos = gallop(pos, sorted[i].get().end(), id);
+      // no later id can be in all the lists
+      if (pos == sorted[i].get().end())
+        return ids;
+      if (*pos != id) {
+        found = false;
+        break;
+      }
+    }
+    if (found)
+      ids.push_back(id);
+  }
+  return ids;
+}
+
+}  // namespace pdcpl
@@ -12,8 +12,30 @@
 #include <sstream>
 #include <variant>
 
+#include "pdcpl/cdcl_memory.hh"
+
 namespace pdcpl {
 
+namespace {
+
+/**
+ * Return a shared pointer to a copy of a declarator.
+ *
+ * The copy is made using the default memory resource instead of the calling
+ * thread's `cdcl_memory_resource()`, so a parameter's shared declarator does
+ * not refer into the parser's arena and may outlive the parser. A declarator
+ * being moved from is still copied, since its nodes keep their allocator.
+ *
+ * @param dclr Declarator to copy
+ */
+inline auto make_dclr(const cdcl_dclr& dclr)
+{
+  cdcl_memory_scope scope{nullptr};
+  return std::make_shared<cdcl_dclr>(dclr);
+}
+
+}  // namespace
+
 // cdcl_param_spec functions involving cdcl_dclr member dclr_ cannot be inline
 // due to cdcl_dclr only being forward declared at time of use
 
@@ -27,11 +49,11 @@ cdcl_param_spec::cdcl_param_spec(cdcl_qtype_spec&& spec)
 
 cdcl_param_spec::cdcl_param_spec(
   const cdcl_qtype_spec& spec, const cdcl_dclr& dclr)
-  : spec_{spec}, dclr_{std::make_unique<cdcl_dclr>(dclr)}
+  : spec_{spec}, dclr_{make_dclr(dclr)}
 {}
 
 cdcl_param_spec::cdcl_param_spec(cdcl_qtype_spec&& spec, cdcl_dclr&& dclr)
-  : spec_{spec}, dclr_{std::make_unique<cdcl_dclr>(std::move(dclr))}
+  : spec_{spec}, dclr_{make_dclr(dclr)}
 {}
 
 cdcl_param_spec::cdcl_param_spec(
@@ -0,0 +1,142 @@
+/**
+ * @file cdcl_hash_set.hh
+ * @author Derek Huang
+ * @brief C++ compact set of identifier hashes for C declaration parsing
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_BCDP_CDCL_HASH_SET_HH_
+#define PDCPL_BCDP_CDCL_HASH_SET_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pdcpl {
+
+/**
+ * Return a 64-bit hash of a string.
+ *
+ * This is FNV-1a followed by the MurmurHash3 finalizer so that the low bits
+ * used for open addressing are well mixed.
+ *
+ * @param s String to hash
+ */
+constexpr std::uint64_t cdcl_hash(std::string_view s) noexcept
+{
+  std::uint64_t h = 0xcbf29ce484222325U;
+  for (auto c : s) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 0x100000001b3U;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdU;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53U;
+  h ^= h >> 33;
+  return h;
+}
+
+/**
+ * Compact open-addressing set of string hashes.
+ *
+ * Only 64-bit hashes are stored, 8 bytes per slot at a load factor of at most
+ * one half, so membership is probabilistic. For n strings, the chance that
+ * two distinct strings share a hash is about n^2 / 2^65.
+ */
+class cdcl_hash_set {
+public:
+  /**
+   * Insert a string's hash.
+   *
+   * @param s String to insert
+   * @returns `true` if the hash was inserted, `false` if already present
+   */
+  bool insert(std::string_view s)
+  {
+    // keep load factor at most 1/2, doubling from 16 slots
+    if (2 * (size_ + 1) > slots_.size())
+      rehash(slots_.size() ? 2 * slots_.size() : 16);
+    auto& slot = find(cdcl_hash(s));
+    if (slot)
+      return false;
+    slot = key(cdcl_hash(s));
+    size_++;
+    return true;
+  }
+
+  /**
+   * Return `true` if a string's hash is present.
+   *
+   * @param s String to look up
+   */
+  bool contains(std::string_view s) const
+  {
+    if (!size_)
+      return false;
+    return const_cast<cdcl_hash_set*>(this)->find(cdcl_hash(s)) != 0;
+  }
+
+  /**
+   * Return the number of hashes in the set.
+   */
+  auto size() const noexcept { return size_; }
+
+  /**
+   * Remove all hashes from the set, releasing its memory.
+   */
+  void clear() noexcept
+  {
+    std::vector<std::uint64_t>{}.swap(slots_);
+    size_ = 0;
+  }
+
+private:
+  // slots hold nonzero keys, 0 marks an empty slot. size is a power of 2
+  std::vector<std::uint64_t> slots_;
+  std::size_t size_{};
+
+  /**
+   * Return the nonzero key stored for a hash.
+   *
+   * @param hash String hash
+   */
+  static constexpr std::uint64_t key(std::uint64_t hash) noexcept
+  {
+    return hash ? hash : 1U;
+  }
+
+  /**
+   * Return the slot holding a hash, or the empty slot where it would go.
+   *
+   * @param hash String hash
+   */
+  std::uint64_t& find(std::uint64_t hash) noexcept
+  {
+    const auto k = key(hash);
+    const auto mask = slots_.size() - 1;
+    for (auto i = static_cast<std::size_t>(k) & mask; ; i = (i + 1) & mask)
+      if (!slots_[i] || slots_[i] == k)
+        return slots_[i];
+  }
+
+  /**
+   * Move all keys into a new slot array.
+   *
+   * @param n_slots New number of slots, a power of 2
+   */
+  void rehash(std::size_t n_slots)
+  {
+    std::vector<std::uint64_t> slots(n_slots);
+    std::swap(slots, slots_);
+    for (auto k : slots)
+      if (k)
+        find(k) = k;
+  }
+};
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_BCDP_CDCL_HASH_SET_HH_
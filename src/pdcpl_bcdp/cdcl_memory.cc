@@ -0,0 +1,46 @@
+/**
+ * @file cdcl_memory.cc
+ * @author Derek Huang
+ * @brief C++ source for C declaration node memory allocation
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cdcl_memory.hh"
+
+#include <memory_resource>
+#include <utility>
+
+namespace pdcpl {
+
+namespace {
+
+// calling thread's memory resource, nullptr to use the default resource
+thread_local std::pmr::memory_resource* current_resource = nullptr;
+
+}  // namespace
+
+/**
+ * Return the calling thread's memory resource for C declaration nodes.
+ *
+ * This is the resource last set with `cdcl_memory_resource(resource)` on the
+ * calling thread, or `std::pmr::get_default_resource()` if none is set.
+ */
+std::pmr::memory_resource* cdcl_memory_resource() noexcept
+{
+  return (current_resource) ? current_resource :
+    std::pmr::get_default_resource();
+}
+
+/**
+ * Set the calling thread's memory resource for C declaration nodes.
+ *
+ * @param resource Memory resource, `nullptr` to use the default resource
+ * @returns Previously set resource, `nullptr` if none was set
+ */
+std::pmr::memory_resource* cdcl_memory_resource(
+  std::pmr::memory_resource* resource) noexcept
+{
+  return std::exchange(current_resource, resource);
+}
+
+}  // namespace pdcpl
@@ -10,6 +10,8 @@
 #include <cstddef>
 #include <filesystem>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include "cdcl_parser_impl.hh"
 
@@ -41,6 +43,41 @@ bool cdcl_parser::parse(
   return impl_->parse(input_file, trace_lexer, trace_parser);
 }
 
+/**
+ * Parse input from a memory buffer.
+ *
+ * @param data Input buffer, can be `nullptr` if `size` is zero
+ * @param size Number of bytes in the input buffer
+ * @param trace_lexer `true` to enable lexer tracing
+ * @param trace_parser `true` to enable parser tracing
+ * @returns `true` on success, `false` on failure
+ */
+bool cdcl_parser::parse_buffer(
+  const void* data, std::size_t size, bool trace_lexer, bool trace_parser)
+{
+  return impl_->parse_buffer(data, size, trace_lexer, trace_parser);
+}
+
+/**
+ * Stream declarations to a sink instead of accumulating results.
+ *
+ * While a sink is set, each declaration is passed to it with its position
+ * as soon as it is parsed, in source order, and is not added to `results()`,
+ * so memory use does not grow with the input. To detect redeclarations,
+ * only a 64-bit hash of each identifier is kept, so for n identifiers there
+ * is roughly an n^2 / 2^65 chance of a spurious redeclaration error.
+ *
+ * The identifier hashes are kept across parses until the sink is reset. An
+ * exception thrown by the sink stops parsing and propagates to the caller.
+ *
+ * @param sink Sink to stream declarations to, empty to accumulate results
+ * @param check_redeclared `true` to report redeclared identifiers as errors
+ */
+void cdcl_parser::set_sink(sink_type sink, bool check_redeclared)
+{
+  impl_->set_sink(std::move(sink), check_redeclared);
+}
+
 /**
  * Return last error encountered during parsing.
  */
@@ -72,7 +109,7 @@ std::size_t cdcl_parser::n_results() const noexcept
  *
  * @param iden Identifier to find matching C declaration for
  */
-bool cdcl_parser::results_contain(const std::string& iden) const
+bool cdcl_parser::results_contain(std::string_view iden) const
 {
   return impl_->results_contain(iden);
 }
@@ -85,7 +122,7 @@ bool cdcl_parser::results_contain(const std::string& iden) const
  *
  * @param iden Identifier to find matching C declaration for
  */
-const cdcl_dcln& cdcl_parser::result(const std::string& iden) const
+const cdcl_dcln& cdcl_parser::result(std::string_view iden) const
 {
   return impl_->result(iden);
 }
@@ -102,4 +139,41 @@ const cdcl_dcln& cdcl_parser::result(std::size_t idx) const
   return impl_->result(idx);
 }
 
+/**
+ * Return the position of a declaration via its position in `results()`.
+ *
+ * Declarations sharing a declaration specifier share a position.
+ * An exception will be thrown if `idx` is out of bounds.
+ *
+ * @param idx Index of a C declaration object in `results()`
+ */
+const cdcl_position& cdcl_parser::result_position(std::size_t idx) const
+{
+  return impl_->result_positions().at(idx);
+}
+
+/**
+ * Return the canonical types of the declarations in `results()`.
+ *
+ * Declarations have the same type if and only if their type ids are equal.
+ * The types are interned on first use, so this is not `noexcept` and is not
+ * safe to call concurrently with other calls to it or `result_type()`.
+ */
+const cdcl_type_table& cdcl_parser::types() const
+{
+  return impl_->types();
+}
+
+/**
+ * Return the type id of a declaration via its position in `results()`.
+ *
+ * An exception will be thrown if `idx` is out of bounds.
+ *
+ * @param idx Index of a C declaration object in `results()`
+ */
+cdcl_type_id cdcl_parser::result_type(std::size_t idx) const
+{
+  return impl_->result_types().at(idx);
+}
+
 }  // namespace pdcpl
@@ -7,9 +7,16 @@
 
 #include "cdcl_parser_impl.hh"
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <stdexcept>
 #include <string>
 
+#include "pdcpl/cdcl_memory.hh"
+#include "pdcpl/trace.hh"
+
 namespace pdcpl {
 
 /**
@@ -23,20 +30,87 @@ namespace pdcpl {
 bool cdcl_parser_impl::parse(
   const std::filesystem::path& input_file, bool trace_lexer, bool trace_parser)
 {
-  // need string path
-  auto input_path_string = input_file.string();
-  // initialize the Bison parser location for location tracking + reset error
-  location_.initialize(&input_path_string);
+  // initialize the Bison parser location for location tracking + reset error.
+  // the location refers to input_name_ so it stays valid after parsing
+  input_name_ = input_file.string();
+  location_.initialize(&input_name_);
   last_error_ = "";
-  // perform Flex lexer setup, create Bison parser, set debug level, parse
-  if (!lex_setup(input_path_string, trace_lexer))
-    return false;
-  yy::cdcl_parser parser{*this};
+  // perform Flex lexer setup, which maps the file if not reading stdin
+  {
+    PDCPL_TRACE_SCOPE("cdcl_lex_setup");
+    if (!lex_setup(input_name_, trace_lexer))
+      return false;
+  }
+  return parse_input(trace_parser);
+}
+
+/**
+ * Parse input from a memory buffer.
+ *
+ * @param data Input buffer, can be `nullptr` if `size` is zero
+ * @param size Number of bytes in the input buffer
+ * @param trace_lexer `true` to enable lexer tracing
+ * @param trace_parser `true` to enable parser tracing
+ * @returns `true` on success, `false` on failure
+ */
+bool cdcl_parser_impl::parse_buffer(
+  const void* data, std::size_t size, bool trace_lexer, bool trace_parser)
+{
+  input_name_ = "<string>";
+  location_.initialize(&input_name_);
+  last_error_ = "";
+  {
+    PDCPL_TRACE_SCOPE("cdcl_lex_setup");
+    if (!lex_setup(data, size, trace_lexer))
+      return false;
+  }
+  return parse_input(trace_parser);
+}
+
+/**
+ * Run the Bison parser on the input set up by `lex_setup` and clean up.
+ *
+ * @param trace_parser `true` to enable parser tracing
+ * @returns `true` on success, `false` on failure
+ */
+bool cdcl_parser_impl::parse_input(bool trace_parser)
+{
+  // declaration nodes are allocated from a new arena that is kept only if it
+  // backs new results. reserve first so keeping the arena cannot throw
+  auto arena = std::make_unique<cdcl_arena>();
+  arenas_.reserve(arenas_.size() + 1);
+  const auto n_results = results_.size();
+  auto keep_arena = [&]
+  {
+    if (results_.size() > n_results)
+      arenas_.push_back(std::move(arena));
+  };
+  // create Bison parser, set debug level, parse
+  yy::cdcl_parser parser{*this, scanner_};
   parser.set_debug_level(trace_parser);
-  auto status = parser.parse();
+  int status;
+  // parser pulls tokens from the lexer, so lexing is included in the span.
+  // exceptions not handled by the parser still need the lexer cleaned up
+  {
+    PDCPL_TRACE_SCOPE("cdcl_parse");
+    cdcl_memory_scope scope{arena.get()};
+    try {
+      status = parser.parse();
+    }
+    catch (...) {
+      keep_arena();
+      lex_cleanup();
+      throw;
+    }
+  }
+  keep_arena();
+  PDCPL_TRACE_COUNTER("cdcl_results", (std::int64_t) results_.size());
   // perform Flex lexer cleanup + return
-  if (!lex_cleanup(input_path_string))
-    return false;
+  {
+    PDCPL_TRACE_SCOPE("cdcl_lex_cleanup");
+    if (!lex_cleanup())
+      return false;
+  }
   // last_error_ should already have been set if parsing is failing
   return !status;
 }
@@ -8,16 +8,29 @@
 #ifndef PDCPL_BCDP_CDCL_PARSER_IMPL_HH_
 #define PDCPL_BCDP_CDCL_PARSER_IMPL_HH_
 
+#include <cstddef>
 #include <filesystem>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "pdcpl/cdcl_dcln_spec.hh"
+#include "pdcpl/cdcl_memory.hh"
+#include "pdcpl/cdcl_parser.hh"
 #include "pdcpl/cdcl_type_spec.hh"
+#include "pdcpl/cdcl_type_table.hh"
+#include "pdcpl/file.h"
 #include "pdcpl/warnings.h"
 
+#include "cdcl_hash_set.hh"
+#include "cdcl_symbol_table.hh"
+#include "cdcl_token_pool.hh"
+
 /**
  * Forward declaration to satisfy the `yy::cdcl_parser` class definition.
  *
@@ -25,6 +38,13 @@
  */
 namespace pdcpl { class cdcl_parser_impl; }  // namespace pdcpl
 
+/**
+ * Forward declaration of the Flex buffer state.
+ *
+ * Flex defines `YY_BUFFER_STATE` as a pointer to this in the generated lexer.
+ */
+struct yy_buffer_state;
+
 /**
  * The C++ header generated by Bison defining the parsing class.
  *
@@ -56,9 +76,11 @@ PDCPL_MSVC_WARNING_ENABLE()
 /**
  * `YY_DECL` function declaration arguments.
  *
- * Should be a comma-separated list of function arguments.
+ * Should be a comma-separated list of function arguments. The reentrant Flex
+ * lexer requires that the scanner handle be named `yyscanner`.
  */
-#define PDCPL_BCDP_YYLEX_ARGS pdcpl::cdcl_parser_impl& parser
+#define PDCPL_BCDP_YYLEX_ARGS \
+  pdcpl::cdcl_parser_impl& parser, yyscan_t yyscanner
 
 /**
  * Macro declaring `yylex` in the format the Bison parser expects.
@@ -77,11 +99,59 @@ YY_DECL;
 
 namespace pdcpl {
 
+/**
+ * Arena that the declaration nodes of a single parse are allocated from.
+ *
+ * Freed blocks are reused, so memory use stays bounded when declarations are
+ * streamed to a sink and discarded.
+ */
+using cdcl_arena = std::pmr::unsynchronized_pool_resource;
+
+/**
+ * Declarations released from a parser with the arenas backing them.
+ *
+ * The arenas are declared first so that they outlive the declarations.
+ *
+ * @param arenas Arenas the declaration nodes are allocated from
+ * @param results Parsed declarations
+ * @param positions Positions of the parsed declarations
+ */
+struct cdcl_released_results {
+  std::vector<std::unique_ptr<cdcl_arena>> arenas;
+  std::vector<cdcl_dcln> results;
+  std::vector<cdcl_position> positions;
+};
+
 /**
  * Parser driver implementation class for parsing C declarations.
+ *
+ * Each instance owns its own reentrant Flex scanner, so separate instances can
+ * parse concurrently from different threads.
+ *
+ * Each parse allocates its declaration nodes from a new arena that is kept
+ * while the declarations it backs are in the results and freed in one go
+ * afterwards. Arenas of parses that add no results are freed immediately.
  */
 class cdcl_parser_impl {
 public:
+  /**
+   * Ctor.
+   *
+   * Creates the Flex scanner, throwing `std::bad_alloc` on failure.
+   */
+  cdcl_parser_impl();
+
+  // the Flex scanner is uniquely owned
+  cdcl_parser_impl(const cdcl_parser_impl&) = delete;
+  cdcl_parser_impl& operator=(const cdcl_parser_impl&) = delete;
+
+  /**
+   * Dtor.
+   *
+   * Destroys the Flex scanner.
+   */
+  ~cdcl_parser_impl();
+
   /**
    * Parse the specified input file.
    *
@@ -95,6 +165,18 @@ public:
     bool trace_lexer,
     bool trace_parser);
 
+  /**
+   * Parse input from a memory buffer.
+   *
+   * @param data Input buffer, can be `nullptr` if `size` is zero
+   * @param size Number of bytes in the input buffer
+   * @param trace_lexer `true` to enable lexer tracing
+   * @param trace_parser `true` to enable parser tracing
+   * @returns `true` on success, `false` on failure
+   */
+  bool parse_buffer(
+    const void* data, std::size_t size, bool trace_lexer, bool trace_parser);
+
   // allow lexer to access to the parse driver members to update location +
   // error. we use (::PDCPL_BCDP_YYLEX) to tell compiler PDCPL_BCDP_YYLEX is in
   // the global namespace, not in the current enclosing pdcpl namespace
@@ -120,40 +202,92 @@ public:
   const auto& results() const noexcept { return results_; }
 
   /**
-   * Return map for looking up a declaration given its identifier.
+   * Return ordered vector of declaration positions.
    *
-   * The returned index can be used with `results()` to get the declaration.
+   * Each position is the start of the declaration in `results()` with the
+   * same index. Declarations sharing a specifier share a position.
    */
-  const auto& result_indices() const noexcept { return result_indicies_; }
+  const auto& result_positions() const noexcept { return result_positions_; }
+
+  /**
+   * Return the canonical types of the declarations.
+   *
+   * Declarations are only interned when their types are first requested, so
+   * parses whose types are never used do not pay for them.
+   */
+  const auto& types() const
+  {
+    intern_types();
+    return types_;
+  }
+
+  /**
+   * Return ordered vector of declaration type ids.
+   *
+   * Each id is the type in `types()` of the declaration in `results()` with
+   * the same index.
+   */
+  const auto& result_types() const
+  {
+    intern_types();
+    return result_types_;
+  }
 
   /**
    * Insert a new declaration.
    *
    * @param dcl_spec Declaration specifier, e.g. storage and qualified type
    * @param init_dclr Init declarator, currently only supports declarator
+   * @param loc Location of the declaration
    */
-  void insert(const cdcl_dcl_spec& dcl_spec, const cdcl_init_dclr& init_dclr)
+  void insert(
+    const cdcl_dcl_spec& dcl_spec,
+    cdcl_init_dclr&& init_dclr,
+    const yy::location& loc)
   {
     // currently only support declarations
     if (!std::holds_alternative<cdcl_dclr>(init_dclr)) {
       last_error_ = "init_dclr only support C declarators";
       throw yy::cdcl_parser::syntax_error{location_, last_error_};
     }
-    // create cdcl_dcln C declaration from dcl_spec and dclr
-    cdcl_dcln dcln{dcl_spec, std::get<cdcl_dclr>(init_dclr)};
+    // create cdcl_dcln C declaration from dcl_spec and dclr. the declarator
+    // is moved since the specifier is shared by all the init declarators
+    cdcl_dcln dcln{
+      cdcl_dcl_spec{dcl_spec}, std::get<cdcl_dclr>(std::move(init_dclr))
+    };
     // must have identifer and must not be duplicate declaration
     const auto& iden = dcln.iden();
     if (iden.empty()) {
       last_error_ = "dcln is missing identifier";
       throw yy::cdcl_parser::syntax_error{location_, last_error_};
     }
-    if (result_indicies_.find(iden) != result_indicies_.end()) {
+    const auto hash = cdcl_hash(iden);
+    if (
+      sink_ ?
+        check_redeclared_ && !seen_.insert(iden) :
+        result_indices_.find(iden, hash, result_iden()) != nullptr
+    ) {
       last_error_ = "identifier " + iden + " redeclared";
       throw yy::cdcl_parser::syntax_error{location_, last_error_};
     }
-    // otherwise, we can insert the declaration + update iden -> index map
+    cdcl_position position{
+      static_cast<unsigned int>(loc.begin.line),
+      static_cast<unsigned int>(loc.begin.column)
+    };
+    // when streaming, hand off the declaration without keeping it. any
+    // copies made by the sink must not be allocated from the arena
+    if (sink_) {
+      cdcl_memory_scope scope{nullptr};
+      sink_(dcln, position);
+      return;
+    }
+    // otherwise, we can insert the declaration + update iden -> index map.
+    // iden refers into dcln, so the key must be read from the moved-to copy
     results_.push_back(std::move(dcln));
-    result_indicies_[iden] = results_.size() - 1;
+    result_indices_.insert(
+      results_.back().iden(), hash, results_.size() - 1, result_iden()
+    );
+    result_positions_.push_back(position);
   }
 
   /**
@@ -161,11 +295,65 @@ public:
    *
    * @param dcl_spec Declaration specifier, e.g. storage and qualified type
    * @param init_dclrs Init declarators, currently only supports declarator
+   * @param loc Location of the declaration
+   */
+  void insert(
+    const cdcl_dcl_spec& dcl_spec,
+    cdcl_init_dclrs&& init_dclrs,
+    const yy::location& loc)
+  {
+    for (auto& init_dclr : init_dclrs)
+      insert(dcl_spec, std::move(init_dclr), loc);
+    // token views of this declaration have all been reduced
+    tokens_.flip();
+  }
+
+  /**
+   * Return a view of token text that is valid until the next declaration.
+   *
+   * Memory buffers are scanned in place and never refilled by Flex, so views
+   * point directly into them, while stream input text is copied into a pool.
+   *
+   * @param text Token text
+   * @param size Number of characters in the token text
+   */
+  std::string_view token_text(const char* text, std::size_t size)
+  {
+    if (stream_input_)
+      return tokens_.copy(text, size);
+    return {text, size};
+  }
+
+  /**
+   * Stream declarations to a sink instead of accumulating results.
+   *
+   * Any identifier hashes kept from a previous sink are discarded.
+   *
+   * @param sink Sink to stream declarations to, empty to accumulate results
+   * @param check_redeclared `true` to report redeclared identifiers as errors
+   */
+  void set_sink(cdcl_parser::sink_type sink, bool check_redeclared)
+  {
+    sink_ = std::move(sink);
+    check_redeclared_ = check_redeclared;
+    seen_.clear();
+  }
+
+  /**
+   * Move out the parsed declarations, their positions, and their arenas.
+   *
+   * The results are reset so the parser can be reused without copying.
    */
-  void insert(const cdcl_dcl_spec& dcl_spec, const cdcl_init_dclrs& init_dclrs)
+  cdcl_released_results release_results()
   {
-    for (const auto& init_dclr : init_dclrs)
-      insert(dcl_spec, init_dclr);
+    result_indices_.clear();
+    types_.clear();
+    result_types_.clear();
+    return {
+      std::exchange(arenas_, {}),
+      std::exchange(results_, {}),
+      std::exchange(result_positions_, {})
+    };
   }
 
   /**
@@ -178,9 +366,9 @@ public:
    *
    * @param iden Identifier to find matching C declaration for
    */
-  auto results_contain(const std::string& iden) const
+  auto results_contain(std::string_view iden) const
   {
-    return result_indicies_.find(iden) != result_indicies_.end();
+    return result_indices_.find(iden, result_iden()) != nullptr;
   }
 
   /**
@@ -191,9 +379,14 @@ public:
    *
    * @param iden Identifier to find matching C declaration for
    */
-  const auto& result(const std::string& iden) const
+  const auto& result(std::string_view iden) const
   {
-    return results_[result_indicies_.at(iden)];
+    auto idx = result_indices_.find(iden, result_iden());
+    if (!idx)
+      throw std::out_of_range{
+        "no declaration with identifier " + std::string{iden}
+      };
+    return results_[*idx];
   }
 
   /**
@@ -211,27 +404,105 @@ public:
 private:
   yy::location location_;
   std::string last_error_;
+  // arenas backing results_, declared first so they are destroyed last
+  std::vector<std::unique_ptr<cdcl_arena>> arenas_;
   std::vector<cdcl_dcln> results_;
-  std::unordered_map<std::string, std::size_t> result_indicies_;
+  // identifier to results_ index map, keyed by the identifiers in results_
+  cdcl_symbol_table result_indices_;
+  std::vector<cdcl_position> result_positions_;
+  // canonical types of results_ + the type id of each declaration, which are
+  // interned on demand and so may lag behind results_
+  mutable cdcl_type_table types_;
+  mutable std::vector<cdcl_type_id> result_types_;
+  // sink declarations are streamed to, empty to accumulate results
+  cdcl_parser::sink_type sink_;
+  // when streaming, whether to check for redeclarations + identifier hashes
+  bool check_redeclared_{};
+  cdcl_hash_set seen_;
+  // input name referenced by location_, "<string>" for memory buffers
+  std::string input_name_;
+  // reusable copy of memory buffer input with the Flex NUL sentinels
+  std::vector<char> input_buffer_;
+  // mapped input file, data is nullptr if no file is mapped
+  pdcpl_file_map input_map_{};
+  // reentrant Flex scanner state
+  yyscan_t scanner_{};
+  // Flex buffer being scanned
+  yy_buffer_state* buffer_{};
+  // whether buffer_ is a stream buffer that Flex refills in place
+  bool stream_input_{};
+  // stable copies of stream input token text
+  cdcl_token_pool tokens_;
 
   /**
-   * Perform setup for the Flex lexer.
+   * Run the Bison parser on the input set up by `lex_setup` and clean up.
+   *
+   * @param trace_parser `true` to enable parser tracing
+   * @returns `true` on success, `false` on failure
+   */
+  bool parse_input(bool trace_parser);
+
+  /**
+   * Return a key function mapping a `results_` index to its identifier.
+   */
+  cdcl_iden_key<std::vector<cdcl_dcln>> result_iden() const noexcept
+  {
+    return {&results_};
+  }
+
+  /**
+   * Intern the types of the declarations added since the last call.
+   */
+  void intern_types() const
+  {
+    result_types_.reserve(results_.size());
+    for (auto i = result_types_.size(); i < results_.size(); i++)
+      result_types_.push_back(types_.intern(results_[i]));
+  }
+
+  /**
+   * Perform setup for the Flex lexer to read from a file.
+   *
+   * Files are memory-mapped and scanned in place, while `stdin` is read
+   * through a regular Flex stream buffer since it may be a pipe or terminal.
    *
    * @param input_file Input file to read. If empty or "-", `stdin` is used.
-   * @param enable_debug `true` to turn on lexer tracing, default `false`
+   * @param enable_tracing `true` to turn on lexer tracing
    * @returns `true` on success, `false` on failure and sets `last_error_`
    */
   bool lex_setup(const std::string& input_file, bool enable_tracing) noexcept;
 
+  /**
+   * Perform setup for the Flex lexer to read from a memory buffer.
+   *
+   * The buffer is copied once into a reusable buffer with the two NUL
+   * sentinels Flex requires, as Flex writes into the buffer it scans.
+   *
+   * @param data Input buffer
+   * @param size Number of bytes in the input buffer
+   * @param enable_tracing `true` to turn on lexer tracing
+   * @returns `true` on success, `false` on failure and sets `last_error_`
+   */
+  bool lex_setup(
+    const void* data, std::size_t size, bool enable_tracing) noexcept;
+
+  /**
+   * Switch the Flex lexer to scan a buffer in place.
+   *
+   * @param data Buffer of `size + 2` bytes ending in two NUL sentinels
+   * @param size Number of input bytes in the buffer, excluding the sentinels
+   * @returns `true` on success, `false` on failure and sets `last_error_`
+   */
+  bool lex_scan(char* data, std::size_t size) noexcept;
+
   /**
    * Perform cleanup for the Flex lexer.
    *
-   * Currently, all this does is close `yyin` unless `yyin` is `stdin`.
+   * Deletes the Flex buffer and unmaps the input file if one was mapped.
    *
-   * @param input_file Input file passed to `lex_setup`. Used in error reporting.
    * @returns `true` on success, `false` on failure and sets `last_error_`
    */
-  bool lex_cleanup(const std::string& input_file) noexcept;
+  bool lex_cleanup() noexcept;
 };
 
 }  // namespace pdcpl
@@ -0,0 +1,246 @@
+/**
+ * @file cdcl_symbol_table.hh
+ * @author Derek Huang
+ * @brief C++ identifier symbol table for C declaration parsing
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_BCDP_CDCL_SYMBOL_TABLE_HH_
+#define PDCPL_BCDP_CDCL_SYMBOL_TABLE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cdcl_hash_set.hh"
+
+namespace pdcpl {
+
+/**
+ * Key function mapping an index to the identifier of a declaration.
+ *
+ * @tparam Container Random-access container of objects with an `iden()`
+ */
+template <typename Container>
+struct cdcl_iden_key {
+  const Container* items;
+
+  std::string_view operator()(std::size_t idx) const
+  {
+    return (*items)[idx].iden();
+  }
+};
+
+/**
+ * Open-addressing map from identifiers to declaration indices.
+ *
+ * The table does not own any identifiers. Each slot holds the 64-bit hash of
+ * an identifier and the index of the declaration it belongs to, and the
+ * identifier text is only read from the declarations, through a key function
+ * mapping an index to an identifier, to confirm a hash match. Indices are
+ * stored rather than views since moving a declaration, e.g. when its vector
+ * grows, can move its identifier's characters.
+ *
+ * Slots are 16 bytes at a load factor of at most one half, so a lookup is
+ * usually one cache line plus one string compare and never allocates.
+ */
+class cdcl_symbol_table {
+public:
+  /**
+   * Look up the declaration index of an identifier.
+   *
+   * @tparam KeyFn Callable taking an index and returning a string view
+   *
+   * @param iden Identifier to look up
+   * @param key Key function returning the identifier of an index
+   * @returns Pointer to the index, `nullptr` if not found
+   */
+  template <typename KeyFn>
+  const std::size_t* find(std::string_view iden, const KeyFn& key) const
+  {
+    return find(iden, cdcl_hash(iden), key);
+  }
+
+  /**
+   * Look up the declaration index of an identifier with a precomputed hash.
+   *
+   * @tparam KeyFn Callable taking an index and returning a string view
+   *
+   * @param iden Identifier to look up
+   * @param hash Identifier hash from `cdcl_hash()`
+   * @param key Key function returning the identifier of an index
+   * @returns Pointer to the index, `nullptr` if not found
+   */
+  template <typename KeyFn>
+  const std::size_t* find(
+    std::string_view iden, std::uint64_t hash, const KeyFn& key) const
+  {
+    if (!size_)
+      return nullptr;
+    auto& slot = const_cast<cdcl_symbol_table*>(this)->probe(iden, hash, key);
+    return (slot.hash) ? &slot.index : nullptr;
+  }
+
+  /**
+   * Insert an identifier's declaration index if the identifier is not present.
+   *
+   * @tparam KeyFn Callable taking an index and returning a string view
+   *
+   * @param iden Identifier to insert
+   * @param index Declaration index of the identifier
+   * @param key Key function returning the identifier of an index
+   * @returns Reference to the identifier's index and `true` if inserted,
+   *  `false` if the identifier was already present
+   */
+  template <typename KeyFn>
+  auto insert(std::string_view iden, std::size_t index, const KeyFn& key)
+  {
+    return insert(iden, cdcl_hash(iden), index, key);
+  }
+
+  /**
+   * Insert an identifier's declaration index with a precomputed hash.
+   *
+   * @tparam KeyFn Callable taking an index and returning a string view
+   *
+   * @param iden Identifier to insert
+   * @param hash Identifier hash from `cdcl_hash()`
+   * @param index Declaration index of the identifier
+   * @param key Key function returning the identifier of an index
+   * @returns Reference to the identifier's index and `true` if inserted,
+   *  `false` if the identifier was already present
+   */
+  template <typename KeyFn>
+  std::pair<std::size_t&, bool> insert(
+    std::string_view iden,
+    std::uint64_t hash,
+    std::size_t index,
+    const KeyFn& key)
+  {
+    // keep load factor at most 1/2, doubling from 16 slots
+    if (2 * (size_ + 1) > slots_.size())
+      rehash(slots_.size() ? 2 * slots_.size() : 16);
+    auto& slot = probe(iden, hash, key);
+    if (slot.hash)
+      return {slot.index, false};
+    slot = {stored(hash), index};
+    size_++;
+    return {slot.index, true};
+  }
+
+  /**
+   * Reserve slots for at least `n` identifiers.
+   *
+   * @param n Number of identifiers
+   */
+  void reserve(std::size_t n)
+  {
+    std::size_t n_slots = 16;
+    while (n_slots < 2 * n)
+      n_slots *= 2;
+    if (n_slots > slots_.size())
+      rehash(n_slots);
+  }
+
+  /**
+   * Replace each stored index with the result of a function.
+   *
+   * Only indices change, so the key function used afterwards must return the
+   * same identifier for the new index as the old one did for the old index.
+   *
+   * @tparam Fn Callable taking an index and returning an index
+   *
+   * @param fn Function mapping old indices to new indices
+   */
+  template <typename Fn>
+  void remap(const Fn& fn)
+  {
+    for (auto& slot : slots_)
+      if (slot.hash)
+        slot.index = fn(slot.index);
+  }
+
+  /**
+   * Return the number of identifiers in the table.
+   */
+  auto size() const noexcept { return size_; }
+
+  /**
+   * Remove all identifiers from the table, releasing its memory.
+   */
+  void clear() noexcept
+  {
+    std::vector<slot_type>{}.swap(slots_);
+    size_ = 0;
+  }
+
+private:
+  // hash is nonzero for a used slot, 0 marks an empty slot
+  struct slot_type {
+    std::uint64_t hash;
+    std::size_t index;
+  };
+
+  // number of slots is a power of 2
+  std::vector<slot_type> slots_;
+  std::size_t size_{};
+
+  /**
+   * Return the nonzero value stored for a hash.
+   *
+   * @param hash Identifier hash
+   */
+  static constexpr std::uint64_t stored(std::uint64_t hash) noexcept
+  {
+    return hash ? hash : 1U;
+  }
+
+  /**
+   * Return the slot holding an identifier, or the empty slot where it would go.
+   *
+   * @tparam KeyFn Callable taking an index and returning a string view
+   *
+   * @param iden Identifier
+   * @param hash Identifier hash
+   * @param key Key function returning the identifier of an index
+   */
+  template <typename KeyFn>
+  slot_type& probe(std::string_view iden, std::uint64_t hash, const KeyFn& key)
+  {
+    const auto h = stored(hash);
+    const auto mask = slots_.size() - 1;
+    for (auto i = static_cast<std::size_t>(h) & mask; ; i = (i + 1) & mask) {
+      auto& slot = slots_[i];
+      if (!slot.hash || (slot.hash == h && key(slot.index) == iden))
+        return slot;
+    }
+  }
+
+  /**
+   * Move all slots into a new slot array.
+   *
+   * Stored hashes are reused so no identifiers are read.
+   *
+   * @param n_slots New number of slots, a power of 2
+   */
+  void rehash(std::size_t n_slots)
+  {
+    std::vector<slot_type> slots(n_slots);
+    std::swap(slots, slots_);
+    const auto mask = slots_.size() - 1;
+    for (const auto& slot : slots) {
+      if (!slot.hash)
+        continue;
+      auto i = static_cast<std::size_t>(slot.hash) & mask;
+      while (slots_[i].hash)
+        i = (i + 1) & mask;
+      slots_[i] = slot;
+    }
+  }
+};
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_BCDP_CDCL_SYMBOL_TABLE_HH_
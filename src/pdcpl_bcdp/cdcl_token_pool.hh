@@ -0,0 +1,85 @@
+/**
+ * @file cdcl_token_pool.hh
+ * @author Derek Huang
+ * @brief C++ pool for lexer token text used in C declaration parsing
+ * @copyright MIT License
+ */
+
+#ifndef PDCPL_BCDP_CDCL_TOKEN_POOL_HH_
+#define PDCPL_BCDP_CDCL_TOKEN_POOL_HH_
+
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+
+namespace pdcpl {
+
+/**
+ * Double-buffered pool of token text copied out of a Flex stream buffer.
+ *
+ * Flex refills stream buffers in place, so token text passed to the parser as
+ * `std::string_view` must be copied somewhere stable. Token views only live
+ * until the grammar rule they appear in is reduced, which always happens
+ * before the end of the next declaration. Text is therefore copied into the
+ * current generation and `flip()` is called after each declaration, freeing
+ * the generation before the current one so memory use stays bounded.
+ */
+class cdcl_token_pool {
+public:
+  /**
+   * Ctor.
+   */
+  cdcl_token_pool()
+    : pools_{
+        {buffers_[0], sizeof buffers_[0]},
+        {buffers_[1], sizeof buffers_[1]}
+      }
+  {}
+
+  cdcl_token_pool(const cdcl_token_pool&) = delete;
+  cdcl_token_pool& operator=(const cdcl_token_pool&) = delete;
+
+  /**
+   * Copy token text into the current generation and return a view of it.
+   *
+   * @param text Token text
+   * @param size Number of characters in the token text
+   */
+  std::string_view copy(const char* text, std::size_t size)
+  {
+    auto data = static_cast<char*>(
+      pools_[current_].allocate((size) ? size : 1U, 1U)
+    );
+    std::memcpy(data, text, size);
+    return {data, size};
+  }
+
+  /**
+   * Start a new generation, freeing the one before the current generation.
+   */
+  void flip() noexcept
+  {
+    current_ ^= 1U;
+    pools_[current_].release();
+  }
+
+  /**
+   * Free all the token text.
+   */
+  void clear() noexcept
+  {
+    pools_[0].release();
+    pools_[1].release();
+  }
+
+private:
+  // initial buffers reused after each release so most flips never allocate
+  char buffers_[2][4096];
+  std::pmr::monotonic_buffer_resource pools_[2];
+  unsigned int current_{};
+};
+
+}  // namespace pdcpl
+
+#endif  // PDCPL_BCDP_CDCL_TOKEN_POOL_HH_
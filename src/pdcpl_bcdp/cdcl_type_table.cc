@@ -0,0 +1,443 @@
+/**
+ * @file cdcl_type_table.cc
+ * @author Derek Huang
+ * @brief C++ source for canonical C declaration types
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cdcl_type_table.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "pdcpl/cdcl_dcln_spec.hh"
+#include "pdcpl/cdcl_type_spec.hh"
+
+#include "cdcl_hash_set.hh"
+#include "cdcl_symbol_table.hh"
+
+namespace pdcpl {
+
+namespace {
+
+/**
+ * Append the bytes of a trivially copyable value to a node key.
+ *
+ * @param key Node key
+ * @param value Value to append
+ */
+template <typename T>
+inline void append_key(std::string& key, const T& value)
+{
+  key.append(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+}  // namespace
+
+/**
+ * Type table implementation class.
+ *
+ * Each node has a key, its kind followed by its fields, with target and
+ * parameter ids standing in for the nodes they refer to. Since the nodes
+ * referred to are already unique, two nodes are equal if their keys are. The
+ * keys are packed into one buffer and looked up with a `cdcl_symbol_table`.
+ */
+class cdcl_type_table_impl {
+public:
+  /**
+   * Return the id of a qualified type with an optional declarator applied.
+   *
+   * @param spec Qualified type specifier
+   * @param dclr [Abstract] declarator, `nullptr` for none
+   */
+  cdcl_type_id intern(const cdcl_qtype_spec& spec, const cdcl_dclr* dclr)
+  {
+    auto id = insert(
+      cdcl_type_kind::base,
+      spec.qual(),
+      spec.spec(),
+      0U,
+      false,
+      0U,
+      params_.size()
+    );
+    if (!dclr)
+      return id;
+    // specifiers are written outermost first, so apply them from the last
+    for (auto it = dclr->rbegin(); it != dclr->rend(); it++)
+      id = std::visit(
+        [this, id](const auto& spec) { return derive(spec, id); },
+        *it
+      );
+    return id;
+  }
+
+  /**
+   * Add the types of another table to this table.
+   *
+   * Nodes only refer to nodes with smaller ids, so nodes are added in order.
+   *
+   * @param other Table to add types from
+   * @returns Ids in this table indexed by ids in `other`
+   */
+  std::vector<cdcl_type_id> merge(const cdcl_type_table_impl& other)
+  {
+    std::vector<cdcl_type_id> ids;
+    ids.reserve(other.nodes_.size());
+    for (const auto& node : other.nodes_) {
+      const auto params_begin = params_.size();
+      for (auto param : node.params())
+        params_.push_back(ids[param]);
+      ids.push_back(
+        insert(
+          node.kind(),
+          node.qual(),
+          node.spec(),
+          node.size(),
+          node.variadic(),
+          (node.kind() == cdcl_type_kind::base) ? 0U : ids[node.target()],
+          params_begin
+        )
+      );
+    }
+    return ids;
+  }
+
+  /**
+   * Return the node of a type.
+   *
+   * @param id Type id
+   */
+  const auto& node(cdcl_type_id id) const { return nodes_.at(id); }
+
+  /**
+   * Return the description of a type, building it if it is not cached.
+   *
+   * Derived nodes are described like declarator specifiers followed by the
+   * description of their target, with parameters described by type only.
+   *
+   * @param id Type id
+   */
+  const std::string& description(cdcl_type_id id) const
+  {
+    const auto& node = nodes_.at(id);
+    // descriptions are never empty, so an empty string has not been built
+    if (descriptions_.size() < nodes_.size())
+      descriptions_.resize(nodes_.size());
+    if (!descriptions_[id].empty())
+      return descriptions_[id];
+    std::string desc;
+    switch (node.kind()) {
+      case cdcl_type_kind::base:
+        desc = cdcl_qtype_spec{node.qual(), node.spec()};
+        break;
+      case cdcl_type_kind::pointer:
+        desc = cdcl_dclr_spec::printer{}(cdcl_ptrs_spec{node.qual()}) + " " +
+          description(node.target());
+        break;
+      case cdcl_type_kind::array:
+        desc = cdcl_dclr_spec::printer{}(cdcl_array_spec{node.size()}) + " " +
+          description(node.target());
+        break;
+      case cdcl_type_kind::function:
+        desc = "function (";
+        for (std::size_t i = 0; i < node.params().size(); i++) {
+          if (i)
+            desc += ", ";
+          desc += description(node.params()[i]);
+        }
+        if (node.variadic())
+          desc += (node.params().empty()) ? "..." : ", ...";
+        desc += ") returning " + description(node.target());
+        break;
+      default:
+        throw std::runtime_error{
+          "cannot describe unknown cdcl_type_kind value"
+        };
+    }
+    return descriptions_[id] = std::move(desc);
+  }
+
+  /**
+   * Return the number of distinct types.
+   */
+  auto size() const noexcept { return nodes_.size(); }
+
+  /**
+   * Remove all types from the table.
+   */
+  void clear() noexcept
+  {
+    nodes_.clear();
+    descriptions_.clear();
+    key_data_.clear();
+    key_offsets_.assign(1, 0U);
+    index_.clear();
+  }
+
+private:
+  std::vector<cdcl_type_node> nodes_;
+  // descriptions of nodes_, built on first use. may be shorter than nodes_
+  mutable std::vector<std::string> descriptions_;
+  // packed node keys, where key i is [key_offsets_[i], key_offsets_[i + 1])
+  std::string key_data_;
+  std::vector<std::size_t> key_offsets_{0U};
+  // node key to node id map
+  cdcl_symbol_table index_;
+  // reusable key of the node being inserted
+  std::string key_;
+  // parameter ids of the function nodes being built. nested function types
+  // push their parameters above those of the enclosing function type
+  std::vector<cdcl_type_id> params_;
+
+  /**
+   * Return the id of the array type of a target type.
+   *
+   * @param spec Array specifier
+   * @param target Element type id
+   */
+  cdcl_type_id derive(const cdcl_array_spec& spec, cdcl_type_id target)
+  {
+    return insert(
+      cdcl_type_kind::array,
+      cdcl_qual::qnone,
+      {},
+      spec.size(),
+      false,
+      target,
+      params_.size()
+    );
+  }
+
+  /**
+   * Return the id of the pointer type of a target type.
+   *
+   * @param specs Pointers specifier, where the first pointer is outermost
+   * @param target Pointee type id
+   */
+  cdcl_type_id derive(const cdcl_ptrs_spec& specs, cdcl_type_id target)
+  {
+    for (auto it = specs.rbegin(); it != specs.rend(); it++)
+      target = insert(
+        cdcl_type_kind::pointer, *it, {}, 0U, false, target, params_.size()
+      );
+    return target;
+  }
+
+  /**
+   * Return the id of the function type returning a target type.
+   *
+   * @param specs Function parameters specifier
+   * @param target Return type id
+   */
+  cdcl_type_id derive(const cdcl_params_spec& specs, cdcl_type_id target)
+  {
+    const auto params_begin = params_.size();
+    for (const auto& param : specs)
+      params_.push_back(intern(param.spec(), param.dclr().get()));
+    return insert(
+      cdcl_type_kind::function,
+      cdcl_qual::qnone,
+      {},
+      0U,
+      specs.variadic(),
+      target,
+      params_begin
+    );
+  }
+
+  /**
+   * Return the id of a node, inserting the node if it is new.
+   *
+   * The parameter ids of a function node are taken from the end of `params_`
+   * starting at `params_begin` and are popped before returning. For other
+   * nodes, `params_begin` must be `params_.size()`.
+   *
+   * @param kind Node kind
+   * @param qual Qualifier of a base or pointer node
+   * @param spec Type specifier of a base node
+   * @param size Size of an array node
+   * @param variadic `true` if a function node accepts varargs
+   * @param target Target type id of a derived node
+   * @param params_begin Index of the first parameter id in `params_`
+   */
+  cdcl_type_id insert(
+    cdcl_type_kind kind,
+    cdcl_qual qual,
+    const cdcl_type_spec& spec,
+    std::size_t size,
+    bool variadic,
+    cdcl_type_id target,
+    std::size_t params_begin)
+  {
+    // build key, which only has the fields used by the node kind
+    key_.clear();
+    append_key(key_, static_cast<std::uint8_t>(kind));
+    switch (kind) {
+      case cdcl_type_kind::base:
+        append_key(key_, static_cast<std::uint8_t>(qual));
+        append_key(key_, static_cast<std::uint8_t>(spec.type()));
+        key_ += spec.iden();
+        break;
+      case cdcl_type_kind::pointer:
+        append_key(key_, static_cast<std::uint8_t>(qual));
+        append_key(key_, target);
+        break;
+      case cdcl_type_kind::array:
+        append_key(key_, size);
+        append_key(key_, target);
+        break;
+      case cdcl_type_kind::function:
+        append_key(key_, static_cast<std::uint8_t>(variadic));
+        append_key(key_, target);
+        for (auto i = params_begin; i < params_.size(); i++)
+          append_key(key_, params_[i]);
+        break;
+    }
+    auto [id, inserted] = index_.insert(
+      key_,
+      nodes_.size(),
+      [this](std::size_t idx)
+      {
+        return std::string_view{key_data_}.substr(
+          key_offsets_[idx], key_offsets_[idx + 1] - key_offsets_[idx]
+        );
+      }
+    );
+    if (inserted) {
+      key_data_ += key_;
+      key_offsets_.push_back(key_data_.size());
+      nodes_.emplace_back(
+        kind,
+        qual,
+        (kind == cdcl_type_kind::base) ? spec : cdcl_type_spec{},
+        size,
+        variadic,
+        target,
+        std::vector<cdcl_type_id>(
+          params_.begin() + static_cast<std::ptrdiff_t>(params_begin),
+          params_.end()
+        )
+      );
+    }
+    params_.resize(params_begin);
+    return static_cast<cdcl_type_id>(id);
+  }
+};
+
+/**
+ * Ctor.
+ */
+cdcl_type_table::cdcl_type_table()
+  : impl_{std::make_unique<cdcl_type_table_impl>()}
+{}
+
+/**
+ * Move ctor.
+ *
+ * The moved-from table can only be assigned to or destroyed.
+ */
+cdcl_type_table::cdcl_type_table(cdcl_type_table&&) noexcept = default;
+
+/**
+ * Move assignment operator.
+ *
+ * The tables are swapped so the moved-from table remains usable.
+ */
+cdcl_type_table& cdcl_type_table::operator=(cdcl_type_table&& other) noexcept
+{
+  std::swap(impl_, other.impl_);
+  return *this;
+}
+
+/**
+ * Dtor.
+ */
+cdcl_type_table::~cdcl_type_table() = default;
+
+/**
+ * Return the id of the type of a declaration.
+ *
+ * This is the qualified type specifier with the declarator chain applied,
+ * so storage and the declaration's identifier are not part of the type.
+ *
+ * @param dcln C declaration
+ */
+cdcl_type_id cdcl_type_table::intern(const cdcl_dcln& dcln)
+{
+  return impl_->intern(dcln.dcl_spec().spec(), &dcln.dclr());
+}
+
+/**
+ * Return the id of a qualified type with an optional declarator applied.
+ *
+ * @param spec Qualified type specifier
+ * @param dclr [Abstract] declarator, `nullptr` for none
+ */
+cdcl_type_id cdcl_type_table::intern(
+  const cdcl_qtype_spec& spec, const cdcl_dclr* dclr)
+{
+  return impl_->intern(spec, dclr);
+}
+
+/**
+ * Add the types of another table to this table.
+ *
+ * @param other Table to add types from
+ * @returns Ids in this table indexed by ids in `other`
+ */
+std::vector<cdcl_type_id> cdcl_type_table::merge(const cdcl_type_table& other)
+{
+  return impl_->merge(*other.impl_);
+}
+
+/**
+ * Return the node of a type.
+ *
+ * An exception will be thrown if `id` is out of bounds.
+ *
+ * @param id Type id
+ */
+const cdcl_type_node& cdcl_type_table::node(cdcl_type_id id) const
+{
+  return impl_->node(id);
+}
+
+/**
+ * Return the description of a type.
+ *
+ * For example, "pointer to function (signed int) returning const char". The
+ * description is built on first use and cached until the table is cleared.
+ * An exception will be thrown if `id` is out of bounds.
+ *
+ * @param id Type id
+ */
+const std::string& cdcl_type_table::description(cdcl_type_id id) const
+{
+  return impl_->description(id);
+}
+
+/**
+ * Return the number of distinct types.
+ */
+std::size_t cdcl_type_table::size() const noexcept
+{
+  return impl_->size();
+}
+
+/**
+ * Remove all types from the table.
+ */
+void cdcl_type_table::clear() noexcept
+{
+  impl_->clear();
+}
+
+}  // namespace pdcpl
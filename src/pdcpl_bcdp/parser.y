@@ -17,6 +17,7 @@
   #include <sstream>
   #include <stdexcept>
   #include <string>
+  #include <string_view>
   #include <utility>
 
   #include "cdcl_parser_impl.hh"
@@ -32,6 +33,8 @@
  *
  * Location tracking is enabled and as recommended by Bison documentation, the
  * parser's parse() function takes the pdcpl_bcdp cdcl_parser as a parameter.
+ * The reentrant Flex scanner handle owned by the cdcl_parser is also passed so
+ * that yylex() uses no global state and separate parsers can run concurrently.
  *
  * Requiring Bison 3.2 stops unnecessary stack.hh generation. For Bison 3.6+,
  * it is better for parse.error to have the value of detailed. Lookahead
@@ -53,6 +56,18 @@
 /* parser class is yy::cdcl_parser, not the usual yy::parser */
 %define api.parser.class { cdcl_parser }
 %param { pdcpl::cdcl_parser_impl& parser }
+%param { yyscan_t scanner }
+
+/* Flex reentrant scanner handle. The Flex-generated lexer defines this too */
+%code requires {
+  #include <cstddef>
+  #include <string_view>
+
+  #ifndef YY_TYPEDEF_YY_SCANNER_T
+  #define YY_TYPEDEF_YY_SCANNER_T
+  typedef void* yyscan_t;
+  #endif  // YY_TYPEDEF_YY_SCANNER_T
+}
 
 /* Token definitions */
 %token STAR "*"
@@ -62,9 +77,11 @@
 %token RANGLE "]"
 %token COMMA ","
 %token SEMICOLON ";"
-/* don't need digits' numerical value, so semantic type is std::string */
-%token <std::string> DIGITS
-%token <std::string> IDEN
+/* digits are converted to an array size by the lexer. identifiers are views
+ * of the token text that are only valid until the end of the declaration, so
+ * they are copied into the declaration nodes when first reduced */
+%token <std::size_t> DIGITS
+%token <std::string_view> IDEN
 /* storage class specifiers */
 %token ST_AUTO "auto"
 %token ST_EXTERN "extern"
@@ -90,7 +107,11 @@
 /* variadic args specifier */
 %token T_VARIADIC "..."
 
-/* Nonterminal token definitions */
+/* Nonterminal token definitions.
+ *
+ * Semantic values allocate from the arena of the current parse, which is set
+ * by the cdcl_parser_impl, and are moved rather than copied where possible.
+ */
 %nterm <pdcpl::cdcl_qual> type_qual
 %nterm <pdcpl::cdcl_type_spec> type_spec
 %nterm <pdcpl::cdcl_qtype_spec> qual_type_spec
@@ -135,7 +156,7 @@ stmt:
 dcln:
   dcl_spec init_dclrs ";"
   {
-    parser.insert($1, $2);
+    parser.insert($1, std::move($2), @$);
   }
 
 /* C declaration specifier rule. */
@@ -143,6 +164,10 @@ dcl_spec:
   storage_spec qual_type_spec
   {
     $$ = {$1, std::move($2)};
+    // empty storage_spec location is the end of the previous symbol, so the
+    // declaration specifier starts at the type specifier instead
+    if (@1.begin.line == @1.end.line && @1.begin.column == @1.end.column)
+      @$.begin = @2.begin;
   }
 
 /* C storage class specifier rule.
@@ -281,15 +306,15 @@ type_spec:
   }
 | "struct" IDEN
   {
-    $$ = {pdcpl::cdcl_type::gstruct, $2};
+    $$ = {pdcpl::cdcl_type::gstruct, std::string{$2}};
   }
 | "enum" IDEN
   {
-    $$ = {pdcpl::cdcl_type::genum, $2};
+    $$ = {pdcpl::cdcl_type::genum, std::string{$2}};
   }
 | IDEN
   {
-    $$ = {pdcpl::cdcl_type::gtype, $1};
+    $$ = {pdcpl::cdcl_type::gtype, std::string{$1}};
   }
 
 /* "Implied" int.
@@ -304,7 +329,7 @@ implied_int:
 init_dclrs:
   init_dclr
   {
-    $$ = {$1};
+    $$.append(std::move($1));
   }
 | init_dclrs "," init_dclr
   {
@@ -377,7 +402,7 @@ ptr_spec:
 dir_dclr:
   IDEN
   {
-    $$ = $1;
+    $$ = pdcpl::cdcl_dclr{std::string{$1}};
   }
 | "(" dclr ")"
   {
@@ -406,7 +431,7 @@ array_spec:
   }
 | "[" DIGITS "]"
   {
-    $$ = std::stoul($2);
+    $$ = $2;
   }
 
 /* C optional parameter specifiers.
@@ -430,7 +455,7 @@ maybe_param_specs:
 param_specs:
   param_spec
   {
-    $$ = {$1};
+    $$.append(std::move($1));
   }
 | param_specs "," param_spec
   {
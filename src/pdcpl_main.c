@@ -0,0 +1,193 @@
+/**
+ * @file pdcpl_main.c
+ * @author Derek Huang
+ * @brief pdcpl multi-call program containing all the standalone programs
+ * @copyright MIT License
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdcpl/core.h"
+
+/**
+ * Entry points of the standalone programs.
+ *
+ * Each standalone is compiled with `PDCPL_MAIN_NAME` set to one of these.
+ */
+int pdcpl_main_1_1(int argc, char **argv);
+int pdcpl_main_1_2(int argc, char **argv);
+int pdcpl_main_1_3(int argc, char **argv);
+int pdcpl_main_1_4(int argc, char **argv);
+int pdcpl_main_1_5(int argc, char **argv);
+int pdcpl_main_1_6(int argc, char **argv);
+int pdcpl_main_1_7(int argc, char **argv);
+int pdcpl_main_1_8(int argc, char **argv);
+int pdcpl_main_1_9(int argc, char **argv);
+int pdcpl_main_1_10(int argc, char **argv);
+int pdcpl_main_1_12(int argc, char **argv);
+int pdcpl_main_1_16(int argc, char **argv);
+int pdcpl_main_1_17(int argc, char **argv);
+int pdcpl_main_1_19(int argc, char **argv);
+int pdcpl_main_2_1(int argc, char **argv);
+int pdcpl_main_2_2(int argc, char **argv);
+int pdcpl_main_2_9(int argc, char **argv);
+int pdcpl_main_3_4(int argc, char **argv);
+int pdcpl_main_4_14(int argc, char **argv);
+int pdcpl_main_5_13(int argc, char **argv);
+int pdcpl_main_5_16(int argc, char **argv);
+int pdcpl_main_6_1(int argc, char **argv);
+int pdcpl_main_7_1(int argc, char **argv);
+int pdcpl_main_run(int argc, char **argv);
+
+/**
+ * Program contained in the multi-call program.
+ *
+ * @param name Program name, also accepted as the invocation name
+ * @param main Program entry point
+ */
+typedef struct {
+  const char *name;
+  int (*main)(int argc, char **argv);
+} applet;
+
+/**
+ * Programs in the order they are listed in the usage.
+ *
+ * 7.1 dispatches on its invocation name, so it is also listed as lower and
+ * upper. Those names are passed through as `argv[0]` to select its mode.
+ */
+static const applet applets[] = {
+  {"1.1", pdcpl_main_1_1},
+  {"1.2", pdcpl_main_1_2},
+  {"1.3", pdcpl_main_1_3},
+  {"1.4", pdcpl_main_1_4},
+  {"1.5", pdcpl_main_1_5},
+  {"1.6", pdcpl_main_1_6},
+  {"1.7", pdcpl_main_1_7},
+  {"1.8", pdcpl_main_1_8},
+  {"1.9", pdcpl_main_1_9},
+  {"1.10", pdcpl_main_1_10},
+  {"1.12", pdcpl_main_1_12},
+  {"1.16", pdcpl_main_1_16},
+  {"1.17", pdcpl_main_1_17},
+  {"1.19", pdcpl_main_1_19},
+  {"2.1", pdcpl_main_2_1},
+  {"2.2", pdcpl_main_2_2},
+  {"2.9", pdcpl_main_2_9},
+  {"3.4", pdcpl_main_3_4},
+  {"4.14", pdcpl_main_4_14},
+  {"5.13", pdcpl_main_5_13},
+  {"5.16", pdcpl_main_5_16},
+  {"6.1", pdcpl_main_6_1},
+  {"7.1", pdcpl_main_7_1},
+  {"lower", pdcpl_main_7_1},
+  {"upper", pdcpl_main_7_1},
+  {"run", pdcpl_main_run}
+};
+
+/**
+ * Number of programs in the multi-call program.
+ */
+#define N_APPLETS (sizeof applets / sizeof *applets)
+
+/**
+ * Return the program with the given name, `NULL` if there is none.
+ *
+ * On Windows, a trailing `.exe` is ignored so that renamed copies work.
+ *
+ * @param name Program name
+ */
+static const applet *
+find_applet(const char *name)
+{
+  size_t len = strlen(name);
+#ifdef _WIN32
+  if (len > 4 && !strcmp(name + len - 4, ".exe"))
+    len -= 4;
+#endif  // _WIN32
+  for (size_t i = 0; i < N_APPLETS; i++)
+    if (strlen(applets[i].name) == len && !strncmp(applets[i].name, name, len))
+      return applets + i;
+  return NULL;
+}
+
+/**
+ * Print the multi-call program usage.
+ *
+ * @param f Stream to print to
+ */
+static void
+print_usage(FILE *f)
+{
+  fprintf(
+    f,
+    "Usage: %s PROGRAM [ARGS...]\n"
+    "       %s run [OPTIONS...] PIPELINE [FILE...]\n"
+    "\n"
+    "Multi-call program containing all the standalone exercise programs.\n"
+    "\n"
+    "The program to run is either the first argument or, if this program is\n"
+    "symlinked, copied, or renamed to a program name, the invocation name.\n"
+    "The run program chains text filters in a single process, e.g.\n"
+    "\n"
+    "  %s run 'detab 4 | squeeze | lower'\n"
+    "\n"
+    "Use `%s PROGRAM --help' for help on a particular program.\n"
+    "\n"
+    "Programs:\n"
+    " ",
+    PDCPL_PROGRAM_NAME,
+    PDCPL_PROGRAM_NAME,
+    PDCPL_PROGRAM_NAME,
+    PDCPL_PROGRAM_NAME
+  );
+  // wrap program names to fit in 80 columns
+  size_t col = 1;
+  for (size_t i = 0; i < N_APPLETS; i++) {
+    size_t len = strlen(applets[i].name);
+    if (col + 1 + len > 78) {
+      fprintf(f, "\n ");
+      col = 1;
+    }
+    fprintf(f, " %s", applets[i].name);
+    col += 1 + len;
+  }
+  fprintf(
+    f,
+    "\n"
+    "\n"
+    "Info options:\n"
+    "  -h, --help                  Print this help output\n"
+    "  -V, --version               Print program version info\n"
+  );
+}
+
+PDCPL_ARG_MAIN
+{
+  PDCPL_SET_PROGRAM_NAME();
+  // if invoked through a program name, run it with the arguments as is
+  const applet *app = find_applet(PDCPL_PROGRAM_NAME);
+  if (app)
+    return app->main(argc, argv);
+  if (argc < 2) {
+    print_usage(stderr);
+    return EXIT_FAILURE;
+  }
+  if (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+    print_usage(stdout);
+    return EXIT_SUCCESS;
+  }
+  if (!strcmp(argv[1], "-V") || !strcmp(argv[1], "--version")) {
+    PDCPL_PRINT_VERSION_INFO();
+    return EXIT_SUCCESS;
+  }
+  // otherwise the first argument names the program and becomes its argv[0]
+  if (!(app = find_applet(argv[1]))) {
+    PDCPL_PRINT_ERROR_EX("error: unknown program %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  return app->main(argc - 1, argv + 1);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file pdcpl_run.c
+ * @author Derek Huang
+ * @brief pdcpl multi-call program in-process filter pipeline runner
+ * @copyright MIT License
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PDCPL_HAS_PROGRAM_INPUTS
+#define PDCPL_HAS_PROGRAM_USAGE
+#define PDCPL_HAS_PROGRAM_OPTIONS
+#include "pdcpl/cliopts.h"
+#include "pdcpl/core.h"
+#include "pdcpl/pipeline.h"
+
+static size_t block_size = PDCPL_PIPELINE_BLOCK_SIZE;
+
+/**
+ * Action to get the number of input bytes per block.
+ */
+static
+PDCPL_CLIOPT_ACTION(block_size_action)
+{
+  PDCPL_CLIOPT_ACTION_ARGI_GUARD
+  char *end;
+  errno = 0;
+  long long n = strtoll(argv[argi + 1], &end, 10);
+  if (errno || end == argv[argi + 1] || *end)
+    return PDCPL_CLIOPT_ERROR_CANT_CONVERT;
+  if (n <= 0)
+    return PDCPL_CLIOPT_ERROR_EXPECTED_POSITIVE;
+  block_size = (size_t) n;
+  return PDCPL_CLIOPT_PARSE_OK;
+}
+
+PDCPL_PROGRAM_USAGE_DEF
+(
+  "Run a pipeline of text filters on stdin or files in a single process.\n"
+  "\n"
+  "The first argument is the pipeline, written like a shell pipeline, e.g.\n"
+  "\n"
+  "  run 'detab 4 | squeeze | lower' < in.txt\n"
+  "\n"
+  "has the same output as `detab 4 < in.txt | 1.9 | lower' would if there\n"
+  "were a detab program, but the stages hand blocks to each other through\n"
+  "shared buffers instead of OS pipes. The available stages are\n"
+  "\n"
+  "  detab [N]   Replace tabs with blanks, tab stops every N columns,\n"
+  "              default 8\n"
+  "  escape      Escape tabs, backspaces, and backslashes, like 1.10\n"
+  "  lower       Convert to lowercase, like 7.1 as lower\n"
+  "  squeeze     Replace multiple blanks with one blank, like 1.9\n"
+  "  upper       Convert to uppercase, like 7.1 as upper\n"
+  "  words       Print one word per line, like 1.12\n"
+  "\n"
+  "Any remaining arguments are input files. Each input is run through its\n"
+  "own copy of the pipeline, so stage state does not carry across files."
+)
+
+PDCPL_PROGRAM_OPTIONS_DEF
+{
+  {
+    "-b", "--block-size",
+    "Number of input bytes each stage transforms at a time, default 65536",
+    1,
+    block_size_action,
+    NULL
+  },
+  PDCPL_PROGRAM_OPTIONS_END
+};
+
+/**
+ * Run a stream through a new pipeline.
+ *
+ * @param in Input stream
+ * @param out Output stream
+ * @param path Input stream path
+ * @param ctx `const char *` pipeline specification
+ * @returns 0 on success, -ENOMEM on allocation failure, -EIO on stream error
+ */
+static int
+run_stream(FILE *in, FILE *out, const char *path, void *ctx)
+{
+  (void) path;
+  pdcpl_pipeline *pipeline;
+  int status = pdcpl_pipeline_create(&pipeline, ctx, block_size);
+  if (status)
+    return status;
+  status = pdcpl_pipeline_run(pipeline, in, out);
+  pdcpl_pipeline_destroy(pipeline);
+  return status;
+}
+
+PDCPL_ARG_MAIN
+{
+  PDCPL_PARSE_PROGRAM_OPTIONS();
+  // first input is the pipeline specification, the rest are files
+  PDCPL_MAIN_EXIT_EX(!PDCPL_PROGRAM_N_INPUTS, "error: missing pipeline");
+  char *spec = PDCPL_PROGRAM_INPUTS[0];
+  PDCPL_PROGRAM_INPUTS++;
+  PDCPL_PROGRAM_N_INPUTS--;
+  // check the specification once up front so errors are reported once
+  {
+    pdcpl_pipeline *pipeline;
+    int status = pdcpl_pipeline_create(&pipeline, spec, block_size);
+    if (status == -EINVAL) {
+      PDCPL_PRINT_ERROR_EX("error: invalid pipeline '%s'\n", spec);
+      return EXIT_FAILURE;
+    }
+    PDCPL_MAIN_ERRNO_EXIT(status);
+    pdcpl_pipeline_destroy(pipeline);
+  }
+  if (PDCPL_PROGRAM_RUN_INPUTS(run_stream, spec))
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file batch_test.cc
+ * @author Derek Huang
+ * @brief batch.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/batch.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * Main batch test fixture.
+ *
+ * Creates a temporary directory of input files, each containing its index
+ * repeated a varying number of times, and a temporary output file.
+ */
+class BatchTest : public ::testing::Test {
+protected:
+  static constexpr std::size_t n_files_ = 32;
+
+  void SetUp() override
+  {
+    dir_ = std::filesystem::temp_directory_path() /
+      ("pdcpl_batch_test_" + std::to_string(
+        ::testing::UnitTest::GetInstance()->random_seed()) + "_" +
+        ::testing::UnitTest::GetInstance()->current_test_info()->name()
+      );
+    std::filesystem::create_directories(dir_);
+    for (std::size_t i = 0; i < n_files_; i++) {
+      auto path = (dir_ / (std::to_string(i) + ".txt")).string();
+      std::ofstream stream{path};
+      // vary the file sizes so workers finish out of order
+      for (std::size_t j = 0; j < 1 + (i * 7919) % 512; j++)
+        stream << i << '\n';
+      paths_.push_back(path);
+    }
+    out_ = std::tmpfile();
+    ASSERT_TRUE(out_);
+  }
+
+  void TearDown() override
+  {
+    if (out_)
+      std::fclose(out_);
+    std::filesystem::remove_all(dir_);
+  }
+
+  /**
+   * Return C string pointers to the paths.
+   */
+  auto c_paths() const
+  {
+    std::vector<const char*> ptrs;
+    for (const auto& path : paths_)
+      ptrs.push_back(path.c_str());
+    return ptrs;
+  }
+
+  /**
+   * Return the contents of the output file.
+   */
+  std::string output()
+  {
+    std::string text;
+    std::rewind(out_);
+    int c;
+    while ((c = std::fgetc(out_)) != EOF)
+      text += static_cast<char>(c);
+    return text;
+  }
+
+  /**
+   * Return the expected output of `line_count` over the given paths.
+   *
+   * @param paths File paths
+   */
+  static std::string expected(const std::vector<std::string>& paths)
+  {
+    std::string text;
+    for (const auto& path : paths) {
+      std::ifstream stream{path};
+      std::string line;
+      std::size_t n = 0;
+      while (std::getline(stream, line))
+        n++;
+      text += path + ": " + std::to_string(n) + "\n";
+    }
+    return text;
+  }
+
+  std::filesystem::path dir_;
+  std::vector<std::string> paths_;
+  std::FILE* out_ = nullptr;
+};
+
+/**
+ * Batch function that writes the path and number of lines in the stream.
+ */
+int line_count(std::FILE* in, std::FILE* out, const char* path, void* ctx)
+{
+  (void) ctx;
+  std::size_t n = 0;
+  int c;
+  while ((c = std::fgetc(in)) != EOF)
+    n += (c == '\n');
+  std::fprintf(out, "%s: %zu\n", path, n);
+  return 0;
+}
+
+/**
+ * Test that serial processing gives the expected output.
+ */
+TEST_F(BatchTest, SerialTest)
+{
+  auto paths = c_paths();
+  ASSERT_FALSE(
+    pdcpl_batch_run(
+      paths.data(), paths.size(), 1, line_count, nullptr, out_, nullptr
+    )
+  );
+  EXPECT_EQ(expected(paths_), output());
+}
+
+/**
+ * Test that parallel processing writes outputs in argument order.
+ */
+TEST_F(BatchTest, ParallelOrderTest)
+{
+  auto paths = c_paths();
+  for (unsigned int n_jobs : {0u, 2u, 4u, 64u}) {
+    // clear output by reopening the temporary file
+    std::fclose(out_);
+    out_ = std::tmpfile();
+    ASSERT_TRUE(out_);
+    ASSERT_FALSE(
+      pdcpl_batch_run(
+        paths.data(), paths.size(), n_jobs, line_count, nullptr, out_, nullptr
+      )
+    ) << "n_jobs=" << n_jobs;
+    EXPECT_EQ(expected(paths_), output()) << "n_jobs=" << n_jobs;
+  }
+}
+
+/**
+ * Test that a missing file is reported without stopping the other files.
+ */
+TEST_F(BatchTest, MissingFileTest)
+{
+  auto missing = (dir_ / "missing.txt").string();
+  auto paths = c_paths();
+  paths.insert(paths.begin() + 3, missing.c_str());
+  EXPECT_EQ(
+    -ENOENT,
+    pdcpl_batch_run(
+      paths.data(), paths.size(), 4, line_count, nullptr, out_, "batch_test"
+    )
+  );
+  // missing file produces no output, all others are in order
+  EXPECT_EQ(expected(paths_), output());
+}
+
+/**
+ * Test that invalid arguments are rejected.
+ */
+TEST_F(BatchTest, InvalidTest)
+{
+  auto paths = c_paths();
+  EXPECT_EQ(
+    -EINVAL,
+    pdcpl_batch_run(nullptr, 1, 1, line_count, nullptr, out_, nullptr)
+  );
+  EXPECT_EQ(
+    -EINVAL,
+    pdcpl_batch_run(paths.data(), 1, 1, nullptr, nullptr, out_, nullptr)
+  );
+  EXPECT_EQ(
+    -EINVAL,
+    pdcpl_batch_run(paths.data(), 1, 1, line_count, nullptr, nullptr, nullptr)
+  );
+}
+
+}  // namespace
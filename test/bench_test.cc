@@ -0,0 +1,125 @@
+/**
+ * @file bench_test.cc
+ * @author Derek Huang
+ * @brief bench.h unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/bench.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+/**
+ * Main bench test fixture.
+ */
+class BenchTest : public ::testing::Test {
+protected:
+  // options that keep the runs short
+  static constexpr pdcpl_bench_options opts_ = {1e-5, 1e-5, 5};
+};
+
+/**
+ * Test that the median sorts values and averages for even counts.
+ */
+TEST_F(BenchTest, MedianTest)
+{
+  double odd[] = {5, 1, 3};
+  EXPECT_DOUBLE_EQ(3, pdcpl_bench_median(odd, PDCPL_ARRAY_SIZE(odd)));
+  EXPECT_DOUBLE_EQ(1, odd[0]);
+  double even[] = {4, 1, 3, 2};
+  EXPECT_DOUBLE_EQ(2.5, pdcpl_bench_median(even, PDCPL_ARRAY_SIZE(even)));
+}
+
+// benchmark state for the run test
+std::uint64_t setup_calls, teardown_calls;
+
+int bench_setup(pdcpl_bench_state *state)
+{
+  setup_calls++;
+  state->bytes = 1000;
+  return 0;
+}
+
+int bench_func(pdcpl_bench_state *state)
+{
+  std::uint64_t total = 0;
+  for (std::uint64_t i = 0; i < state->iterations; i++) {
+    total += i;
+    PDCPL_BENCH_DO_NOT_OPTIMIZE(total);
+  }
+  return 0;
+}
+
+int bench_fail(pdcpl_bench_state * /*state*/)
+{
+  return -ENOMEM;
+}
+
+int bench_teardown(pdcpl_bench_state * /*state*/)
+{
+  teardown_calls++;
+  return 0;
+}
+
+/**
+ * Test that a benchmark case is calibrated, sampled, and torn down.
+ */
+TEST_F(BenchTest, RunTest)
+{
+  setup_calls = teardown_calls = 0;
+  const pdcpl_bench_case bc = {"run", bench_func, bench_setup, bench_teardown};
+  pdcpl_bench_result res;
+  ASSERT_FALSE(pdcpl_bench_run(&bc, &opts_, &res));
+  EXPECT_EQ(std::string{"run"}, res.name);
+  EXPECT_EQ(opts_.samples, res.samples);
+  EXPECT_GE(res.iterations, 1u);
+  EXPECT_LE(res.min_ns, res.median_ns);
+  EXPECT_GE(res.mad_ns, 0);
+  EXPECT_GT(res.bytes_per_sec, 0);
+  EXPECT_EQ(1u, setup_calls);
+  EXPECT_EQ(1u, teardown_calls);
+  // errors from the case are returned and teardown still runs
+  const pdcpl_bench_case fail = {"fail", bench_fail, NULL, bench_teardown};
+  EXPECT_EQ(-ENOMEM, pdcpl_bench_run(&fail, &opts_, &res));
+  EXPECT_EQ(2u, teardown_calls);
+  // invalid arguments
+  EXPECT_EQ(-EINVAL, pdcpl_bench_run(nullptr, &opts_, &res));
+  EXPECT_EQ(-EINVAL, pdcpl_bench_run(&bc, &opts_, nullptr));
+  pdcpl_bench_options no_samples = opts_;
+  no_samples.samples = 0;
+  EXPECT_EQ(-EINVAL, pdcpl_bench_run(&bc, &no_samples, &res));
+  EXPECT_EQ(1u, setup_calls);
+}
+
+/**
+ * Test that results are written as JSON.
+ */
+TEST_F(BenchTest, JsonTest)
+{
+  const pdcpl_bench_result res[] = {
+    {"a", 10, 5, 1.5, 0.25, 1, 0},
+    {"b", 20, 5, 2, 0.5, 1.75, 1e9}
+  };
+  auto f = std::tmpfile();
+  ASSERT_TRUE(f);
+  ASSERT_FALSE(pdcpl_bench_fprintf_json(f, res, PDCPL_ARRAY_SIZE(res)));
+  std::rewind(f);
+  std::string json;
+  for (int c; (c = std::fgetc(f)) != EOF; )
+    json += static_cast<char>(c);
+  std::fclose(f);
+  EXPECT_EQ(0u, json.find("{\"benchmarks\": ["));
+  EXPECT_NE(std::string::npos, json.find("\"name\": \"a\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\": \"b\""));
+  EXPECT_NE(std::string::npos, json.find("\"iterations\": 20"));
+  EXPECT_EQ(-EINVAL, pdcpl_bench_fprintf_json(nullptr, res, 1));
+}
+
+}  // namespace
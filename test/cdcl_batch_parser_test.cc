@@ -0,0 +1,247 @@
+/**
+ * @file cdcl_batch_parser_test.cc
+ * @author Derek Huang
+ * @brief cdcl_batch_parser.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cdcl_batch_parser.hh"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pdcpl/cdcl_parser.hh"
+
+// default location for the test data root, determined at compile time. this is
+// used if PDCPL_BCDP_TEST_DIR is not set in the environment
+#ifndef PDCPL_BCDP_TEST_DIR
+#define PDCPL_BCDP_TEST_DIR ""
+#endif  // PDCPL_BCDP_TEST_DIR
+
+namespace {
+
+/**
+ * Return the test data directory path given by `PDCPL_BCDP_TEST_DIR`.
+ *
+ * The environment variable takes precedence over the macro.
+ */
+std::filesystem::path test_data_dir()
+{
+  auto dir_path = std::getenv("PDCPL_BCDP_TEST_DIR");
+  if (dir_path)
+    return dir_path;
+  return PDCPL_BCDP_TEST_DIR;
+}
+
+/**
+ * Return the string representation of a C declaration.
+ *
+ * @param dcln C declaration
+ */
+std::string dcln_string(const pdcpl::cdcl_dcln& dcln)
+{
+  std::stringstream ss;
+  ss << dcln;
+  return ss.str();
+}
+
+/**
+ * Test fixture that writes declaration files to a temporary directory.
+ */
+class CdclBatchParserTest : public ::testing::Test {
+protected:
+  /**
+   * Create the temporary directory.
+   */
+  void SetUp() override
+  {
+    dir_ = std::filesystem::temp_directory_path() /
+      ("pdcpl_cdcl_batch_parser_test_" +
+        std::string{
+          ::testing::UnitTest::GetInstance()->current_test_info()->name()
+        });
+    std::filesystem::create_directories(dir_);
+  }
+
+  /**
+   * Remove the temporary directory.
+   */
+  void TearDown() override
+  {
+    std::filesystem::remove_all(dir_);
+  }
+
+  /**
+   * Write a declaration file to the temporary directory and return its path.
+   *
+   * @param name File name
+   * @param text File contents
+   */
+  std::filesystem::path write(const std::string& name, std::string_view text)
+  {
+    auto path = dir_ / name;
+    std::ofstream f{path, std::ios::binary};
+    f << text;
+    return path;
+  }
+
+  std::filesystem::path dir_;
+};
+
+/**
+ * Test that the merged sample results match parsing the samples one by one.
+ */
+TEST_F(CdclBatchParserTest, SampleTest)
+{
+  const auto data_dir = test_data_dir();
+  if (data_dir.empty() || !std::filesystem::is_directory(data_dir))
+    GTEST_SKIP() << "PDCPL_BCDP_TEST_DIR not a directory";
+  pdcpl::cdcl_batch_parser::paths_type files;
+  for (auto name : {"bdcl.in.1", "bdcl.in.2", "bdcl.in.3", "bdcl.in.4"})
+    files.push_back(data_dir / name);
+  // expected results are the results of each file in file order, keeping
+  // only the first declaration of each identifier
+  std::vector<std::string> expected;
+  std::vector<std::string> expected_conflicts;
+  std::unordered_set<std::string> seen;
+  for (const auto& file : files) {
+    pdcpl::cdcl_parser parser;
+    ASSERT_TRUE(parser(file)) << parser.last_error();
+    for (const auto& dcln : parser.results()) {
+      if (seen.insert(dcln.iden()).second)
+        expected.push_back(dcln_string(dcln));
+      else
+        expected_conflicts.push_back(dcln.iden());
+    }
+  }
+  for (unsigned int n_jobs : {1U, 3U, 0U}) {
+    pdcpl::cdcl_batch_parser parser{n_jobs};
+    EXPECT_EQ(n_jobs, parser.n_jobs());
+    EXPECT_EQ(expected_conflicts.empty(), parser(files));
+    ASSERT_EQ(expected.size(), parser.n_results());
+    for (std::size_t i = 0; i < expected.size(); i++)
+      EXPECT_EQ(expected[i], dcln_string(parser.result(i)));
+    ASSERT_EQ(expected_conflicts.size(), parser.conflicts().size());
+    for (std::size_t i = 0; i < expected_conflicts.size(); i++)
+      EXPECT_EQ(expected_conflicts[i], parser.conflicts()[i].iden);
+  }
+}
+
+/**
+ * Test that redeclarations across files are reported as conflicts.
+ */
+TEST_F(CdclBatchParserTest, ConflictTest)
+{
+  pdcpl::cdcl_batch_parser::paths_type files{
+    write("a.h", "int x;\nint y;\n"),
+    write("b.h", "int z;\n  char *x, w;\n"),
+    write("c.h", "double y;")
+  };
+  pdcpl::cdcl_batch_parser parser{2};
+  EXPECT_FALSE(parser(files));
+  // first declarations are kept in file order
+  ASSERT_EQ(4U, parser.n_results());
+  EXPECT_EQ("x", parser.result(0).iden());
+  EXPECT_EQ("y", parser.result(1).iden());
+  EXPECT_EQ("z", parser.result(2).iden());
+  EXPECT_EQ("w", parser.result(3).iden());
+  ASSERT_TRUE(parser.results_contain("x"));
+  EXPECT_EQ(dcln_string(parser.result(0)), dcln_string(parser.result("x")));
+  EXPECT_FALSE(parser.results_contain("v"));
+  EXPECT_EQ(1U, parser.result_position(3).file);
+  EXPECT_EQ(2U, parser.result_position(3).position.line);
+  EXPECT_EQ(3U, parser.result_position(3).position.column);
+  // type ids are shared across files
+  EXPECT_EQ(parser.result_type(0), parser.result_type(2));
+  EXPECT_NE(parser.result_type(0), parser.result_type(3));
+  EXPECT_EQ("char", parser.types().description(parser.result_type(3)));
+  // conflicts are ordered by redeclaration
+  ASSERT_EQ(2U, parser.conflicts().size());
+  const auto& x_conflict = parser.conflicts()[0];
+  EXPECT_EQ("x", x_conflict.iden);
+  EXPECT_EQ(0U, x_conflict.first.file);
+  EXPECT_EQ(1U, x_conflict.first.position.line);
+  EXPECT_EQ(1U, x_conflict.redeclared.file);
+  EXPECT_EQ(2U, x_conflict.redeclared.position.line);
+  EXPECT_EQ(3U, x_conflict.redeclared.position.column);
+  EXPECT_EQ("y", parser.conflicts()[1].iden);
+  EXPECT_EQ(2U, parser.conflicts()[1].redeclared.file);
+  // conflict messages give the files and positions
+  ASSERT_EQ(2U, parser.errors().size());
+  EXPECT_EQ(
+    files[1].string() + ":2.3: identifier x redeclared, first declared at " +
+      files[0].string() + ":1.1",
+    parser.errors()[0]
+  );
+}
+
+/**
+ * Test that files that fail to parse are skipped and reported.
+ */
+TEST_F(CdclBatchParserTest, ParseErrorTest)
+{
+  pdcpl::cdcl_batch_parser::paths_type files{
+    write("a.h", "int x;"),
+    dir_ / "missing.h",
+    write("b.h", "int y; int y;"),
+    write("c.h", "int z;")
+  };
+  pdcpl::cdcl_batch_parser parser;
+  EXPECT_FALSE(parser(files));
+  ASSERT_EQ(2U, parser.n_results());
+  EXPECT_TRUE(parser.results_contain("x"));
+  EXPECT_FALSE(parser.results_contain("y"));
+  EXPECT_TRUE(parser.results_contain("z"));
+  EXPECT_EQ(3U, parser.result_position(1).file);
+  ASSERT_EQ(2U, parser.errors().size());
+  EXPECT_NE(std::string::npos, parser.errors()[0].find("missing.h"));
+  EXPECT_NE(std::string::npos, parser.errors()[1].find("redeclared"));
+  EXPECT_TRUE(parser.conflicts().empty());
+  // reparsing replaces the previous results
+  EXPECT_TRUE(parser({files[0]}));
+  EXPECT_EQ(1U, parser.n_results());
+  EXPECT_TRUE(parser.errors().empty());
+}
+
+/**
+ * Test that many files parsed with all hardware threads merge correctly.
+ */
+TEST_F(CdclBatchParserTest, ManyFilesTest)
+{
+  constexpr std::size_t n_files = 500;
+  constexpr std::size_t n_dclns = 20;
+  pdcpl::cdcl_batch_parser::paths_type files;
+  for (std::size_t i = 0; i < n_files; i++) {
+    std::string text;
+    for (std::size_t j = 0; j < n_dclns; j++)
+      text += "int *f" + std::to_string(i) + "_" + std::to_string(j) +
+        "(char, ...);\n";
+    // every file redeclares the same shared identifier
+    text += "extern int shared;\n";
+    files.push_back(write("f" + std::to_string(i) + ".h", text));
+  }
+  pdcpl::cdcl_batch_parser parser{0};
+  EXPECT_FALSE(parser(files));
+  ASSERT_EQ(n_files * n_dclns + 1, parser.n_results());
+  ASSERT_EQ(n_files - 1, parser.conflicts().size());
+  for (std::size_t i = 1; i < n_files; i++) {
+    EXPECT_EQ(0U, parser.conflicts()[i - 1].first.file);
+    EXPECT_EQ(i, parser.conflicts()[i - 1].redeclared.file);
+  }
+  for (std::size_t i = 0; i < parser.n_results(); i++)
+    ASSERT_EQ(
+      parser.result(i).iden(), parser.result(parser.result(i).iden()).iden()
+    );
+}
+
+}  // namespace
@@ -0,0 +1,133 @@
+/**
+ * @file cdcl_dcln_index_test.cc
+ * @author Derek Huang
+ * @brief cdcl_dcln_index.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cdcl_dcln_index.hh"
+
+#include <cstddef>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "pdcpl/cdcl_parser.hh"
+#include "pdcpl/cdcl_type_spec.hh"
+#include "pdcpl/cdcl_type_table.hh"
+
+namespace {
+
+/**
+ * Test fixture class for declaration index tests.
+ */
+class CdclDclnIndexTest : public ::testing::Test {
+protected:
+  using ids_type = pdcpl::cdcl_dcln_index::ids_type;
+
+  /**
+   * Parse the declarations shared by the tests.
+   */
+  void SetUp() override
+  {
+    ASSERT_TRUE(
+      parser_.parse_string(
+        // 0, 1
+        "extern struct s *f(int, ...), g(t_t);\n"
+        // 2
+        "static int h(struct s *);\n"
+        // 3, 4
+        "extern char *p, a[3];\n"
+        // 5
+        "t_t x;\n"
+        // 6
+        "int printf(const char *, ...);"
+      )
+    ) << parser_.last_error();
+  }
+
+  pdcpl::cdcl_parser parser_;
+};
+
+/**
+ * Test that each index lists the expected declarations.
+ */
+TEST_F(CdclDclnIndexTest, KeyTest)
+{
+  pdcpl::cdcl_dcln_index index{parser_};
+  ASSERT_EQ(parser_.n_results(), index.size());
+  EXPECT_EQ((ids_type{0, 1}), index.type(pdcpl::cdcl_type::gstruct));
+  EXPECT_EQ((ids_type{2, 6}), index.type(pdcpl::cdcl_type::sint));
+  EXPECT_EQ((ids_type{5}), index.type(pdcpl::cdcl_type::gtype));
+  EXPECT_EQ((ids_type{0, 1}), index.type_iden("s"));
+  EXPECT_EQ((ids_type{0, 1, 2}), index.uses_iden("s"));
+  EXPECT_EQ((ids_type{1, 5}), index.uses_iden("t_t"));
+  EXPECT_TRUE(index.type_iden("u").empty());
+  EXPECT_EQ(
+    (ids_type{0, 1, 3, 4}), index.storage(pdcpl::cdcl_storage::st_extern)
+  );
+  EXPECT_EQ((ids_type{2}), index.storage(pdcpl::cdcl_storage::st_static));
+  EXPECT_EQ(
+    (ids_type{0, 1, 2, 6}), index.kind(pdcpl::cdcl_type_kind::function)
+  );
+  EXPECT_EQ((ids_type{3}), index.kind(pdcpl::cdcl_type_kind::pointer));
+  EXPECT_EQ((ids_type{4}), index.kind(pdcpl::cdcl_type_kind::array));
+  EXPECT_EQ((ids_type{5}), index.kind(pdcpl::cdcl_type_kind::base));
+  EXPECT_EQ((ids_type{0, 6}), index.variadic());
+  EXPECT_EQ((ids_type{3}), index.type_id(parser_.result_type(3)));
+}
+
+/**
+ * Test that queries combining keys intersect the id lists.
+ */
+TEST_F(CdclDclnIndexTest, IntersectTest)
+{
+  pdcpl::cdcl_dcln_index index{parser_};
+  // extern functions with struct s as their base type
+  auto ids = index.intersect(
+    {
+      index.storage(pdcpl::cdcl_storage::st_extern),
+      index.kind(pdcpl::cdcl_type_kind::function),
+      index.type_iden("s")
+    }
+  );
+  ASSERT_EQ((ids_type{0, 1}), ids);
+  // of which only f returns a pointer
+  const auto& types = parser_.types();
+  const auto& f_node = types.node(parser_.result_type(ids[0]));
+  EXPECT_EQ(
+    pdcpl::cdcl_type_kind::pointer, types.node(f_node.target()).kind()
+  );
+  // variadic functions returning int
+  EXPECT_EQ(
+    (ids_type{6}),
+    index.intersect(index.variadic(), index.type(pdcpl::cdcl_type::sint))
+  );
+  EXPECT_TRUE(index.intersect({}).empty());
+}
+
+/**
+ * Test that intersecting lists of very different sizes is correct.
+ */
+TEST(CdclDclnIndexStaticTest, GallopTest)
+{
+  pdcpl::cdcl_dcln_index::ids_type evens, threes, sevens;
+  for (unsigned int i = 0; i < 10000; i++) {
+    evens.push_back(2 * i);
+    threes.push_back(3 * i);
+  }
+  sevens = {0, 7, 14, 42, 420, 4242, 8400, 19998, 30000};
+  pdcpl::cdcl_dcln_index::ids_type expected;
+  for (auto id : sevens)
+    if (id % 6 == 0 && id < 20000)
+      expected.push_back(id);
+  EXPECT_EQ(
+    expected, pdcpl::cdcl_dcln_index::intersect({threes, sevens, evens})
+  );
+  EXPECT_EQ(
+    (pdcpl::cdcl_dcln_index::ids_type{0, 14, 42, 420, 4242, 8400, 19998}),
+    pdcpl::cdcl_dcln_index::intersect(evens, sevens)
+  );
+}
+
+}  // namespace
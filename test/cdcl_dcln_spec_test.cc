@@ -7,11 +7,19 @@
 
 #include "pdcpl/cdcl_dcln_spec.hh"
 
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "pdcpl/cdcl_memory.hh"
+#include "pdcpl/cdcl_type_spec.hh"
+
 namespace {
 
 /**
@@ -68,4 +76,123 @@ INSTANTIATE_TEST_SUITE_P(
   )
 );
 
+/**
+ * Memory resource that counts its live allocations.
+ */
+class counting_resource : public std::pmr::memory_resource {
+public:
+  /**
+   * Return the number of allocations not yet deallocated.
+   */
+  auto n_live() const noexcept { return n_live_; }
+
+  /**
+   * Return the total number of allocations made.
+   */
+  auto n_total() const noexcept { return n_total_; }
+
+private:
+  std::size_t n_live_{};
+  std::size_t n_total_{};
+
+  void* do_allocate(std::size_t bytes, std::size_t align) override
+  {
+    auto p = std::pmr::new_delete_resource()->allocate(bytes, align);
+    n_live_++;
+    n_total_++;
+    return p;
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+  {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    n_live_--;
+  }
+
+  bool do_is_equal(const memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+};
+
+/**
+ * Test that nodes allocate from the thread's resource and copies do not.
+ *
+ * Parameter declarators are shared, so they never allocate from the resource
+ * and stay valid after all the nodes that were allocated from it are freed.
+ */
+TEST_F(CdclDclnSpecTest, MemoryResourceTest)
+{
+  counting_resource arena;
+  std::shared_ptr<pdcpl::cdcl_dclr> shared_dclr;
+  std::string expected;
+  {
+    // function (pointer to double) returning pointer to int
+    pdcpl::cdcl_dclr dclr;
+    {
+      pdcpl::cdcl_memory_scope scope{&arena};
+      EXPECT_EQ(&arena, pdcpl::cdcl_memory_resource());
+      pdcpl::cdcl_dclr param_dclr;
+      param_dclr.append(pdcpl::cdcl_ptrs_spec{pdcpl::cdcl_qual::qnone});
+      pdcpl::cdcl_params_spec params;
+      params.append(
+        {pdcpl::cdcl_type_spec{pdcpl::cdcl_type::gdouble}, param_dclr}
+      );
+      pdcpl::cdcl_dclr func_dclr{"f"};
+      func_dclr.append(std::move(params));
+      func_dclr.append(pdcpl::cdcl_ptrs_spec{pdcpl::cdcl_qual::qnone});
+      // move assignment takes the arena along
+      dclr = std::move(func_dclr);
+    }
+    EXPECT_EQ(
+      std::pmr::get_default_resource(), pdcpl::cdcl_memory_resource()
+    );
+    EXPECT_NE(0U, arena.n_live());
+    // copies made outside the scope do not allocate from the arena
+    const auto n_total = arena.n_total();
+    auto copy = dclr;
+    std::vector<pdcpl::cdcl_dclr_spec> specs = dclr.specs();
+    EXPECT_EQ(n_total, arena.n_total());
+    ASSERT_EQ(2U, specs.size());
+    const auto& params = std::get<pdcpl::cdcl_params_spec>(dclr[0]);
+    ASSERT_EQ(1U, params.size());
+    shared_dclr = params[0].dclr();
+    ASSERT_TRUE(shared_dclr);
+    expected = static_cast<std::string>(*shared_dclr);
+    EXPECT_EQ(static_cast<std::string>(dclr), static_cast<std::string>(copy));
+    EXPECT_EQ(
+      "f: function (pointer to double) returning pointer to",
+      static_cast<std::string>(copy)
+    );
+  }
+  // the shared declarator outlives the nodes allocated from the arena
+  EXPECT_EQ(0U, arena.n_live());
+  EXPECT_EQ(expected, static_cast<std::string>(*shared_dclr));
+}
+
+/**
+ * Test that nodes can be built from and copied into `std::vector` values.
+ */
+TEST_F(CdclDclnSpecTest, VectorTest)
+{
+  pdcpl::cdcl_ptrs_spec::container_type quals{
+    pdcpl::cdcl_qual::qconst, pdcpl::cdcl_qual::qnone
+  };
+  pdcpl::cdcl_ptrs_spec ptrs{quals};
+  EXPECT_EQ(quals, ptrs.specs());
+  pdcpl::cdcl_init_dclrs dclrs{
+    pdcpl::cdcl_init_dclrs::container_type{pdcpl::cdcl_dclr{"a"}}
+  };
+  ASSERT_EQ(1U, dclrs.size());
+  std::vector<pdcpl::cdcl_init_dclr> dclr_vec = dclrs.init_dclrs();
+  ASSERT_EQ(1U, dclr_vec.size());
+  EXPECT_EQ("a", std::get<pdcpl::cdcl_dclr>(dclr_vec[0]).iden());
+  std::vector<pdcpl::cdcl_param_spec> int_params;
+  int_params.emplace_back(pdcpl::cdcl_type_spec{pdcpl::cdcl_type::sint});
+  pdcpl::cdcl_params_spec params{std::move(int_params), true};
+  std::vector<pdcpl::cdcl_param_spec> param_vec = params.specs();
+  ASSERT_EQ(1U, param_vec.size());
+  EXPECT_EQ(nullptr, param_vec[0].dclr());
+}
+
 }  // namespace
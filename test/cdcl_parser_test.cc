@@ -7,10 +7,16 @@
 
 #include "pdcpl/cdcl_parser.hh"
 
+#include <cstddef>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -101,10 +107,314 @@ TEST_P(DclParserParamTest, PureParseTest)
   ASSERT_TRUE(parser(test_data_dir() / GetParam())) << parser.last_error();
 }
 
+/**
+ * Test that parsing a file's contents from memory matches parsing the file.
+ */
+TEST_P(DclParserParamTest, StringParseTest)
+{
+  auto path = test_data_dir() / GetParam();
+  pdcpl::cdcl_parser file_parser;
+  ASSERT_TRUE(file_parser(path)) << file_parser.last_error();
+  // read file contents into string
+  std::ifstream f{path, std::ios::binary};
+  ASSERT_TRUE(f) << "could not open " << path;
+  std::stringstream ss;
+  ss << f.rdbuf();
+  auto text = ss.str();
+  pdcpl::cdcl_parser string_parser;
+  ASSERT_TRUE(string_parser.parse_string(text)) << string_parser.last_error();
+  ASSERT_EQ(file_parser.n_results(), string_parser.n_results());
+  for (std::size_t i = 0; i < file_parser.n_results(); i++) {
+    std::stringstream expected, actual;
+    expected << file_parser.result(i);
+    actual << string_parser.result(i);
+    EXPECT_EQ(expected.str(), actual.str());
+  }
+}
+
+/**
+ * Test that streamed declarations match the accumulated results in order.
+ */
+TEST_P(DclParserParamTest, StreamParseTest)
+{
+  auto path = test_data_dir() / GetParam();
+  pdcpl::cdcl_parser parser;
+  ASSERT_TRUE(parser(path)) << parser.last_error();
+  std::vector<std::string> dclns;
+  std::vector<pdcpl::cdcl_position> positions;
+  pdcpl::cdcl_parser stream_parser;
+  stream_parser.set_sink(
+    [&](const pdcpl::cdcl_dcln& dcln, const pdcpl::cdcl_position& position)
+    {
+      std::stringstream ss;
+      ss << dcln;
+      dclns.push_back(ss.str());
+      positions.push_back(position);
+    }
+  );
+  ASSERT_TRUE(stream_parser(path)) << stream_parser.last_error();
+  // nothing is accumulated while streaming
+  EXPECT_EQ(0U, stream_parser.n_results());
+  ASSERT_EQ(parser.n_results(), dclns.size());
+  for (std::size_t i = 0; i < parser.n_results(); i++) {
+    std::stringstream expected;
+    expected << parser.result(i);
+    EXPECT_EQ(expected.str(), dclns[i]);
+    EXPECT_EQ(parser.result_position(i).line, positions[i].line);
+    EXPECT_EQ(parser.result_position(i).column, positions[i].column);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
   ParseTest,
   DclParserParamTest,
   ::testing::Values("bdcl.in.1", "bdcl.in.2", "bdcl.in.3", "bdcl.in.4")
 );
 
+/**
+ * Return a string representation of a parser's results, one per line.
+ *
+ * @param parser Parser to print results for
+ */
+std::string results_string(const pdcpl::cdcl_parser& parser)
+{
+  std::stringstream ss;
+  for (const auto& dcln : parser.results())
+    ss << dcln << "\n";
+  return ss.str();
+}
+
+/**
+ * Test that separate parsers give the same results when run concurrently.
+ *
+ * Each thread parses every sample input, alternating between parsing files and
+ * parsing strings, and compares against single-threaded results.
+ */
+TEST_F(DclParserTest, ConcurrentParseTest)
+{
+  constexpr unsigned n_threads = 64;
+  constexpr unsigned n_rounds = 8;
+  const std::vector<std::string> files{
+    "bdcl.in.1", "bdcl.in.2", "bdcl.in.3", "bdcl.in.4"
+  };
+  // single-threaded expected results + file contents
+  std::vector<std::string> expected;
+  std::vector<std::string> texts;
+  for (const auto& file : files) {
+    pdcpl::cdcl_parser parser;
+    ASSERT_TRUE(parser(test_data_dir() / file)) << parser.last_error();
+    expected.push_back(results_string(parser));
+    std::ifstream f{test_data_dir() / file, std::ios::binary};
+    std::stringstream ss;
+    ss << f.rdbuf();
+    texts.push_back(ss.str());
+  }
+  // gtest assertions are thread-safe on POSIX but record failures to check
+  // from the main thread so reporting works on all platforms
+  std::vector<unsigned> n_failed(n_threads);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < n_threads; i++)
+    threads.emplace_back(
+      [&, i]
+      {
+        for (unsigned j = 0; j < n_rounds; j++) {
+          for (std::size_t k = 0; k < files.size(); k++) {
+            pdcpl::cdcl_parser parser;
+            auto status = (i + j) % 2 ?
+              parser.parse(test_data_dir() / files[k]) :
+              parser.parse_string(texts[k]);
+            if (!status || results_string(parser) != expected[k])
+              n_failed[i]++;
+          }
+        }
+      }
+    );
+  for (auto& thread : threads)
+    thread.join();
+  for (unsigned i = 0; i < n_threads; i++)
+    EXPECT_EQ(0U, n_failed[i]) << "thread " << i << " had failed parses";
+}
+
+/**
+ * Test that strings and buffers can be parsed repeatedly with one parser.
+ *
+ * Results accumulate across parses, so redeclarations are still caught.
+ */
+TEST(DclParserStringTest, RepeatedParseTest)
+{
+  pdcpl::cdcl_parser parser;
+  ASSERT_TRUE(parser.parse_string("int x; char *y[10];")) <<
+    parser.last_error();
+  EXPECT_EQ(2U, parser.n_results());
+  std::string_view text{"static double (*z)(int, ...);"};
+  ASSERT_TRUE(parser.parse_buffer(text.data(), text.size())) <<
+    parser.last_error();
+  EXPECT_EQ(3U, parser.n_results());
+  EXPECT_TRUE(parser.results_contain("z"));
+  EXPECT_TRUE(parser.parse_buffer(nullptr, 0U)) << parser.last_error();
+  EXPECT_FALSE(parser.parse_string("/* comment */ int x;"));
+  EXPECT_NE(std::string::npos, parser.last_error().find("redeclared"));
+  // unterminated comment must not affect the next parse
+  parser.parse_string("/* unterminated");
+  EXPECT_TRUE(parser.parse_string("int w;")) << parser.last_error();
+  EXPECT_TRUE(parser.results_contain("w"));
+}
+
+/**
+ * Test redeclaration checking and sink exceptions when streaming.
+ */
+TEST(DclParserStreamTest, RedeclaredTest)
+{
+  pdcpl::cdcl_parser parser;
+  std::vector<std::string> idens;
+  auto sink = [&](const pdcpl::cdcl_dcln& dcln, const pdcpl::cdcl_position&)
+  {
+    if (dcln.iden() == "stop")
+      throw std::runtime_error{"sink stopped"};
+    idens.push_back(dcln.iden());
+  };
+  parser.set_sink(sink);
+  // identifier hashes are kept across parses
+  ASSERT_TRUE(parser.parse_string("int x, y;")) << parser.last_error();
+  EXPECT_FALSE(parser.parse_string("char z; double *x;"));
+  EXPECT_NE(std::string::npos, parser.last_error().find("x redeclared"));
+  EXPECT_EQ((std::vector<std::string>{"x", "y", "z"}), idens);
+  // sink exceptions propagate and parsing can continue afterwards
+  EXPECT_THROW(parser.parse_string("int stop;"), std::runtime_error);
+  EXPECT_TRUE(parser.parse_string("int w;")) << parser.last_error();
+  // without checking, redeclarations are passed through
+  idens.clear();
+  parser.set_sink(sink, false);
+  ASSERT_TRUE(parser.parse_string("int x; char x[4];")) << parser.last_error();
+  EXPECT_EQ((std::vector<std::string>{"x", "x"}), idens);
+  EXPECT_EQ(0U, parser.n_results());
+  // resetting the sink resumes accumulating results
+  parser.set_sink({});
+  ASSERT_TRUE(parser.parse_string("int x;")) << parser.last_error();
+  EXPECT_TRUE(parser.results_contain("x"));
+}
+
+/**
+ * Test that identifier and array size tokens are converted correctly.
+ */
+TEST(DclParserStringTest, TokenTest)
+{
+  pdcpl::cdcl_parser parser;
+  // identifiers longer than any small string buffer
+  std::string func_name(100, 'f');
+  std::string type_name = "a_rather_long_type_name_t";
+  ASSERT_TRUE(
+    parser.parse_string(
+      "extern " + type_name + " *" + func_name + "(struct s_t [4000000000]);"
+    )
+  ) << parser.last_error();
+  ASSERT_TRUE(parser.results_contain(func_name));
+  std::stringstream ss;
+  ss << parser.result(func_name);
+  EXPECT_EQ(
+    func_name + ": function (array[4000000000] of struct s_t) returning " +
+      "pointer to extern typedef " + type_name,
+    ss.str()
+  );
+  // array sizes that do not fit are syntax errors
+  EXPECT_FALSE(parser.parse_string("int x[99999999999999999999999];"));
+  EXPECT_NE(std::string::npos, parser.last_error().find("out of range")) <<
+    parser.last_error();
+}
+
+/**
+ * Test that declarations can be looked up by any string-like identifier.
+ */
+TEST(DclParserStringTest, LookupTest)
+{
+  pdcpl::cdcl_parser parser;
+  // enough declarations for the identifier table to grow several times
+  constexpr std::size_t n_dclns = 1000;
+  std::string input;
+  for (std::size_t i = 0; i < n_dclns; i++)
+    input += "int x" + std::to_string(i) + ";\n";
+  ASSERT_TRUE(parser.parse_string(input)) << parser.last_error();
+  ASSERT_EQ(n_dclns, parser.n_results());
+  for (std::size_t i = 0; i < n_dclns; i++) {
+    auto iden = "x" + std::to_string(i);
+    ASSERT_TRUE(parser.results_contain(iden)) << iden;
+    EXPECT_EQ(&parser.result(i), &parser.result(iden));
+  }
+  // views need not be null-terminated
+  std::string_view line = "x42;";
+  EXPECT_EQ(&parser.result(42), &parser.result(line.substr(0, 3)));
+  EXPECT_EQ(&parser.result(7), &parser.result("x7"));
+  EXPECT_FALSE(parser.results_contain("x"));
+  EXPECT_FALSE(parser.results_contain(std::to_string(n_dclns)));
+  EXPECT_THROW(parser.result("x1000"), std::out_of_range);
+}
+
+/**
+ * Test that declarations of the same type share a type id.
+ */
+TEST(DclParserStringTest, TypeTest)
+{
+  pdcpl::cdcl_parser parser;
+  ASSERT_TRUE(
+    parser.parse_string(
+      "int (*f)(int, char *);\n"
+      "static int (*g)(int a, char *b), (*h)(int, char);\n"
+      "int (*k[2])(int, char *);"
+    )
+  ) << parser.last_error();
+  ASSERT_EQ(4U, parser.n_results());
+  // storage and parameter names are not part of the type
+  EXPECT_EQ(parser.result_type(0), parser.result_type(1));
+  EXPECT_NE(parser.result_type(0), parser.result_type(2));
+  const auto& types = parser.types();
+  EXPECT_EQ(
+    "pointer to function (signed int, pointer to char) returning signed int",
+    types.description(parser.result_type(0))
+  );
+  // the array element type is the type of f
+  const auto& k_node = types.node(parser.result_type(3));
+  ASSERT_EQ(pdcpl::cdcl_type_kind::array, k_node.kind());
+  EXPECT_EQ(2U, k_node.size());
+  EXPECT_EQ(parser.result_type(0), k_node.target());
+  // types are interned on demand, so later parses add to the same table
+  const auto n_types = types.size();
+  ASSERT_TRUE(
+    parser.parse_string("char **s;\nint (*p)(int, char *);")
+  ) << parser.last_error();
+  ASSERT_EQ(6U, parser.n_results());
+  EXPECT_EQ(parser.result_type(0), parser.result_type(5));
+  EXPECT_EQ(n_types + 1, parser.types().size());
+  EXPECT_EQ(
+    "pointer to pointer to char", types.description(parser.result_type(4))
+  );
+}
+
+/**
+ * Test that copied results outlive the parser and its arenas.
+ */
+TEST(DclParserStringTest, ResultsCopyTest)
+{
+  pdcpl::cdcl_parser::results_type results;
+  std::string expected;
+  {
+    pdcpl::cdcl_parser parser;
+    ASSERT_TRUE(parser.parse_string("int *f(char (*)[2], ...);")) <<
+      parser.last_error();
+    // failed + streamed parses must not affect the earlier results
+    EXPECT_FALSE(parser.parse_string("int g(double *h"));
+    parser.set_sink([](const auto&, const auto&) {});
+    ASSERT_TRUE(parser.parse_string("int f;")) << parser.last_error();
+    parser.set_sink({});
+    ASSERT_EQ(1U, parser.n_results());
+    std::stringstream ss;
+    ss << parser.result(0);
+    expected = ss.str();
+    results = parser.results();
+  }
+  ASSERT_EQ(1U, results.size());
+  std::stringstream ss;
+  ss << results[0];
+  EXPECT_EQ(expected, ss.str());
+}
+
 }  // namespace
@@ -0,0 +1,155 @@
+/**
+ * @file cdcl_type_table_test.cc
+ * @author Derek Huang
+ * @brief cdcl_type_table.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cdcl_type_table.hh"
+
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "pdcpl/cdcl_dcln_spec.hh"
+#include "pdcpl/cdcl_type_spec.hh"
+
+namespace {
+
+/**
+ * Test fixture class for type table tests.
+ */
+class CdclTypeTableTest : public ::testing::Test {
+protected:
+  /**
+   * Return a declarator for a pointer to a function.
+   *
+   * The declarator is `(*iden)(int a, char *b)` with identifiers given.
+   *
+   * @param iden Declarator identifier
+   * @param param_1 First parameter identifier
+   * @param param_2 Second parameter identifier
+   */
+  static auto func_ptr_dclr(
+    const std::string& iden,
+    const std::string& param_1,
+    const std::string& param_2)
+  {
+    pdcpl::cdcl_dclr param_2_dclr{param_2};
+    param_2_dclr.append(pdcpl::cdcl_ptrs_spec{pdcpl::cdcl_qual::qnone});
+    pdcpl::cdcl_dclr dclr{iden};
+    dclr.append(pdcpl::cdcl_ptrs_spec{pdcpl::cdcl_qual::qnone});
+    dclr.append(
+      pdcpl::cdcl_params_spec{
+        {
+          {int_spec_, pdcpl::cdcl_dclr{param_1}},
+          {char_spec_, std::move(param_2_dclr)}
+        }
+      }
+    );
+    return dclr;
+  }
+
+  static inline const pdcpl::cdcl_qtype_spec int_spec_{
+    pdcpl::cdcl_qual::qnone, pdcpl::cdcl_type::sint
+  };
+  static inline const pdcpl::cdcl_qtype_spec char_spec_{
+    pdcpl::cdcl_qual::qnone, pdcpl::cdcl_type::gchar
+  };
+};
+
+/**
+ * Test that base types are interned once.
+ */
+TEST_F(CdclTypeTableTest, BaseTest)
+{
+  pdcpl::cdcl_type_table types;
+  auto int_id = types.intern(int_spec_, nullptr);
+  EXPECT_EQ(int_id, types.intern(int_spec_, nullptr));
+  EXPECT_EQ(
+    int_id,
+    types.intern(
+      pdcpl::cdcl_dcln{
+        {pdcpl::cdcl_storage::st_static, int_spec_}, pdcpl::cdcl_dclr{"x"}
+      }
+    )
+  );
+  auto const_int_id = types.intern(
+    {pdcpl::cdcl_qual::qconst, pdcpl::cdcl_type::sint}, nullptr
+  );
+  EXPECT_NE(int_id, const_int_id);
+  auto a_id = types.intern({{pdcpl::cdcl_type::gstruct, "a"}}, nullptr);
+  auto b_id = types.intern({{pdcpl::cdcl_type::gstruct, "b"}}, nullptr);
+  EXPECT_NE(a_id, b_id);
+  EXPECT_EQ(4U, types.size());
+  EXPECT_EQ(pdcpl::cdcl_type_kind::base, types.node(a_id).kind());
+  EXPECT_EQ("a", types.node(a_id).spec().iden());
+  EXPECT_EQ("const signed int", types.description(const_int_id));
+  EXPECT_EQ("struct b", types.description(b_id));
+}
+
+/**
+ * Test that derived types are equal regardless of parameter names.
+ */
+TEST_F(CdclTypeTableTest, DerivedTest)
+{
+  pdcpl::cdcl_type_table types;
+  auto f_dclr = func_ptr_dclr("f", "a", "b");
+  auto g_dclr = func_ptr_dclr("g", "x", "y");
+  auto f_id = types.intern(int_spec_, &f_dclr);
+  auto g_id = types.intern(int_spec_, &g_dclr);
+  EXPECT_EQ(f_id, g_id);
+  EXPECT_NE(f_id, types.intern(char_spec_, &g_dclr));
+  EXPECT_EQ(
+    "pointer to function (signed int, pointer to char) returning signed int",
+    types.description(f_id)
+  );
+  // pointer -> function -> int, where targets and parameters come first
+  const auto& ptr_node = types.node(f_id);
+  ASSERT_EQ(pdcpl::cdcl_type_kind::pointer, ptr_node.kind());
+  EXPECT_EQ(pdcpl::cdcl_qual::qnone, ptr_node.qual());
+  EXPECT_LT(ptr_node.target(), f_id);
+  const auto& func_node = types.node(ptr_node.target());
+  ASSERT_EQ(pdcpl::cdcl_type_kind::function, func_node.kind());
+  EXPECT_FALSE(func_node.variadic());
+  ASSERT_EQ(2U, func_node.params().size());
+  EXPECT_EQ(types.intern(int_spec_, nullptr), func_node.params()[0]);
+  EXPECT_EQ(types.intern(int_spec_, nullptr), func_node.target());
+  EXPECT_EQ(
+    "pointer to char", types.description(func_node.params()[1])
+  );
+  // arrays of different sizes differ
+  pdcpl::cdcl_dclr a_dclr{"a"};
+  a_dclr.append(pdcpl::cdcl_array_spec{3});
+  pdcpl::cdcl_dclr b_dclr{"b"};
+  b_dclr.append(pdcpl::cdcl_array_spec{4});
+  auto a_id = types.intern(int_spec_, &a_dclr);
+  EXPECT_NE(a_id, types.intern(int_spec_, &b_dclr));
+  EXPECT_EQ("array[3] of signed int", types.description(a_id));
+}
+
+/**
+ * Test that merged tables map equal types to equal ids.
+ */
+TEST_F(CdclTypeTableTest, MergeTest)
+{
+  pdcpl::cdcl_type_table a_types;
+  pdcpl::cdcl_type_table b_types;
+  auto f_dclr = func_ptr_dclr("f", "a", "b");
+  auto char_id = b_types.intern(char_spec_, nullptr);
+  auto f_id = b_types.intern(int_spec_, &f_dclr);
+  auto a_f_id = a_types.intern(int_spec_, &f_dclr);
+  auto ids = a_types.merge(b_types);
+  ASSERT_EQ(b_types.size(), ids.size());
+  EXPECT_EQ(a_f_id, ids[f_id]);
+  EXPECT_EQ(a_types.intern(char_spec_, nullptr), ids[char_id]);
+  EXPECT_EQ(b_types.description(f_id), a_types.description(ids[f_id]));
+  // moved-to table keeps ids
+  auto size = a_types.size();
+  pdcpl::cdcl_type_table c_types{std::move(a_types)};
+  EXPECT_EQ(size, c_types.size());
+  EXPECT_EQ(a_f_id, c_types.intern(int_spec_, &f_dclr));
+}
+
+}  // namespace
@@ -0,0 +1,32 @@
+/**
+ * @file clock_test.cc
+ * @author Derek Huang
+ * @brief clock.h unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/clock.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace {
+
+/**
+ * Test that clock readings don't go backwards and advance over time.
+ */
+TEST(ClockTest, MonotonicTest)
+{
+  std::uint64_t prev = pdcpl_clock_ns();
+  std::uint64_t start = prev;
+  // spin until the clock advances, checking readings never decrease
+  while (prev == start) {
+    auto now = pdcpl_clock_ns();
+    ASSERT_GE(now, prev);
+    prev = now;
+  }
+  EXPECT_GT(prev, start);
+}
+
+}  // namespace
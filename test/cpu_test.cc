@@ -0,0 +1,118 @@
+/**
+ * @file cpu_test.cc
+ * @author Derek Huang
+ * @brief cpu.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/cpu.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+/**
+ * Main CPU test fixture.
+ */
+class CpuTest : public ::testing::Test {};
+
+/**
+ * Test that level names and parsing round trip.
+ */
+TEST_F(CpuTest, LevelNameTest)
+{
+  for (int i = 0; i < PDCPL_CPU_LEVEL_MAX; i++) {
+    auto level = static_cast<pdcpl_cpu_level>(i);
+    auto name = pdcpl_cpu_level_name(level);
+    ASSERT_TRUE(name);
+    pdcpl_cpu_level parsed;
+    ASSERT_FALSE(pdcpl_cpu_level_parse(name, &parsed));
+    EXPECT_EQ(level, parsed);
+  }
+  pdcpl_cpu_level level;
+  ASSERT_FALSE(pdcpl_cpu_level_parse("AVX2", &level));
+  EXPECT_EQ(PDCPL_CPU_LEVEL_AVX2, level);
+  EXPECT_EQ(-EINVAL, pdcpl_cpu_level_parse("avx3", &level));
+  EXPECT_EQ(-EINVAL, pdcpl_cpu_level_parse("avx", nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_cpu_level_parse(nullptr, &level));
+  EXPECT_FALSE(pdcpl_cpu_level_name(PDCPL_CPU_LEVEL_MAX));
+}
+
+/**
+ * Test that levels and their required features are consistent.
+ */
+TEST_F(CpuTest, LevelFeaturesTest)
+{
+  for (int i = 0; i < PDCPL_CPU_LEVEL_MAX; i++) {
+    auto level = static_cast<pdcpl_cpu_level>(i);
+    auto features = pdcpl_cpu_level_features(level);
+    EXPECT_EQ(level, pdcpl_cpu_features_level(features));
+    // each level requires all the features of the previous level
+    if (i) {
+      auto prev = pdcpl_cpu_level_features(static_cast<pdcpl_cpu_level>(i - 1));
+      EXPECT_EQ(prev, features & prev);
+    }
+  }
+  // AVX2 without BMI2 is only AVX
+  auto features = pdcpl_cpu_level_features(PDCPL_CPU_LEVEL_AVX2);
+  EXPECT_EQ(
+    PDCPL_CPU_LEVEL_AVX, pdcpl_cpu_features_level(features & ~PDCPL_CPU_BMI2)
+  );
+  EXPECT_EQ(0u, pdcpl_cpu_level_features(PDCPL_CPU_LEVEL_MAX));
+}
+
+/**
+ * Test that cached features are a subset of the detected features.
+ */
+TEST_F(CpuTest, FeaturesTest)
+{
+  auto detected = pdcpl_cpu_detect();
+  auto features = pdcpl_cpu_features();
+  EXPECT_EQ(features, detected & features);
+  EXPECT_EQ(features, pdcpl_cpu_features());
+  EXPECT_EQ(pdcpl_cpu_features_level(features), pdcpl_cpu_get_level());
+  // the override caps the level
+  pdcpl_cpu_level cap;
+  if (!pdcpl_cpu_level_parse(std::getenv(PDCPL_CPU_LEVEL_ENV), &cap))
+    EXPECT_LE(pdcpl_cpu_get_level(), cap);
+  else
+    EXPECT_EQ(detected, features);
+#if defined(__x86_64__) || defined(_M_X64)
+  // SSE2 is part of the x64 baseline
+  EXPECT_TRUE(detected & PDCPL_CPU_SSE2);
+#endif  // !defined(__x86_64__) && !defined(_M_X64)
+  EXPECT_EQ(
+    (features & PDCPL_CPU_AVX) != 0, pdcpl_cpu_has(PDCPL_CPU_AVX)
+  );
+}
+
+// dispatch test kernels, which record which kernel was called
+int dispatch_called;
+void dispatch_low() { dispatch_called = 1; }
+void dispatch_high() { dispatch_called = 2; }
+
+/**
+ * Test that dispatch selects the highest usable kernel.
+ */
+TEST_F(CpuTest, SelectTest)
+{
+  const pdcpl_cpu_impl impls[] = {
+    {PDCPL_CPU_LEVEL_AVX512, dispatch_high},
+    {PDCPL_CPU_LEVEL_BASELINE, dispatch_low}
+  };
+  EXPECT_EQ(
+    dispatch_high, pdcpl_cpu_select(impls, 2, PDCPL_CPU_LEVEL_AVX512)
+  );
+  EXPECT_EQ(dispatch_low, pdcpl_cpu_select(impls, 2, PDCPL_CPU_LEVEL_AVX2));
+  EXPECT_FALSE(pdcpl_cpu_select(impls, 1, PDCPL_CPU_LEVEL_SSE2));
+  EXPECT_FALSE(pdcpl_cpu_select(nullptr, 2, PDCPL_CPU_LEVEL_SSE2));
+  pdcpl_cpu_select(impls, 2, pdcpl_cpu_get_level())();
+  auto expected = (pdcpl_cpu_get_level() == PDCPL_CPU_LEVEL_AVX512) ? 2 : 1;
+  EXPECT_EQ(expected, dispatch_called);
+}
+
+}  // namespace
@@ -0,0 +1,198 @@
+/**
+ * @file dsv_test.cc
+ * @author Derek Huang
+ * @brief dsv.(c|h) unit test
+ * @copyright MIT License
+ */
+
+#include "pdcpl/dsv.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+#include "pdcpl/variant.h"
+
+namespace {
+
+/**
+ * Main test fixture for delimiter-separated values tests.
+ *
+ * Holds the writable input buffer and frees the table after each test.
+ */
+class DsvTest : public ::testing::Test {
+protected:
+  void TearDown() override
+  {
+    ASSERT_FALSE(pdcpl_dsv_table_free(&table_));
+  }
+
+  /**
+   * Parse the given text, which is copied into the writable buffer.
+   *
+   * @param text Input records
+   * @param opts Parsing options
+   */
+  int parse(const std::string& text, const pdcpl_dsv_options& opts)
+  {
+    buf_ = text;
+    return pdcpl_dsv_parse(buf_.data(), buf_.size(), &opts, &table_);
+  }
+
+  /**
+   * Return the value in the given output column and row.
+   */
+  const pdcpl_variant& value(std::size_t col, std::size_t row) const
+  {
+    return pdcpl_dsv_column_values(table_.columns + col)[row];
+  }
+
+  // std::string guarantees a writable terminating null since C++11
+  std::string buf_;
+  pdcpl_dsv_table table_{};
+};
+
+/**
+ * Test that TSV numeric and string column types are inferred.
+ */
+TEST_F(DsvTest, InferTest)
+{
+  ASSERT_FALSE(
+    parse("1\t2.5\tabc\n-7\t1e3\tdef\n", pdcpl_dsv_options_default('\t'))
+  );
+  ASSERT_EQ(3U, table_.n_columns);
+  ASSERT_EQ(2U, table_.n_rows);
+  EXPECT_EQ(pdcpl_variant_int, table_.columns[0].type);
+  EXPECT_EQ(pdcpl_variant_double, table_.columns[1].type);
+  EXPECT_EQ(pdcpl_variant_string, table_.columns[2].type);
+  EXPECT_EQ(1, value(0, 0).data.i);
+  EXPECT_EQ(-7, value(0, 1).data.i);
+  EXPECT_DOUBLE_EQ(2.5, value(1, 0).data.d);
+  EXPECT_DOUBLE_EQ(1e3, value(1, 1).data.d);
+  EXPECT_STREQ("abc", value(2, 0).data.s);
+  EXPECT_STREQ("def", value(2, 1).data.s);
+  // strings are borrowed slices of the input buffer
+  EXPECT_EQ(buf_.data() + 6, value(2, 0).data.s);
+  EXPECT_EQ(0U, value(2, 0).flags & pdcpl_variant_mem_own);
+}
+
+/**
+ * Test quoted CSV fields with doubled quotes, delimiters, and newlines.
+ */
+TEST_F(DsvTest, QuoteTest)
+{
+  auto opts = pdcpl_dsv_options_default(',');
+  opts.header = true;
+  ASSERT_FALSE(
+    parse(
+      "name,\"note\"\r\n"
+      "\"a, b\",\"say \"\"hi\"\"\"\r\n"
+      "c,\"two\nlines\"\r\n"
+      "\r\n",
+      opts
+    )
+  );
+  ASSERT_EQ(2U, table_.n_columns);
+  ASSERT_EQ(2U, table_.n_rows);
+  EXPECT_STREQ("name", table_.columns[0].name);
+  EXPECT_STREQ("note", table_.columns[1].name);
+  EXPECT_STREQ("a, b", value(0, 0).data.s);
+  EXPECT_STREQ("say \"hi\"", value(1, 0).data.s);
+  EXPECT_STREQ("c", value(0, 1).data.s);
+  EXPECT_STREQ("two\nlines", value(1, 1).data.s);
+}
+
+/**
+ * Test that projection reads only selected columns, in the given order.
+ */
+TEST_F(DsvTest, ProjectTest)
+{
+  // unselected fields would fail conversion if they were materialized
+  const unsigned int types[] = {
+    pdcpl_variant_int, pdcpl_variant_int, pdcpl_variant_int, pdcpl_variant_int
+  };
+  const std::size_t columns[] = {3, 1};
+  auto opts = pdcpl_dsv_options_default(',');
+  opts.types = types;
+  opts.n_types = std::size(types);
+  opts.columns = columns;
+  opts.n_columns = std::size(columns);
+  ASSERT_FALSE(parse("x,10,y,20,z\nx,11,y,21,z,extra\n", opts));
+  ASSERT_EQ(2U, table_.n_columns);
+  ASSERT_EQ(2U, table_.n_rows);
+  EXPECT_EQ(3U, table_.columns[0].index);
+  EXPECT_EQ(1U, table_.columns[1].index);
+  EXPECT_EQ(20, value(0, 0).data.i);
+  EXPECT_EQ(21, value(0, 1).data.i);
+  EXPECT_EQ(10, value(1, 0).data.i);
+  EXPECT_EQ(11, value(1, 1).data.i);
+}
+
+/**
+ * Test explicit column types.
+ */
+TEST_F(DsvTest, TypesTest)
+{
+  const unsigned int types[] = {
+    pdcpl_variant_char,
+    pdcpl_variant_uint,
+    pdcpl_variant_size,
+    pdcpl_variant_float,
+    pdcpl_variant_string
+  };
+  auto opts = pdcpl_dsv_options_default('|');
+  opts.types = types;
+  opts.n_types = std::size(types);
+  ASSERT_FALSE(parse("a|4000000000|123|0.5|42", opts));
+  ASSERT_EQ(1U, table_.n_rows);
+  EXPECT_EQ('a', value(0, 0).data.c);
+  EXPECT_EQ(4000000000U, value(1, 0).data.u);
+  EXPECT_EQ(123U, value(2, 0).data.z);
+  EXPECT_FLOAT_EQ(0.5f, value(3, 0).data.f);
+  EXPECT_STREQ("42", value(4, 0).data.s);
+}
+
+/**
+ * Test that many rows are read as the columns grow.
+ */
+TEST_F(DsvTest, GrowthTest)
+{
+  constexpr int n_rows = 2000;
+  std::string text;
+  for (int i = 0; i < n_rows; i++)
+    text += std::to_string(i) + ",row" + std::to_string(i) + "\n";
+  ASSERT_FALSE(parse(text, pdcpl_dsv_options_default(',')));
+  ASSERT_EQ(static_cast<std::size_t>(n_rows), table_.n_rows);
+  for (int i = 0; i < n_rows; i++) {
+    ASSERT_EQ(i, value(0, i).data.i);
+    ASSERT_EQ("row" + std::to_string(i), value(1, i).data.s);
+  }
+}
+
+/**
+ * Test that errors report the failing record and free the table.
+ */
+TEST_F(DsvTest, ErrorTest)
+{
+  auto opts = pdcpl_dsv_options_default(',');
+  // type inferred as int from the first record
+  EXPECT_EQ(-EINVAL, parse("1,2\n3,4\n5,x\n", opts));
+  EXPECT_EQ(2U, table_.error_record);
+  EXPECT_FALSE(table_.columns);
+  // missing column
+  EXPECT_EQ(-EINVAL, parse("1,2\n3\n", opts));
+  EXPECT_EQ(1U, table_.error_record);
+  // out of range
+  EXPECT_EQ(-ERANGE, parse("1\n99999999999\n", opts));
+  EXPECT_EQ(1U, table_.error_record);
+  // unterminated quote
+  EXPECT_EQ(-EINVAL, parse("\"abc\n", opts));
+  // quote can't be the delimiter
+  opts.quote = ',';
+  EXPECT_EQ(-EINVAL, parse("1,2\n", opts));
+}
+
+}  // namespace
@@ -14,6 +14,7 @@
 #endif  // _WIN32
 
 #include <cerrno>
+#include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -205,4 +206,69 @@ PDCPL_MSVC_WARNING_ENABLE()
 #endif  // !defined(_WIN32)
 }
 
+/**
+ * Write a string to a file in binary mode.
+ *
+ * @param path File path
+ * @param text Text to write
+ */
+void write_file(const char* path, const std::string& text)
+{
+  pdcpl::unique_file f{std::fopen(path, "wb")};
+  ASSERT_TRUE(f) << pdcpl::errno_message();
+  ASSERT_EQ(text.size(), std::fwrite(text.data(), 1U, text.size(), f.get()));
+}
+
+/**
+ * Test that `pdcpl_file_map_open` maps contents followed by zero padding.
+ *
+ * Sizes on either side of a common page size are used so that the padding
+ * falls in both the file's last page and in the pages reserved after it.
+ */
+TEST_F(FileTest, FileMapTest)
+{
+  const char* path = "pdcpl_file_map_test.txt";
+  for (std::size_t size : {1U, 100U, 4095U, 4096U, 10000U}) {
+    std::string text;
+    for (std::size_t i = 0; i < size; i++)
+      text += static_cast<char>('a' + i % 26);
+    write_file(path, text);
+    pdcpl_file_map map;
+    ASSERT_FALSE(pdcpl_file_map_open(&map, path, 2U)) << "size: " << size;
+    ASSERT_EQ(size, map.size);
+    EXPECT_EQ(text, std::string(map.data, map.size));
+    EXPECT_EQ('\0', map.data[size]);
+    EXPECT_EQ('\0', map.data[size + 1]);
+    // writes are private to the mapping
+    map.data[0] = '!';
+    EXPECT_FALSE(pdcpl_file_map_close(&map));
+    EXPECT_FALSE(map.data);
+    ASSERT_FALSE(pdcpl_file_map_open(&map, path, 0U));
+    EXPECT_EQ(text, std::string(map.data, map.size));
+    EXPECT_FALSE(pdcpl_file_map_close(&map));
+  }
+  EXPECT_EQ(0, std::remove(path)) << pdcpl::errno_message();
+}
+
+/**
+ * Test that `pdcpl_file_map_open` handles empty and missing files.
+ */
+TEST_F(FileTest, FileMapEmptyTest)
+{
+  const char* path = "pdcpl_file_map_empty_test.txt";
+  write_file(path, "");
+  pdcpl_file_map map;
+  ASSERT_FALSE(pdcpl_file_map_open(&map, path, 2U));
+  EXPECT_EQ(0U, map.size);
+  EXPECT_EQ(0U, map.map_size);
+  EXPECT_EQ('\0', map.data[0]);
+  EXPECT_EQ('\0', map.data[1]);
+  EXPECT_FALSE(pdcpl_file_map_close(&map));
+  EXPECT_EQ(0, std::remove(path)) << pdcpl::errno_message();
+  EXPECT_EQ(-ENOENT, pdcpl_file_map_open(&map, path, 2U));
+  EXPECT_EQ(-EINVAL, pdcpl_file_map_open(nullptr, path, 2U));
+  EXPECT_EQ(-EINVAL, pdcpl_file_map_open(&map, nullptr, 2U));
+  EXPECT_EQ(-EINVAL, pdcpl_file_map_close(nullptr));
+}
+
 }  // namespace
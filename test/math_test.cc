@@ -7,9 +7,12 @@
 
 #include "pdcpl/math.h"
 
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -48,4 +51,63 @@ INSTANTIATE_TEST_SUITE_P(
   )
 );
 
+/**
+ * Test fixture for array and ULP comparison tests.
+ */
+class MathArrayTest : public ::testing::Test {};
+
+/**
+ * Test that `pdcpl_double_near_array` matches `pdcpl_double_near`.
+ */
+TEST_F(MathArrayTest, NearArrayTest)
+{
+  // length not a multiple of any vector width or the mask word size
+  constexpr std::size_t n = 131;
+  constexpr double eps = 0.5;
+  std::vector<double> a(n), b(n);
+  for (std::size_t i = 0; i < n; i++) {
+    a[i] = 0.1 * i;
+    b[i] = a[i] + ((i % 3) ? 0.25 : -0.75);
+  }
+  b[7] = std::numeric_limits<double>::quiet_NaN();
+  std::vector<std::uint64_t> mask(pdcpl_mask_words(n), ~std::uint64_t{});
+  ASSERT_FALSE(
+    pdcpl_double_near_array(a.data(), b.data(), n, -eps, mask.data())
+  );
+  for (std::size_t i = 0; i < n; i++) {
+    EXPECT_EQ(
+      pdcpl_double_near(a[i], b[i], eps), (mask[i / 64] >> (i % 64)) & 1
+    ) << "i = " << i;
+  }
+  // unused high bits are cleared
+  EXPECT_FALSE(mask.back() >> (n % 64));
+}
+
+/**
+ * Test ULP distance and ULP array comparison.
+ */
+TEST_F(MathArrayTest, UlpTest)
+{
+  constexpr auto inf = std::numeric_limits<double>::infinity();
+  constexpr auto denorm_min = std::numeric_limits<double>::denorm_min();
+  EXPECT_EQ(0U, pdcpl_double_ulp_distance(0., -0.));
+  EXPECT_EQ(1U, pdcpl_double_ulp_distance(1., std::nextafter(1., 2.)));
+  EXPECT_EQ(2U, pdcpl_double_ulp_distance(-denorm_min, denorm_min));
+  EXPECT_EQ(
+    UINT64_MAX,
+    pdcpl_double_ulp_distance(std::numeric_limits<double>::quiet_NaN(), 1.)
+  );
+  EXPECT_EQ(1U, pdcpl_double_ulp_distance(inf, std::nextafter(inf, 0.)));
+  // ULP tolerance scales with magnitude, unlike an absolute tolerance
+  const double a[] = {1e-300, 1e300, 0.1 + 0.2};
+  const double b[] = {
+    std::nextafter(1e-300, 1.), std::nextafter(1e300, 0.), 0.3
+  };
+  std::uint64_t mask;
+  ASSERT_FALSE(pdcpl_double_ulp_near_array(a, b, 3, 1, &mask));
+  EXPECT_EQ(0x7U, mask);
+  ASSERT_FALSE(pdcpl_double_ulp_near_array(a, b, 3, 0, &mask));
+  EXPECT_EQ(0U, mask);
+}
+
 }  // namespace
@@ -7,6 +7,12 @@
 
 #include <gtest/gtest.h>
 
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "pdcpl/memory.h"
 #include "pdcpl/misc.h"
 
 namespace {
@@ -29,4 +35,89 @@ TEST_F(MiscTest, TempTest)
   EXPECT_DOUBLE_EQ(freezing_f, pdcpl_c2ftemp(freezing_c));
 }
 
+/**
+ * Test that array conversions match scalar conversions exactly.
+ */
+TEST_F(MiscTest, TempArrayTest)
+{
+  constexpr std::size_t n = 1001;
+  std::vector<double> in(n), out(n);
+  for (std::size_t i = 0; i < n; i++)
+    in[i] = -200. + 0.37 * i;
+  pdcpl_f2ctemp_array(in.data(), out.data(), n);
+  for (std::size_t i = 0; i < n; i++)
+    ASSERT_EQ(pdcpl_f2ctemp(in[i]), out[i]) << "i = " << i;
+  pdcpl_c2ftemp_array(in.data(), out.data(), n);
+  for (std::size_t i = 0; i < n; i++)
+    ASSERT_EQ(pdcpl_c2ftemp(in[i]), out[i]) << "i = " << i;
+  // in place conversion
+  auto expected = pdcpl_c2ftemp(in[5]);
+  pdcpl_c2ftemp_array(in.data(), in.data(), n);
+  EXPECT_EQ(expected, in[5]);
+}
+
+/**
+ * Test conversion table formatting, ascending and descending.
+ */
+TEST_F(MiscTest, ConvTableTest)
+{
+  pdcpl_convtable_spec spec{
+    {"F.", 6, 0}, {"C.", 6, 1}, 0, 40, 20, pdcpl_f2ctemp_array
+  };
+  pdcpl_buffer table;
+  std::size_t size;
+  ASSERT_FALSE(pdcpl_convtable_format(&spec, &table, &size));
+  EXPECT_EQ(
+    "+--------+--------+\n"
+    "|     F. |     C. |\n"
+    "+--------+--------+\n"
+    "|      0 |  -17.8 |\n"
+    "|     20 |   -6.7 |\n"
+    "|     40 |    4.4 |\n"
+    "+--------+--------+\n",
+    std::string(static_cast<const char*>(table.data), size)
+  );
+  pdcpl_buffer_clear(&table);
+  spec = {{"C.", 6, 0}, {"F.", 6, 1}, 100, 0, -100, pdcpl_c2ftemp_array};
+  ASSERT_FALSE(pdcpl_convtable_format(&spec, &table, &size));
+  std::string text{static_cast<const char*>(table.data), size};
+  EXPECT_NE(
+    std::string::npos, text.find("|    100 |  212.0 |\n|      0 |   32.0 |")
+  );
+  pdcpl_buffer_clear(&table);
+  // other column widths and precisions
+  spec = {{"K", 3, 0}, {"Celsius", 8, 3}, 0, 10, 10, pdcpl_f2ctemp_array};
+  ASSERT_FALSE(pdcpl_convtable_format(&spec, &table, &size));
+  EXPECT_EQ(
+    "+-----+----------+\n"
+    "|   K |  Celsius |\n"
+    "+-----+----------+\n"
+    "|   0 |  -17.778 |\n"
+    "|  10 |  -12.222 |\n"
+    "+-----+----------+\n",
+    std::string(static_cast<const char*>(table.data), size)
+  );
+  pdcpl_buffer_clear(&table);
+  // values wider than the column widen their rows only
+  spec = {{"F.", 1, 0}, {"C.", 1, 0}, 100, 100, 1, pdcpl_f2ctemp_array};
+  ASSERT_FALSE(pdcpl_convtable_format(&spec, &table, &size));
+  EXPECT_EQ(
+    "+---+---+\n| F. | C. |\n+---+---+\n| 100 | 38 |\n+---+---+\n",
+    std::string(static_cast<const char*>(table.data), size)
+  );
+  pdcpl_buffer_clear(&table);
+  // zero or too large widths and precisions
+  spec.in.width = 0;
+  EXPECT_EQ(-EINVAL, pdcpl_convtable_format(&spec, &table, &size));
+  spec.in.width = PDCPL_CONVTABLE_WIDTH_MAX + 1;
+  EXPECT_EQ(-EINVAL, pdcpl_convtable_format(&spec, &table, &size));
+  spec.in.width = 6;
+  spec.out.precision = PDCPL_CONVTABLE_WIDTH_MAX + 1;
+  EXPECT_EQ(-EINVAL, pdcpl_convtable_format(&spec, &table, &size));
+  // step goes away from stop
+  spec.out.precision = 1;
+  spec.stop = 0;
+  EXPECT_EQ(-EINVAL, pdcpl_convtable_format(&spec, &table, &size));
+}
+
 }  // namespace
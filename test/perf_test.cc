@@ -0,0 +1,146 @@
+/**
+ * @file perf_test.cc
+ * @author Derek Huang
+ * @brief perf.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/perf.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+/**
+ * Main perf test fixture.
+ *
+ * Counters are often unavailable in containers and virtual machines, so tests
+ * that need them are skipped if the group cannot be opened.
+ */
+class PerfTest : public ::testing::Test {
+protected:
+  void SetUp() override
+  {
+    open_status_ = pdcpl_perf_open(&group_);
+  }
+
+  void TearDown() override
+  {
+    pdcpl_perf_close(&group_);
+  }
+
+  /**
+   * Return what `pdcpl_perf_fprintf` writes as a string.
+   *
+   * @param counters Counter values
+   * @param bytes Number of bytes processed
+   * @param json `true` to write JSON
+   */
+  static std::string format(
+    const pdcpl_perf_counters& counters, std::uint64_t bytes, bool json)
+  {
+    auto f = std::tmpfile();
+    if (!f)
+      return "";
+    EXPECT_FALSE(pdcpl_perf_fprintf(f, &counters, bytes, json));
+    std::rewind(f);
+    std::string out;
+    for (int c; (c = std::fgetc(f)) != EOF; )
+      out += static_cast<char>(c);
+    std::fclose(f);
+    return out;
+  }
+
+  pdcpl_perf_group group_;
+  int open_status_;
+};
+
+/**
+ * Test that event names are defined.
+ */
+TEST_F(PerfTest, EventNameTest)
+{
+  for (int i = 0; i < PDCPL_PERF_EVENT_MAX; i++)
+    EXPECT_TRUE(pdcpl_perf_event_name(static_cast<pdcpl_perf_event>(i)));
+  EXPECT_EQ(std::string{"cycles"}, pdcpl_perf_event_name(PDCPL_PERF_CYCLES));
+  EXPECT_FALSE(pdcpl_perf_event_name(PDCPL_PERF_EVENT_MAX));
+}
+
+/**
+ * Test that opening either succeeds or fails with no events.
+ */
+TEST_F(PerfTest, OpenTest)
+{
+  if (open_status_) {
+    EXPECT_LT(open_status_, 0);
+    EXPECT_EQ(0u, group_.events);
+    for (auto fd : group_.fds)
+      EXPECT_EQ(-1, fd);
+    pdcpl_perf_counters counters;
+    EXPECT_EQ(-EINVAL, pdcpl_perf_start(&group_));
+    EXPECT_EQ(-EINVAL, pdcpl_perf_stop(&group_, &counters));
+  }
+  else
+    EXPECT_NE(0u, group_.events);
+  EXPECT_EQ(-EINVAL, pdcpl_perf_open(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_perf_read(nullptr, nullptr));
+}
+
+/**
+ * Test that counting a loop counts instructions.
+ */
+TEST_F(PerfTest, CountTest)
+{
+  if (open_status_)
+    GTEST_SKIP() << "perf counters unavailable: " << open_status_;
+  ASSERT_FALSE(pdcpl_perf_start(&group_));
+  volatile std::uint64_t total = 0;
+  for (std::uint64_t i = 0; i < 100000; i++)
+    total = total + i;
+  pdcpl_perf_counters counters;
+  ASSERT_FALSE(pdcpl_perf_stop(&group_, &counters));
+  EXPECT_EQ(group_.events, counters.events);
+  if (!pdcpl_perf_has(&counters, PDCPL_PERF_INSTRUCTIONS))
+    return;
+  EXPECT_GE(counters.values[PDCPL_PERF_INSTRUCTIONS], 100000u);
+  // counters are reset on start
+  ASSERT_FALSE(pdcpl_perf_start(&group_));
+  pdcpl_perf_counters restarted;
+  ASSERT_FALSE(pdcpl_perf_stop(&group_, &restarted));
+  EXPECT_LT(
+    restarted.values[PDCPL_PERF_INSTRUCTIONS],
+    counters.values[PDCPL_PERF_INSTRUCTIONS]
+  );
+}
+
+/**
+ * Test that counters and derived rates are formatted.
+ */
+TEST_F(PerfTest, FprintfTest)
+{
+  pdcpl_perf_counters counters{};
+  EXPECT_EQ("perf counters:  unavailable\n", format(counters, 0, false));
+  EXPECT_EQ("null", format(counters, 0, true));
+  counters.events = (1u << PDCPL_PERF_CYCLES) | (1u << PDCPL_PERF_INSTRUCTIONS);
+  counters.values[PDCPL_PERF_CYCLES] = 1000;
+  counters.values[PDCPL_PERF_INSTRUCTIONS] = 2500;
+  EXPECT_DOUBLE_EQ(2.5, pdcpl_perf_ipc(&counters));
+  EXPECT_EQ(
+    "{\"cycles\": 1000, \"cycles_per_byte\": 10.0000, "
+    "\"instructions\": 2500, \"instructions_per_byte\": 25.0000, "
+    "\"ipc\": 2.500}",
+    format(counters, 100, true)
+  );
+  auto text = format(counters, 0, false);
+  EXPECT_NE(std::string::npos, text.find("cycles:"));
+  EXPECT_NE(std::string::npos, text.find("ipc:"));
+  EXPECT_EQ(std::string::npos, text.find("/byte"));
+  EXPECT_EQ(-EINVAL, pdcpl_perf_fprintf(nullptr, &counters, 0, false));
+}
+
+}  // namespace
@@ -0,0 +1,191 @@
+/**
+ * @file pipeline_test.cc
+ * @author Derek Huang
+ * @brief pipeline.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/pipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <tuple>
+
+namespace {
+
+/**
+ * Transform a string through a pipeline in blocks of the given size.
+ *
+ * @param pipeline Pipeline handle
+ * @param in Input string
+ * @param block_size Number of bytes per block
+ */
+std::string transform(
+  pdcpl_pipeline* pipeline, const std::string& in, std::size_t block_size)
+{
+  std::string out;
+  for (std::size_t i = 0; i < in.size(); i += block_size) {
+    auto n = std::min(block_size, in.size() - i);
+    const char* block;
+    std::size_t block_out_size;
+    EXPECT_FALSE(
+      pdcpl_pipeline_process(
+        pipeline, in.data() + i, n, &block, &block_out_size
+      )
+    );
+    out.append(block, block_out_size);
+  }
+  return out;
+}
+
+/**
+ * Test fixture for pipeline transforms.
+ *
+ * Parameters are the pipeline specification, input, and expected output.
+ */
+class PipelineTest
+  : public ::testing::TestWithParam<
+      std::tuple<const char*, const char*, const char*>
+    > {};
+
+/**
+ * Test that a pipeline gives the same output for any block size.
+ */
+TEST_P(PipelineTest, TransformTest)
+{
+  const auto& [spec, in, expected] = GetParam();
+  std::string input{in};
+  for (std::size_t block_size : {1u, 2u, 3u, 7u, 4096u}) {
+    pdcpl_pipeline* pipeline;
+    ASSERT_FALSE(pdcpl_pipeline_create(&pipeline, spec, block_size));
+    EXPECT_EQ(block_size, pdcpl_pipeline_block_size(pipeline));
+    EXPECT_EQ(expected, transform(pipeline, input, block_size)) <<
+      "spec: " << spec << ", block size: " << block_size;
+    EXPECT_FALSE(pdcpl_pipeline_destroy(pipeline));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  Stages,
+  PipelineTest,
+  ::testing::Values(
+    std::make_tuple("detab", "a\tb\n\tc", "a       b\n        c"),
+    std::make_tuple("detab 4", "ab\tc\t\td", "ab  c       d"),
+    std::make_tuple("detab 1", "\t\t", "  "),
+    std::make_tuple("escape", "a\tb\bc\\d", "a\\tb\\bc\\\\d"),
+    std::make_tuple("lower", "Hello WORLD 42", "hello world 42"),
+    std::make_tuple("squeeze", "i    say  hello ", "i say hello "),
+    std::make_tuple("upper", "Hello world 42", "HELLO WORLD 42"),
+    std::make_tuple(
+      "words",
+      "hello from  \n   the other\nside  \n\n\n",
+      "hello\nfrom\nthe\nother\nside\n"
+    ),
+    std::make_tuple(
+      "  detab 4|squeeze |  lower  ",
+      "Hi\tTHERE    you\n\tOK",
+      "hi there you\n ok"
+    ),
+    std::make_tuple(
+      "squeeze | escape | upper | words",
+      "a\\b  \tc d",
+      "A\\\\B\n\\TC\nD"
+    )
+  )
+);
+
+/**
+ * Test that malformed specifications are rejected.
+ */
+TEST(PipelineCreateTest, InvalidSpecTest)
+{
+  pdcpl_pipeline* pipeline;
+  EXPECT_EQ(-EINVAL, pdcpl_pipeline_create(nullptr, "lower", 0));
+  EXPECT_EQ(-EINVAL, pdcpl_pipeline_create(&pipeline, nullptr, 0));
+  for (
+    auto spec : {
+      "", " ", "lower |", "| lower", "lower || upper", "nope", "lower 4",
+      "detab 0", "detab 4x", "detab -4", "detab 4 4", "detab 100000"
+    }
+  )
+    EXPECT_EQ(-EINVAL, pdcpl_pipeline_create(&pipeline, spec, 0)) <<
+      "spec: " << spec;
+}
+
+/**
+ * Test the default block size, stage count, and oversized blocks.
+ */
+TEST(PipelineCreateTest, BlockSizeTest)
+{
+  pdcpl_pipeline* pipeline;
+  ASSERT_FALSE(pdcpl_pipeline_create(&pipeline, "lower | upper", 0));
+  EXPECT_EQ(2u, pdcpl_pipeline_size(pipeline));
+  EXPECT_EQ(PDCPL_PIPELINE_BLOCK_SIZE, pdcpl_pipeline_block_size(pipeline));
+  std::string input(PDCPL_PIPELINE_BLOCK_SIZE + 1, 'a');
+  const char* out;
+  std::size_t out_size;
+  EXPECT_EQ(
+    -EINVAL,
+    pdcpl_pipeline_process(
+      pipeline, input.data(), input.size(), &out, &out_size
+    )
+  );
+  EXPECT_FALSE(
+    pdcpl_pipeline_process(pipeline, nullptr, 0, &out, &out_size)
+  );
+  EXPECT_EQ(0u, out_size);
+  EXPECT_FALSE(pdcpl_pipeline_destroy(pipeline));
+}
+
+/**
+ * Test that resetting a pipeline clears the stage state.
+ */
+TEST(PipelineResetTest, SqueezeTest)
+{
+  pdcpl_pipeline* pipeline;
+  ASSERT_FALSE(pdcpl_pipeline_create(&pipeline, "squeeze", 0));
+  EXPECT_EQ("a ", transform(pipeline, "a ", 2));
+  // blank run continues across blocks unless reset
+  EXPECT_EQ("b", transform(pipeline, " b", 2));
+  EXPECT_FALSE(pdcpl_pipeline_reset(pipeline));
+  EXPECT_EQ(" b", transform(pipeline, " b", 2));
+  EXPECT_FALSE(pdcpl_pipeline_destroy(pipeline));
+}
+
+/**
+ * Test that running a pipeline on a stream matches transforming blocks.
+ */
+TEST(PipelineRunTest, StreamTest)
+{
+  // long enough to span several blocks
+  std::string input;
+  for (unsigned i = 0; i < 1000; i++)
+    input += "The\tQuick  Brown\\Fox\n";
+  auto in = std::tmpfile();
+  auto out = std::tmpfile();
+  ASSERT_TRUE(in);
+  ASSERT_TRUE(out);
+  ASSERT_EQ(input.size(), std::fwrite(input.data(), 1, input.size(), in));
+  std::rewind(in);
+  pdcpl_pipeline* pipeline;
+  const char* spec = "detab 4 | squeeze | escape | lower";
+  ASSERT_FALSE(pdcpl_pipeline_create(&pipeline, spec, 256));
+  EXPECT_FALSE(pdcpl_pipeline_run(pipeline, in, out));
+  EXPECT_FALSE(pdcpl_pipeline_reset(pipeline));
+  auto expected = transform(pipeline, input, 256);
+  EXPECT_FALSE(pdcpl_pipeline_destroy(pipeline));
+  // read back the stream output
+  std::string actual(expected.size() + 1, '\0');
+  std::rewind(out);
+  actual.resize(std::fread(actual.data(), 1, actual.size(), out));
+  EXPECT_EQ(expected, actual);
+  std::fclose(in);
+  std::fclose(out);
+}
+
+}  // namespace
@@ -0,0 +1,314 @@
+/**
+ * @file queue_test.cc
+ * @author Derek Huang
+ * @brief queue.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/queue.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pdcpl/memory.h"
+#include "pdcpl/thread.h"
+
+namespace {
+
+/**
+ * Return a buffer that does not own memory and carries an integer.
+ *
+ * The queues never look inside buffers, so the size can carry a payload as
+ * long as the data is `NULL` when the queue frees leftover buffers.
+ *
+ * @param value Payload
+ */
+pdcpl_buffer tag(std::size_t value)
+{
+  return {nullptr, value};
+}
+
+/**
+ * Test that the SPSC queue is FIFO, bounded, and supports batches.
+ */
+TEST(SpscQueueTest, PushPopTest)
+{
+  pdcpl_spsc_queue* queue;
+  ASSERT_FALSE(pdcpl_spsc_queue_create(&queue, 5));
+  ASSERT_EQ(8u, pdcpl_spsc_queue_capacity(queue));
+  for (std::size_t i = 0; i < 8; i++) {
+    auto buf = tag(i);
+    ASSERT_FALSE(pdcpl_spsc_queue_push(queue, &buf));
+  }
+  auto extra = tag(8);
+  EXPECT_EQ(-EAGAIN, pdcpl_spsc_queue_push(queue, &extra));
+  pdcpl_buffer buf;
+  for (std::size_t i = 0; i < 3; i++) {
+    ASSERT_FALSE(pdcpl_spsc_queue_pop(queue, &buf));
+    EXPECT_EQ(i, buf.size);
+  }
+  // only 3 free slots, so a batch of 4 is truncated, wrapping the ring
+  std::vector<pdcpl_buffer> bufs{tag(8), tag(9), tag(10), tag(11)};
+  EXPECT_EQ(3u, pdcpl_spsc_queue_push_n(queue, bufs.data(), bufs.size()));
+  std::vector<pdcpl_buffer> out(16);
+  ASSERT_EQ(8u, pdcpl_spsc_queue_pop_n(queue, out.data(), out.size()));
+  for (std::size_t i = 0; i < 8; i++)
+    EXPECT_EQ(i + 3, out[i].size);
+  EXPECT_EQ(-EAGAIN, pdcpl_spsc_queue_pop(queue, &buf));
+  EXPECT_EQ(0u, pdcpl_spsc_queue_pop_n(queue, out.data(), out.size()));
+  EXPECT_FALSE(pdcpl_spsc_queue_destroy(queue));
+}
+
+/**
+ * Test that the MPMC queue is FIFO, bounded, and supports batches.
+ */
+TEST(MpmcQueueTest, PushPopTest)
+{
+  pdcpl_mpmc_queue* queue;
+  // minimum capacity is 2
+  ASSERT_FALSE(pdcpl_mpmc_queue_create(&queue, 1));
+  EXPECT_EQ(2u, pdcpl_mpmc_queue_capacity(queue));
+  EXPECT_FALSE(pdcpl_mpmc_queue_destroy(queue));
+  ASSERT_FALSE(pdcpl_mpmc_queue_create(&queue, 8));
+  std::vector<pdcpl_buffer> bufs;
+  for (std::size_t i = 0; i < 10; i++)
+    bufs.push_back(tag(i));
+  EXPECT_EQ(8u, pdcpl_mpmc_queue_push_n(queue, bufs.data(), bufs.size()));
+  EXPECT_EQ(-EAGAIN, pdcpl_mpmc_queue_push(queue, &bufs[8]));
+  pdcpl_buffer buf;
+  ASSERT_FALSE(pdcpl_mpmc_queue_pop(queue, &buf));
+  EXPECT_EQ(0u, buf.size);
+  ASSERT_FALSE(pdcpl_mpmc_queue_push(queue, &bufs[8]));
+  std::vector<pdcpl_buffer> out(16);
+  ASSERT_EQ(8u, pdcpl_mpmc_queue_pop_n(queue, out.data(), out.size()));
+  for (std::size_t i = 0; i < 8; i++)
+    EXPECT_EQ(i + 1, out[i].size);
+  EXPECT_EQ(-EAGAIN, pdcpl_mpmc_queue_pop(queue, &buf));
+  EXPECT_EQ(0u, pdcpl_mpmc_queue_push_n(queue, bufs.data(), 0));
+  EXPECT_FALSE(pdcpl_mpmc_queue_destroy(queue));
+}
+
+/**
+ * Test that queues free buffers still in them when destroyed.
+ *
+ * Leaks are reported by sanitizer or Valgrind builds.
+ */
+TEST(QueueTest, DestroyTest)
+{
+  pdcpl_spsc_queue* spsc;
+  pdcpl_mpmc_queue* mpmc;
+  ASSERT_FALSE(pdcpl_spsc_queue_create(&spsc, 4));
+  ASSERT_FALSE(pdcpl_mpmc_queue_create(&mpmc, 4));
+  for (int i = 0; i < 3; i++) {
+    auto buf = pdcpl_buffer_new(16);
+    ASSERT_FALSE(pdcpl_spsc_queue_push(spsc, &buf));
+    buf = pdcpl_buffer_new(16);
+    ASSERT_FALSE(pdcpl_mpmc_queue_push(mpmc, &buf));
+  }
+  EXPECT_FALSE(pdcpl_spsc_queue_destroy(spsc));
+  EXPECT_FALSE(pdcpl_mpmc_queue_destroy(mpmc));
+}
+
+/**
+ * Test that invalid arguments are rejected.
+ */
+TEST(QueueTest, InvalidTest)
+{
+  pdcpl_spsc_queue* spsc;
+  pdcpl_mpmc_queue* mpmc;
+  pdcpl_blocking_queue* blocking;
+  EXPECT_EQ(-EINVAL, pdcpl_spsc_queue_create(nullptr, 4));
+  EXPECT_EQ(-EINVAL, pdcpl_spsc_queue_create(&spsc, 0));
+  EXPECT_EQ(-EINVAL, pdcpl_spsc_queue_create(&spsc, SIZE_MAX));
+  EXPECT_EQ(-EINVAL, pdcpl_spsc_queue_destroy(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_mpmc_queue_create(nullptr, 4));
+  EXPECT_EQ(-EINVAL, pdcpl_mpmc_queue_create(&mpmc, 0));
+  EXPECT_EQ(-EINVAL, pdcpl_mpmc_queue_destroy(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_blocking_queue_create(nullptr, PDCPL_QUEUE_MPMC, 4));
+  EXPECT_EQ(
+    -EINVAL,
+    pdcpl_blocking_queue_create(&blocking, static_cast<pdcpl_queue_kind>(9), 4)
+  );
+  EXPECT_EQ(
+    -EINVAL, pdcpl_blocking_queue_create(&blocking, PDCPL_QUEUE_SPSC, 0)
+  );
+  EXPECT_EQ(-EINVAL, pdcpl_blocking_queue_destroy(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_blocking_queue_close(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_blocking_queue_push(nullptr, nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_blocking_queue_pop(nullptr, nullptr));
+}
+
+/**
+ * Shared state for queue producer threads.
+ *
+ * @param queue Blocking queue to push to
+ * @param first First payload value to push
+ * @param n_items Number of payloads to push
+ * @param batch Number of buffers per push
+ */
+struct producer_state {
+  pdcpl_blocking_queue* queue;
+  std::size_t first;
+  std::size_t n_items;
+  std::size_t batch;
+};
+
+/**
+ * Thread function that pushes consecutive payloads in batches.
+ *
+ * @param arg `producer_state *` state
+ * @returns `NULL` on success, `arg` on error
+ */
+void* producer_func(void* arg)
+{
+  auto state = static_cast<producer_state*>(arg);
+  std::vector<pdcpl_buffer> bufs;
+  for (std::size_t i = 0; i < state->n_items; i += bufs.size()) {
+    bufs.clear();
+    for (auto j = i; j < state->n_items && bufs.size() < state->batch; j++)
+      bufs.push_back(tag(state->first + j));
+    auto status = pdcpl_blocking_queue_push_n(
+      state->queue, bufs.data(), bufs.size(), nullptr
+    );
+    if (status)
+      return arg;
+  }
+  return nullptr;
+}
+
+/**
+ * Blocking queue test fixture parametrized by queue kind.
+ */
+class BlockingQueueTest : public ::testing::TestWithParam<pdcpl_queue_kind> {
+protected:
+  void SetUp() override
+  {
+    ASSERT_FALSE(pdcpl_blocking_queue_create(&queue_, GetParam(), 16));
+  }
+
+  void TearDown() override
+  {
+    EXPECT_FALSE(pdcpl_blocking_queue_destroy(queue_));
+  }
+
+  /**
+   * Start producers, pop everything they push, and check every payload.
+   *
+   * With a small queue, producers and the consumer both have to wait.
+   *
+   * @param n_producers Number of producer threads
+   */
+  void run_producers(std::size_t n_producers)
+  {
+    std::vector<producer_state> states;
+    for (std::size_t i = 0; i < n_producers; i++)
+      states.push_back({queue_, i * n_items_, n_items_, 1 + i * 3});
+    std::vector<pdcpl_thread*> threads(n_producers);
+    for (std::size_t i = 0; i < n_producers; i++)
+      ASSERT_FALSE(pdcpl_thread_create(&threads[i], producer_func, &states[i]));
+    // per-producer payloads must arrive in order
+    std::vector<std::size_t> next(n_producers);
+    std::vector<pdcpl_buffer> bufs(7);
+    for (std::size_t total = 0; total < n_producers * n_items_; ) {
+      std::size_t n_popped;
+      ASSERT_FALSE(
+        pdcpl_blocking_queue_pop_n(queue_, bufs.data(), bufs.size(), &n_popped)
+      );
+      for (std::size_t i = 0; i < n_popped; i++) {
+        auto producer = bufs[i].size / n_items_;
+        ASSERT_LT(producer, n_producers);
+        EXPECT_EQ(producer * n_items_ + next[producer]++, bufs[i].size);
+      }
+      total += n_popped;
+    }
+    for (auto thread : threads) {
+      void* result;
+      ASSERT_FALSE(pdcpl_thread_join(thread, &result));
+      EXPECT_FALSE(result);
+    }
+  }
+
+  static constexpr std::size_t n_items_ = 20000;
+  pdcpl_blocking_queue* queue_;
+};
+
+/**
+ * Test handing buffers from one producer to the consumer.
+ */
+TEST_P(BlockingQueueTest, SingleProducerTest)
+{
+  run_producers(1);
+}
+
+/**
+ * Test that pops drain a closed queue and then fail, as do pushes.
+ */
+TEST_P(BlockingQueueTest, CloseTest)
+{
+  auto buf = tag(1);
+  ASSERT_FALSE(pdcpl_blocking_queue_push(queue_, &buf));
+  ASSERT_FALSE(pdcpl_blocking_queue_close(queue_));
+  EXPECT_EQ(-EPIPE, pdcpl_blocking_queue_push(queue_, &buf));
+  pdcpl_buffer out;
+  ASSERT_FALSE(pdcpl_blocking_queue_pop(queue_, &out));
+  EXPECT_EQ(1u, out.size);
+  EXPECT_EQ(-EPIPE, pdcpl_blocking_queue_pop(queue_, &out));
+}
+
+/**
+ * Thread function that pops from a blocking queue until it is closed.
+ *
+ * @param arg `pdcpl_blocking_queue *` queue
+ * @returns `NULL` if the pop failed with -EPIPE, `arg` otherwise
+ */
+void* close_waiter_func(void* arg)
+{
+  pdcpl_buffer buf;
+  auto status = pdcpl_blocking_queue_pop(
+    static_cast<pdcpl_blocking_queue*>(arg), &buf
+  );
+  return (status == -EPIPE) ? nullptr : arg;
+}
+
+/**
+ * Test that closing wakes a waiting consumer.
+ */
+TEST_P(BlockingQueueTest, CloseWakeTest)
+{
+  pdcpl_thread* thread;
+  ASSERT_FALSE(pdcpl_thread_create(&thread, close_waiter_func, queue_));
+  pdcpl_thread_yield();
+  ASSERT_FALSE(pdcpl_blocking_queue_close(queue_));
+  void* result;
+  ASSERT_FALSE(pdcpl_thread_join(thread, &result));
+  EXPECT_FALSE(result);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  Kinds,
+  BlockingQueueTest,
+  ::testing::Values(PDCPL_QUEUE_SPSC, PDCPL_QUEUE_MPMC)
+);
+
+/**
+ * Blocking MPMC queue test fixture.
+ */
+class BlockingMpmcQueueTest : public BlockingQueueTest {};
+
+/**
+ * Test handing buffers from several producers to the consumer.
+ */
+TEST_P(BlockingMpmcQueueTest, MultiProducerTest)
+{
+  run_producers(4);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  Mpmc, BlockingMpmcQueueTest, ::testing::Values(PDCPL_QUEUE_MPMC)
+);
+
+}  // namespace
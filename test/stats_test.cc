@@ -0,0 +1,164 @@
+/**
+ * @file stats_test.cc
+ * @author Derek Huang
+ * @brief stats.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/stats.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "pdcpl/string.h"
+#include "pdcpl/thread.h"
+
+namespace {
+
+/**
+ * Main stats test fixture.
+ *
+ * Since counters are program-wide, tests check differences between snapshots.
+ */
+class StatsTest : public ::testing::Test {
+protected:
+  void SetUp() override
+  {
+    ASSERT_FALSE(pdcpl_stats_get(&before_));
+  }
+
+  /**
+   * Return the change in a counter since the test started.
+   *
+   * @param counter Counter to check
+   */
+  std::uint64_t delta(pdcpl_stats_counter counter)
+  {
+    pdcpl_stats after;
+    EXPECT_FALSE(pdcpl_stats_get(&after));
+    return after.counters[counter] - before_.counters[counter];
+  }
+
+  pdcpl_stats before_;
+};
+
+/**
+ * Thread function that adds to the lines counter and flushes.
+ *
+ * @param arg Unused
+ */
+void* add_lines(void* arg)
+{
+  (void) arg;
+  for (int i = 0; i < 1000; i++)
+    pdcpl_stats_add(PDCPL_STATS_LINES, 1);
+  pdcpl_stats_flush();
+  return nullptr;
+}
+
+/**
+ * Test that counters added from multiple threads are totaled.
+ */
+TEST_F(StatsTest, AddFlushTest)
+{
+  pdcpl_stats_add(PDCPL_STATS_BYTES_WRITTEN, 42);
+  pdcpl_thread* threads[4];
+  for (auto& thread : threads)
+    ASSERT_FALSE(pdcpl_thread_create(&thread, add_lines, nullptr));
+  for (auto thread : threads)
+    ASSERT_FALSE(pdcpl_thread_join(thread, nullptr));
+  EXPECT_EQ(42u, delta(PDCPL_STATS_BYTES_WRITTEN));
+  EXPECT_EQ(4000u, delta(PDCPL_STATS_LINES));
+}
+
+/**
+ * Test that library stream functions increment the counters.
+ */
+TEST_F(StatsTest, GetlineTest)
+{
+  auto stream = std::tmpfile();
+  ASSERT_TRUE(stream);
+  std::fputs("first\nsecond\nthird", stream);
+  std::rewind(stream);
+  char* line;
+  while (!pdcpl_getline(stream, &line, nullptr) && line)
+    std::free(line);
+  std::fclose(stream);
+  EXPECT_EQ(18u, delta(PDCPL_STATS_BYTES_READ));
+  EXPECT_EQ(3u, delta(PDCPL_STATS_LINES));
+  EXPECT_LE(3u, delta(PDCPL_STATS_ALLOCS));
+}
+
+/**
+ * Test that the stdio wrappers used by getchar-style programs count.
+ */
+TEST_F(StatsTest, StdioTest)
+{
+  auto in = std::tmpfile();
+  ASSERT_TRUE(in);
+  auto out = std::tmpfile();
+  ASSERT_TRUE(out);
+  std::fputs("one\ntwo\n", in);
+  std::rewind(in);
+  // copy like a getchar/putchar loop, then write a string and formatted text
+  int c;
+  while ((c = pdcpl_stats_getc(in)) != EOF)
+    ASSERT_NE(EOF, pdcpl_stats_putc(c, out));
+  ASSERT_NE(EOF, pdcpl_stats_puts("three", out));
+  EXPECT_EQ(2, pdcpl_stats_written(std::fprintf(out, "%d\n", 4)));
+  EXPECT_EQ(-1, pdcpl_stats_written(-1));
+  std::fclose(in);
+  std::fclose(out);
+  EXPECT_EQ(8u, delta(PDCPL_STATS_BYTES_READ));
+  EXPECT_EQ(15u, delta(PDCPL_STATS_BYTES_WRITTEN));
+  EXPECT_EQ(2u, delta(PDCPL_STATS_LINES));
+}
+
+/**
+ * Test that the resource usage and formatted output are sensible.
+ */
+TEST_F(StatsTest, FprintfTest)
+{
+  pdcpl_stats_start();
+  pdcpl_stats stats;
+  ASSERT_FALSE(pdcpl_stats_get(&stats));
+  EXPECT_GE(stats.wall_time, 0);
+  EXPECT_GE(stats.user_time + stats.sys_time, 0);
+#ifndef _WIN32
+  EXPECT_GT(stats.peak_rss, 0u);
+#endif  // _WIN32
+  // read back formatted output
+  auto format = [&stats](pdcpl_stats_format fmt)
+  {
+    std::string text;
+    auto stream = std::tmpfile();
+    EXPECT_TRUE(stream);
+    if (!stream)
+      return text;
+    EXPECT_FALSE(pdcpl_stats_fprintf(stream, &stats, fmt));
+    std::rewind(stream);
+    int c;
+    while ((c = std::fgetc(stream)) != EOF)
+      text += static_cast<char>(c);
+    std::fclose(stream);
+    return text;
+  };
+  auto text = format(PDCPL_STATS_FORMAT_TEXT);
+  EXPECT_NE(std::string::npos, text.find("wall time:"));
+  EXPECT_NE(std::string::npos, text.find("peak rss:"));
+  auto json = format(PDCPL_STATS_FORMAT_JSON);
+  ASSERT_FALSE(json.empty());
+  EXPECT_EQ('{', json.front());
+  EXPECT_NE(std::string::npos, json.find("\"bytes_read\": "));
+  EXPECT_EQ(
+    -EINVAL, pdcpl_stats_fprintf(stdout, nullptr, PDCPL_STATS_FORMAT_TEXT)
+  );
+  EXPECT_EQ(-EINVAL, pdcpl_stats_get(nullptr));
+}
+
+}  // namespace
@@ -0,0 +1,171 @@
+/**
+ * @file strtod_test.cc
+ * @author Derek Huang
+ * @brief strtod.(c|h) unit test
+ * @copyright MIT License
+ */
+
+#include "pdcpl/strtod.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace {
+
+/**
+ * Main test fixture for fast string to number conversion tests.
+ */
+class StrtodTest : public ::testing::Test {
+protected:
+  /**
+   * Check that `pdcpl_strtod_fast` exactly matches `strtod`.
+   *
+   * The value bits, number of chars consumed, and `errno` must all match.
+   *
+   * @param str Null-terminated string to convert
+   */
+  static void check(const std::string& str)
+  {
+    char* endp;
+    errno = 0;
+    auto expected = std::strtod(str.c_str(), &endp);
+    auto expected_errno = errno;
+    double actual;
+    errno = 0;
+    auto n_read = pdcpl_strtod_fast(str.c_str(), str.size(), &actual);
+    EXPECT_EQ(static_cast<std::size_t>(endp - str.c_str()), n_read) << str;
+    EXPECT_EQ(0, std::memcmp(&expected, &actual, sizeof actual)) << str;
+    EXPECT_EQ(expected_errno, errno) << str;
+  }
+};
+
+/**
+ * Test edge cases of syntax, rounding, and range.
+ */
+TEST_F(StrtodTest, EdgeCaseTest)
+{
+  for (
+    auto str : {
+      "0", "-0", "+0.000e10", " \t 12.5xyz", "1e", "1e+", "-.5", ".", "-",
+      "+.e3", "inf", "-Infinity", "nan", "0x1p-3", "9007199254740993",
+      "2.2250738585072011e-308", "4.9e-324", "2e-324",
+      "1.7976931348623157e308", "1.7976931348623159e308", "1e99999999999",
+      "123456789012345678901234567890", "0.1", "0.30000000000000004",
+      "7.3177701707893310e+15", "9999999999999999999", "1e23", "8.589973e9"
+    }
+  )
+    check(str);
+}
+
+/**
+ * Test that long non-decimal tokens are converted in full.
+ */
+TEST_F(StrtodTest, LongSpecialTest)
+{
+  // hex floats with many leading zero digits, 0x1p-3 in total
+  check("0x" + std::string(70, '0') + "1p-3");
+  check("-0x0." + std::string(70, '0') + "8p+3 tail");
+  // NaN with a long char sequence
+  check("nan(" + std::string(80, 'a') + ")");
+  check("0x" + std::string(100, '0'));
+}
+
+/**
+ * Test that only a prefix of the given size is read.
+ */
+TEST_F(StrtodTest, SizeTest)
+{
+  double value;
+  EXPECT_EQ(3U, pdcpl_strtod_fast("12.75", 3, &value));
+  EXPECT_EQ(12., value);
+  EXPECT_EQ(0U, pdcpl_strtod_fast("12.75", 0, &value));
+}
+
+/**
+ * Test random values printed with varying precision against `strtod`.
+ */
+TEST_F(StrtodTest, RandomTest)
+{
+  std::mt19937_64 rng;
+  char buf[64];
+  for (int i = 0; i < 100000; i++) {
+    auto bits = rng();
+    double value;
+    std::memcpy(&value, &bits, sizeof value);
+    std::snprintf(buf, sizeof buf, "%.*g", 1 + i % 17, value);
+    check(buf);
+    // significands longer than 19 digits and wide exponents
+    std::snprintf(
+      buf,
+      sizeof buf,
+      "%llu.%llue%d",
+      static_cast<unsigned long long>(rng() % 100000000000),
+      static_cast<unsigned long long>(rng()),
+      static_cast<int>(rng() % 700) - 350
+    );
+    check(buf);
+  }
+}
+
+/**
+ * Test integer conversion, including overflow clamping.
+ */
+TEST_F(StrtodTest, IntegerTest)
+{
+  std::intmax_t value;
+  EXPECT_EQ(5U, pdcpl_strtoj_fast("  -42x", 6, &value));
+  EXPECT_EQ(-42, value);
+  EXPECT_EQ(0U, pdcpl_strtoj_fast("+", 1, &value));
+  std::string min_str{std::to_string(INTMAX_MIN)};
+  errno = 0;
+  EXPECT_EQ(min_str.size(), pdcpl_strtoj_fast(min_str.c_str(), 99, &value));
+  EXPECT_EQ(INTMAX_MIN, value);
+  EXPECT_EQ(0, errno);
+  std::string big_str{"123456789012345678901234567890"};
+  EXPECT_EQ(
+    big_str.size(), pdcpl_strtoj_fast(big_str.c_str(), big_str.size(), &value)
+  );
+  EXPECT_EQ(INTMAX_MAX, value);
+  EXPECT_EQ(ERANGE, errno);
+}
+
+/**
+ * Test batch conversion of whitespace-separated values.
+ */
+TEST_F(StrtodTest, BatchTest)
+{
+  std::string in{" 1.5\n-2e3\t7  0.25 \n"};
+  double values[8];
+  std::size_t n, n_read;
+  ASSERT_FALSE(
+    pdcpl_strtod_batch(in.c_str(), in.size(), values, 8, &n, &n_read)
+  );
+  ASSERT_EQ(4U, n);
+  EXPECT_EQ(1.5, values[0]);
+  EXPECT_EQ(-2e3, values[1]);
+  EXPECT_EQ(7., values[2]);
+  EXPECT_EQ(0.25, values[3]);
+  // stop after max_n values
+  ASSERT_FALSE(
+    pdcpl_strtod_batch(in.c_str(), in.size(), values, 2, &n, &n_read)
+  );
+  EXPECT_EQ(2U, n);
+  EXPECT_EQ(in.find('\t'), n_read);
+  // stop at a token that isn't a number
+  std::string bad{"1 2 3x 4"};
+  EXPECT_EQ(
+    -EINVAL,
+    pdcpl_strtod_batch(bad.c_str(), bad.size(), values, 8, &n, &n_read)
+  );
+  EXPECT_EQ(2U, n);
+  EXPECT_EQ(3U, n_read);
+}
+
+}  // namespace
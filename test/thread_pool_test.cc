@@ -0,0 +1,319 @@
+/**
+ * @file thread_pool_test.cc
+ * @author Derek Huang
+ * @brief thread_pool.(c|h|hh) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "pdcpl/thread_pool.hh"
+
+namespace {
+
+/**
+ * Main thread pool test fixture.
+ *
+ * A fixed number of workers is used so that stealing and sleeping are also
+ * exercised on machines with fewer hardware threads.
+ */
+class ThreadPoolTest : public ::testing::Test {
+protected:
+  void SetUp() override
+  {
+    pdcpl_thread_pool_options opts{n_threads_, false};
+    ASSERT_FALSE(pdcpl_thread_pool_create(&pool_, &opts));
+  }
+
+  void TearDown() override
+  {
+    EXPECT_FALSE(pdcpl_thread_pool_destroy(pool_));
+  }
+
+  static constexpr unsigned int n_threads_ = 4;
+  static constexpr std::size_t n_tasks_ = 1000;
+  pdcpl_thread_pool* pool_;
+};
+
+/**
+ * Task function that increments an atomic counter.
+ *
+ * @param arg `std::atomic<std::size_t> *` counter
+ */
+void increment_task(void* arg)
+{
+  static_cast<std::atomic<std::size_t>*>(arg)->fetch_add(1);
+}
+
+/**
+ * Range function that sets each element of a vector to its index.
+ *
+ * @param begin First index
+ * @param end One past the last index
+ * @param arg `std::vector<std::size_t> *` vector
+ */
+void iota_range(std::size_t begin, std::size_t end, void* arg)
+{
+  auto& values = *static_cast<std::vector<std::size_t>*>(arg);
+  for (auto i = begin; i < end; i++)
+    values[i] = i;
+}
+
+/**
+ * Test that the pool has the requested number of workers.
+ */
+TEST_F(ThreadPoolTest, SizeTest)
+{
+  EXPECT_EQ(n_threads_, pdcpl_thread_pool_size(pool_));
+  EXPECT_EQ(0u, pdcpl_thread_pool_size(nullptr));
+}
+
+/**
+ * Test that all submitted tasks run before the group wait returns.
+ */
+TEST_F(ThreadPoolTest, SubmitWaitTest)
+{
+  std::atomic<std::size_t> count{};
+  pdcpl_task_group group = PDCPL_TASK_GROUP_INIT;
+  for (std::size_t i = 0; i < n_tasks_; i++)
+    ASSERT_FALSE(
+      pdcpl_thread_pool_submit(pool_, &group, increment_task, &count)
+    );
+  EXPECT_FALSE(pdcpl_task_group_wait(pool_, &group));
+  EXPECT_EQ(n_tasks_, count);
+  EXPECT_EQ(0u, group.pending);
+}
+
+/**
+ * Shared state for the nested task function.
+ *
+ * @param pool Thread pool
+ * @param count Number of leaf tasks run
+ * @param depth Remaining recursion depth
+ */
+struct nested_state {
+  pdcpl_thread_pool* pool;
+  std::atomic<std::size_t>* count;
+  unsigned int depth;
+};
+
+/**
+ * Task function that submits two child tasks from a worker and waits on them.
+ *
+ * @param arg `nested_state *` state
+ */
+void nested_task(void* arg)
+{
+  auto state = static_cast<nested_state*>(arg);
+  if (!state->depth) {
+    state->count->fetch_add(1);
+    return;
+  }
+  nested_state child{state->pool, state->count, state->depth - 1};
+  pdcpl_task_group group = PDCPL_TASK_GROUP_INIT;
+  pdcpl_thread_pool_submit(state->pool, &group, nested_task, &child);
+  pdcpl_thread_pool_submit(state->pool, &group, nested_task, &child);
+  pdcpl_task_group_wait(state->pool, &group);
+}
+
+/**
+ * Test that tasks can submit and wait on tasks without deadlocking.
+ */
+TEST_F(ThreadPoolTest, NestedTest)
+{
+  std::atomic<std::size_t> count{};
+  nested_state state{pool_, &count, 10};
+  pdcpl_task_group group = PDCPL_TASK_GROUP_INIT;
+  ASSERT_FALSE(pdcpl_thread_pool_submit(pool_, &group, nested_task, &state));
+  EXPECT_FALSE(pdcpl_task_group_wait(pool_, &group));
+  EXPECT_EQ(1u << 10, count);
+}
+
+/**
+ * Task function that sleeps briefly and then increments an atomic counter.
+ *
+ * @param arg `std::atomic<std::size_t> *` counter
+ */
+void slow_increment_task(void* arg)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  increment_task(arg);
+}
+
+/**
+ * Task function that submits two slow tasks from a worker and waits on them.
+ *
+ * @param arg `nested_state *` state, `depth` is ignored
+ */
+void slow_parent_task(void* arg)
+{
+  auto state = static_cast<nested_state*>(arg);
+  pdcpl_task_group group = PDCPL_TASK_GROUP_INIT;
+  for (int i = 0; i < 2; i++)
+    pdcpl_thread_pool_submit(
+      state->pool, &group, slow_increment_task, state->count
+    );
+  pdcpl_task_group_wait(state->pool, &group);
+}
+
+/**
+ * Test that waiters that block for lack of tasks are woken when done.
+ *
+ * The tasks take long enough that waiters run out of spins, both for the
+ * calling thread and for workers waiting inside tasks.
+ */
+TEST_F(ThreadPoolTest, BlockingWaitTest)
+{
+  std::atomic<std::size_t> count{};
+  pdcpl_task_group group = PDCPL_TASK_GROUP_INIT;
+  for (unsigned int i = 0; i < n_threads_; i++)
+    ASSERT_FALSE(
+      pdcpl_thread_pool_submit(pool_, &group, slow_increment_task, &count)
+    );
+  EXPECT_FALSE(pdcpl_task_group_wait(pool_, &group));
+  EXPECT_EQ(n_threads_, count);
+  // 2 parents per worker, so some parents wait while others are queued
+  count = 0;
+  nested_state state{pool_, &count, 0};
+  for (unsigned int i = 0; i < 2 * n_threads_; i++)
+    ASSERT_FALSE(
+      pdcpl_thread_pool_submit(pool_, &group, slow_parent_task, &state)
+    );
+  EXPECT_FALSE(pdcpl_task_group_wait(pool_, &group));
+  EXPECT_EQ(4 * n_threads_, count);
+  EXPECT_EQ(0u, group.pending);
+}
+
+/**
+ * Test that a parallel loop visits every index exactly once.
+ */
+TEST_F(ThreadPoolTest, ParallelForTest)
+{
+  // odd size so halving gives uneven subranges
+  std::vector<std::size_t> values(100003, SIZE_MAX);
+  // automatic grain, grain of 1, and a grain larger than the range
+  for (std::size_t grain : {0, 1, 1 << 20}) {
+    std::fill(values.begin(), values.end(), SIZE_MAX);
+    ASSERT_FALSE(
+      pdcpl_parallel_for(pool_, 0, values.size(), grain, iota_range, &values)
+    );
+    for (std::size_t i = 0; i < values.size(); i++)
+      ASSERT_EQ(i, values[i]) << "grain " << grain;
+  }
+  // empty range calls nothing
+  EXPECT_FALSE(pdcpl_parallel_for(pool_, 5, 5, 0, iota_range, nullptr));
+}
+
+/**
+ * Test that invalid arguments are rejected.
+ */
+TEST_F(ThreadPoolTest, InvalidTest)
+{
+  pdcpl_task_group group = PDCPL_TASK_GROUP_INIT;
+  EXPECT_EQ(-EINVAL, pdcpl_thread_pool_create(nullptr, nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_thread_pool_destroy(nullptr));
+  EXPECT_EQ(
+    -EINVAL, pdcpl_thread_pool_submit(nullptr, &group, increment_task, nullptr)
+  );
+  EXPECT_EQ(-EINVAL, pdcpl_thread_pool_submit(pool_, &group, nullptr, nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_task_group_wait(pool_, nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_parallel_for(pool_, 0, 1, 0, nullptr, nullptr));
+}
+
+/**
+ * Test that destroying a pool runs tasks that are still queued.
+ */
+TEST(ThreadPoolDestroyTest, DrainTest)
+{
+  pdcpl_thread_pool* pool;
+  pdcpl_thread_pool_options opts{2, true};
+  ASSERT_FALSE(pdcpl_thread_pool_create(&pool, &opts));
+  std::atomic<std::size_t> count{};
+  for (std::size_t i = 0; i < 100; i++)
+    ASSERT_FALSE(
+      pdcpl_thread_pool_submit(pool, nullptr, increment_task, &count)
+    );
+  EXPECT_FALSE(pdcpl_thread_pool_destroy(pool));
+  EXPECT_EQ(100u, count);
+}
+
+/**
+ * Test the C++ parallel loop with a lambda.
+ */
+TEST(ThreadPoolHHTest, ParallelForTest)
+{
+  pdcpl::thread_pool pool{3};
+  EXPECT_EQ(3u, pool.size());
+  std::vector<std::uint64_t> values(10000);
+  std::iota(values.begin(), values.end(), 1);
+  std::atomic<std::uint64_t> total{};
+  pool.parallel_for(
+    0,
+    values.size(),
+    [&](std::size_t begin, std::size_t end)
+    {
+      total += std::accumulate(
+        values.begin() + begin, values.begin() + end, std::uint64_t{}
+      );
+    }
+  );
+  EXPECT_EQ(values.size() * (values.size() + 1) / 2, total);
+}
+
+/**
+ * Test that exceptions thrown in the C++ parallel loop are rethrown.
+ */
+TEST(ThreadPoolHHTest, ParallelForThrowTest)
+{
+  pdcpl::thread_pool pool{2};
+  std::atomic<std::size_t> count{};
+  EXPECT_THROW(
+    pool.parallel_for(
+      0,
+      100,
+      [&](std::size_t begin, std::size_t end)
+      {
+        count += end - begin;
+        if (begin <= 50 && 50 < end)
+          throw std::runtime_error{"index 50"};
+      },
+      1
+    ),
+    std::runtime_error
+  );
+  // other subranges still ran
+  EXPECT_EQ(100u, count);
+}
+
+/**
+ * Test C++ task groups with lambdas and exception propagation.
+ */
+TEST(ThreadPoolHHTest, TaskGroupTest)
+{
+  pdcpl::thread_pool pool{2};
+  std::atomic<std::size_t> count{};
+  pdcpl::task_group group{pool};
+  for (std::size_t i = 0; i < 100; i++)
+    group.run([&count] { count++; });
+  group.wait();
+  EXPECT_EQ(100u, count);
+  group.run([] { throw std::runtime_error{"task"}; });
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  // exception is cleared after being rethrown
+  EXPECT_NO_THROW(group.wait());
+}
+
+}  // namespace
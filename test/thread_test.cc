@@ -0,0 +1,168 @@
+/**
+ * @file thread_test.cc
+ * @author Derek Huang
+ * @brief thread.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/thread.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+/**
+ * Main thread test fixture.
+ */
+class ThreadTest : public ::testing::Test {
+protected:
+  static constexpr unsigned int n_threads_ = 8;
+  static constexpr std::size_t n_incr_ = 10000;
+};
+
+/**
+ * Shared state for the counter thread function.
+ *
+ * @param mutex Mutex guarding `count`
+ * @param count Shared counter
+ * @param n_incr Number of times each thread increments `count`
+ */
+struct counter_state {
+  pdcpl_mutex* mutex;
+  std::size_t count;
+  std::size_t n_incr;
+};
+
+/**
+ * Thread function that increments the shared counter under the mutex.
+ *
+ * @param arg `counter_state *` shared state
+ * @returns `arg`
+ */
+void* counter_func(void* arg)
+{
+  auto state = static_cast<counter_state*>(arg);
+  for (std::size_t i = 0; i < state->n_incr; i++) {
+    pdcpl_mutex_lock(state->mutex);
+    state->count++;
+    pdcpl_mutex_unlock(state->mutex);
+  }
+  return arg;
+}
+
+/**
+ * Test that threads can be created and joined, with correct results.
+ */
+TEST_F(ThreadTest, CreateJoinTest)
+{
+  counter_state state{nullptr, 0, n_incr_};
+  ASSERT_FALSE(pdcpl_mutex_create(&state.mutex));
+  std::vector<pdcpl_thread*> threads(n_threads_);
+  for (auto& thread : threads)
+    ASSERT_FALSE(pdcpl_thread_create(&thread, counter_func, &state));
+  for (auto thread : threads) {
+    void* result;
+    ASSERT_FALSE(pdcpl_thread_join(thread, &result));
+    EXPECT_EQ(&state, result);
+  }
+  EXPECT_EQ(n_threads_ * n_incr_, state.count);
+  EXPECT_FALSE(pdcpl_mutex_destroy(state.mutex));
+}
+
+/**
+ * Test that invalid arguments are rejected.
+ */
+TEST_F(ThreadTest, InvalidTest)
+{
+  pdcpl_thread* thread;
+  EXPECT_EQ(-EINVAL, pdcpl_thread_create(nullptr, counter_func, nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_thread_create(&thread, nullptr, nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_thread_join(nullptr, nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_mutex_create(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_mutex_lock(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_mutex_unlock(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_mutex_destroy(nullptr));
+}
+
+/**
+ * Shared state for the condition variable thread function.
+ *
+ * @param mutex Mutex guarding `ready`
+ * @param cond Condition variable signaled when `ready` is set
+ * @param ready Flag set by the main thread
+ */
+struct cond_state {
+  pdcpl_mutex* mutex;
+  pdcpl_cond* cond;
+  bool ready;
+};
+
+/**
+ * Thread function that waits until the ready flag is set.
+ *
+ * @param arg `cond_state *` shared state
+ * @returns `arg`
+ */
+void* cond_func(void* arg)
+{
+  auto state = static_cast<cond_state*>(arg);
+  pdcpl_mutex_lock(state->mutex);
+  while (!state->ready)
+    pdcpl_cond_wait(state->cond, state->mutex);
+  pdcpl_mutex_unlock(state->mutex);
+  return arg;
+}
+
+/**
+ * Test that waiting threads are woken by a broadcast.
+ */
+TEST_F(ThreadTest, CondTest)
+{
+  cond_state state{nullptr, nullptr, false};
+  ASSERT_FALSE(pdcpl_mutex_create(&state.mutex));
+  ASSERT_FALSE(pdcpl_cond_create(&state.cond));
+  std::vector<pdcpl_thread*> threads(n_threads_);
+  for (auto& thread : threads)
+    ASSERT_FALSE(pdcpl_thread_create(&thread, cond_func, &state));
+  pdcpl_thread_yield();
+  ASSERT_FALSE(pdcpl_mutex_lock(state.mutex));
+  state.ready = true;
+  EXPECT_FALSE(pdcpl_cond_broadcast(state.cond));
+  ASSERT_FALSE(pdcpl_mutex_unlock(state.mutex));
+  for (auto thread : threads)
+    ASSERT_FALSE(pdcpl_thread_join(thread, nullptr));
+  EXPECT_FALSE(pdcpl_cond_signal(state.cond));
+  EXPECT_FALSE(pdcpl_cond_destroy(state.cond));
+  EXPECT_FALSE(pdcpl_mutex_destroy(state.mutex));
+  EXPECT_EQ(-EINVAL, pdcpl_cond_create(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_cond_wait(nullptr, state.mutex));
+  EXPECT_EQ(-EINVAL, pdcpl_cond_signal(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_cond_broadcast(nullptr));
+  EXPECT_EQ(-EINVAL, pdcpl_cond_destroy(nullptr));
+}
+
+/**
+ * Test that pinning rejects out-of-range CPUs.
+ *
+ * Pinning to a valid CPU may still fail, e.g. if the CPU is outside the
+ * process's allowed set in a container, so only the error value is checked.
+ */
+TEST_F(ThreadTest, PinTest)
+{
+  EXPECT_EQ(-EINVAL, pdcpl_thread_pin(pdcpl_thread_hardware_concurrency()));
+  EXPECT_LE(pdcpl_thread_pin(0), 0);
+}
+
+/**
+ * Test that the hardware concurrency is at least 1.
+ */
+TEST_F(ThreadTest, HardwareConcurrencyTest)
+{
+  EXPECT_GE(pdcpl_thread_hardware_concurrency(), 1u);
+}
+
+}  // namespace
@@ -0,0 +1,155 @@
+/**
+ * @file trace_test.cc
+ * @author Derek Huang
+ * @brief trace.(c|h) unit tests
+ * @copyright MIT License
+ */
+
+#include "pdcpl/trace.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "pdcpl/thread.h"
+#include "pdcpl/trace.hh"
+
+namespace {
+
+/**
+ * Main trace test fixture.
+ *
+ * Since recorded events are program-wide, each test starts with no events.
+ */
+class TraceTest : public ::testing::Test {
+protected:
+  void SetUp() override
+  {
+    pdcpl_trace_clear();
+  }
+
+  void TearDown() override
+  {
+    pdcpl_trace_clear();
+  }
+
+  /**
+   * Return the dumped trace as a string.
+   */
+  std::string dump()
+  {
+    std::string text;
+    auto stream = std::tmpfile();
+    EXPECT_TRUE(stream);
+    if (!stream)
+      return text;
+    EXPECT_FALSE(pdcpl_trace_dump(stream));
+    std::rewind(stream);
+    int c;
+    while ((c = std::fgetc(stream)) != EOF)
+      text += static_cast<char>(c);
+    std::fclose(stream);
+    return text;
+  }
+
+  /**
+   * Return the number of times a substring occurs in a string.
+   *
+   * @param text String to search
+   * @param sub Substring to count
+   */
+  static std::size_t count(const std::string& text, const std::string& sub)
+  {
+    std::size_t n = 0;
+    for (auto pos = text.find(sub); pos != std::string::npos; n++)
+      pos = text.find(sub, pos + sub.size());
+    return n;
+  }
+};
+
+/**
+ * Test that spans and counters are dumped as trace-event JSON.
+ */
+TEST_F(TraceTest, SpanCounterTest)
+{
+  auto start = pdcpl_trace_now();
+  pdcpl_trace_span("test_span", start);
+  pdcpl_trace_counter("test_counter", -42);
+  {
+    pdcpl::trace_scope scope{"test_scope"};
+  }
+  auto json = dump();
+  ASSERT_FALSE(json.empty());
+  EXPECT_EQ(0u, json.find("{\"traceEvents\": ["));
+  EXPECT_EQ(1u, count(json, "\"name\": \"test_span\", \"ph\": \"X\""));
+  EXPECT_EQ(1u, count(json, "\"name\": \"test_scope\", \"ph\": \"X\""));
+  EXPECT_EQ(1u, count(json, "\"name\": \"test_counter\", \"ph\": \"C\""));
+  EXPECT_EQ(1u, count(json, "\"args\": {\"value\": -42}"));
+  EXPECT_EQ(2u, count(json, "\"dur\": "));
+  EXPECT_NE(std::string::npos, json.find("\"displayTimeUnit\": \"ns\"}"));
+}
+
+/**
+ * Test that clearing discards all recorded events.
+ */
+TEST_F(TraceTest, ClearTest)
+{
+  pdcpl_trace_counter("test_counter", 1);
+  pdcpl_trace_clear();
+  auto json = dump();
+  EXPECT_EQ(0u, count(json, "\"name\": "));
+  EXPECT_EQ(-EINVAL, pdcpl_trace_dump(nullptr));
+}
+
+/**
+ * Thread function that records spans.
+ *
+ * @param arg Unused
+ */
+void* record_spans(void* arg)
+{
+  (void) arg;
+  for (int i = 0; i < 100; i++)
+    pdcpl_trace_span("thread_span", pdcpl_trace_now());
+  return nullptr;
+}
+
+/**
+ * Test that events recorded from multiple threads are all dumped.
+ */
+TEST_F(TraceTest, ThreadTest)
+{
+  pdcpl_thread* threads[4];
+  for (auto& thread : threads)
+    ASSERT_FALSE(pdcpl_thread_create(&thread, record_spans, nullptr));
+  for (auto thread : threads)
+    ASSERT_FALSE(pdcpl_thread_join(thread, nullptr));
+  EXPECT_EQ(400u, count(dump(), "\"name\": \"thread_span\""));
+}
+
+/**
+ * Test that only the most recent events are kept when a ring is full.
+ */
+TEST_F(TraceTest, OverwriteTest)
+{
+  for (int i = 0; i < PDCPL_TRACE_RING_SIZE + 10; i++)
+    pdcpl_trace_counter("test_counter", i);
+  auto json = dump();
+  EXPECT_EQ(
+    static_cast<std::size_t>(PDCPL_TRACE_RING_SIZE),
+    count(json, "\"name\": \"test_counter\"")
+  );
+  EXPECT_EQ(0u, count(json, "\"args\": {\"value\": 9}"));
+  EXPECT_EQ(
+    1u,
+    count(
+      json,
+      "\"args\": {\"value\": " + std::to_string(PDCPL_TRACE_RING_SIZE + 9) + "}"
+    )
+  );
+}
+
+}  // namespace
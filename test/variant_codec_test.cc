@@ -0,0 +1,303 @@
+/**
+ * @file variant_codec_test.cc
+ * @author Derek Huang
+ * @brief variant_codec.(c|h) unit test
+ * @copyright MIT License
+ */
+
+#include "pdcpl/variant_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "pdcpl/memory.h"
+#include "pdcpl/variant.h"
+
+namespace {
+
+/**
+ * Main test fixture for variant codec tests.
+ */
+class VariantCodecTest : public ::testing::Test {
+protected:
+  /**
+   * Return a vector of borrowed variants covering all the types.
+   *
+   * String and buffer data point into static storage.
+   */
+  static auto CreateVariants()
+  {
+    static char str[] = "serialized string";
+    static char buf[] = {'\x01', '\x00', '\xfe'};
+    std::vector<pdcpl_variant> vts(9);
+    PDCPL_VARIANT_INIT(char)(&vts[0], 'z');
+    PDCPL_VARIANT_INIT(int)(&vts[1], std::numeric_limits<int>::min());
+    PDCPL_VARIANT_INIT(uint)(&vts[2], 0xdeadbeefU);
+    PDCPL_VARIANT_INIT(size)(&vts[3], 300U);
+    PDCPL_VARIANT_INIT(double)(&vts[4], -1.5e300);
+    PDCPL_VARIANT_INIT(float)(&vts[5], 3.25f);
+    PDCPL_VARIANT_INIT(string_ref)(&vts[6], str);
+    PDCPL_VARIANT_INIT(string_ref)(&vts[7], nullptr);
+    PDCPL_VARIANT_INIT(void_ref)(&vts[8], buf, sizeof buf);
+    return vts;
+  }
+
+  /**
+   * Check that a decoded variant holds the same value as the original.
+   *
+   * @param expected Original variant
+   * @param actual Decoded variant
+   */
+  static void
+  ExpectSame(const pdcpl_variant& expected, const pdcpl_variant& actual)
+  {
+    ASSERT_TRUE(pdcpl_variant_shared_type(&expected, &actual));
+    // decoded variants never own their memory
+    EXPECT_FALSE(actual.flags & pdcpl_variant_mem_own);
+    if (expected.flags & pdcpl_variant_string && !expected.data.s) {
+      EXPECT_EQ(nullptr, actual.data.s);
+    }
+    else if (expected.flags & pdcpl_variant_double) {
+      EXPECT_EQ(expected.data.d, actual.data.d);
+    }
+    else if (expected.flags & pdcpl_variant_float) {
+      EXPECT_EQ(expected.data.f, actual.data.f);
+    }
+    else {
+      EXPECT_EQ(0, pdcpl_variant_compare(&expected, &actual));
+    }
+  }
+};
+
+/**
+ * Test that varints round trip and use the expected number of bytes.
+ */
+TEST_F(VariantCodecTest, VarintTest)
+{
+  unsigned char buf[PDCPL_VARINT_MAX_SIZE];
+  for (std::uint64_t value : {
+    std::uint64_t{0},
+    std::uint64_t{127},
+    std::uint64_t{128},
+    std::uint64_t{16384},
+    std::numeric_limits<std::uint64_t>::max()
+  }) {
+    auto n = pdcpl_varint_encode(value, buf);
+    EXPECT_EQ(pdcpl_varint_size(value), n);
+    std::uint64_t decoded;
+    std::size_t nr;
+    ASSERT_FALSE(pdcpl_varint_decode(buf, n, &decoded, &nr));
+    EXPECT_EQ(value, decoded);
+    EXPECT_EQ(n, nr);
+    // truncated varints are detected
+    if (n > 1) {
+      EXPECT_EQ(-ERANGE, pdcpl_varint_decode(buf, n - 1, &decoded, &nr));
+    }
+  }
+  EXPECT_EQ(PDCPL_VARINT_MAX_SIZE, pdcpl_varint_size(~std::uint64_t{0}));
+}
+
+/**
+ * Test that single variants round trip through the encoding.
+ */
+TEST_F(VariantCodecTest, RoundTripTest)
+{
+  unsigned char buf[64];
+  for (const auto& vt : CreateVariants()) {
+    std::size_t expected_size, nw, nr;
+    ASSERT_FALSE(pdcpl_variant_encoded_size(&vt, &expected_size));
+    ASSERT_FALSE(pdcpl_variant_encode(&vt, buf, sizeof buf, &nw));
+    EXPECT_EQ(expected_size, nw);
+    pdcpl_variant decoded;
+    ASSERT_FALSE(pdcpl_variant_decode(buf, nw, &decoded, &nr));
+    EXPECT_EQ(nw, nr);
+    ExpectSame(vt, decoded);
+    // too small output buffer is an error, as is a truncated input buffer
+    EXPECT_EQ(-ERANGE, pdcpl_variant_encode(&vt, buf, nw - 1, nullptr));
+    EXPECT_EQ(-ERANGE, pdcpl_variant_decode(buf, nw - 1, &decoded, nullptr));
+  }
+  // empty void buffer can't be decoded, so it can't be encoded either. since
+  // void_ref rejects empty buffers, the variant is filled in directly
+  pdcpl_variant empty{};
+  empty.flags = pdcpl_variant_void | pdcpl_variant_mem_borrow;
+  empty.data.v.b = buf;
+  empty.data.v.z = 0;
+  std::size_t size;
+  EXPECT_EQ(-EINVAL, pdcpl_variant_encoded_size(&empty, &size));
+  EXPECT_EQ(-EINVAL, pdcpl_variant_encode(&empty, buf, sizeof buf, nullptr));
+  EXPECT_EQ(
+    -EINVAL, pdcpl_variant_array_encode(&empty, 1, buf, sizeof buf, nullptr)
+  );
+}
+
+/**
+ * Test that decoded strings and buffers borrow from the input buffer.
+ */
+TEST_F(VariantCodecTest, BorrowTest)
+{
+  auto vts = CreateVariants();
+  std::size_t size;
+  ASSERT_FALSE(
+    pdcpl_variant_array_encoded_size(vts.data(), vts.size(), &size)
+  );
+  std::vector<unsigned char> buf(size);
+  ASSERT_FALSE(
+    pdcpl_variant_array_encode(
+      vts.data(), vts.size(), buf.data(), size, nullptr
+    )
+  );
+  std::vector<pdcpl_variant> decoded(vts.size());
+  std::size_t n;
+  ASSERT_FALSE(
+    pdcpl_variant_array_decode(
+      buf.data(), size, decoded.data(), decoded.size(), &n, nullptr
+    )
+  );
+  ASSERT_EQ(vts.size(), n);
+  auto in_buffer = [&buf](const void* p)
+  {
+    auto c = static_cast<const unsigned char*>(p);
+    return c >= buf.data() && c < buf.data() + buf.size();
+  };
+  EXPECT_TRUE(decoded[6].flags & pdcpl_variant_mem_borrow);
+  EXPECT_TRUE(in_buffer(decoded[6].data.s));
+  EXPECT_STREQ(vts[6].data.s, decoded[6].data.s);
+  EXPECT_TRUE(decoded[8].flags & pdcpl_variant_mem_borrow);
+  EXPECT_TRUE(in_buffer(decoded[8].data.v.b));
+  // freeing borrowed variants is a no-op
+  for (auto& vt : decoded)
+    EXPECT_FALSE(pdcpl_variant_free(&vt));
+}
+
+/**
+ * Test that decoding an array into too few variants reports the count.
+ */
+TEST_F(VariantCodecTest, ArrayTooSmallTest)
+{
+  auto vts = CreateVariants();
+  unsigned char buf[256];
+  std::size_t nw, n;
+  ASSERT_FALSE(
+    pdcpl_variant_array_encode(vts.data(), vts.size(), buf, sizeof buf, &nw)
+  );
+  pdcpl_variant decoded[2];
+  EXPECT_EQ(
+    -ERANGE, pdcpl_variant_array_decode(buf, nw, decoded, 2, &n, nullptr)
+  );
+  EXPECT_EQ(vts.size(), n);
+}
+
+/**
+ * Test that malformed input is rejected.
+ */
+TEST_F(VariantCodecTest, MalformedTest)
+{
+  pdcpl_variant vt;
+  // unknown tag
+  const unsigned char bad_tag[] = {0x7f, 0x00};
+  EXPECT_EQ(
+    -EINVAL, pdcpl_variant_decode(bad_tag, sizeof bad_tag, &vt, nullptr)
+  );
+  // string without a null terminator
+  const unsigned char bad_str[] = {pdcpl_variant_tag_string, 0x02, 'a', 'b'};
+  EXPECT_EQ(
+    -EINVAL, pdcpl_variant_decode(bad_str, sizeof bad_str, &vt, nullptr)
+  );
+  // empty void buffer
+  const unsigned char bad_void[] = {pdcpl_variant_tag_void, 0x00};
+  EXPECT_EQ(
+    -EINVAL, pdcpl_variant_decode(bad_void, sizeof bad_void, &vt, nullptr)
+  );
+  // encoding variant with no type
+  pdcpl_variant untyped{};
+  std::size_t size;
+  EXPECT_EQ(-EINVAL, pdcpl_variant_encoded_size(&untyped, &size));
+}
+
+/**
+ * Test that frames written to a stream can be read back.
+ */
+TEST_F(VariantCodecTest, FrameStreamTest)
+{
+  auto vts = CreateVariants();
+  auto f = std::tmpfile();
+  ASSERT_TRUE(f) << "std::tmpfile() failed: " << std::strerror(errno);
+  // write a few frames with different numbers of variants
+  constexpr std::size_t n_frames = 3;
+  for (std::size_t i = 0; i < n_frames; i++)
+    ASSERT_FALSE(pdcpl_variant_frame_write(f, vts.data(), vts.size() - i));
+  std::rewind(f);
+  pdcpl_buffer buf{};
+  std::vector<pdcpl_variant> decoded(vts.size());
+  std::size_t payload_size, n;
+  for (std::size_t i = 0; i < n_frames; i++) {
+    ASSERT_FALSE(pdcpl_variant_frame_read(f, &buf, &payload_size));
+    ASSERT_TRUE(payload_size);
+    ASSERT_FALSE(
+      pdcpl_variant_array_decode(
+        buf.data, payload_size, decoded.data(), decoded.size(), &n, nullptr
+      )
+    );
+    ASSERT_EQ(vts.size() - i, n);
+    for (std::size_t j = 0; j < n; j++)
+      ExpectSame(vts[j], decoded[j]);
+  }
+  // clean EOF
+  ASSERT_FALSE(pdcpl_variant_frame_read(f, &buf, &payload_size));
+  EXPECT_EQ(0U, payload_size);
+  pdcpl_buffer_clear(&buf);
+  std::fclose(f);
+}
+
+/**
+ * Test that frames in a memory buffer can be iterated over.
+ */
+TEST_F(VariantCodecTest, FrameBufferTest)
+{
+  auto vts = CreateVariants();
+  std::size_t payload_size;
+  ASSERT_FALSE(
+    pdcpl_variant_array_encoded_size(vts.data(), vts.size(), &payload_size)
+  );
+  // two identical frames back to back
+  const auto frame_size = pdcpl_varint_size(payload_size) + payload_size;
+  std::vector<unsigned char> buf(2 * frame_size);
+  for (std::size_t i = 0; i < 2; i++) {
+    auto out = buf.data() + i * frame_size;
+    auto nh = pdcpl_varint_encode(payload_size, out);
+    ASSERT_FALSE(
+      pdcpl_variant_array_encode(
+        vts.data(), vts.size(), out + nh, payload_size, nullptr
+      )
+    );
+  }
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < 2; i++) {
+    const void* payload;
+    std::size_t size, nr;
+    ASSERT_FALSE(
+      pdcpl_variant_frame_next(
+        buf.data() + offset, buf.size() - offset, &payload, &size, &nr
+      )
+    );
+    EXPECT_EQ(payload_size, size);
+    EXPECT_EQ(frame_size, nr);
+    offset += nr;
+  }
+  EXPECT_EQ(buf.size(), offset);
+  // truncated frame
+  const void* payload;
+  std::size_t size, nr;
+  EXPECT_EQ(
+    -ERANGE,
+    pdcpl_variant_frame_next(buf.data(), frame_size - 1, &payload, &size, &nr)
+  );
+}
+
+}  // namespace
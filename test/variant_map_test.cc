@@ -0,0 +1,158 @@
+/**
+ * @file variant_map_test.cc
+ * @author Derek Huang
+ * @brief variant_map.(c|h) unit test
+ * @copyright MIT License
+ */
+
+#include "pdcpl/variant_map.h"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pdcpl/variant.h"
+
+namespace {
+
+/**
+ * Main test fixture for variant map tests.
+ */
+class VariantMapTest : public ::testing::Test {
+protected:
+  void SetUp() override
+  {
+    ASSERT_FALSE(pdcpl_variant_map_init(&map_, 0, 0));
+  }
+
+  void TearDown() override
+  {
+    ASSERT_FALSE(pdcpl_variant_map_free(&map_));
+  }
+
+  pdcpl_variant_map map_;
+};
+
+/**
+ * Test that keys of different types that hold the same bits are distinct.
+ */
+TEST_F(VariantMapTest, MixedTypeTest)
+{
+  pdcpl_variant ki, ku, kc;
+  PDCPL_VARIANT_INIT(int)(&ki, 65);
+  PDCPL_VARIANT_INIT(uint)(&ku, 65U);
+  PDCPL_VARIANT_INIT(char)(&kc, 'A');
+  int vi, vu, vc;
+  ASSERT_FALSE(pdcpl_variant_map_insert(&map_, &ki, &vi));
+  ASSERT_FALSE(pdcpl_variant_map_insert(&map_, &ku, &vu));
+  ASSERT_FALSE(pdcpl_variant_map_insert(&map_, &kc, &vc));
+  EXPECT_EQ(3U, map_.size);
+  EXPECT_EQ(&vi, *pdcpl_variant_map_find(&map_, &ki));
+  EXPECT_EQ(&vu, *pdcpl_variant_map_find(&map_, &ku));
+  EXPECT_EQ(&vc, *pdcpl_variant_map_find(&map_, &kc));
+  // -0.0 and +0.0 are the same key
+  pdcpl_variant kpz, knz;
+  PDCPL_VARIANT_INIT(double)(&kpz, 0.);
+  PDCPL_VARIANT_INIT(double)(&knz, -0.);
+  ASSERT_FALSE(pdcpl_variant_map_insert(&map_, &kpz, &vi));
+  EXPECT_EQ(&vi, *pdcpl_variant_map_find(&map_, &knz));
+}
+
+/**
+ * Test that string keys are copied and can be looked up with borrowed keys.
+ */
+TEST_F(VariantMapTest, StringKeyTest)
+{
+  std::string key_str{"group key"};
+  pdcpl_variant key;
+  ASSERT_FALSE(PDCPL_VARIANT_INIT(string_ref)(&key, key_str.data()));
+  int value;
+  ASSERT_FALSE(pdcpl_variant_map_insert(&map_, &key, &value));
+  // modifying the original string doesn't affect the owned copy
+  key_str[0] = 'G';
+  EXPECT_FALSE(pdcpl_variant_map_find(&map_, &key));
+  key_str[0] = 'g';
+  auto slot = pdcpl_variant_map_find(&map_, &key);
+  ASSERT_TRUE(slot);
+  EXPECT_EQ(&value, *slot);
+}
+
+/**
+ * Test grouping with `pdcpl_variant_map_emplace`, growth, and erasure.
+ */
+TEST_F(VariantMapTest, GroupByTest)
+{
+  // keys 0, 1, ..., n_keys - 1, each seen n_keys - key times
+  constexpr std::uintptr_t n_keys = 200;
+  pdcpl_variant key;
+  for (std::uintptr_t i = 0; i < n_keys; i++) {
+    for (std::uintptr_t j = i; j < n_keys; j++) {
+      PDCPL_VARIANT_INIT(size)(&key, j);
+      void** slot;
+      bool inserted;
+      ASSERT_FALSE(pdcpl_variant_map_emplace(&map_, &key, &slot, &inserted));
+      EXPECT_EQ(!i, inserted);
+      // count stored in the pointer value itself
+      auto count = reinterpret_cast<std::uintptr_t>(*slot);
+      *slot = reinterpret_cast<void*>(count + 1);
+    }
+  }
+  ASSERT_EQ(n_keys, map_.size);
+  for (std::uintptr_t i = 0; i < n_keys; i++) {
+    PDCPL_VARIANT_INIT(size)(&key, i);
+    auto slot = pdcpl_variant_map_find(&map_, &key);
+    ASSERT_TRUE(slot);
+    EXPECT_EQ(i + 1, reinterpret_cast<std::uintptr_t>(*slot));
+  }
+  // erase the even keys and make sure odd keys are all still reachable
+  for (std::uintptr_t i = 0; i < n_keys; i += 2) {
+    PDCPL_VARIANT_INIT(size)(&key, i);
+    ASSERT_FALSE(pdcpl_variant_map_erase(&map_, &key));
+  }
+  EXPECT_EQ(n_keys / 2, map_.size);
+  for (std::uintptr_t i = 0; i < n_keys; i++) {
+    PDCPL_VARIANT_INIT(size)(&key, i);
+    EXPECT_EQ(i % 2, !!pdcpl_variant_map_find(&map_, &key));
+  }
+  PDCPL_VARIANT_INIT(size)(&key, 0);
+  EXPECT_EQ(-ENOENT, pdcpl_variant_map_erase(&map_, &key));
+}
+
+/**
+ * Test that a map with borrowed keys stores the keys as given.
+ */
+TEST_F(VariantMapTest, BorrowKeysTest)
+{
+  static char key_str[] = "borrowed";
+  pdcpl_variant_map map;
+  ASSERT_FALSE(
+    pdcpl_variant_map_init(&map, 100, pdcpl_variant_map_borrow_keys)
+  );
+  EXPECT_LE(100U, map.capacity / 4 * 3);
+  pdcpl_variant key;
+  PDCPL_VARIANT_INIT(string_ref)(&key, key_str);
+  ASSERT_FALSE(pdcpl_variant_map_insert(&map, &key, nullptr));
+  for (std::size_t i = 0; i < map.capacity; i++) {
+    if (pdcpl_variant_map_entry_used(map.entries + i)) {
+      EXPECT_EQ(key_str, map.entries[i].key.data.s);
+    }
+  }
+  ASSERT_FALSE(pdcpl_variant_map_free(&map));
+}
+
+/**
+ * Test that invalid keys are rejected.
+ */
+TEST_F(VariantMapTest, InvalidKeyTest)
+{
+  pdcpl_variant key{};
+  EXPECT_EQ(-EINVAL, pdcpl_variant_map_insert(&map_, &key, nullptr));
+  key.flags = pdcpl_variant_int | pdcpl_variant_char;
+  EXPECT_EQ(-EINVAL, pdcpl_variant_map_insert(&map_, &key, nullptr));
+  EXPECT_FALSE(pdcpl_variant_map_find(&map_, &key));
+}
+
+}  // namespace
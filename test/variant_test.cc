@@ -10,8 +10,10 @@
 #include <gtest/gtest.h>
 
 #include <cerrno>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <string>
 #include <tuple>
 
@@ -164,6 +166,91 @@ TEST_F(VariantTest, FreeErrorTest)
   EXPECT_EQ(-EINVAL, pdcpl_variant_free(&vt));
 }
 
+/**
+ * Test that `pdcpl_variant_equal` is exact and type-aware.
+ */
+TEST_F(VariantTest, EqualTest)
+{
+  pdcpl_variant va, vb;
+  // same bits, different types
+  PDCPL_VARIANT_INIT(int)(&va, 1);
+  PDCPL_VARIANT_INIT(uint)(&vb, 1U);
+  EXPECT_FALSE(pdcpl_variant_equal(&va, &vb));
+  // signed zeros are equal
+  PDCPL_VARIANT_INIT(double)(&va, 0.);
+  PDCPL_VARIANT_INIT(double)(&vb, -0.);
+  EXPECT_TRUE(pdcpl_variant_equal(&va, &vb));
+  // NaN equals NaN
+  PDCPL_VARIANT_INIT(float)(&va, std::numeric_limits<float>::quiet_NaN());
+  PDCPL_VARIANT_INIT(float)(&vb, -std::numeric_limits<float>::quiet_NaN());
+  EXPECT_TRUE(pdcpl_variant_equal(&va, &vb));
+  // no epsilon tolerance, unlike pdcpl_variant_compare
+  PDCPL_VARIANT_INIT(double)(&va, 1.);
+  PDCPL_VARIANT_INIT(double)(&vb, std::nextafter(1., 2.));
+  EXPECT_FALSE(pdcpl_variant_equal(&va, &vb));
+  // owned and borrowed strings compare by contents
+  static char value[] = "string";
+  ASSERT_FALSE(PDCPL_VARIANT_INIT(string)(&va, value));
+  PDCPL_VARIANT_INIT(string_ref)(&vb, value);
+  EXPECT_TRUE(pdcpl_variant_equal(&va, &vb));
+  ASSERT_FALSE(pdcpl_variant_free(&va));
+  // NULL string only equals NULL string
+  ASSERT_FALSE(PDCPL_VARIANT_INIT(string)(&va, nullptr));
+  EXPECT_FALSE(pdcpl_variant_equal(&va, &vb));
+  PDCPL_VARIANT_INIT(string_ref)(&vb, nullptr);
+  EXPECT_TRUE(pdcpl_variant_equal(&va, &vb));
+}
+
+/**
+ * Test that `pdcpl_variant_hash` is consistent with `pdcpl_variant_equal`.
+ */
+TEST_F(VariantTest, HashTest)
+{
+  pdcpl_variant va, vb;
+  PDCPL_VARIANT_INIT(double)(&va, 0.);
+  PDCPL_VARIANT_INIT(double)(&vb, -0.);
+  EXPECT_EQ(pdcpl_variant_hash(&va), pdcpl_variant_hash(&vb));
+  PDCPL_VARIANT_INIT(double)(&va, std::numeric_limits<double>::quiet_NaN());
+  PDCPL_VARIANT_INIT(double)(&vb, -std::numeric_limits<double>::quiet_NaN());
+  EXPECT_EQ(pdcpl_variant_hash(&va), pdcpl_variant_hash(&vb));
+  // type is part of the hash
+  PDCPL_VARIANT_INIT(int)(&va, 42);
+  PDCPL_VARIANT_INIT(size)(&vb, 42U);
+  EXPECT_NE(pdcpl_variant_hash(&va), pdcpl_variant_hash(&vb));
+  // contents are hashed, not pointers. use string longer than 8 bytes
+  static char value[] = "a string long enough to span words";
+  ASSERT_FALSE(PDCPL_VARIANT_INIT(string)(&va, value));
+  PDCPL_VARIANT_INIT(string_ref)(&vb, value);
+  EXPECT_EQ(pdcpl_variant_hash(&va), pdcpl_variant_hash(&vb));
+  ASSERT_FALSE(pdcpl_variant_free(&va));
+  // strings and void buffers with the same bytes differ
+  PDCPL_VARIANT_INIT(void_ref)(&va, value, std::strlen(value));
+  EXPECT_NE(pdcpl_variant_hash(&va), pdcpl_variant_hash(&vb));
+}
+
+/**
+ * Test that `pdcpl_variant_copy` makes deep copies.
+ */
+TEST_F(VariantTest, CopyTest)
+{
+  static char value[] = "borrowed";
+  pdcpl_variant src, dst;
+  PDCPL_VARIANT_INIT(string_ref)(&src, value);
+  ASSERT_FALSE(pdcpl_variant_copy(&dst, &src));
+  EXPECT_TRUE(dst.flags & pdcpl_variant_mem_own);
+  EXPECT_NE(src.data.s, dst.data.s);
+  EXPECT_TRUE(pdcpl_variant_equal(&src, &dst));
+  ASSERT_FALSE(pdcpl_variant_free(&dst));
+  PDCPL_VARIANT_INIT(void_ref)(&src, value, sizeof value);
+  ASSERT_FALSE(pdcpl_variant_copy(&dst, &src));
+  EXPECT_NE(src.data.v.b, dst.data.v.b);
+  EXPECT_TRUE(pdcpl_variant_equal(&src, &dst));
+  ASSERT_FALSE(pdcpl_variant_free(&dst));
+  // untyped source is an error
+  src.flags = 0;
+  EXPECT_EQ(-EINVAL, pdcpl_variant_copy(&dst, &src));
+}
+
 /**
  * Test fixture for parametrized testing of `pdcpl_variant_shared_type`.
  */
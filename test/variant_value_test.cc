@@ -0,0 +1,184 @@
+/**
+ * @file variant_value_test.cc
+ * @author Derek Huang
+ * @brief variant_value.hh unit test
+ * @copyright MIT License
+ */
+
+#include "pdcpl/variant_value.hh"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "pdcpl/variant.h"
+
+namespace {
+
+/**
+ * Main test fixture for `variant_value` tests.
+ */
+class VariantValueTest : public ::testing::Test {};
+
+// moves must be noexcept so containers relocate with moves, not copies
+static_assert(std::is_nothrow_move_constructible_v<pdcpl::variant_value>);
+static_assert(std::is_nothrow_move_assignable_v<pdcpl::variant_value>);
+static_assert(!std::is_copy_constructible_v<pdcpl::variant_value>);
+static_assert(!std::is_copy_assignable_v<pdcpl::variant_value>);
+static_assert(
+  pdcpl::variant_type_v<double> == pdcpl::variant_type::double_value
+);
+static_assert(
+  pdcpl::variant_type_v<std::size_t> == pdcpl::variant_type::size_value ||
+  std::is_same_v<std::size_t, unsigned int>
+);
+
+/**
+ * Test that scalar values are stored and typed correctly.
+ */
+TEST_F(VariantValueTest, ScalarTest)
+{
+  pdcpl::variant_value vc{'a'}, vi{-5}, vu{7U}, vd{2.5}, vf{1.5f};
+  EXPECT_EQ('a', vc.get<pdcpl::variant_type::char_value>());
+  EXPECT_EQ(-5, vi.get<pdcpl::variant_type::int_value>());
+  EXPECT_EQ(7U, vu.get<pdcpl::variant_type::uint_value>());
+  EXPECT_EQ(2.5, vd.get<pdcpl::variant_type::double_value>());
+  EXPECT_EQ(1.5f, vf.get<pdcpl::variant_type::float_value>());
+  EXPECT_TRUE(vi.holds<pdcpl::variant_type::int_value>());
+  EXPECT_THROW(
+    vi.get<pdcpl::variant_type::uint_value>(), std::bad_variant_access
+  );
+  pdcpl::variant_value empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_FALSE(empty);
+}
+
+/**
+ * Test that strings are owned and viewable.
+ */
+TEST_F(VariantValueTest, StringTest)
+{
+  std::string_view text{"owned text"};
+  pdcpl::variant_value value{text};
+  EXPECT_TRUE(value.owns_memory());
+  EXPECT_EQ(text, value.as_string());
+  EXPECT_NE(text.data(), value.as_string().data());
+  EXPECT_THROW(value.as_bytes(), std::bad_variant_access);
+  pdcpl::variant_value c_value{"c string"};
+  EXPECT_EQ("c string", c_value.as_string());
+  EXPECT_THROW(
+    pdcpl::variant_value{static_cast<const char*>(nullptr)},
+    std::invalid_argument
+  );
+}
+
+/**
+ * Test that `void *` buffers are owned and viewable.
+ */
+TEST_F(VariantValueTest, BytesTest)
+{
+  const unsigned char data[] = {1, 2, 3, 4};
+  pdcpl::variant_value value{data, sizeof data};
+  auto bytes = value.as_bytes();
+  ASSERT_EQ(sizeof data, bytes.size());
+  EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), data));
+  EXPECT_THROW(
+    (pdcpl::variant_value{data, 0}), std::invalid_argument
+  );
+}
+
+/**
+ * Test that moves transfer ownership and copies are deep.
+ */
+TEST_F(VariantValueTest, MoveCopyTest)
+{
+  pdcpl::variant_value a{"moved string"};
+  auto data = a.as_string().data();
+  auto b = std::move(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(data, b.as_string().data());
+  auto c = b.copy();
+  EXPECT_EQ(b, c);
+  EXPECT_NE(b.as_string().data(), c.as_string().data());
+  // vector growth relocates strings without copying them
+  std::vector<pdcpl::variant_value> values;
+  values.emplace_back(std::move(b));
+  auto first = values.front().as_string().data();
+  for (int i = 0; i < 100; i++)
+    values.emplace_back(i);
+  EXPECT_EQ(first, values.front().as_string().data());
+}
+
+/**
+ * Test that borrowed C variants can be wrapped and released.
+ */
+TEST_F(VariantValueTest, WrapTest)
+{
+  static char text[] = "borrowed";
+  pdcpl_variant vt;
+  ASSERT_FALSE(PDCPL_VARIANT_INIT(string_ref)(&vt, text));
+  auto value = pdcpl::variant_value::wrap(vt);
+  EXPECT_FALSE(value.owns_memory());
+  EXPECT_EQ(text, value.as_string().data());
+  auto released = value.release();
+  EXPECT_TRUE(value.empty());
+  EXPECT_EQ(text, released.data.s);
+}
+
+/**
+ * Test that comparison is a total order, type first and then value.
+ */
+TEST_F(VariantValueTest, CompareTest)
+{
+  constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+  // same bits, different types
+  EXPECT_NE(pdcpl::variant_value{1}, pdcpl::variant_value{1U});
+  EXPECT_LT(pdcpl::variant_value{100}, pdcpl::variant_value{1U});
+  // signed zeros are equal, NaN orders last and equals NaN
+  EXPECT_EQ(pdcpl::variant_value{0.}, pdcpl::variant_value{-0.});
+  EXPECT_LT(pdcpl::variant_value{1e300}, pdcpl::variant_value{nan});
+  EXPECT_EQ(pdcpl::variant_value{nan}, pdcpl::variant_value{-nan});
+  // strings compare by contents
+  EXPECT_LT(pdcpl::variant_value{"abc"}, pdcpl::variant_value{"abd"});
+  EXPECT_EQ(pdcpl::variant_value{"abc"}, pdcpl::variant_value{"abc"});
+  // sorting a mixed vector groups by type
+  std::vector<pdcpl::variant_value> values;
+  values.emplace_back("b");
+  values.emplace_back(3);
+  values.emplace_back(1.5);
+  values.emplace_back("a");
+  values.emplace_back(-2);
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(-2, values[0].get<pdcpl::variant_type::int_value>());
+  EXPECT_EQ(3, values[1].get<pdcpl::variant_type::int_value>());
+  EXPECT_EQ(1.5, values[2].get<pdcpl::variant_type::double_value>());
+  EXPECT_EQ("a", values[3].as_string());
+  EXPECT_EQ("b", values[4].as_string());
+}
+
+/**
+ * Test that `variant_value` works as an unordered container key.
+ */
+TEST_F(VariantValueTest, HashTest)
+{
+  std::unordered_set<pdcpl::variant_value> values;
+  values.emplace(0.);
+  values.emplace(-0.);
+  values.emplace("key");
+  values.emplace("key");
+  values.emplace(5);
+  values.emplace(5U);
+  EXPECT_EQ(4U, values.size());
+  EXPECT_TRUE(values.count(pdcpl::variant_value{"key"}));
+}
+
+}  // namespace